@@ -40,6 +40,7 @@
 #include "ship/shipfx.h"
 #include "ship/shiphit.h"
 #include "stats/scoring.h"
+#include "tracing/tracing.h"
 #include "weapon/weapon.h"
 
 #include <algorithm>
@@ -84,6 +85,115 @@ typedef struct asteroid_target {
 // if not, then this is whatever number of mission-specified ships (after they arrive, list is sanitized when they exit)
 SCP_vector<asteroid_target> Asteroid_targets;
 
+#define	ASTEROID_PROMOTE_DIST			1000.0f	// instanced asteroids this close to a ship, weapon or the camera become objects
+#define	ASTEROID_DEMOTE_DIST			1500.0f	// promoted asteroids this far away from all of them become instances again
+#define	ASTEROID_PROMOTE_LOOKAHEAD		0.5f	// seconds of movement added to the range of ships and weapons
+#define	ASTEROID_PROMOTE_CELL_SIZE		2000.0f	// size of the grid cells used to find what is near an asteroid
+
+// The asteroids of an instanced field which are far away from anything they could interact with.  They are not objects,
+// they only fly in a straight line, wrap around the field and get drawn.  Keeping them as a structure of arrays lets
+// a field have tens of thousands of them without touching the object limit or the collision pairs.
+struct asteroid_instance_store {
+	SCP_vector<float>	pos_x, pos_y, pos_z;
+	SCP_vector<float>	vel_x, vel_y, vel_z;
+	SCP_vector<matrix>	orient;			// orientation when rot_angle is 0
+	SCP_vector<vec3d>	rot_axis;		// local axis the asteroid spins around
+	SCP_vector<float>	rot_speed;		// radians per second
+	SCP_vector<float>	rot_angle;
+	SCP_vector<float>	radius;
+	SCP_vector<float>	hull_strength;
+	SCP_vector<int>		asteroid_type;
+	SCP_vector<int>		asteroid_subtype;
+	float				max_radius = 0.0f;
+
+	size_t size() const { return pos_x.size(); }
+
+	vec3d pos(size_t i) const
+	{
+		vec3d p;
+		vm_vec_make(&p, pos_x[i], pos_y[i], pos_z[i]);
+		return p;
+	}
+
+	vec3d vel(size_t i) const
+	{
+		vec3d v;
+		vm_vec_make(&v, vel_x[i], vel_y[i], vel_z[i]);
+		return v;
+	}
+
+	void add(const vec3d *p, const vec3d *v, const matrix *m, const vec3d *rotvel, float rad, float hull, int type, int subtype)
+	{
+		pos_x.push_back(p->xyz.x);
+		pos_y.push_back(p->xyz.y);
+		pos_z.push_back(p->xyz.z);
+		vel_x.push_back(v->xyz.x);
+		vel_y.push_back(v->xyz.y);
+		vel_z.push_back(v->xyz.z);
+		orient.push_back(*m);
+
+		vec3d axis;
+		float speed = vm_vec_copy_normalize_safe(&axis, rotvel);
+		rot_axis.push_back(axis);
+		rot_speed.push_back(speed);
+		rot_angle.push_back(0.0f);
+
+		radius.push_back(rad);
+		hull_strength.push_back(hull);
+		asteroid_type.push_back(type);
+		asteroid_subtype.push_back(subtype);
+
+		max_radius = MAX(max_radius, rad);
+	}
+
+	// Removes by moving the last asteroid into the slot, so the order is not kept
+	void remove(size_t i)
+	{
+		auto move_last = [i](auto& vec) {
+			vec[i] = vec.back();
+			vec.pop_back();
+		};
+
+		move_last(pos_x); move_last(pos_y); move_last(pos_z);
+		move_last(vel_x); move_last(vel_y); move_last(vel_z);
+		move_last(orient);
+		move_last(rot_axis);
+		move_last(rot_speed);
+		move_last(rot_angle);
+		move_last(radius);
+		move_last(hull_strength);
+		move_last(asteroid_type);
+		move_last(asteroid_subtype);
+	}
+
+	void clear()
+	{
+		pos_x.clear(); pos_y.clear(); pos_z.clear();
+		vel_x.clear(); vel_y.clear(); vel_z.clear();
+		orient.clear();
+		rot_axis.clear();
+		rot_speed.clear();
+		rot_angle.clear();
+		radius.clear();
+		hull_strength.clear();
+		asteroid_type.clear();
+		asteroid_subtype.clear();
+		max_radius = 0.0f;
+	}
+};
+
+static asteroid_instance_store Asteroid_instances;
+
+// Something which makes instanced asteroids near it become objects: a ship, a weapon or the camera
+typedef struct asteroid_promoter {
+	vec3d	pos;
+	float	radius;
+} asteroid_promoter;
+
+static SCP_vector<asteroid_promoter> Asteroid_promoters;
+// (grid cell, promoter index) of every cell a promoter reaches into, sorted by cell
+static SCP_vector<std::pair<std::uint64_t, int>> Asteroid_promoter_cells;
+
 
 /**
  * Return number of asteroids expected to collide with a ship.
@@ -581,6 +691,50 @@ void asteroid_load(int asteroid_info_index, int asteroid_subtype)
 	}
 }
 
+/**
+ * Create a single asteroid of an instanced field, in the instance store instead of as an object
+ */
+static void asteroid_instance_create(asteroid_field *asfieldp, int asteroid_type, int asteroid_subtype)
+{
+	asteroid_info	*asip;
+	vec3d			pos, vel, rotvel, delta_bound;
+	matrix			orient;
+	angles			angs;
+
+	if (!SCP_vector_inbounds(Asteroid_info, asteroid_type)) {
+		return;
+	}
+
+	asip = &Asteroid_info[asteroid_type];
+
+	if (!SCP_vector_inbounds(asip->subtypes, asteroid_subtype) || asip->subtypes[asteroid_subtype].model_number == -1) {
+		return;
+	}
+
+	// same distributions as asteroid_create() uses for single player
+	vm_vec_sub(&delta_bound, &asfieldp->max_bound, &asfieldp->min_bound);
+	pos.xyz.x = asfieldp->min_bound.xyz.x + delta_bound.xyz.x * frand();
+	pos.xyz.y = asfieldp->min_bound.xyz.y + delta_bound.xyz.y * frand();
+	pos.xyz.z = asfieldp->min_bound.xyz.z + delta_bound.xyz.z * frand();
+	inner_bound_pos_fixup(asfieldp, &pos);
+
+	angs.p = frand() * PI2;
+	angs.b = frand() * PI2;
+	angs.h = frand() * PI2;
+	vm_angles_2_matrix(&orient, &angs);
+
+	vm_vec_rand_vec_quick(&rotvel);
+	vm_vec_scale(&rotvel, asip->rotational_vel_multiplier * (frand()/4.0f + 0.1f));
+
+	vm_vec_rand_vec_quick(&vel);
+	vm_vec_scale(&vel, asteroid_cap_speed(asteroid_type, asfieldp->speed*frand_range(0.5f + (float) Game_skill_level/NUM_SKILL_LEVELS, 2.0f + (float) (2*Game_skill_level)/NUM_SKILL_LEVELS)));
+
+	float radius = model_get_radius(asip->subtypes[asteroid_subtype].model_number);
+	float hull = asip->initial_asteroid_strength * (0.8f + (float)Game_skill_level/NUM_SKILL_LEVELS)/2.0f;
+
+	Asteroid_instances.add(&pos, &vel, &orient, &rotvel, radius, hull, asteroid_type, asteroid_subtype);
+}
+
 /**
  * Create all the asteroids for the mission
  */
@@ -669,6 +823,19 @@ void asteroid_create_all()
 		}
 	}
 
+	// only single player keeps asteroids out of the object system.  In multiplayer every asteroid is an object with a
+	// network signature from the moment it is created, and which asteroids get promoted depends on where the local
+	// camera is, so the server and the clients would end up with different asteroid objects
+	bool instanced = Asteroid_field.instanced && (Game_mode & GM_NORMAL);
+
+	auto create = [instanced](int asteroid_type, int asteroid_subtype) {
+		if (instanced) {
+			asteroid_instance_create(&Asteroid_field, asteroid_type, asteroid_subtype);
+		} else {
+			asteroid_create(&Asteroid_field, asteroid_type, asteroid_subtype);
+		}
+	};
+
 	// load all the asteroid/debris pieces
 	for (i=0; i<max_asteroids; i++) {
 		if (Asteroid_field.debris_genre == DG_ASTEROID) {
@@ -678,7 +845,7 @@ void asteroid_create_all()
 			int subtype = get_asteroid_subtype_index_by_name(pick_random_asteroid_type(), ASTEROID_TYPE_LARGE);
 
 			if (subtype >= 0)
-				asteroid_create(&Asteroid_field, ASTEROID_TYPE_LARGE, subtype);
+				create(ASTEROID_TYPE_LARGE, subtype);
 		} else {
 			Assert(num_debris_types > 0);
 
@@ -687,7 +854,7 @@ void asteroid_create_all()
 			for (idx = 0; idx < static_cast<int>(Asteroid_field.field_debris_type.size()); idx++) {
 				// for ship debris, choose type according to odds table
 				if (rand_choice < shipDebrisOddsTable[idx].random_threshold) {
-					asteroid_create(&Asteroid_field, shipDebrisOddsTable[idx].debris_type, 0);
+					create(shipDebrisOddsTable[idx].debris_type, 0);
 					break;
 				}
 			}
@@ -708,6 +875,8 @@ void remove_all_asteroids()
 			Objects[Asteroids[i].objnum].flags.set(Object::Object_Flags::Should_be_dead);
 		}
 	}
+	Asteroid_instances.clear();
+
 	// This feels hackish, but we need to make sure all the asteroids are actually gone before we continue-Mjn
 	obj_delete_all_that_should_be_dead();
 }
@@ -828,55 +997,64 @@ void asteroid_level_init()
 		Num_asteroids = 0;
 		asteroid_obj_list_init();
 		Asteroid_targets.clear();
+		Asteroid_instances.clear();
 	}
 }
 
 /**
- * Should asteroid wrap from one end of the asteroid field to the other.
- * Multiplayer clients will always return 0 from this function.  We will force a wrap on the clients when server tells us
- *
- * @return !0 if asteroid should be wrapped, 0 otherwise.  
+ * Is the position outside of the asteroid field, so an asteroid there should wrap to the other end of it
  */
-static int asteroid_should_wrap(object *objp, asteroid_field *asfieldp)
+static bool asteroid_pos_should_wrap(const vec3d *pos, const asteroid_field *asfieldp)
 {
-	if ( MULTIPLAYER_CLIENT )
-		return 0;
-
-	if (objp->pos.xyz.x < asfieldp->min_bound.xyz.x) {
-		return 1;
+	if (pos->xyz.x < asfieldp->min_bound.xyz.x) {
+		return true;
 	}
 
-	if (objp->pos.xyz.y < asfieldp->min_bound.xyz.y) {
-		return 1;
+	if (pos->xyz.y < asfieldp->min_bound.xyz.y) {
+		return true;
 	}
 
-	if (objp->pos.xyz.z < asfieldp->min_bound.xyz.z) {
-		return 1;
+	if (pos->xyz.z < asfieldp->min_bound.xyz.z) {
+		return true;
 	}
 
-	if (objp->pos.xyz.x > asfieldp->max_bound.xyz.x) {
-		return 1;
+	if (pos->xyz.x > asfieldp->max_bound.xyz.x) {
+		return true;
 	}
 
-	if (objp->pos.xyz.y > asfieldp->max_bound.xyz.y) {
-		return 1;
+	if (pos->xyz.y > asfieldp->max_bound.xyz.y) {
+		return true;
 	}
 
-	if (objp->pos.xyz.z > asfieldp->max_bound.xyz.z) {
-		return 1;
+	if (pos->xyz.z > asfieldp->max_bound.xyz.z) {
+		return true;
 	}
 
 	// check against inner bound
 	if (asfieldp->has_inner_bound) {
-		if ( (objp->pos.xyz.x > asfieldp->inner_min_bound.xyz.x) && (objp->pos.xyz.x < asfieldp->inner_max_bound.xyz.x)
-		  && (objp->pos.xyz.y > asfieldp->inner_min_bound.xyz.y) && (objp->pos.xyz.y < asfieldp->inner_max_bound.xyz.y)
-		  && (objp->pos.xyz.z > asfieldp->inner_min_bound.xyz.z) && (objp->pos.xyz.z < asfieldp->inner_max_bound.xyz.z) ) {
+		if ( (pos->xyz.x > asfieldp->inner_min_bound.xyz.x) && (pos->xyz.x < asfieldp->inner_max_bound.xyz.x)
+		  && (pos->xyz.y > asfieldp->inner_min_bound.xyz.y) && (pos->xyz.y < asfieldp->inner_max_bound.xyz.y)
+		  && (pos->xyz.z > asfieldp->inner_min_bound.xyz.z) && (pos->xyz.z < asfieldp->inner_max_bound.xyz.z) ) {
 
-			return 1;
+			return true;
 		}
 	}
 
-	return 0;
+	return false;
+}
+
+/**
+ * Should asteroid wrap from one end of the asteroid field to the other.
+ * Multiplayer clients will always return 0 from this function.  We will force a wrap on the clients when server tells us
+ *
+ * @return !0 if asteroid should be wrapped, 0 otherwise.  
+ */
+static int asteroid_should_wrap(object *objp, asteroid_field *asfieldp)
+{
+	if ( MULTIPLAYER_CLIENT )
+		return 0;
+
+	return asteroid_pos_should_wrap(&objp->pos, asfieldp) ? 1 : 0;
 }
 
 /**
@@ -1172,6 +1350,258 @@ static void asteroid_maybe_reposition(object *objp, asteroid_field *asfieldp)
 	}
 }
 
+static int asteroid_cell_coord(float pos)
+{
+	return static_cast<int>(floorf(pos / ASTEROID_PROMOTE_CELL_SIZE));
+}
+
+static std::uint64_t asteroid_cell_key(int x, int y, int z)
+{
+	// 21 bits per axis cover more than a million kilometers at this cell size
+	auto pack = [](int coord) { return static_cast<std::uint64_t>(std::clamp(coord + (1 << 20), 0, (1 << 21) - 1)); };
+
+	return (pack(x) << 42) | (pack(y) << 21) | pack(z);
+}
+
+/**
+ * Collect the ships, weapons and the camera and put them into the grid cells which are close enough to them for an
+ * asteroid in the cell to be promoted or to stay an object
+ */
+static void asteroid_gather_promoters()
+{
+	Asteroid_promoters.clear();
+	Asteroid_promoter_cells.clear();
+
+	auto add_promoter = [](const vec3d *pos, float radius) {
+		int index = static_cast<int>(Asteroid_promoters.size());
+		Asteroid_promoters.push_back({*pos, radius});
+
+		float reach = radius + ASTEROID_DEMOTE_DIST + Asteroid_instances.max_radius;
+		int min_x = asteroid_cell_coord(pos->xyz.x - reach), max_x = asteroid_cell_coord(pos->xyz.x + reach);
+		int min_y = asteroid_cell_coord(pos->xyz.y - reach), max_y = asteroid_cell_coord(pos->xyz.y + reach);
+		int min_z = asteroid_cell_coord(pos->xyz.z - reach), max_z = asteroid_cell_coord(pos->xyz.z + reach);
+
+		for (int x = min_x; x <= max_x; x++) {
+			for (int y = min_y; y <= max_y; y++) {
+				for (int z = min_z; z <= max_z; z++) {
+					Asteroid_promoter_cells.emplace_back(asteroid_cell_key(x, y, z), index);
+				}
+			}
+		}
+	};
+
+	add_promoter(&Eye_position, 0.0f);
+
+	for (auto objp : list_range(&obj_used_list)) {
+		if ((objp->type != OBJ_SHIP && objp->type != OBJ_WEAPON) || objp->flags[Object::Object_Flags::Should_be_dead]) {
+			continue;
+		}
+
+		add_promoter(&objp->pos, objp->radius + vm_vec_mag_quick(&objp->phys_info.vel) * ASTEROID_PROMOTE_LOOKAHEAD);
+	}
+
+	std::sort(Asteroid_promoter_cells.begin(), Asteroid_promoter_cells.end());
+}
+
+/**
+ * Distance from the surface of an asteroid to the closest promoter, or ASTEROID_DEMOTE_DIST if there is none closer
+ */
+static float asteroid_promoter_dist(const vec3d *pos, float radius)
+{
+	float closest = ASTEROID_DEMOTE_DIST;
+
+	auto key = asteroid_cell_key(asteroid_cell_coord(pos->xyz.x), asteroid_cell_coord(pos->xyz.y), asteroid_cell_coord(pos->xyz.z));
+	auto it = std::lower_bound(Asteroid_promoter_cells.begin(), Asteroid_promoter_cells.end(), std::make_pair(key, -1));
+
+	for (; it != Asteroid_promoter_cells.end() && it->first == key; ++it) {
+		const auto& promoter = Asteroid_promoters[it->second];
+
+		float dist = vm_vec_dist(pos, &promoter.pos) - promoter.radius - radius;
+		closest = MIN(closest, dist);
+	}
+
+	return closest;
+}
+
+/**
+ * Orientation of an instanced asteroid, including the spin since it became an instance
+ */
+static void asteroid_instance_orient(matrix *orient, size_t i)
+{
+	matrix rotmat;
+
+	vm_quaternion_rotate(&rotmat, Asteroid_instances.rot_angle[i], &Asteroid_instances.rot_axis[i]);
+	vm_matrix_x_matrix(orient, &Asteroid_instances.orient[i], &rotmat);
+}
+
+/**
+ * Turn an instanced asteroid into a real asteroid object at the same place, moving the same way
+ */
+static bool asteroid_instance_promote(size_t i)
+{
+	object *objp = asteroid_create(&Asteroid_field, Asteroid_instances.asteroid_type[i], Asteroid_instances.asteroid_subtype[i]);
+
+	if (objp == nullptr) {
+		return false;
+	}
+
+	//	Now, bash some values.
+	objp->pos = Asteroid_instances.pos(i);
+	asteroid_instance_orient(&objp->orient, i);
+	objp->last_orient = objp->orient;
+
+	objp->phys_info.vel = Asteroid_instances.vel(i);
+	objp->phys_info.desired_vel = objp->phys_info.vel;
+	objp->phys_info.max_vel.xyz.z = vm_vec_mag(&objp->phys_info.vel);
+	vm_vec_copy_scale(&objp->phys_info.rotvel, &Asteroid_instances.rot_axis[i], Asteroid_instances.rot_speed[i]);
+	vm_vec_scale_add(&objp->last_pos, &objp->pos, &objp->phys_info.vel, -flFrametime);
+
+	objp->hull_strength = Asteroid_instances.hull_strength[i];
+
+	Asteroids[objp->instance].flags |= AF_INSTANCED;
+
+	return true;
+}
+
+/**
+ * Can a promoted asteroid go back to the instance store without anybody noticing?
+ */
+static bool asteroid_can_demote(object *objp)
+{
+	asteroid *asp = &Asteroids[objp->instance];
+
+	if (!(asp->flags & AF_INSTANCED) || objp->flags[Object::Object_Flags::Should_be_dead]) {
+		return false;
+	}
+
+	// breaking up, thrown at a ship or about to hit one
+	if (asp->final_death_time.isValid() || asp->target_objnum >= 0 || asp->collide_objnum >= 0) {
+		return false;
+	}
+
+	return !asteroid_is_targeted(objp);
+}
+
+/**
+ * Turn a promoted asteroid object back into an instance
+ */
+static void asteroid_demote(object *objp)
+{
+	asteroid *asp = &Asteroids[objp->instance];
+
+	Asteroid_instances.add(&objp->pos, &objp->phys_info.vel, &objp->orient, &objp->phys_info.rotvel, objp->radius,
+		objp->hull_strength, asp->asteroid_type, asp->asteroid_subtype);
+
+	objp->flags.set(Object::Object_Flags::Should_be_dead);
+}
+
+/**
+ * Move the instanced asteroids and wrap the ones which left the field the same way asteroid_maybe_reposition() does
+ */
+static void asteroid_instances_move(asteroid_field *asfieldp, float frametime)
+{
+	auto& inst = Asteroid_instances;
+	size_t count = inst.size();
+
+	for (size_t i = 0; i < count; i++) {
+		inst.pos_x[i] += inst.vel_x[i] * frametime;
+		inst.pos_y[i] += inst.vel_y[i] * frametime;
+		inst.pos_z[i] += inst.vel_z[i] * frametime;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		inst.rot_angle[i] = fmodf(inst.rot_angle[i] + inst.rot_speed[i] * frametime, PI2);
+	}
+
+	bool has_gravity = !IS_VEC_NULL(&The_mission.gravity);
+
+	if (has_gravity) {
+		for (size_t i = 0; i < count; i++) {
+			vec3d grav_vel = The_mission.gravity * frametime * Asteroid_info[inst.asteroid_type[i]].gravity_const;
+
+			inst.pos_x[i] += grav_vel.xyz.x * frametime * 0.5f;
+			inst.pos_y[i] += grav_vel.xyz.y * frametime * 0.5f;
+			inst.pos_z[i] += grav_vel.xyz.z * frametime * 0.5f;
+			inst.vel_x[i] += grav_vel.xyz.x;
+			inst.vel_y[i] += grav_vel.xyz.y;
+			inst.vel_z[i] += grav_vel.xyz.z;
+		}
+	}
+
+	// passive field does not wrap if there is no gravity
+	if (!has_gravity && (asfieldp->field_type == FT_PASSIVE)) {
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		vec3d pos = inst.pos(i);
+
+		if (!asteroid_pos_should_wrap(&pos, asfieldp)) {
+			continue;
+		}
+
+		// the player could see it
+		if (asteroid_is_within_view(&pos, asfieldp->bound_rad, asfieldp->enhanced_visibility_checks)) {
+			continue;
+		}
+
+		vec3d new_pos = pos;
+		asteroid_wrap_pos(&new_pos, asfieldp);
+
+		if (!asteroid_is_within_view(&new_pos, (asfieldp->bound_rad * 1.3f), asfieldp->enhanced_visibility_checks)) {
+			inst.pos_x[i] = new_pos.xyz.x;
+			inst.pos_y[i] = new_pos.xyz.y;
+			inst.pos_z[i] = new_pos.xyz.z;
+		} else if (!has_gravity) {
+			inst.vel_x[i] = -inst.vel_x[i];
+			inst.vel_y[i] = -inst.vel_y[i];
+			inst.vel_z[i] = -inst.vel_z[i];
+		}
+	}
+}
+
+/**
+ * Move the instanced asteroids of the field and swap them with real objects as ships, weapons and the camera come
+ * close or leave
+ */
+static void asteroid_instances_frame()
+{
+	TRACE_SCOPE(tracing::AsteroidInstances);
+
+	asteroid_gather_promoters();
+
+	// promoted asteroids which nothing is near anymore go back first, so their slots are free for promotion
+	for (auto aop: list_range(&Asteroid_obj_list)) {
+		object *objp = &Objects[aop->objnum];
+
+		if (objp->type != OBJ_ASTEROID || asteroid_promoter_dist(&objp->pos, objp->radius) < ASTEROID_DEMOTE_DIST) {
+			continue;
+		}
+
+		if (asteroid_can_demote(objp)) {
+			asteroid_demote(objp);
+		}
+	}
+
+	asteroid_instances_move(&Asteroid_field, flFrametime);
+
+	// backwards since promoting moves the last instance into the slot
+	for (size_t i = Asteroid_instances.size(); i-- > 0;) {
+		vec3d pos = Asteroid_instances.pos(i);
+
+		if (asteroid_promoter_dist(&pos, Asteroid_instances.radius[i]) >= ASTEROID_PROMOTE_DIST) {
+			continue;
+		}
+
+		// keep some slots for thrown and split asteroids, the instance stays until there is room
+		if (Num_asteroids > MAX_ASTEROIDS - 10 || !asteroid_instance_promote(i)) {
+			break;
+		}
+
+		Asteroid_instances.remove(i);
+	}
+}
+
 static void lerp(float *goal, float f1, float f2, float scale)
 {
 	*goal = (f2 - f1) * scale + f1;
@@ -1530,6 +1960,41 @@ void asteroid_render(object * obj, model_draw_list *scene)
 	}
 }
 
+/**
+ * Queue the instanced asteroids of the field which are in view
+ */
+void asteroid_render_instanced(model_draw_list *scene)
+{
+	if (Asteroid_instances.size() == 0) {
+		return;
+	}
+
+	for (auto& asip : Asteroid_info) {
+		for (auto& subtype : asip.subtypes) {
+			if (subtype.model_number >= 0) {
+				model_clear_instance(subtype.model_number);
+			}
+		}
+	}
+
+	model_render_params render_info;
+	render_info.set_flags(MR_IS_ASTEROID);
+
+	for (size_t i = 0; i < Asteroid_instances.size(); i++) {
+		vec3d pos = Asteroid_instances.pos(i);
+
+		if (!obj_in_view_cone(&pos, Asteroid_instances.radius[i])) {
+			continue;
+		}
+
+		matrix orient;
+		asteroid_instance_orient(&orient, i);
+
+		int model_num = Asteroid_info[Asteroid_instances.asteroid_type[i]].subtypes[Asteroid_instances.asteroid_subtype[i]].model_number;
+		model_render_queue(&render_info, scene, model_num, &orient, &pos);
+	}
+}
+
 /**
  * Create a normalized vector generally in the direction from *hitpos to other_obj->pos
  */
@@ -1793,6 +2258,8 @@ void asteroid_level_close()
 		}
 	}
 
+	Asteroid_instances.clear();
+
 	Asteroid_field.num_initial_asteroids=0;
 }
 
@@ -2737,6 +3204,11 @@ static int set_asteroid_throw_objnum()
 
 void asteroid_frame()
 {
+	// instanced fields are only created in single player, see asteroid_create_all()
+	if (Asteroids_enabled && Asteroid_field.instanced && (Game_mode & GM_NORMAL)) {
+		asteroid_instances_frame();
+	}
+
 	if (Num_asteroids < 1)
 		return;
 
@@ -104,6 +104,7 @@ public:
 
 
 #define	AF_USED					(1<<0)			// Set means used.
+#define	AF_INSTANCED			(1<<1)			// Promoted from the instanced field store, may be demoted again
 
 typedef	struct asteroid {
 	int		flags;
@@ -149,6 +150,7 @@ struct asteroid_field {
 	SCP_vector<int>	field_debris_type;	// one of the debris type defines above
 	SCP_vector<SCP_string> field_asteroid_type; // one of the asteroid subtypes
 	bool            enhanced_visibility_checks;     // if true then range checks are overridden for spawning and wrapping asteroids in the field
+	bool            instanced;                      // if true then asteroids far from ships, weapons and the camera are kept out of the object system
 
 	SCP_vector<SCP_string> target_names;	// default retail behavior is to just throw at the first big ship in the field
 
@@ -164,6 +166,7 @@ struct asteroid_field {
 		field_type = FT_ACTIVE;
 		debris_genre = DG_ASTEROID;
 		enhanced_visibility_checks = false;
+		instanced = false;
 		bound_rad = 0.0f;
 		vel = ZERO_VECTOR;
 		// the vectors default-construct to empty
@@ -194,6 +197,7 @@ void	asteroid_process_post( object *asteroid_objp);
 int	asteroid_check_collision( object *asteroid_objp, object * other_obj, vec3d * hitpos, collision_info_struct *asteroid_hit_info=NULL, vec3d* hitnormal=NULL );
 void	asteroid_hit( object *pasteroid_objp, object *other_objp, vec3d *hitpos, float damage, vec3d* force );
 int	asteroid_count();
+void	asteroid_render_instanced(model_draw_list* scene);
 int	asteroid_collide_objnum(object *asteroid_objp);
 float asteroid_time_to_impact(object *asteroid_objp);
 void	asteroid_show_brackets();
@@ -24,6 +24,7 @@
 #include "io/key.h"
 #include "io/timer.h"
 #include "jpgutils/jpgutils.h"
+#include "mission/missionmanifest.h"
 #include "network/multiutil.h"
 #include "parse/parselo.h"
 #include "pcxutils/pcxutils.h"
@@ -2633,6 +2634,40 @@ void bm_page_in_start() {
 	gr_bm_page_in_start();
 }
 
+// Reads the files of all bitmaps marked for paging in into memory on the task pool, so that loading them one by one
+// afterwards does not have to wait for the disk each time
+static void bm_preload_paged_in() {
+	SCP_vector<CFileLocation> files;
+	SCP_unordered_set<SCP_string> seen;	// the frames of an animation can share a file
+
+	for (auto& block : bm_blocks) {
+		for (auto& slot : block) {
+			auto& entry = slot.entry;
+
+			if (!entry.preloaded) {
+				continue;
+			}
+
+			// these don't come from a file
+			if ((entry.type == BM_TYPE_NONE) || (entry.type == BM_TYPE_USER) || (entry.type == BM_TYPE_3D)
+				|| (entry.type == BM_TYPE_RENDER_TARGET_DYNAMIC) || (entry.type == BM_TYPE_RENDER_TARGET_STATIC)) {
+				continue;
+			}
+
+			if (!seen.insert(entry.filename).second) {
+				continue;
+			}
+
+			auto res = cf_find_file_location(entry.filename, entry.dir_type);
+			if (res.found) {
+				files.push_back(std::move(res));
+			}
+		}
+	}
+
+	cf_preload(files);
+}
+
 void bm_page_in_stop() {
 	TRACE_SCOPE(tracing::PageInStop);
 
@@ -2642,6 +2677,8 @@ void bm_page_in_stop() {
 
 	nprintf(("BmpInfo", "BMPMAN: Loading all used bitmaps.\n"));
 
+	bm_preload_paged_in();
+
 	// Load all the ones that are supposed to be loaded for this level.
 	int n = 0;
 
@@ -2655,6 +2692,8 @@ void bm_page_in_stop() {
 				&& (entry.type != BM_TYPE_RENDER_TARGET_STATIC)) {
 				if (entry.preloaded) {
 					TRACE_SCOPE(tracing::PageInSingleBitmap);
+					auto load_start = timer_get_microseconds();
+
 					if (bm_preloading) {
 						if (!gr_preload(entry.handle, (entry.preloaded == 2))) {
 							mprintf(("Out of VRAM.  Done preloading.\n"));
@@ -2667,6 +2706,10 @@ void bm_page_in_stop() {
 						}
 					}
 
+					if (mission_manifest_recording() && (entry.type != BM_TYPE_USER) && (entry.type != BM_TYPE_3D)) {
+						mission_manifest_add(entry.filename, entry.dir_type, timer_get_microseconds() - load_start);
+					}
+
 					n++;
 
 					multi_send_anti_timeout_ping();
@@ -2691,6 +2734,9 @@ void bm_page_in_stop() {
 		}
 	}
 
+	// whatever was read but not loaded isn't needed anymore
+	cf_preload_release();
+
 	nprintf(("BmpInfo", "BMPMAN: Loaded %d bitmaps that are marked as used for this level.\n", n));
 
 #ifndef NDEBUG
@@ -28,13 +28,18 @@
 
 #include "cfile/cfile.h"
 #include "cfile/cfilearchive.h"
+#include "cfile/cfilecompression.h"
 #include "cfile/cfilesystem.h"
 #include "osapi/osapi.h"
 #include "parse/encrypt.h"
 #include "cfilesystem.h"
+#include "tracing/tracing.h"
+#include "utils/threading.h"
 
 
+#include <atomic>
 #include <limits>
+#include <thread>
 
 char Cfile_root_dir[CFILE_ROOT_DIRECTORY_LEN] = "";
 char Cfile_user_dir[CFILE_ROOT_DIRECTORY_LEN] = "";
@@ -108,6 +113,13 @@ static CFILE *cf_open_memory_fill_cfblock(const char* source, int line, const ch
 
 static void cf_chksum_long_init();
 
+// cf_preload() doesn't read more than this, the files past it are read from the disk as usual
+static const size_t CF_PRELOAD_MAX_BYTES = 256 * 1024 * 1024;
+
+// The files read by cf_preload() keyed by their location (full_name and offset) until they are opened
+static SCP_map<std::pair<SCP_string, size_t>, SCP_vector<ubyte>> Preloaded_files;
+static size_t Preloaded_bytes = 0;
+
 static void dump_opened_files()
 {
 	for (int i = 0; i < MAX_CFILE_BLOCKS; i++) {
@@ -120,6 +132,9 @@ static void dump_opened_files()
 
 void cfile_close()
 {
+	cf_prefetch_background_stop();
+	cf_preload_release();
+
 	mprintf(("Still opened files:\n"));
 	dump_opened_files();
 
@@ -761,6 +776,20 @@ CFILE *_cfopen_special(const char* source, int line, const CFileLocation &res, c
 	if (res.data_ptr != nullptr) {
 		return cf_open_memory_fill_cfblock(source, line, res.name_ext.c_str(), res.data_ptr, res.size, dir_type);
 	}
+
+	// Files read by cf_preload() are handed over to the CFILE, which frees them when it's closed
+	auto preloaded = Preloaded_files.find(std::make_pair(res.full_name, res.offset));
+	if (preloaded != Preloaded_files.end()) {
+		auto& data = preloaded->second;
+		CFILE* cfp = cf_open_memory_fill_cfblock(source, line, res.name_ext.c_str(), data.data(), data.size(), dir_type);
+
+		if (cfp != nullptr) {
+			Preloaded_bytes -= data.size();
+			cfp->preloaded_data = std::move(data);
+			Preloaded_files.erase(preloaded);
+		}
+		return cfp;
+	}
 	else {
 		// "file_path" should already be a fully qualified path, so just try to open it
 		FILE *fp = fopen(res.full_name.c_str(), "rb");
@@ -781,6 +810,151 @@ CFILE *_cfopen_special(const char* source, int line, const CFileLocation &res, c
 }
 
 
+// Reads a file found by cf_find_file_location() and throws the data away.  Only plain stdio in here since this runs
+// outside of the main thread and the cfile state must not be touched from there.
+static void cf_prefetch_file(const CFileLocation& res, const std::atomic<bool>* cancel)
+{
+	// in-memory files don't need to be read
+	if (!res.found || res.data_ptr != nullptr || res.full_name.empty()) {
+		return;
+	}
+
+	FILE* fp = fopen(res.full_name.c_str(), "rb");
+	if (fp == nullptr) {
+		return;
+	}
+
+	if (res.offset == 0 || fseek(fp, static_cast<long>(res.offset), SEEK_SET) == 0) {
+		ubyte buffer[64 * 1024];
+
+		// a size of 0 just reads the whole file
+		size_t left = (res.size > 0) ? res.size : std::numeric_limits<size_t>::max();
+
+		while (left > 0 && (cancel == nullptr || !cancel->load(std::memory_order_relaxed))) {
+			size_t read = fread(buffer, 1, std::min(left, sizeof(buffer)), fp);
+			if (read == 0) {
+				break;
+			}
+			left -= read;
+		}
+	}
+
+	fclose(fp);
+}
+
+// Reads a whole file found by cf_find_file_location() into data.  Only plain stdio in here since this runs on the task
+// pool, see cf_prefetch_file().
+static bool cf_preload_file(const CFileLocation& res, SCP_vector<ubyte>& data)
+{
+	FILE* fp = fopen(res.full_name.c_str(), "rb");
+	if (fp == nullptr) {
+		return false;
+	}
+
+	bool ok = false;
+	if (res.offset == 0 || fseek(fp, static_cast<long>(res.offset), SEEK_SET) == 0) {
+		data.resize(res.size);
+		ok = fread(data.data(), 1, data.size(), fp) == data.size();
+	}
+
+	fclose(fp);
+
+	// compressed files are decompressed from the disk, see cf_check_compression()
+	if (ok && data.size() > 16) {
+		int header;
+		memcpy(&header, data.data(), sizeof(header));
+		ok = comp_check_header(INTEL_INT(header)) != COMP_HEADER_MATCH;
+	}
+
+	return ok;
+}
+
+void cf_preload(const SCP_vector<CFileLocation>& files)
+{
+	if (!cfile_inited || files.empty()) {
+		return;
+	}
+
+	TRACE_SCOPE(tracing::PreloadFiles);
+
+	// decide what to read up front so that the task pool only fills in the buffers
+	SCP_vector<const CFileLocation*> to_read;
+	size_t total = Preloaded_bytes;
+
+	for (const auto& res : files) {
+		// in-memory files don't need to be read
+		if (!res.found || res.data_ptr != nullptr || res.full_name.empty() || res.size == 0) {
+			continue;
+		}
+
+		// the rest is read from the disk when it's opened
+		if (total + res.size > CF_PRELOAD_MAX_BYTES) {
+			continue;
+		}
+
+		if (Preloaded_files.find(std::make_pair(res.full_name, res.offset)) != Preloaded_files.end()) {
+			continue;
+		}
+
+		total += res.size;
+		to_read.push_back(&res);
+	}
+
+	SCP_vector<SCP_vector<ubyte>> buffers(to_read.size());
+	SCP_vector<bool> read_ok(to_read.size(), false);
+
+	threading::parallel_for(to_read.size(), 1, [&to_read, &buffers, &read_ok](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			read_ok[i] = cf_preload_file(*to_read[i], buffers[i]);
+		}
+	});
+
+	for (size_t i = 0; i < to_read.size(); i++) {
+		if (read_ok[i]) {
+			Preloaded_bytes += buffers[i].size();
+			Preloaded_files.emplace(std::make_pair(to_read[i]->full_name, to_read[i]->offset), std::move(buffers[i]));
+		}
+	}
+}
+
+void cf_preload_release()
+{
+	Preloaded_files.clear();
+	Preloaded_bytes = 0;
+}
+
+namespace {
+std::thread Prefetch_thread;
+std::atomic<bool> Prefetch_cancel{false};
+}
+
+void cf_prefetch_background(SCP_vector<CFileLocation> files)
+{
+	cf_prefetch_background_stop();
+
+	if (!cfile_inited || files.empty()) {
+		return;
+	}
+
+	Prefetch_cancel = false;
+	Prefetch_thread = std::thread([](SCP_vector<CFileLocation> thread_files) {
+		for (const auto& res : thread_files) {
+			if (Prefetch_cancel) {
+				break;
+			}
+			cf_prefetch_file(res, &Prefetch_cancel);
+		}
+	}, std::move(files));
+}
+
+void cf_prefetch_background_stop()
+{
+	if (Prefetch_thread.joinable()) {
+		Prefetch_cancel = true;
+		Prefetch_thread.join();
+	}
+}
+
 // ------------------------------------------------------------------------
 // ctmpfile() 
 //
@@ -856,6 +1030,7 @@ int cfclose( CFILE * cfile )
 		// VP  do nothing
 	}
 	cf_clear_compression_info(cfile);
+	cfile->preloaded_data = SCP_vector<ubyte>();
 	cfile->type = CFILE_BLOCK_UNUSED;
 	return result;
 }
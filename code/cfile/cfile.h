@@ -429,6 +429,21 @@ int cfile_pop_dir();
 
 int cfile_get_path_type(const SCP_string& dir);
 
+// Reads the given files into memory on the task pool.  The next cfopen() of each of these files reads from that memory
+// instead of the disk and the memory is freed when that file is closed.  Must be called from the main thread.
+void cf_preload(const SCP_vector<CFileLocation>& files);
+
+// Frees the files read by cf_preload() which were not opened since
+void cf_preload_release();
+
+// Reads the given files on a background thread, one after another, so that they come out of the OS file cache when
+// they are opened later.  Nothing is kept and this returns immediately.
+// Only one background prefetch runs at a time, starting a new one cancels the previous one.
+void cf_prefetch_background(SCP_vector<CFileLocation> files);
+
+// Cancels a running background prefetch and waits for its thread to exit
+void cf_prefetch_background_stop();
+
 namespace cfile
 {
 	// exceptions and other errors
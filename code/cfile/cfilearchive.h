@@ -48,6 +48,7 @@ struct CFILE {
 	const char* source_file;
 	int line_num;
 	COMPRESSION_INFO compression_info;
+	SCP_vector<ubyte> preloaded_data;	// owns data if the file was read ahead by cf_preload()
 };
 
 #define MAX_CFILE_BLOCKS	64
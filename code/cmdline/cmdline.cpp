@@ -271,6 +271,8 @@ Flag exe_params[] =
 	{ "-profile_frame_time","Profile frame time",						true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-profile_frame_time", },
 	{ "-profile_write_file", "Write profiling information to file",		true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-profile_write_file", },
 	{ "-json_profiling",	"Generate JSON profiling output",			true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-json_profiling", },
+	{ "-binary_profiling",	"Generate binary profiling output",		true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-binary_profiling", },
+	{ "-timedemo",			"Run -start_mission headless N frames",	true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-timedemo", },
 	{ "-debug_window",		"Enable the debug window",					true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-debug_window", },
 	{ "-gr_debug",		"Output graphics debug information",			true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-gr_debug", },
 	{ "-stdout_log",		"Output log file to stdout",				true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-stdout_log", },
@@ -523,8 +525,12 @@ cmdline_parm benchmark_mode_arg("-benchmark_mode", NULL, AT_NONE); //Cmdline_ben
 cmdline_parm pilot_arg("-pilot", nullptr, AT_STRING); //Cmdline_pilot
 cmdline_parm noninteractive_arg("-noninteractive", NULL, AT_NONE); //Cmdline_noninteractive
 cmdline_parm json_profiling("-json_profiling", NULL, AT_NONE); //Cmdline_json_profiling
+cmdline_parm binary_profiling("-binary_profiling", "Write the profiling trace in the compact binary format (see -convert_trace)", AT_NONE); //Cmdline_binary_profiling
+cmdline_parm convert_trace_arg("-convert_trace", "Convert a binary trace file to the chrome://tracing JSON format and exit", AT_STRING); //Cmdline_convert_trace
 cmdline_parm show_video_info("-show_video_info", NULL, AT_NONE); //Cmdline_show_video_info
 cmdline_parm frame_profile_arg("-profile_frame_time", NULL, AT_NONE); //Cmdline_frame_profile
+cmdline_parm timedemo_arg("-timedemo", "Run the -start_mission headless with a fixed timestep for this many frames", AT_INT); //Cmdline_timedemo_frames
+cmdline_parm timedemo_output_arg("-timedemo_output", "File the timedemo results are written to", AT_STRING); //Cmdline_timedemo_output
 cmdline_parm debug_window_arg("-debug_window", NULL, AT_NONE);	// Cmdline_debug_window
 cmdline_parm graphics_debug_output_arg("-gr_debug", nullptr, AT_NONE); // Cmdline_graphics_debug_output
 cmdline_parm log_to_stdout_arg("-stdout_log", nullptr, AT_NONE); // Cmdline_log_to_stdout
@@ -537,6 +543,8 @@ cmdline_parm vulkan("-vulkan", nullptr, AT_NONE);
 cmdline_parm vk_stress("-vk_stress", "Enable Vulkan stress mode (buffer churn)", AT_NONE);
 cmdline_parm vk_hud_debug("-vk_hud_debug", "Log Vulkan HUD/UI draw state for debugging HUD flicker", AT_NONE);
 cmdline_parm multithreading("-threads", nullptr, AT_INT);
+cmdline_parm pipeline_render("-pipeline_render", "Cull objects for rendering on a separate thread", AT_NONE);	// Cmdline_pipeline_render
+cmdline_parm occlusion_cull("-occlusion_cull", "Skip rendering objects hidden behind large ships", AT_NONE);	// Cmdline_occlusion_cull
 
 char *Cmdline_start_mission = NULL;
 int Cmdline_dis_collisions = 0;
@@ -565,7 +573,11 @@ bool Cmdline_benchmark_mode = false;
 const char *Cmdline_pilot = nullptr;
 bool Cmdline_noninteractive = false;
 bool Cmdline_json_profiling = false;
+bool Cmdline_binary_profiling = false;
+const char *Cmdline_convert_trace = nullptr;
 bool Cmdline_frame_profile = false;
+int Cmdline_timedemo_frames = 0;
+const char *Cmdline_timedemo_output = nullptr;
 bool Cmdline_show_video_info = false;
 bool Cmdline_debug_window = false;
 bool Cmdline_graphics_debug_output = false;
@@ -578,6 +590,8 @@ bool Cmdline_vulkan = false;
 bool Cmdline_vk_stress = false;
 bool Cmdline_vk_hud_debug = false;
 int Cmdline_multithreading = 1;
+bool Cmdline_pipeline_render = false;
+bool Cmdline_occlusion_cull = false;
 
 // Other
 cmdline_parm get_flags_arg(GET_FLAGS_STRING, "Output the launcher flags file", AT_STRING);
@@ -2298,11 +2312,42 @@ bool SetCmdlineParams()
 		Cmdline_json_profiling = true;
 	}
 
+	if (binary_profiling.found())
+	{
+		Cmdline_binary_profiling = true;
+	}
+
+	if (convert_trace_arg.found())
+	{
+		Cmdline_convert_trace = convert_trace_arg.str();
+	}
+
 	if (frame_profile_arg.found() )
 	{
 		Cmdline_frame_profile = true;
 	}
 
+	if (timedemo_arg.found())
+	{
+		if (timedemo_arg.get_int() > 0) {
+			Cmdline_timedemo_frames = timedemo_arg.get_int();
+
+			// The timedemo runs unattended and as fast as possible without a display or sound
+			Cmdline_benchmark_mode = true;
+			Cmdline_noninteractive = true;
+			Cmdline_NoFPSCap = 1;
+			Cmdline_freespace_no_sound = 1;
+			Cmdline_freespace_no_music = 1;
+		} else {
+			Warning(LOCATION, "-timedemo must be given a frame count greater than 0.");
+		}
+	}
+
+	if (timedemo_output_arg.found())
+	{
+		Cmdline_timedemo_output = timedemo_output_arg.str();
+	}
+
 	if (debug_window_arg.found()) {
 		Cmdline_debug_window = true;
 	}
@@ -2420,10 +2465,24 @@ bool SetCmdlineParams()
 		}
 	}
 
+	// Timedemo runs must be repeatable so they always use a fixed seed
+	if (Cmdline_timedemo_frames > 0 && !Cmdline_reuse_rng_seed) {
+		Cmdline_rng_seed = 1;
+		Cmdline_reuse_rng_seed = true;
+	}
+
 	if (multithreading.found()) {
 		Cmdline_multithreading = abs(multithreading.get_int());
 	}
 
+	if (pipeline_render.found()) {
+		Cmdline_pipeline_render = true;
+	}
+
+	if (occlusion_cull.found()) {
+		Cmdline_occlusion_cull = true;
+	}
+
 	return true; 
 }
 
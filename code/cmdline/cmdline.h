@@ -149,7 +149,11 @@ extern bool Cmdline_benchmark_mode;
 extern const char *Cmdline_pilot;
 extern bool Cmdline_noninteractive;
 extern bool Cmdline_json_profiling;
+extern bool Cmdline_binary_profiling;
+extern const char *Cmdline_convert_trace;
 extern bool Cmdline_frame_profile;
+extern int Cmdline_timedemo_frames;
+extern const char *Cmdline_timedemo_output;
 extern bool Cmdline_show_video_info;
 extern bool Cmdline_debug_window;
 extern bool Cmdline_graphics_debug_output;
@@ -162,6 +166,8 @@ extern bool Cmdline_vulkan;
 extern bool Cmdline_vk_stress;
 extern bool Cmdline_vk_hud_debug;
 extern int Cmdline_multithreading;
+extern bool Cmdline_pipeline_render;
+extern bool Cmdline_occlusion_cull;
 
 enum class WeaponSpewType { NONE = 0, STANDARD, ALL };
 extern WeaponSpewType Cmdline_spew_weapon_stats;
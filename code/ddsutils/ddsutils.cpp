@@ -2,6 +2,12 @@
 #include "ddsutils/ddsutils.h"
 #include "cfile/cfile.h"
 #include "osapi/osregistry.h"
+#include "utils/threading.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DDS_DECODE_SSE2
+#include <emmintrin.h>
+#endif
 
 #ifdef WITH_OPENGL
 #include <glad/glad.h>
@@ -406,8 +412,230 @@ Done:
 	return retval;
 }
 
-static void (*decompress_dds)(const void *in, void *out, int pitch) = nullptr;
-static uint32_t BLOCK_SIZE = 0;
+// Block decoders write a full 4x4 block of 32-bit BGRA pixels, rows are pitch bytes apart
+typedef void (*dds_block_decode_func)(const ubyte *block, ubyte *out, int pitch);
+
+// Block rows of an image which are decoded together, small mipmap levels are not worth waking up the task pool for
+static const size_t DDS_DECODE_ROWS_PER_TASK = 8;
+
+// swap red and blue of 4 pixels, bcdec writes rgba
+static inline void dds_rgba_to_bgra(ubyte *row)
+{
+#ifdef DDS_DECODE_SSE2
+	__m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row));
+	__m128i ga = _mm_and_si128(px, _mm_set1_epi32(static_cast<int>(0xFF00FF00)));
+	__m128i r = _mm_and_si128(px, _mm_set1_epi32(0x000000FF));
+	__m128i b = _mm_and_si128(_mm_srli_epi32(px, 16), _mm_set1_epi32(0x000000FF));
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(row), _mm_or_si128(ga, _mm_or_si128(b, _mm_slli_epi32(r, 16))));
+#else
+	for (int i = 0; i < 16; i += 4) {
+		std::swap(row[i], row[i + 2]);
+	}
+#endif
+}
+
+template <void (*Decode)(const void *, void *, int)>
+static void dds_decode_bcdec_block(const ubyte *block, ubyte *out, int pitch)
+{
+	Decode(block, out, pitch);
+
+	for (int i = 0; i < 4; ++i) {
+		dds_rgba_to_bgra(out + i * pitch);
+	}
+}
+
+// The four colors of a BC1 color block as BGRA, computed the same way as bcdec does it
+static inline void dds_bc1_palette(const ubyte *block, bool only_opaque, uint palette[4])
+{
+	const uint c0 = block[0] | (block[1] << 8);
+	const uint c1 = block[2] | (block[3] << 8);
+
+	const uint r0 = (c0 >> 11) & 0x1F, g0 = (c0 >> 5) & 0x3F, b0 = c0 & 0x1F;
+	const uint r1 = (c1 >> 11) & 0x1F, g1 = (c1 >> 5) & 0x3F, b1 = c1 & 0x1F;
+
+	auto bgra = [](uint r, uint g, uint b) { return 0xFF000000 | (r << 16) | (g << 8) | b; };
+
+	palette[0] = bgra((r0 * 527 + 23) >> 6, (g0 * 259 + 33) >> 6, (b0 * 527 + 23) >> 6);
+	palette[1] = bgra((r1 * 527 + 23) >> 6, (g1 * 259 + 33) >> 6, (b1 * 527 + 23) >> 6);
+
+	if (c0 > c1 || only_opaque) {
+		palette[2] = bgra(((2 * r0 + r1) * 351 + 61) >> 7, ((2 * g0 + g1) * 2763 + 1039) >> 11,
+			((2 * b0 + b1) * 351 + 61) >> 7);
+		palette[3] = bgra(((r0 + r1 * 2) * 351 + 61) >> 7, ((g0 + g1 * 2) * 2763 + 1039) >> 11,
+			((b0 + b1 * 2) * 351 + 61) >> 7);
+	} else {
+		palette[2] = bgra(((r0 + r1) * 1053 + 125) >> 8, ((g0 + g1) * 4145 + 1019) >> 11, ((b0 + b1) * 1053 + 125) >> 8);
+		palette[3] = 0;
+	}
+}
+
+// Writes the 16 pixels of a BC1 color block.  If alpha is given it replaces the alpha of the colors.
+static inline void dds_bc1_store(const ubyte *block, const uint palette[4], const ubyte *alpha, ubyte *out, int pitch)
+{
+	const uint indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint>(block[7]) << 24);
+
+#ifdef DDS_DECODE_SSE2
+	const __m128i c0 = _mm_set1_epi32(static_cast<int>(palette[0]));
+	const __m128i x1 = _mm_xor_si128(c0, _mm_set1_epi32(static_cast<int>(palette[1])));
+	const __m128i x2 = _mm_xor_si128(c0, _mm_set1_epi32(static_cast<int>(palette[2])));
+	const __m128i x3 = _mm_xor_si128(c0, _mm_set1_epi32(static_cast<int>(palette[3])));
+
+	// lane j looks at bits 2j and 2j+1 of the row
+	const __m128i lane_mask = _mm_set_epi32(0xC0, 0x30, 0x0C, 0x03);
+	const __m128i index1 = _mm_set_epi32(0x40, 0x10, 0x04, 0x01);
+	const __m128i index2 = _mm_set_epi32(0x80, 0x20, 0x08, 0x02);
+
+	for (int i = 0; i < 4; ++i) {
+		__m128i bits = _mm_and_si128(_mm_set1_epi32(static_cast<int>((indices >> (8 * i)) & 0xFF)), lane_mask);
+
+		// only one of the masks can be set, so xoring in the difference to color 0 selects the color
+		__m128i px = c0;
+		px = _mm_xor_si128(px, _mm_and_si128(_mm_cmpeq_epi32(bits, index1), x1));
+		px = _mm_xor_si128(px, _mm_and_si128(_mm_cmpeq_epi32(bits, index2), x2));
+		px = _mm_xor_si128(px, _mm_and_si128(_mm_cmpeq_epi32(bits, lane_mask), x3));
+
+		if (alpha != nullptr) {
+			__m128i a = _mm_set_epi32(alpha[i * 4 + 3] << 24, alpha[i * 4 + 2] << 24, alpha[i * 4 + 1] << 24,
+				alpha[i * 4] << 24);
+			px = _mm_or_si128(_mm_and_si128(px, _mm_set1_epi32(0x00FFFFFF)), a);
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i * pitch), px);
+	}
+#else
+	for (int i = 0; i < 4; ++i) {
+		uint row[4];
+		for (int j = 0; j < 4; ++j) {
+			row[j] = palette[(indices >> (8 * i + 2 * j)) & 0x03];
+
+			if (alpha != nullptr) {
+				row[j] = (row[j] & 0x00FFFFFF) | (static_cast<uint>(alpha[i * 4 + j]) << 24);
+			}
+		}
+		memcpy(out + i * pitch, row, sizeof(row));
+	}
+#endif
+}
+
+static void dds_decode_bc1_block(const ubyte *block, ubyte *out, int pitch)
+{
+	uint palette[4];
+	dds_bc1_palette(block, false, palette);
+	dds_bc1_store(block, palette, nullptr, out, pitch);
+}
+
+static void dds_decode_bc3_block(const ubyte *block, ubyte *out, int pitch)
+{
+	// interpolated alpha values, same as bcdec
+	ubyte table[8];
+	table[0] = block[0];
+	table[1] = block[1];
+
+	if (table[0] > table[1]) {
+		for (int i = 1; i < 7; ++i) {
+			table[i + 1] = static_cast<ubyte>(((7 - i) * table[0] + i * table[1]) / 7);
+		}
+	} else {
+		for (int i = 1; i < 5; ++i) {
+			table[i + 1] = static_cast<ubyte>(((5 - i) * table[0] + i * table[1]) / 5);
+		}
+		table[6] = 0x00;
+		table[7] = 0xFF;
+	}
+
+	std::uint64_t indices = 0;
+	for (int i = 7; i >= 2; --i) {
+		indices = (indices << 8) | block[i];
+	}
+
+	ubyte alpha[16];
+	for (auto &a : alpha) {
+		a = table[indices & 0x07];
+		indices >>= 3;
+	}
+
+	uint palette[4];
+	dds_bc1_palette(block + 8, true, palette);
+	dds_bc1_store(block + 8, palette, alpha, out, pitch);
+}
+
+static bool dds_get_block_decoder(uint format, dds_block_decode_func &decode, uint &block_size)
+{
+	switch (format) {
+		case FOURCC_DX10:
+			decode = dds_decode_bcdec_block<bcdec_bc7>;
+			block_size = BCDEC_BC7_BLOCK_SIZE;
+			return true;
+		case FOURCC_DXT5:
+			decode = dds_decode_bc3_block;
+			block_size = BCDEC_BC3_BLOCK_SIZE;
+			return true;
+		case FOURCC_DXT1:
+			decode = dds_decode_bc1_block;
+			block_size = BCDEC_BC1_BLOCK_SIZE;
+			return true;
+		case FOURCC_DXT3:
+			decode = dds_decode_bcdec_block<bcdec_bc2>;
+			block_size = BCDEC_BC2_BLOCK_SIZE;
+			return true;
+		default:
+			return false;
+	}
+}
+
+size_t dds_compressed_size(uint format, uint width, uint height, uint depth)
+{
+	dds_block_decode_func decode;
+	uint block_size;
+	if (!dds_get_block_decoder(format, decode, block_size)) {
+		return 0;
+	}
+
+	return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * depth * block_size;
+}
+
+bool dds_decompress(uint format, const ubyte *src, uint width, uint height, uint depth, ubyte *dst)
+{
+	dds_block_decode_func decode;
+	uint block_size;
+	if (!dds_get_block_decoder(format, decode, block_size)) {
+		return false;
+	}
+
+	const uint blocks_x = (width + 3) / 4;
+	const uint blocks_y = (height + 3) / 4;
+	const int pitch = static_cast<int>(width * 4);
+	const size_t layer_size = static_cast<size_t>(width) * height * 4;
+
+	threading::parallel_for(static_cast<size_t>(blocks_y) * depth, DDS_DECODE_ROWS_PER_TASK, [&](size_t begin, size_t end) {
+		ubyte partial[4 * 4 * 4];
+
+		for (size_t row = begin; row < end; ++row) {
+			const ubyte *block = src + row * blocks_x * block_size;
+			const uint y = static_cast<uint>(row % blocks_y) * 4;
+			const uint rows = std::min(4U, height - y);
+
+			ubyte *out = dst + (row / blocks_y) * layer_size + static_cast<size_t>(y) * pitch;
+
+			for (uint x = 0; x < width; x += 4, block += block_size, out += 16) {
+				const uint cols = std::min(4U, width - x);
+
+				if (rows == 4 && cols == 4) {
+					decode(block, out, pitch);
+				} else {
+					// blocks on the edge of the image must not write into the next row or past the end
+					decode(block, partial, 16);
+
+					for (uint i = 0; i < rows; ++i) {
+						memcpy(out + i * pitch, partial + i * 16, cols * 4);
+					}
+				}
+			}
+		}
+	});
+
+	return true;
+}
 
 //reads pixel info from a dds file
 int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
@@ -457,8 +685,7 @@ int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 
 		cfread(comp_data, 1, (int)size, cfp);
 
-		ubyte *src = comp_data;
-		ubyte *dst = data;
+		const ubyte *src = comp_data;
 
 		uint d_width, d_height, d_depth;
 		size_t data_offset = 0;
@@ -470,26 +697,10 @@ int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 		const int num_faces = (dds_header.dwCaps2 & DDSCAPS2_CUBEMAP) ? 6 : 1;
 		const bool has_depth = (dds_header.dwFlags & DDSD_DEPTH) == DDSD_DEPTH;
 
-		switch (dds_header.ddspf.dwFourCC) {
-			case FOURCC_DX10:
-				decompress_dds = bcdec_bc7;
-				BLOCK_SIZE = BCDEC_BC7_BLOCK_SIZE;
-				break;
-			case FOURCC_DXT5:
-				decompress_dds = bcdec_bc3;
-				BLOCK_SIZE = BCDEC_BC3_BLOCK_SIZE;
-				break;
-			case FOURCC_DXT1:
-				decompress_dds = bcdec_bc1;
-				BLOCK_SIZE = BCDEC_BC1_BLOCK_SIZE;
-				break;
-			case FOURCC_DXT3:
-				decompress_dds = bcdec_bc2;
-				BLOCK_SIZE = BCDEC_BC2_BLOCK_SIZE;
-				break;
-			default:
-				Error(LOCATION, "Invalid FourCC (%d) for DDS decompression!", dds_header.ddspf.dwFourCC);
-				break;
+		const uint format = dds_header.ddspf.dwFourCC;
+
+		if (dds_compressed_size(format, 1, 1, 1) == 0) {
+			Error(LOCATION, "Invalid FourCC (%d) for DDS decompression!", format);
 		}
 
 		for (int f = 0; f < num_faces; ++f) {
@@ -499,7 +710,7 @@ int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 				d_height = std::max(1U, dds_header.dwHeight << (mipmap_offset - x));
 				d_depth = has_depth ? std::max(1U, dds_header.dwDepth << (mipmap_offset - x)) : 1U;
 
-				src += ((d_width + 3) / 4) * ((d_height + 3) / 4) * d_depth * BLOCK_SIZE;
+				src += dds_compressed_size(format, d_width, d_height, d_depth);
 			}
 
 			for (uint m = mipmap_offset; m < dds_header.dwMipMapCount; ++m) {
@@ -508,23 +719,8 @@ int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 				d_height = std::max(1U, dds_header.dwHeight >> (m - mipmap_offset));
 				d_depth = std::max(1U, dds_header.dwDepth >> (m - mipmap_offset));
 
-				for (uint d = 0; d < d_depth; ++d) {
-					auto depth_offset = d * d_width * d_height * 4;
-
-					for (uint i = 0; i < d_height; i += 4) {
-						for (uint j = 0; j < d_width; j += 4) {
-							dst = data + data_offset + depth_offset + ((i * d_width + j) * 4);
-
-							decompress_dds(src, dst, d_width * 4);
-							src += BLOCK_SIZE;
-						}
-					}
-				}
-
-				// we need it in bgra, XOR to the rescue
-				for (size_t x = data_offset; x < (data_offset + (d_width * d_height * d_depth * 4)); x += 4) {
-					data[x] ^= data[x+2], data[x+2] ^= data[x], data[x] ^= data[x+2];
-				}
+				dds_decompress(format, src, d_width, d_height, d_depth, data + data_offset);
+				src += dds_compressed_size(format, d_width, d_height, d_depth);
 
 				// bump data offset to next layer
 				data_offset += (d_width * d_height * d_depth * 4);
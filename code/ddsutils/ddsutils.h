@@ -285,6 +285,16 @@ int dds_read_header(const char *filename, CFILE *img_cfp = NULL, int *width = 0,
 //size of the data it stored in size
 int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp = NULL, int cf_type = CF_TYPE_ANY);
 
+// returns the size of one image (a mipmap level of a face) in the given compressed format, 0 if the format is unknown
+// 'format' is the FourCC of the file, FOURCC_DX10 for BC7
+size_t dds_compressed_size(uint format, uint width, uint height, uint depth);
+
+// decodes one image of a DXT1/DXT3/DXT5/BC7 compressed texture to 32-bit BGRA, 'dst' needs width*height*depth*4 bytes
+// rows of blocks are decoded on the task pool when called from the main thread, otherwise everything runs on the
+// calling thread
+// returns false if the format can't be decoded
+bool dds_decompress(uint format, const ubyte *src, uint width, uint height, uint depth, ubyte *dst);
+
 // writes a DDS file using given data
 void dds_save_image(int width, int height, int bpp, int num_mipmaps, ubyte *data = NULL, int cubemap = 0, const char *filename = NULL);
 
@@ -1898,6 +1898,11 @@ bool gr_init(std::unique_ptr<os::GraphicsOperations>&& graphicsOps, int d_mode,
 		center_aspect_ratio = -1.0f;
 	}
 
+	// the timedemo measures the simulation without a display
+	if (Cmdline_timedemo_frames > 0) {
+		mode = GR_STUB;
+	}
+
 	gr_init_function_pointers(mode);
 
 	if (gr_get_resolution_class(width, height) != GR_640) {
@@ -63,7 +63,7 @@ const float gr_light_emission[4] = { 0.09f, 0.09f, 0.09f, 1.0f };
 float gr_light_ambient[4] = { 0.47f, 0.47f, 0.47f, 1.0f };
 
 
-void FSLight2GLLight(light* FSLight, gr_light* GLLight) {
+void FSLight2GLLight(const light* FSLight, gr_light* GLLight) {
 	GLLight->Ambient.xyzw.x = 0.0f;
 	GLLight->Ambient.xyzw.y = 0.0f;
 	GLLight->Ambient.xyzw.z = 0.0f;
@@ -143,18 +143,16 @@ void FSLight2GLLight(light* FSLight, gr_light* GLLight) {
 	}
 }
 
-static void set_light(int light_num, gr_light* ltp) {
-	Assert(light_num < (int)graphics::MAX_UNIFORM_LIGHTS);
+static void set_light(graphics::model_light* light_out, const gr_light* ltp) {
+	vm_vec_transform(&light_out->position, &ltp->Position, &gr_view_matrix);
+	vm_vec_transform(&light_out->direction, &ltp->SpotDir, &gr_view_matrix, false);
 
-	vm_vec_transform(&gr_light_uniforms[light_num].position, &ltp->Position, &gr_view_matrix);
-	vm_vec_transform(&gr_light_uniforms[light_num].direction, &ltp->SpotDir, &gr_view_matrix, false);
+	light_out->diffuse_color = vm_vec4_to_vec3(ltp->Diffuse);
 
-	gr_light_uniforms[light_num].diffuse_color = vm_vec4_to_vec3(ltp->Diffuse);
+	light_out->light_type = ltp->type;
 
-	gr_light_uniforms[light_num].light_type = ltp->type;
-
-	gr_light_uniforms[light_num].attenuation = ltp->LinearAtten;
-	gr_light_uniforms[light_num].ml_sourceRadius = ltp->SourceRadius;
+	light_out->attenuation = ltp->LinearAtten;
+	light_out->ml_sourceRadius = ltp->SourceRadius;
 }
 
 static bool sort_active_lights(const gr_light& la, const gr_light& lb) {
@@ -195,9 +193,25 @@ static bool sort_active_lights(const gr_light& la, const gr_light& lb) {
 	return false;
 }
 
-static void pre_render_init_lights() {
+static void pre_render_init_lights(SCP_vector<gr_light>& lights) {
 	// sort the lights to try and get the most visible lights on the first pass
-	std::sort(gr_lights.begin(), gr_lights.end(), sort_active_lights);
+	std::sort(lights.begin(), lights.end(), sort_active_lights);
+}
+
+// Writes the uniform data of the first num_active entries of lights to uniforms_out
+static void write_light_uniforms(const SCP_vector<gr_light>& lights, int num_active, graphics::model_light* uniforms_out) {
+	gr_light zero;
+	memset(&zero, 0, sizeof(gr_light));
+	zero.Position.xyzw.x = 1.0f;
+
+	for (int i = 0; i < (int)graphics::MAX_UNIFORM_LIGHTS; i++) {
+		// only directional lights are passed through the uniforms, the slots of other lights are turned off
+		if (i < num_active && lights[i].type == LT_DIRECTIONAL) {
+			set_light(&uniforms_out[i], &lights[i]);
+		} else {
+			set_light(&uniforms_out[i], &zero);
+		}
+	}
 }
 
 void gr_set_light(light* fs_light) {
@@ -302,30 +316,10 @@ void gr_set_lighting() {
 
 	//Valathil: Sort lights by priority
 	if (!Deferred_lighting) {
-		pre_render_init_lights();
+		pre_render_init_lights(gr_lights);
 	}
 
-	int i = 0;
-
-	for (i = 0; i < (int)graphics::MAX_UNIFORM_LIGHTS; i++) {
-		if (i >= Num_active_gr_lights) {
-			break;
-		}
-
-		if (gr_lights[i].type != LT_DIRECTIONAL)
-			continue;
-
-		set_light(i, &gr_lights[i]);
-	}
-
-	gr_light zero;
-	memset(&zero, 0, sizeof(gr_light));
-	zero.Position.xyzw.x = 1.0f;
-
-	// make sure that we turn off any lights that we aren't using right now
-	for (; i < (int)graphics::MAX_UNIFORM_LIGHTS; i++) {
-		set_light(i, &zero);
-	}
+	write_light_uniforms(gr_lights, Num_active_gr_lights, gr_light_uniforms);
 }
 
 void gr_set_ambient_light(int red, int green, int blue) {
@@ -365,3 +359,27 @@ void gr_lighting_fill_uniforms(void* data_out, size_t buffer_size) {
 
 	memcpy(reinterpret_cast<graphics::model_light*>(data_out), gr_light_uniforms, sizeof(gr_light_uniforms));
 }
+
+int gr_lighting_build_uniforms(const light* const* lights, size_t num_lights, void* data_out, size_t buffer_size) {
+	if (gr_screen.mode == GR_STUB) {
+		return 0;
+	}
+
+	Assertion(sizeof(gr_light_uniforms) <= buffer_size, "Insufficient buffer supplied.");
+
+	// Reused between calls to avoid allocating for every light set
+	thread_local SCP_vector<gr_light> local_lights;
+
+	local_lights.resize(num_lights);
+	for (size_t i = 0; i < num_lights; ++i) {
+		FSLight2GLLight(lights[i], &local_lights[i]);
+	}
+
+	if (!Deferred_lighting) {
+		pre_render_init_lights(local_lights);
+	}
+
+	write_light_uniforms(local_lights, static_cast<int>(num_lights), reinterpret_cast<graphics::model_light*>(data_out));
+
+	return static_cast<int>(num_lights);
+}
@@ -38,5 +38,9 @@ void gr_get_ambient_light(vec3d* light_vector);
 
 void gr_lighting_fill_uniforms(void* data_out, size_t buffer_size);
 
+// Same result as gr_set_light() for each light followed by gr_set_lighting() and gr_lighting_fill_uniforms(), but
+// without touching the global light state so it may be called from several threads at once. Returns the light count.
+int gr_lighting_build_uniforms(const light* const* lights, size_t num_lights, void* data_out, size_t buffer_size);
+
 void gr_light_init();
 void gr_light_shutdown();
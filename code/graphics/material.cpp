@@ -542,6 +542,67 @@ const bvec4& material::get_color_mask() const {
 	return Color_mask;
 }
 
+bool material::has_same_state(const material& other) const
+{
+	if (Sdr_type != other.Sdr_type || Tex_type != other.Tex_type || Texture_addressing != other.Texture_addressing
+		|| Depth_mode != other.Depth_mode || Cull_mode != other.Cull_mode || Fill_mode != other.Fill_mode
+		|| Clr_scale != other.Clr_scale || Depth_bias != other.Depth_bias) {
+		return false;
+	}
+
+	for (int i = 0; i < TM_NUM_TYPES; ++i) {
+		if (Texture_maps[i] != other.Texture_maps[i]) {
+			return false;
+		}
+	}
+
+	if (Clip_params.enabled != other.Clip_params.enabled) {
+		return false;
+	}
+	if (Clip_params.enabled && (!vm_vec_same(&Clip_params.normal, &other.Clip_params.normal)
+			|| !vm_vec_same(&Clip_params.position, &other.Clip_params.position))) {
+		return false;
+	}
+
+	if (Has_buffer_blends != other.Has_buffer_blends) {
+		return false;
+	}
+	for (int i = 0; i < (Has_buffer_blends ? (int)NUM_BUFFER_BLENDS : 1); ++i) {
+		if (get_blend_mode(i) != other.get_blend_mode(i)) {
+			return false;
+		}
+	}
+
+	for (int i = 0; i < 4; ++i) {
+		if (Clr.a1d[i] != other.Clr.a1d[i]) {
+			return false;
+		}
+	}
+
+	if (Color_mask.x != other.Color_mask.x || Color_mask.y != other.Color_mask.y || Color_mask.z != other.Color_mask.z
+		|| Color_mask.w != other.Color_mask.w) {
+		return false;
+	}
+
+	if (Stencil_test != other.Stencil_test) {
+		return false;
+	}
+	if (Stencil_test) {
+		auto same_op = [](const StencilOp& a, const StencilOp& b) {
+			return a.stencilFailOperation == b.stencilFailOperation && a.depthFailOperation == b.depthFailOperation
+				&& a.successOperation == b.successOperation;
+		};
+
+		if (Stencil_mask != other.Stencil_mask || Stencil_func.compare != other.Stencil_func.compare
+			|| Stencil_func.ref != other.Stencil_func.ref || Stencil_func.mask != other.Stencil_func.mask
+			|| !same_op(Front_stencil_op, other.Front_stencil_op) || !same_op(Back_stencil_op, other.Back_stencil_op)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 model_material::model_material() : material() {
 	set_shader_type(SDR_TYPE_MODEL);
 }
@@ -687,6 +748,22 @@ bool model_material::is_batched() const
 	return Batched;
 }
 
+void model_material::set_instances(int count, int matrix_stride)
+{
+	Instance_count = count;
+	Instance_matrix_stride = matrix_stride;
+}
+
+int model_material::get_instance_count() const
+{
+	return Instance_count;
+}
+
+int model_material::get_instance_matrix_stride() const
+{
+	return Instance_matrix_stride;
+}
+
 void model_material::set_fog(int r, int g, int b, float _near, float _far)
 {
 	Fog_params.enabled = true;
@@ -740,6 +817,44 @@ void model_material::reset_alpha_mult() {
 	Alpha_mult = 1.0f;
 }
 
+bool model_material::has_same_state(const model_material& other) const
+{
+	if (!material::has_same_state(other)) {
+		return false;
+	}
+
+	if (Desaturate != other.Desaturate || Shadow_casting != other.Shadow_casting
+		|| Shadow_receiving != other.Shadow_receiving || Batched != other.Batched || Deferred != other.Deferred
+		|| HDR != other.HDR || lighting != other.lighting || Light_factor != other.Light_factor
+		|| Center_alpha != other.Center_alpha || Animated_effect != other.Animated_effect
+		|| Animated_timer != other.Animated_timer || Thrust_scale != other.Thrust_scale
+		|| Outline_thickness != other.Outline_thickness || Use_alpha_mult != other.Use_alpha_mult
+		|| Alpha_mult != other.Alpha_mult) {
+		return false;
+	}
+
+	if (Team_color_set != other.Team_color_set) {
+		return false;
+	}
+	if (Team_color_set
+		&& (Tm_color.base.r != other.Tm_color.base.r || Tm_color.base.g != other.Tm_color.base.g
+			|| Tm_color.base.b != other.Tm_color.base.b || Tm_color.stripe.r != other.Tm_color.stripe.r
+			|| Tm_color.stripe.g != other.Tm_color.stripe.g || Tm_color.stripe.b != other.Tm_color.stripe.b)) {
+		return false;
+	}
+
+	if (Fog_params.enabled != other.Fog_params.enabled) {
+		return false;
+	}
+	if (Fog_params.enabled
+		&& (Fog_params.r != other.Fog_params.r || Fog_params.g != other.Fog_params.g || Fog_params.b != other.Fog_params.b
+			|| Fog_params.dist_near != other.Fog_params.dist_near || Fog_params.dist_far != other.Fog_params.dist_far)) {
+		return false;
+	}
+
+	return true;
+}
+
 uint model_material::get_shader_flags() const
 {
 	uint Shader_flags = 0;
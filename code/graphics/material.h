@@ -162,6 +162,9 @@ public:
 							  StencilOperation depthFailOperation,
 							  StencilOperation successOperation);
 	const StencilOp& get_back_stencil_op() const;
+
+	// True if drawing with the other material sets up exactly the same render state and textures
+	bool has_same_state(const material& other) const;
 };
 
 class model_material : public material
@@ -206,6 +209,9 @@ class model_material : public material
 	bool Use_alpha_mult = false;
 	float Alpha_mult = 1.0f;
 
+	int Instance_count = 1;
+	int Instance_matrix_stride = 0;
+
 public:
 	model_material();
 
@@ -252,6 +258,12 @@ public:
 	void set_batching(bool enabled);
 	bool is_batched() const;
 
+	// Draws the buffer once per instance, the transforms of consecutive instances are matrix_stride matrices apart in
+	// the transform buffer
+	void set_instances(int count, int matrix_stride);
+	int get_instance_count() const;
+	int get_instance_matrix_stride() const;
+
 	uint get_shader_flags() const override;
     int get_shader_runtime_early_flags() const;
 	int get_shader_runtime_flags() const;
@@ -266,6 +278,8 @@ public:
 	void set_alpha_mult(float alpha);
 	void reset_alpha_mult();
 
+	// Like material::has_same_state() but also compares the model specific state, the instances are not compared
+	bool has_same_state(const model_material& other) const;
 };
 
 class particle_material : public material
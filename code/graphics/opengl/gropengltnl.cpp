@@ -632,6 +632,13 @@ void opengl_render_model_program(model_material* material_info, indexed_vertex_s
 										  ibuffer + datap->index_offset,
 										  4,
 										  (GLint) (vert_source->Base_vertex_offset + bufferp->vertex_num_offset));
+	} else if (material_info->get_instance_count() > 1) {
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES,
+			(GLsizei)datap->n_verts,
+			element_type,
+			ibuffer + datap->index_offset,
+			(GLsizei)material_info->get_instance_count(),
+			(GLint)(vert_source->Base_vertex_offset + bufferp->vertex_num_offset));
 	} else {
 		if (Cmdline_drawelements) {
 			glDrawElementsBaseVertex(GL_TRIANGLES,
@@ -28,6 +28,7 @@ layout(set = 0, binding = 2, std140) uniform ModelUniforms
 	layout(offset = 256) mat4 textureMatrix;
 	layout(offset = 1180) int buffer_matrix_offset;
 	layout(offset = 1200) float thruster_scale;
+	layout(offset = 1388) int buffer_matrix_stride;
 } uModel;
 
 layout(push_constant) uniform ModelPushConstants
@@ -130,7 +131,7 @@ void main()
 	mat4 orient = mat4(1.0);
 	bool clipModel = false;
 	if ((pcs.flags & uint(MODEL_SDR_FLAG_TRANSFORM)) != 0u) {
-		getModelTransform(orient, clipModel, int(modelId), uModel.buffer_matrix_offset);
+		getModelTransform(orient, clipModel, int(modelId) + gl_InstanceIndex * uModel.buffer_matrix_stride, uModel.buffer_matrix_offset);
 	}
 
 	vec3 vertex = position;
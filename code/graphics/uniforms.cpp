@@ -33,7 +33,9 @@ void convert_model_material(model_uniform_data* data_out,
 							const model_material& material,
 							const matrix4& model_transform,
 							const vec3d& scale,
-							size_t transform_buffer_offset) {
+							size_t transform_buffer_offset,
+							const model_light* lights,
+							int num_lights) {
 	auto shader_flags = material.get_shader_flags();
 
 	Assertion(gr_model_matrix_stack.depth() == 1, "Uniform conversion does not respect previous transforms! "
@@ -59,6 +61,7 @@ void convert_model_material(model_uniform_data* data_out,
 	data_out->use_clip_plane = 0;
 
 	data_out->flags = material.get_shader_runtime_early_flags() | material.get_shader_runtime_flags();
+	data_out->buffer_matrix_stride = material.get_instance_matrix_stride();
 
 	if (material.get_animated_effect() >= 0) {
 		data_out->anim_timer = material.get_animated_effect_time();
@@ -87,10 +90,14 @@ void convert_model_material(model_uniform_data* data_out,
 	}
 
 	if (material.is_lit()) {
-		int num_lights = MIN(Num_active_gr_lights, (int)graphics::MAX_UNIFORM_LIGHTS);
-		data_out->n_lights = num_lights;
+		if (lights == nullptr) {
+			num_lights = Num_active_gr_lights;
+			gr_lighting_fill_uniforms(data_out->lights, sizeof(data_out->lights));
+		} else {
+			memcpy(data_out->lights, lights, sizeof(data_out->lights));
+		}
 
-		gr_lighting_fill_uniforms(data_out->lights, sizeof(data_out->lights));
+		data_out->n_lights = MIN(num_lights, (int)graphics::MAX_UNIFORM_LIGHTS);
 
 		float light_factor = material.get_light_factor();
 		data_out->diffuseFactor.xyz.x = gr_light_color[0] * light_factor;
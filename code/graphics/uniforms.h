@@ -12,11 +12,20 @@
 namespace graphics {
 namespace uniforms {
 
+/**
+ * @brief Converts a model material into its uniform representation
+ *
+ * If @c lights is nullptr the light data is taken from the global light state. Otherwise @c lights must point to
+ * MAX_UNIFORM_LIGHTS entries (see scene_lights::buildLightUniforms) and the conversion does not read any mutable global
+ * state, which allows converting several materials on different threads at once.
+ */
 void convert_model_material(model_uniform_data* data_out,
 							const model_material& material,
 							const matrix4& model_transform,
 							const vec3d& scale,
-							size_t transform_buffer_offset);
+							size_t transform_buffer_offset,
+							const model_light* lights = nullptr,
+							int num_lights = 0);
 
 }
 }
@@ -141,7 +141,7 @@ struct model_uniform_data {
 	int sMiscmapIndex;
 	float alphaMult;
 	int flags;
-	float pad;
+	int buffer_matrix_stride;	// the offset of the transforms of one instance to the previous one in matrices
 };
 
 const size_t model_uniform_data_size = sizeof(model_uniform_data);
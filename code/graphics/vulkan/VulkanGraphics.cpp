@@ -1068,6 +1068,7 @@ struct ModelDrawContext {
   const indexed_vertex_source &vertSource;
   const vertex_buffer &vbuffer;
   size_t texi;
+  uint32_t instanceCount;
 };
 
 static void issueModelDraw(const RenderCtx &render, const ModelDrawContext &ctx) {
@@ -1105,7 +1106,7 @@ static void issueModelDraw(const RenderCtx &render, const ModelDrawContext &ctx)
   const uint32_t indexCount = static_cast<uint32_t>(batch.n_verts);
 
   cmd.drawIndexed(indexCount,
-                  1, // instanceCount
+                  ctx.instanceCount,
                   0, // firstIndex (we already baked the byte offset above)
                   0, // vertexOffset (vertex pulling handles the base)
                   0  // firstInstance
@@ -1306,6 +1307,7 @@ void gr_vulkan_render_model(model_material *material_info, indexed_vertex_source
 
   ModelDrawContext ctx{
       bound, pipeline, layout, pcs, *vert_source, *bufferp, texi,
+      static_cast<uint32_t>(material_info->get_instance_count()),
   };
 
   issueModelDraw(renderCtx, ctx);
@@ -40,6 +40,10 @@ static bool Timestamp_sudo_paused = false;
 
 static uint64_t Timestamp_microseconds_at_mission_start = 0;
 
+// When non-zero the timestamps follow a counter which is advanced by this many ticks per frame
+static uint64_t Timestamp_fixed_step_ticks = 0;
+static uint64_t Timestamp_fixed_step_counter = 0;
+
 
 static uint64_t timestamp_get_raw(bool start_frame = false);
 
@@ -53,6 +57,16 @@ static uint64_t get_performance_counter()
 	return counter - Timer_base_value;
 }
 
+// The counter the timestamps are based on
+static uint64_t get_timestamp_counter()
+{
+	if (Timestamp_fixed_step_ticks != 0) {
+		return Timestamp_fixed_step_counter;
+	}
+
+	return get_performance_counter();
+}
+
 void timer_close()
 {
 	if ( Timer_inited )	{
@@ -80,6 +94,10 @@ void timer_init()
 
 void timer_start_frame()
 {
+	if (Timestamp_fixed_step_ticks != 0) {
+		Timestamp_fixed_step_counter += Timestamp_fixed_step_ticks;
+	}
+
 	// take a snapshot of the raw timestamp at the beginning of the frame
 	timestamp_get_raw(true);
 }
@@ -149,7 +167,7 @@ static uint64_t timestamp_get_raw(bool start_frame)
 		if (Timestamp_is_paused)
 			timestamp_raw = Timestamp_paused_at_counter;
 		else
-			timestamp_raw = get_performance_counter();
+			timestamp_raw = get_timestamp_counter();
 
 		timestamp_raw -= Timestamp_offset_from_counter;
 	}
@@ -583,7 +601,7 @@ void timestamp_pause(bool sudo)
 		return;
 	Timestamp_is_paused = true;
 
-	Timestamp_paused_at_counter = get_performance_counter();
+	Timestamp_paused_at_counter = get_timestamp_counter();
 }
 
 void timestamp_unpause(bool sudo)
@@ -596,7 +614,7 @@ void timestamp_unpause(bool sudo)
 		return;
 	Timestamp_is_paused = false;
 
-	auto counter = get_performance_counter();
+	auto counter = get_timestamp_counter();
 
 	if (Timestamp_offset_from_counter == 0) {
 		Timestamp_offset_from_counter = counter;
@@ -618,7 +636,7 @@ void timestamp_adjust_pause_offset(int delta_milliseconds)
 
 	// act like we were paused for a certain period of time, even though we weren't
 	if (Timestamp_offset_from_counter == 0) {
-		Timestamp_offset_from_counter = get_performance_counter();
+		Timestamp_offset_from_counter = get_timestamp_counter();
 	} else {
 		Timestamp_offset_from_counter += static_cast<uint64_t>(static_cast<uint64_t>(delta_milliseconds) * MICROSECONDS_PER_MILLISECOND / Timer_to_microseconds);
 	}
@@ -678,6 +696,32 @@ void timestamp_update_time_compression()
 	timestamp_get_raw(true);
 }
 
+void timestamp_set_fixed_step(uint64_t step_microseconds)
+{
+	Assertion(Timer_inited, "Timer should be initialized at this point!");
+
+	auto real_counter = get_performance_counter();
+
+	if (step_microseconds == 0) {
+		if (Timestamp_fixed_step_ticks != 0) {
+			// shift the offsets so that the timestamps continue from where the fixed step counter left them
+			// (unsigned wraparound makes this work no matter which counter is ahead)
+			Timestamp_offset_from_counter += real_counter - Timestamp_fixed_step_counter;
+			Timestamp_paused_at_counter += real_counter - Timestamp_fixed_step_counter;
+		}
+
+		Timestamp_fixed_step_ticks = 0;
+		return;
+	}
+
+	if (Timestamp_fixed_step_ticks == 0) {
+		// start counting from the current real time so the timestamps don't jump
+		Timestamp_fixed_step_counter = real_counter;
+	}
+
+	Timestamp_fixed_step_ticks = std::max(static_cast<uint64_t>(step_microseconds / Timer_to_microseconds), static_cast<uint64_t>(1));
+}
+
 // ======================================== mission-specific stuff ========================================
 
 void timestamp_start_mission()
@@ -241,6 +241,11 @@ void timestamp_adjust_microseconds(uint64_t delta_microseconds, TIMER_DIRECTION
 // the timestamp will be consistent with the faster or slower time.
 void timestamp_update_time_compression();
 
+// Makes the timestamps advance by exactly step_microseconds every time timer_start_frame() is called instead of
+// following the real time, e.g. for running the simulation deterministically as fast as possible.  The timer_get_*
+// functions keep returning the real time.  Pass 0 to return to real time.
+void timestamp_set_fixed_step(uint64_t step_microseconds);
+
 //=================================================================
 //               M I S S I O N   T I M E
 //=================================================================
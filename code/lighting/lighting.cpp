@@ -20,6 +20,7 @@
 #include "math/vecmat.h"
 #include "model/modelrender.h"
 #include "render/3d.h"
+#include "utils/radix_sort.h"
 #include "options/Option.h"
 
 
@@ -593,54 +594,230 @@ void scene_lights::addLight(const light *light_ptr)
 	if ( light_ptr->type == Light_Type::Directional ) {
 		StaticLightIndices.push_back(AllLights.size() - 1);
 	}
+
+	GridDirty = true;
 }
 
-void scene_lights::setLightFilter(const vec3d *pos, float rad)
+bool light_affects_sphere(const light *l, const vec3d *pos, float rad)
 {
-	size_t i = 0;
-	// clear out current filtered lights
-	FilteredLights.clear();
+	switch ( l->type ) {
+		case Light_Type::Directional:
+			return true;
 
-	for ( auto& l : AllLights ) {
-		switch ( l.type ) {
-			case Light_Type::Directional:
-				++i;
-				continue;
-			case Light_Type::Point: {
-				vec3d to_light;
-				float dist_squared, max_dist_squared;
-				vm_vec_sub( &to_light, &l.vec, pos );
-				dist_squared = vm_vec_mag_squared(&to_light);
+		case Light_Type::Point: {
+			float max_dist = l->radb + rad;
 
-				max_dist_squared = l.radb+rad;
-				max_dist_squared *= max_dist_squared;
+			return vm_vec_dist_squared(&l->vec, pos) < max_dist * max_dist;
+		}
 
-				if ( dist_squared < max_dist_squared )	{
-					FilteredLights.push_back(i);
-				}
+		case Light_Type::Tube: {
+			// Measure against the segment rather than the infinite line through it so that the light has finite bounds
+			vec3d nearest;
+			float t = find_nearest_point_on_line(&nearest, &l->vec, &l->vec2, pos);
+			if ( t < 0.0f ) {
+				nearest = l->vec;
+			} else if ( t > 1.0f ) {
+				nearest = l->vec2;
 			}
-			break;
-			case Light_Type::Tube: {
-				vec3d nearest;
-				float dist_squared, max_dist_squared;
-				vm_vec_dist_squared_to_line(pos,&l.vec,&l.vec2,&nearest,&dist_squared);
 
-				max_dist_squared = l.radb+rad;
-				max_dist_squared *= max_dist_squared;
+			float max_dist = l->radb + rad;
+
+			return vm_vec_dist_squared(&nearest, pos) < max_dist * max_dist;
+		}
+
+		case Light_Type::Cone: {
+			vec3d to_sphere;
+			vm_vec_sub(&to_sphere, pos, &l->vec);
+
+			float dist_squared = vm_vec_mag_squared(&to_sphere);
+			float max_dist = l->radb + rad;
+
+			if ( dist_squared >= max_dist * max_dist ) {
+				return false;
+			}
+
+			if ( dist_squared <= rad * rad ) {
+				return true;
+			}
+
+			// Distance from the sphere center to the surface of the cone, cone_angle is the cosine of the half angle
+			vec3d dir = l->vec2;
+			vm_vec_normalize_safe(&dir);
+
+			float along = vm_vec_dot(&to_sphere, &dir);
+			if ( l->flags & LF_DUAL_CONE ) {
+				along = fabsf(along);
+			}
+
+			float across = sqrtf(MAX(dist_squared - along * along, 0.0f));
+			float cos_angle = l->cone_angle;
+			float sin_angle = sqrtf(MAX(1.0f - cos_angle * cos_angle, 0.0f));
+
+			return across * cos_angle - along * sin_angle < rad;
+		}
+
+		default:
+			return false;
+	}
+}
+
+namespace {
+// Cells are addressed with 21 bits per axis. Coordinates outside of that range wrap around which only adds a few
+// false candidates that are removed by the exact test.
+const int LIGHT_GRID_CELL_BITS = 21;
+const int LIGHT_GRID_CELL_MASK = (1 << LIGHT_GRID_CELL_BITS) - 1;
+
+// A light touching more cells than this is tested against every object instead of being inserted into the grid
+const size_t LIGHT_GRID_MAX_CELLS_PER_LIGHT = 64;
+
+inline uint64_t light_grid_cell_key(int x, int y, int z)
+{
+	return (static_cast<uint64_t>(x & LIGHT_GRID_CELL_MASK) << (LIGHT_GRID_CELL_BITS * 2))
+		| (static_cast<uint64_t>(y & LIGHT_GRID_CELL_MASK) << LIGHT_GRID_CELL_BITS)
+		| static_cast<uint64_t>(z & LIGHT_GRID_CELL_MASK);
+}
+
+inline int light_grid_coord(float value, float cell_size)
+{
+	return static_cast<int>(floorf(value / cell_size));
+}
+
+void light_get_bounds(const light &l, vec3d *min, vec3d *max)
+{
+	vec3d extent;
+	extent.xyz.x = extent.xyz.y = extent.xyz.z = l.radb;
+
+	if ( l.type == Light_Type::Tube ) {
+		vm_vec_min(min, &l.vec, &l.vec2);
+		vm_vec_max(max, &l.vec, &l.vec2);
+	} else {
+		*min = l.vec;
+		*max = l.vec;
+	}
+
+	vm_vec_sub2(min, &extent);
+	vm_vec_add2(max, &extent);
+}
+}
+
+void scene_lights::buildLightGrid()
+{
+	GridEntries.clear();
+	GridLargeLights.clear();
+	GridLights.clear();
+
+	LightQueryStamps.assign(AllLights.size(), 0);
+	CurrentQueryStamp = 0;
+
+	float radius_sum = 0.0f;
+	for ( size_t i = 0; i < AllLights.size(); ++i ) {
+		if ( AllLights[i].type == Light_Type::Directional ) {
+			continue;
+		}
+
+		GridLights.push_back(i);
+		radius_sum += AllLights[i].radb;
+	}
+
+	GridDirty = false;
+
+	if ( GridLights.empty() ) {
+		return;
+	}
+
+	// Size the cells so that an average light overlaps a handful of them
+	GridCellSize = MAX(radius_sum / GridLights.size(), 1.0f);
+
+	for ( auto light_index : GridLights ) {
+		vec3d min, max;
+		light_get_bounds(AllLights[light_index], &min, &max);
+
+		int min_x = light_grid_coord(min.xyz.x, GridCellSize), max_x = light_grid_coord(max.xyz.x, GridCellSize);
+		int min_y = light_grid_coord(min.xyz.y, GridCellSize), max_y = light_grid_coord(max.xyz.y, GridCellSize);
+		int min_z = light_grid_coord(min.xyz.z, GridCellSize), max_z = light_grid_coord(max.xyz.z, GridCellSize);
+
+		auto num_cells = static_cast<size_t>(max_x - min_x + 1) * (max_y - min_y + 1) * (max_z - min_z + 1);
+		if ( num_cells > LIGHT_GRID_MAX_CELLS_PER_LIGHT ) {
+			GridLargeLights.push_back(light_index);
+			continue;
+		}
 
-				if ( dist_squared < max_dist_squared ) {
-					FilteredLights.push_back(i);
+		for ( int x = min_x; x <= max_x; ++x ) {
+			for ( int y = min_y; y <= max_y; ++y ) {
+				for ( int z = min_z; z <= max_z; ++z ) {
+					GridEntries.push_back({light_grid_cell_key(x, y, z), light_index});
 				}
 			}
-			break;
+		}
+	}
+
+	util::radix_sort(GridEntries, GridScratch, [](const light_grid_entry& entry) { return entry.cell; });
+}
+
+void scene_lights::addFilterCandidate(size_t light_index, const vec3d *pos, float rad)
+{
+	// A light is listed in every cell it overlaps so make sure it is only tested once per query
+	if ( LightQueryStamps[light_index] == CurrentQueryStamp ) {
+		return;
+	}
+	LightQueryStamps[light_index] = CurrentQueryStamp;
+
+	if ( light_affects_sphere(&AllLights[light_index], pos, rad) ) {
+		FilteredLights.push_back(light_index);
+	}
+}
+
+void scene_lights::setLightFilter(const vec3d *pos, float rad)
+{
+	// clear out current filtered lights
+	FilteredLights.clear();
 
-			case Light_Type::Cone:
-				break;
+	if ( GridDirty ) {
+		buildLightGrid();
+	}
+
+	if ( GridLights.empty() ) {
+		return;
+	}
 
-			default:
-				break;
+	if ( ++CurrentQueryStamp == 0 ) {
+		// The stamp wrapped around so old stamps could be mistaken for the current query
+		std::fill(LightQueryStamps.begin(), LightQueryStamps.end(), 0);
+		CurrentQueryStamp = 1;
+	}
+
+	int min_x = light_grid_coord(pos->xyz.x - rad, GridCellSize), max_x = light_grid_coord(pos->xyz.x + rad, GridCellSize);
+	int min_y = light_grid_coord(pos->xyz.y - rad, GridCellSize), max_y = light_grid_coord(pos->xyz.y + rad, GridCellSize);
+	int min_z = light_grid_coord(pos->xyz.z - rad, GridCellSize), max_z = light_grid_coord(pos->xyz.z + rad, GridCellSize);
+
+	auto num_cells = static_cast<size_t>(max_x - min_x + 1) * (max_y - min_y + 1) * (max_z - min_z + 1);
+
+	if ( num_cells > GridLights.size() ) {
+		// Large objects touch more cells than there are lights so simply test all of them
+		for ( auto light_index : GridLights ) {
+			addFilterCandidate(light_index, pos, rad);
 		}
-		++i;
+	} else {
+		for ( auto light_index : GridLargeLights ) {
+			addFilterCandidate(light_index, pos, rad);
+		}
+
+		for ( int x = min_x; x <= max_x; ++x ) {
+			for ( int y = min_y; y <= max_y; ++y ) {
+				for ( int z = min_z; z <= max_z; ++z ) {
+					auto key = light_grid_cell_key(x, y, z);
+					auto cell = std::lower_bound(GridEntries.begin(), GridEntries.end(), key,
+						[](const light_grid_entry& entry, uint64_t value) { return entry.cell < value; });
+
+					for ( ; cell != GridEntries.end() && cell->cell == key; ++cell ) {
+						addFilterCandidate(cell->light_index, pos, rad);
+					}
+				}
+			}
+		}
+
+		// Keep the same order as a linear scan over all lights would produce
+		std::sort(FilteredLights.begin(), FilteredLights.end());
 	}
 }
 
@@ -722,3 +899,48 @@ bool scene_lights::setLights(const light_indexing_info *info)
 
 	return true;
 }
+
+// Resolves the same lights as setLights() but writes their uniform data to data_out instead of the global light state
+int scene_lights::buildLightUniforms(const light_indexing_info *info, void* data_out, size_t buffer_size) const
+{
+	// Reused between calls to avoid allocating for every light set
+	thread_local SCP_vector<const light*> lights;
+	lights.clear();
+
+	for ( auto light_index : StaticLightIndices ) {
+		lights.push_back(&AllLights[light_index]);
+	}
+
+	extern bool Deferred_lighting;
+	if ( !Deferred_lighting && info->num_lights > 0 ) {
+		Assert(info->index_start + info->num_lights <= BufferedLights.size());
+
+		for ( size_t i = 0; i < info->num_lights; ++i ) {
+			lights.push_back(&AllLights[BufferedLights[info->index_start + i]]);
+		}
+	}
+
+	return gr_lighting_build_uniforms(lights.data(), lights.size(), data_out, buffer_size);
+}
+
+bool scene_lights::hasSameLightUniforms(const light_indexing_info *a, const light_indexing_info *b) const
+{
+	extern bool Deferred_lighting;
+	if ( Deferred_lighting ) {
+		return true;
+	}
+
+	if ( a->num_lights != b->num_lights ) {
+		return false;
+	}
+
+	if ( a->num_lights == 0 || a->index_start == b->index_start ) {
+		return true;
+	}
+
+	Assert(a->index_start + a->num_lights <= BufferedLights.size());
+	Assert(b->index_start + b->num_lights <= BufferedLights.size());
+
+	return std::equal(BufferedLights.begin() + a->index_start, BufferedLights.begin() + a->index_start + a->num_lights,
+		BufferedLights.begin() + b->index_start);
+}
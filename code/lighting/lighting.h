@@ -78,6 +78,25 @@ class scene_lights
 
 	size_t current_light_index;
 	size_t current_num_lights;
+
+	// World space grid over all positional lights so that the light filter only has to test the lights near an object.
+	// It is rebuilt on the first filter query after lights have been added.
+	struct light_grid_entry
+	{
+		uint64_t cell;
+		size_t light_index;
+	};
+	SCP_vector<light_grid_entry> GridEntries;	// sorted by cell
+	SCP_vector<light_grid_entry> GridScratch;
+	SCP_vector<size_t> GridLargeLights;		// lights covering too many cells to be inserted into the grid
+	SCP_vector<size_t> GridLights;			// all lights which can be filtered
+	SCP_vector<uint32_t> LightQueryStamps;
+	uint32_t CurrentQueryStamp = 0;
+	float GridCellSize = 1.0f;
+	bool GridDirty = true;
+
+	void buildLightGrid();
+	void addFilterCandidate(size_t light_index, const vec3d *pos, float rad);
 public:
 	scene_lights()
 	{
@@ -86,10 +105,18 @@ public:
 	void addLight(const light *light_ptr);
 	void setLightFilter(const vec3d *pos, float rad);
 	bool setLights(const light_indexing_info *info);
+	int buildLightUniforms(const light_indexing_info *info, void* data_out, size_t buffer_size) const;
+	// True if buildLightUniforms() writes the same lights for both
+	bool hasSameLightUniforms(const light_indexing_info *a, const light_indexing_info *b) const;
 	void resetLightState();
 	light_indexing_info bufferLights();
+
+	size_t getNumFilteredLights() const { return FilteredLights.size(); }
 };
 
+// Tests whether the light can affect anything inside the given sphere. Directional lights always do.
+extern bool light_affects_sphere(const light *l, const vec3d *pos, float rad);
+
 enum class lighting_mode { NORMAL, COCKPIT };
 extern lighting_mode Lighting_mode;
 
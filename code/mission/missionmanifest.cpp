@@ -0,0 +1,247 @@
+#include "mission/missionmanifest.h"
+
+#include "cfile/cfile.h"
+#include "libs/jansson.h"
+#include "parse/parselo.h"
+
+#include <limits>
+
+namespace {
+
+const int MANIFEST_VERSION = 1;
+
+const uint32_t MANIFEST_LOCATION_FLAGS = CF_LOCATION_ROOT_USER | CF_LOCATION_ROOT_GAME | CF_LOCATION_TYPE_ROOT;
+
+// Marks files which were added but are not worth prefetching (not found or already in memory)
+const size_t IGNORED_ENTRY = std::numeric_limits<size_t>::max();
+
+struct manifest_entry {
+	SCP_string filename;
+	int path_type = CF_TYPE_ANY;
+	size_t size = 0;
+	std::uint64_t load_time_us = 0;
+};
+
+bool Manifest_recording = false;
+SCP_string Manifest_recorded_mission;
+SCP_vector<manifest_entry> Manifest_entries;
+SCP_unordered_map<SCP_string, size_t> Manifest_index;
+int Manifest_recorded_load_steps = 0;
+
+// The mission whose files the last background prefetch is reading or has read.  It is cleared when the prefetch is
+// stopped, so a prefetch of this mission is either still running or has read all of its files.
+SCP_string Manifest_prefetch_mission;
+
+// The load steps of the manifest which was read last
+SCP_string Manifest_steps_mission;
+int Manifest_load_steps = 0;
+
+SCP_string manifest_filename(const char* mission_filename)
+{
+	SCP_string name = mission_filename;
+	drop_extension(name);
+	SCP_tolower(name);
+
+	return "manifest-" + name + ".json";
+}
+
+bool manifest_load(const SCP_string& filename, SCP_vector<manifest_entry>& entries, int& load_steps)
+{
+	auto cfp = cfopen(filename.c_str(), "rb", CF_TYPE_CACHE, false, MANIFEST_LOCATION_FLAGS);
+	if (cfp == nullptr) {
+		return false;
+	}
+
+	json_error_t error;
+	std::unique_ptr<json_t> root(json_load_cfile(cfp, 0, &error));
+	cfclose(cfp);
+
+	if (!root) {
+		mprintf(("Failed to parse asset manifest %s: %s\n", filename.c_str(), error.text));
+		return false;
+	}
+
+	json_int_t version;
+	json_t* files;
+	if (json_unpack(root.get(), "{sIsiso}", "version", &version, "load_steps", &load_steps, "files", &files) != 0
+		|| version != MANIFEST_VERSION || !json_is_array(files)) {
+		mprintf(("Asset manifest %s has an unknown format, ignoring it.\n", filename.c_str()));
+		return false;
+	}
+
+	for (auto file : json::array_range(files)) {
+		const char* name;
+		int path_type;
+		json_int_t size, load_time_us;
+		if (json_unpack(file, "{sssisIsI}", "name", &name, "type", &path_type, "size", &size, "load_us", &load_time_us)
+			!= 0) {
+			continue;
+		}
+
+		manifest_entry entry;
+		entry.filename = name;
+		entry.path_type = path_type;
+		entry.size = static_cast<size_t>(size);
+		entry.load_time_us = static_cast<std::uint64_t>(load_time_us);
+		entries.push_back(std::move(entry));
+	}
+
+	return true;
+}
+
+void manifest_save(const SCP_string& filename, const SCP_vector<manifest_entry>& entries, int load_steps)
+{
+	std::unique_ptr<json_t> root(json_object());
+	json_object_set_new(root.get(), "version", json_integer(MANIFEST_VERSION));
+	json_object_set_new(root.get(), "load_steps", json_integer(load_steps));
+
+	auto files = json_array();
+	for (const auto& entry : entries) {
+		json_array_append_new(files, json_pack("{sssisIsI}", "name", entry.filename.c_str(), "type", entry.path_type,
+			"size", static_cast<json_int_t>(entry.size), "load_us", static_cast<json_int_t>(entry.load_time_us)));
+	}
+	json_object_set_new(root.get(), "files", files);
+
+	auto cfp = cfopen(filename.c_str(), "wb", CF_TYPE_CACHE, false, MANIFEST_LOCATION_FLAGS);
+	if (cfp == nullptr) {
+		mprintf(("Could not open asset manifest %s for writing!\n", filename.c_str()));
+		return;
+	}
+
+	if (json_dump_cfile(root.get(), cfp, JSON_INDENT(1)) != 0) {
+		mprintf(("Failed to write asset manifest %s!\n", filename.c_str()));
+	}
+
+	cfclose(cfp);
+}
+
+} // namespace
+
+void mission_manifest_record_start(const char* mission_filename)
+{
+	Manifest_recording = true;
+	Manifest_recorded_mission = mission_filename;
+	Manifest_entries.clear();
+	Manifest_index.clear();
+	Manifest_recorded_load_steps = 0;
+}
+
+bool mission_manifest_recording()
+{
+	return Manifest_recording;
+}
+
+void mission_manifest_add(const char* filename, int path_type, std::uint64_t load_time_us)
+{
+	if (!Manifest_recording) {
+		return;
+	}
+
+	SCP_string key = filename;
+	SCP_tolower(key);
+
+	auto it = Manifest_index.find(key);
+	if (it != Manifest_index.end()) {
+		// the frames of an animation all come from the same file
+		if (it->second != IGNORED_ENTRY) {
+			Manifest_entries[it->second].load_time_us += load_time_us;
+		}
+		return;
+	}
+
+	auto res = cf_find_file_location(filename, path_type);
+	if (!res.found || res.data_ptr != nullptr) {
+		Manifest_index.emplace(std::move(key), IGNORED_ENTRY);
+		return;
+	}
+
+	manifest_entry entry;
+	entry.filename = filename;
+	entry.path_type = path_type;
+	entry.size = res.size;
+	entry.load_time_us = load_time_us;
+
+	Manifest_index.emplace(std::move(key), Manifest_entries.size());
+	Manifest_entries.push_back(std::move(entry));
+}
+
+void mission_manifest_set_load_steps(int steps)
+{
+	Manifest_recorded_load_steps = steps;
+}
+
+void mission_manifest_record_stop(bool save)
+{
+	if (!Manifest_recording) {
+		return;
+	}
+	Manifest_recording = false;
+
+	if (save && !Manifest_entries.empty()) {
+		size_t total_size = 0;
+		std::uint64_t total_time_us = 0;
+		for (const auto& entry : Manifest_entries) {
+			total_size += entry.size;
+			total_time_us += entry.load_time_us;
+		}
+
+		mprintf(("Asset manifest of %s: %d files, %.1f MB, %.1f ms spent loading them\n",
+			Manifest_recorded_mission.c_str(), static_cast<int>(Manifest_entries.size()),
+			total_size / (1024.0 * 1024.0), total_time_us / 1000.0));
+
+		manifest_save(manifest_filename(Manifest_recorded_mission.c_str()), Manifest_entries,
+			Manifest_recorded_load_steps);
+	}
+
+	Manifest_entries.clear();
+	Manifest_index.clear();
+}
+
+void mission_manifest_prefetch(const char* mission_filename)
+{
+	auto filename = manifest_filename(mission_filename);
+
+	// the prefetch started at the debriefing usually finishes before the mission is actually loaded
+	if (Manifest_prefetch_mission == filename) {
+		return;
+	}
+
+	SCP_vector<manifest_entry> entries;
+	int load_steps = 0;
+	bool loaded = manifest_load(filename, entries, load_steps);
+
+	Manifest_steps_mission = filename;
+	Manifest_load_steps = loaded ? load_steps : 0;
+
+	if (!loaded) {
+		return;
+	}
+
+	// the files are looked up again since the mod configuration might have changed since the manifest was written
+	SCP_vector<CFileLocation> files;
+	size_t total_size = 0;
+	for (const auto& entry : entries) {
+		auto res = cf_find_file_location(entry.filename.c_str(), entry.path_type);
+		if (res.found && res.data_ptr == nullptr) {
+			total_size += res.size;
+			files.push_back(std::move(res));
+		}
+	}
+
+	mprintf(("Prefetching %d files (%.1f MB) of %s in the background\n", static_cast<int>(files.size()),
+		total_size / (1024.0 * 1024.0), mission_filename));
+
+	Manifest_prefetch_mission = filename;
+	cf_prefetch_background(std::move(files));
+}
+
+void mission_manifest_prefetch_stop()
+{
+	cf_prefetch_background_stop();
+	Manifest_prefetch_mission.clear();
+}
+
+int mission_manifest_load_steps(const char* mission_filename)
+{
+	return (Manifest_steps_mission == manifest_filename(mission_filename)) ? Manifest_load_steps : 0;
+}
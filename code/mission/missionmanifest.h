@@ -0,0 +1,35 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+// The asset manifest of a mission lists the files which were loaded the last time the mission was loaded, so the next
+// load (and the briefing screens before it) can read them in the background before they are needed.  The manifests are
+// kept in the cache directory.
+
+// Starts recording the assets loaded for the given mission.  Anything recorded before is thrown away.
+void mission_manifest_record_start(const char* mission_filename);
+
+// Returns true while assets are being recorded
+bool mission_manifest_recording();
+
+// Adds an asset file to the manifest which is being recorded.  filename has to include the extension.
+// load_time_us is how long loading it took, 0 if it was already resident.  Does nothing while not recording.
+void mission_manifest_add(const char* filename, int path_type, std::uint64_t load_time_us);
+
+// Sets the number of game_busy() steps the load which is being recorded took, for the load screen of the next load
+void mission_manifest_set_load_steps(int steps);
+
+// Stops recording and, if save is set, writes the manifest to the cache
+void mission_manifest_record_stop(bool save);
+
+// Starts reading the files of the manifest of the given mission in the background.  Does nothing if there is no
+// manifest for it or if the files of the same mission are being read or were read since the last
+// mission_manifest_prefetch_stop().
+void mission_manifest_prefetch(const char* mission_filename);
+
+// Cancels the background reading started by mission_manifest_prefetch()
+void mission_manifest_prefetch_stop();
+
+// Returns the number of game_busy() steps the last recorded load of the mission took, or 0 if that is not known.
+// Only known after mission_manifest_prefetch() was called for the mission.
+int mission_manifest_load_steps(const char* mission_filename);
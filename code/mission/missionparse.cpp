@@ -6314,6 +6314,10 @@ void parse_asteroid_fields(mission *pm)
 			Asteroid_field.enhanced_visibility_checks = true;
 		}
 
+		if (optional_string("+Instanced Field")) {
+			Asteroid_field.instanced = true;
+		}
+
 		if (optional_string("$Asteroid Targets:")) {
 			stuff_string_list(Asteroid_field.target_names);
 		}
@@ -6654,6 +6658,38 @@ bool parse_mission(mission *pm, int flags)
 	return true;
 }
 
+// Load the models of all ship classes in the mission before any ship is created.  The model files are read into memory
+// on the task pool first, so the loads themselves, which have to stay on the main thread, don't wait for the disk.
+static void mission_preload_ship_classes()
+{
+	SCP_vector<int> ship_classes;
+	SCP_vector<bool> class_used(Ship_info.size(), false);
+
+	for (const auto &p_obj : Parse_objects) {
+		if (p_obj.ship_class < 0 || class_used[p_obj.ship_class])
+			continue;
+
+		class_used[p_obj.ship_class] = true;
+		ship_classes.push_back(p_obj.ship_class);
+	}
+
+	SCP_vector<CFileLocation> files;
+	for (auto ship_class : ship_classes) {
+		auto res = cf_find_file_location(Ship_info[ship_class].pof_file, CF_TYPE_ANY);
+		if (res.found)
+			files.push_back(std::move(res));
+	}
+
+	cf_preload(files);
+
+	for (auto ship_class : ship_classes) {
+		auto sip = &Ship_info[ship_class];
+		sip->model_num = model_load(sip->pof_file, sip);
+	}
+
+	cf_preload_release();
+}
+
 bool post_process_mission(mission *pm)
 {
 	int			i;
@@ -6666,6 +6702,9 @@ bool post_process_mission(mission *pm)
 	// Goober5000 - this must be done even before post_process_ships_wings because it is a prerequisite
 	ship_clear_ship_type_counts();
 
+	// load what the ships need before creating them
+	mission_preload_ship_classes();
+
 	// Goober5000 - must be done before all other post processing
 	post_process_ships_wings();
 
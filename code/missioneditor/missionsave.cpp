@@ -864,6 +864,16 @@ int Fred_mission_save::save_asteroid_fields()
 			}
 		}
 
+		if (Asteroid_field.instanced) {
+			if (save_config.save_format != MissionFormat::RETAIL) {
+				if (optional_string_fred("+Instanced Field")) {
+					parse_comments();
+				} else {
+					fout("\n+Instanced Field");
+				}
+			}
+		}
+
 		if (!Asteroid_field.target_names.empty()) {
 			fso_comment_push(";;FSO 22.0.0;;");
 			if (optional_string_fred("$Asteroid Targets:")) {
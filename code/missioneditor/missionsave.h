@@ -158,6 +158,16 @@ class Fred_mission_save {
 	 */
 	int fout_version(const char* format, ...);
 
+	/**
+	 * @brief Save asteroid field (singular) to file
+	 *
+	 * @details Returns the value of CFred_mission_save::err, which is:
+	 *
+	 * @returns 0 for no error, or
+	 * @returns A negative value if an error occurred
+	 */
+	int save_asteroid_fields();
+
   private:
 
 	/**
@@ -221,16 +231,6 @@ class Fred_mission_save {
 	 */
 	static void convert_special_tags_to_retail(SCP_string& text);
 
-	/**
-	 * @brief Save asteroid field (singular) to file
-	 *
-	 * @details Returns the value of CFred_mission_save::err, which is:
-	 *
-	 * @returns 0 for no error, or
-	 * @returns A negative value if an error occurred
-	 */
-	int save_asteroid_fields();
-
 	//	int save_briefing_info();
 
 	/**
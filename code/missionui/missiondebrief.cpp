@@ -25,6 +25,7 @@
 #include "mission/missionbriefcommon.h"
 #include "mission/missioncampaign.h"
 #include "mission/missiongoals.h"
+#include "mission/missionmanifest.h"
 #include "mission/missiontraining.h"
 #include "missionui/chatbox.h"
 #include "missionui/missiondebrief.h"
@@ -1938,6 +1939,11 @@ void debrief_init(bool API_Access)
 
 		// evaluate next mission
 		mission_campaign_eval_next_mission();
+
+		// start reading what the next mission needs while the player reads the debriefing
+		if (Campaign.next_mission >= 0 && Campaign.next_mission != Campaign.current_mission) {
+			mission_manifest_prefetch(Campaign.missions[Campaign.next_mission].name);
+		}
 	}
 
 	// call traitor init before calling scoring_level_close.  traitor init will essentially nullify
@@ -24,6 +24,7 @@
 #include "object/object.h"
 #include "ship/ship_flags.h"
 #include "particle/particle.h"
+#include "render/occlusion.h"
 
 class object;
 class ship_info;
@@ -916,6 +917,8 @@ public:
 	indexed_vertex_source vert_source;
 	
 	vertex_buffer detail_buffers[MAX_MODEL_DETAIL_LEVELS];
+
+	occluder_mesh occluder;		// boxes inside the hull of the highest detail level, only built for large models
 };
 
 struct model_read_deferred_tasks {
@@ -30,6 +30,7 @@
 #include "io/timer.h"
 #include "math/fvi.h"
 #include "math/vecmat.h"
+#include "mission/missionmanifest.h"
 #include "model/model.h"
 #include "model/modelreplace.h"
 #include "model/modelsinc.h"
@@ -3278,6 +3279,72 @@ void model_load_texture(polymodel *pm, int i, const char *file)
 
 }
 
+// Only hulls this large hide enough of the scene to be worth rasterizing
+const float Occluder_min_radius = 250.0f;
+const int Occluder_resolution = 16;
+const int Occluder_max_boxes = 8;
+
+// Glass, force fields and invisible parts can be seen through, so a hull with any of them mustn't hide what's behind it
+static bool model_hull_is_see_through(const polymodel *pm, const bsp_collision_tree *tree)
+{
+	for (int i = 0; i < tree->n_leaves; i++) {
+		int tmap_num = tree->leaf_list[i].tmap_num;
+		if (tmap_num >= pm->n_textures) {
+			continue;
+		}
+
+		const auto& tmap = pm->maps[tmap_num];
+		if (tmap.is_transparent || tmap.textures[TM_BASE_TYPE].GetTexture() < 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Builds the occluder of a model from the polygons of its highest detail hull, which needs the collision trees
+static void model_build_occluder(polymodel *pm)
+{
+	pm->occluder.clear();
+
+	// only -occlusion_cull uses them
+	if (!Cmdline_occlusion_cull) {
+		return;
+	}
+
+	if (pm->rad < Occluder_min_radius || pm->n_detail_levels < 1 || pm->detail[0] < 0) {
+		return;
+	}
+
+	const auto& hull = pm->submodel[pm->detail[0]];
+	if (hull.collision_tree_index < 0) {
+		return;
+	}
+
+	auto tree = model_get_bsp_collision_tree(hull.collision_tree_index);
+	if (model_hull_is_see_through(pm, tree)) {
+		nprintf(("Model", "No occluder for %s, its hull can be seen through\n", pm->filename));
+		return;
+	}
+
+	TRACE_SCOPE(tracing::ModelBuildOccluder);
+
+	SCP_vector<vec3d> tri_verts;
+	for (int i = 0; i < tree->n_leaves; i++) {
+		const auto& leaf = tree->leaf_list[i];
+
+		for (int j = 2; j < leaf.num_verts; j++) {
+			tri_verts.push_back(tree->point_list[tree->vert_list[leaf.vert_start].vertnum]);
+			tri_verts.push_back(tree->point_list[tree->vert_list[leaf.vert_start + j - 1].vertnum]);
+			tri_verts.push_back(tree->point_list[tree->vert_list[leaf.vert_start + j].vertnum]);
+		}
+	}
+
+	occluder_build(&pm->occluder, tri_verts, &hull.min, &hull.max, Occluder_resolution, Occluder_max_boxes);
+
+	nprintf(("Model", "Built an occluder with %d boxes for %s\n", pm->occluder.get_num_boxes(), pm->filename));
+}
+
 //returns the number of the pof tech model if specified, otherwise number of pof model
 int model_load(ship_info* sip, bool prefer_tech_model)
 {
@@ -3314,6 +3381,7 @@ int model_load(const  char* filename, ship_info* sip, ErrorType error_type, bool
 			if (!stricmp(filename , Polygon_models[i]->filename) && !allow_redundant_load) {
 				// Model already loaded; just return.
 				Polygon_models[i]->used_this_mission++;
+				mission_manifest_add(filename, CF_TYPE_ANY, 0);
 				return Polygon_models[i]->id;
 			}
 		} else if ( num == -1 )	{
@@ -3372,6 +3440,7 @@ int model_load(const  char* filename, ship_info* sip, ErrorType error_type, bool
 #endif
 
 	model_read_deferred_tasks deferredTasks;
+	auto load_start = timer_get_microseconds();
 
 	if (read_and_process_model_file(pm, filename, n_subsystems, subsystems, error_type, deferredTasks) == modelread_status::FAIL)	{
 		if (pm != NULL) {
@@ -3385,6 +3454,8 @@ int model_load(const  char* filename, ship_info* sip, ErrorType error_type, bool
 
 	pm->used_this_mission++;
 
+	mission_manifest_add(filename, CF_TYPE_ANY, timer_get_microseconds() - load_start);
+
 #ifdef _DEBUG
 	if(Fred_running && Parse_normal_problem_count > 0)
 	{
@@ -3563,6 +3634,8 @@ int model_load(const  char* filename, ship_info* sip, ErrorType error_type, bool
 		Macro_ubyte_bounds = nullptr;
 	}
 
+	model_build_occluder(pm);
+
 	// Find the core_radius... the minimum of 
 	float rx, ry, rz;
 	rx = fl_abs( pm->submodel[pm->detail[0]].max.xyz.x - pm->submodel[pm->detail[0]].min.xyz.x );
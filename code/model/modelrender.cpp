@@ -32,6 +32,8 @@
 #include "ship/shipfx.h"
 #include "starfield/starfield.h"
 #include "tracing/tracing.h"
+#include "utils/radix_sort.h"
+#include "utils/threading.h"
 #include "weapon/weapon.h"
 
 #include <algorithm>
@@ -52,6 +54,21 @@ int model_render_determine_elapsed_time(int objnum, uint64_t flags);
 
 model_batch_buffer TransformBufferHandler;
 
+namespace {
+
+// The distances of objects to their models which were computed before the objects were queued
+struct model_object_distance {
+	int model_num = -1;
+	matrix orient;
+	vec3d pos;
+	vec3d eye_pos;
+	float distance = 0.0f;
+};
+
+SCP_vector<model_object_distance> Model_object_distances;
+
+} // namespace
+
 model_render_params::model_render_params() :
 	Model_flags(MR_NORMAL),
 	Debug_flags(0),
@@ -340,6 +357,7 @@ void model_batch_buffer::reset()
 	Submodel_matrices.clear();
 
 	Current_offset = 0;
+	Current_num_models = 0;
 }
 
 void model_batch_buffer::set_num_models(int n_models)
@@ -349,6 +367,7 @@ void model_batch_buffer::set_num_models(int n_models)
 	vm_matrix4_set_identity(&init_mat);
 
 	Current_offset = Submodel_matrices.size();
+	Current_num_models = static_cast<size_t>(n_models);
 
 	for ( int i = 0; i < n_models; ++i ) {
 		Submodel_matrices.push_back(init_mat);
@@ -370,6 +389,29 @@ size_t model_batch_buffer::get_buffer_offset() const
 	return Current_offset;
 }
 
+size_t model_batch_buffer::get_num_models() const
+{
+	return Current_num_models;
+}
+
+size_t model_batch_buffer::add_instances(const SCP_vector<size_t> &offsets, size_t num_models)
+{
+	auto start = Submodel_matrices.size();
+
+	// reserve up front since the copies are read from the same vector
+	Submodel_matrices.reserve(start + offsets.size() * num_models);
+
+	for ( auto offset : offsets ) {
+		Assert(offset + num_models <= start);
+
+		for ( size_t i = 0; i < num_models; ++i ) {
+			Submodel_matrices.push_back(Submodel_matrices[offset + i]);
+		}
+	}
+
+	return start;
+}
+
 void model_batch_buffer::allocate_memory()
 {
 	auto size = Submodel_matrices.size() * sizeof(matrix4);
@@ -419,8 +461,115 @@ void model_draw_list::reset()
 
 void model_draw_list::sort_draws()
 {
-	std::sort(Render_keys.begin(), Render_keys.end(),
-			  [this](const int a, const int b) { return model_draw_list::sort_draw_pair(this, a, b); });
+	TRACE_SCOPE(tracing::SortModelDraws);
+
+	// Sort a compact copy of the keys so that the radix passes do not have to touch the (large) draw elements
+	Sort_entries.clear();
+	Sort_entries.reserve(Render_keys.size());
+	for (auto render_index : Render_keys) {
+		Sort_entries.push_back({Render_elements[render_index].sort_key, render_index});
+	}
+
+	util::radix_sort(Sort_entries, Sort_scratch, [](const draw_sort_entry& entry) { return entry.key; });
+
+	for (size_t i = 0; i < Sort_entries.size(); ++i) {
+		Render_keys[i] = Sort_entries[i].index;
+	}
+}
+
+bool model_draw_list::can_instance(const queued_buffer_draw &first, const queued_buffer_draw &draw) const
+{
+	// Only batched draws have their transforms in the transform buffer. The cascades of the shadow map are drawn as
+	// instances already.
+	if ( draw.transform_buffer_offset == INVALID_SIZE || draw.render_material.is_shadow_casting() ) {
+		return false;
+	}
+
+	if ( draw.vert_src != first.vert_src || draw.buffer != first.buffer || draw.texi != first.texi
+		|| draw.flags != first.flags || draw.sdr_flags != first.sdr_flags
+		|| draw.transform_buffer_models != first.transform_buffer_models ) {
+		return false;
+	}
+
+	if ( !draw.render_material.has_same_state(first.render_material) ) {
+		return false;
+	}
+
+	return !draw.render_material.is_lit() || Scene_light_handler.hasSameLightUniforms(&draw.lights, &first.lights);
+}
+
+void model_draw_list::merge_instances()
+{
+	TRACE_SCOPE(tracing::MergeModelInstances);
+
+	// Draws which can be instanced have the same sort key so only the draws of a run with the same key are compared.
+	// A run may hold the draws of several models with the same textures so a few instanced draws are kept open at once.
+	const int MAX_OPEN_INSTANCES = 8;
+
+	Instance_next.assign(Render_elements.size(), -1);
+
+	size_t num_draws = 0;
+	size_t run_start = 0;
+
+	while ( run_start < Render_keys.size() ) {
+		auto run_key = Render_elements[Render_keys[run_start]].sort_key;
+
+		int open_first[MAX_OPEN_INSTANCES];
+		int open_last[MAX_OPEN_INSTANCES];
+		int num_opened = 0;
+
+		size_t i = run_start;
+		for ( ; i < Render_keys.size() && Render_elements[Render_keys[i]].sort_key == run_key; ++i ) {
+			int render_index = Render_keys[i];
+			const auto& draw = Render_elements[render_index];
+
+			bool merged = false;
+			for ( int j = 0; j < std::min(num_opened, MAX_OPEN_INSTANCES); ++j ) {
+				if ( can_instance(Render_elements[open_first[j]], draw) ) {
+					Instance_next[open_last[j]] = render_index;
+					open_last[j] = render_index;
+					merged = true;
+					break;
+				}
+			}
+
+			if ( merged ) {
+				continue;
+			}
+
+			Render_keys[num_draws++] = render_index;
+
+			if ( can_instance(draw, draw) ) {
+				// replace the draw opened first once all slots are taken
+				auto slot = num_opened % MAX_OPEN_INSTANCES;
+				open_first[slot] = render_index;
+				open_last[slot] = render_index;
+				++num_opened;
+			}
+		}
+
+		run_start = i;
+	}
+
+	Render_keys.resize(num_draws);
+
+	// The transforms of the instances have to follow each other in the transform buffer
+	for ( auto render_index : Render_keys ) {
+		if ( Instance_next[render_index] < 0 ) {
+			continue;
+		}
+
+		auto& first = Render_elements[render_index];
+
+		Instance_offsets.clear();
+		for ( int index = render_index; index >= 0; index = Instance_next[index] ) {
+			Instance_offsets.push_back(Render_elements[index].transform_buffer_offset);
+		}
+
+		first.transform_buffer_offset = TransformBufferHandler.add_instances(Instance_offsets, first.transform_buffer_models);
+		first.render_material.set_instances(static_cast<int>(Instance_offsets.size()),
+			static_cast<int>(first.transform_buffer_models));
+	}
 }
 
 void model_draw_list::start_model_batch(int n_models)
@@ -500,6 +649,7 @@ void model_draw_list::add_buffer_draw(const model_material *render_material, con
 		draw_data.scale.xyz.z = 1.0f;
 
 		draw_data.transform_buffer_offset = TransformBufferHandler.get_buffer_offset();
+		draw_data.transform_buffer_models = TransformBufferHandler.get_num_models();
 
 		draw_data.render_material.set_batching(true);
 	} else {
@@ -516,6 +666,7 @@ void model_draw_list::add_buffer_draw(const model_material *render_material, con
 	draw_data.texi = texi;
 	draw_data.flags = tmap_flags;
 	draw_data.lights = Current_lights_set;
+	draw_data.sort_key = build_sort_key(draw_data);
 
 	Render_elements.push_back(draw_data);
 	Render_keys.push_back((int) (Render_elements.size() - 1));
@@ -593,6 +744,7 @@ void model_draw_list::init_render(bool sort)
 {
 	if ( sort ) {
 		sort_draws();
+		merge_instances();
 	}
 
 	TransformBufferHandler.submit_buffer_data();
@@ -724,57 +876,41 @@ void model_draw_list::render_outline(const outline_draw &outline_info)
 	g3_done_instance(true);
 }
 
-bool model_draw_list::sort_draw_pair(const model_draw_list* target, const int a, const int b)
+uint64_t model_draw_list::build_sort_key(const queued_buffer_draw &draw)
 {
-	auto draw_call_a = &target->Render_elements[a];
-	auto draw_call_b = &target->Render_elements[b];
-
-	if ( draw_call_a->sdr_flags != draw_call_b->sdr_flags ) {
-		return draw_call_a->sdr_flags < draw_call_b->sdr_flags;
-	}
+	// Draws are ordered by the state that is most expensive to change first. From the most significant bit down:
+	//   17 bits shader flags
+	//   10 bits vertex buffer handle
+	//    8 bits index buffer handle
+	//   14 bits base texture handle
+	//   15 bits folded handles of the remaining texture maps
+	// Handles are truncated to their low bits which means that two different buffers or textures may end up with the
+	// same key. That only costs a redundant state change and never affects correctness. Draws with identical keys keep
+	// the order in which they were queued since the radix sort is stable.
+	auto field = [](int value, int bits) -> uint64_t {
+		// +1 so that "no texture" (-1) sorts before every valid handle
+		return static_cast<uint64_t>(static_cast<uint32_t>(value + 1)) & ((uint64_t(1) << bits) - 1);
+	};
 
-	if ( draw_call_a->vert_src->Vbuffer_handle != draw_call_b->vert_src->Vbuffer_handle ) {
-		return draw_call_a->vert_src->Vbuffer_handle.value() < draw_call_b->vert_src->Vbuffer_handle.value();
-	}
-
-	if ( draw_call_a->vert_src->Ibuffer_handle != draw_call_b->vert_src->Ibuffer_handle ) {
-		return draw_call_a->vert_src->Ibuffer_handle.value() < draw_call_b->vert_src->Ibuffer_handle.value();
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_BASE_TYPE) != draw_call_b->render_material.get_texture_map(TM_BASE_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_BASE_TYPE) < draw_call_b->render_material.get_texture_map(TM_BASE_TYPE);
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_SPECULAR_TYPE) != draw_call_b->render_material.get_texture_map(TM_SPECULAR_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_SPECULAR_TYPE) < draw_call_b->render_material.get_texture_map(TM_SPECULAR_TYPE);
-	}
-	
-	if ( draw_call_a->render_material.get_texture_map(TM_SPEC_GLOSS_TYPE) != draw_call_b->render_material.get_texture_map(TM_SPEC_GLOSS_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_SPEC_GLOSS_TYPE) < draw_call_b->render_material.get_texture_map(TM_SPEC_GLOSS_TYPE);
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_GLOW_TYPE) != draw_call_b->render_material.get_texture_map(TM_GLOW_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_GLOW_TYPE) < draw_call_b->render_material.get_texture_map(TM_GLOW_TYPE);
-	}
+	const auto& mat = draw.render_material;
 
-	if ( draw_call_a->render_material.get_texture_map(TM_NORMAL_TYPE) != draw_call_b->render_material.get_texture_map(TM_NORMAL_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_NORMAL_TYPE) < draw_call_b->render_material.get_texture_map(TM_NORMAL_TYPE);
+	uint32_t secondary_textures = 0;
+	for (auto type : {TM_SPECULAR_TYPE, TM_SPEC_GLOSS_TYPE, TM_GLOW_TYPE, TM_NORMAL_TYPE, TM_HEIGHT_TYPE,
+		     TM_AMBIENT_TYPE, TM_MISC_TYPE}) {
+		secondary_textures = secondary_textures * 31 + static_cast<uint32_t>(mat.get_texture_map(type) + 1);
 	}
+	secondary_textures ^= secondary_textures >> 15;
 
-	if ( draw_call_a->render_material.get_texture_map(TM_HEIGHT_TYPE) != draw_call_b->render_material.get_texture_map(TM_HEIGHT_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_HEIGHT_TYPE) < draw_call_b->render_material.get_texture_map(TM_HEIGHT_TYPE);
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_AMBIENT_TYPE) != draw_call_b->render_material.get_texture_map(TM_AMBIENT_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_AMBIENT_TYPE) < draw_call_b->render_material.get_texture_map(TM_AMBIENT_TYPE);
-	}
+	uint64_t key = 0;
+	key |= (static_cast<uint64_t>(draw.sdr_flags) & 0x1FFFF) << 47;
+	key |= field(draw.vert_src->Vbuffer_handle.value(), 10) << 37;
+	key |= field(draw.vert_src->Ibuffer_handle.value(), 8) << 29;
+	key |= field(mat.get_texture_map(TM_BASE_TYPE), 14) << 15;
+	key |= static_cast<uint64_t>(secondary_textures) & 0x7FFF;
 
-	if ( draw_call_a->render_material.get_texture_map(TM_MISC_TYPE) != draw_call_b->render_material.get_texture_map(TM_MISC_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_MISC_TYPE) < draw_call_b->render_material.get_texture_map(TM_MISC_TYPE);
-	}
-
-	return draw_call_a->lights.index_start < draw_call_b->lights.index_start;
+	return key;
 }
+
 void model_draw_list::build_uniform_buffer() {
 	GR_DEBUG_SCOPE("Build model uniform buffer");
 
@@ -782,25 +918,35 @@ void model_draw_list::build_uniform_buffer() {
 
 	_dataBuffer = gr_get_uniform_buffer(uniform_block_type::ModelData, Render_keys.size());
 
-	for (auto render_index : Render_keys) {
-		auto& queued_draw = Render_elements[render_index];
-
-		// Set lighting here so that it can be captured by the uniform conversion below
-		if ( queued_draw.render_material.is_lit() ) {
-			Scene_light_handler.setLights(&queued_draw.lights);
-		} else {
+	// Every draw gets the element matching its position in the sorted key list so the offsets are known up front and
+	// the elements can be filled in any order. The light data is resolved without going through the global light state
+	// which makes the conversion safe to split across the worker threads.
+	threading::parallel_for(Render_keys.size(), 64, [this](size_t begin, size_t end) {
+		graphics::model_light lights[graphics::MAX_UNIFORM_LIGHTS] = {};
+		int num_lights = 0;
+		light_indexing_info current_lights = {static_cast<size_t>(-1), static_cast<size_t>(-1)};
+
+		for (size_t i = begin; i < end; ++i) {
+			auto& queued_draw = Render_elements[Render_keys[i]];
+
+			// Consecutive draws usually belong to the same object so only rebuild the lights when the set changes
+			if ( queued_draw.render_material.is_lit() && (queued_draw.lights.index_start != current_lights.index_start
+					|| queued_draw.lights.num_lights != current_lights.num_lights) ) {
+				num_lights = Scene_light_handler.buildLightUniforms(&queued_draw.lights, lights, sizeof(lights));
+				current_lights = queued_draw.lights;
+			}
 
-			Scene_light_handler.resetLightState();
+			auto element = _dataBuffer.aligner().getTypedElement<graphics::model_uniform_data>(i);
+			graphics::uniforms::convert_model_material(element,
+													   queued_draw.render_material,
+													   queued_draw.transform,
+													   queued_draw.scale,
+													   queued_draw.transform_buffer_offset,
+													   lights,
+													   num_lights);
+			queued_draw.uniform_buffer_offset = _dataBuffer.getAlignerElementOffset(i);
 		}
-
-		auto element = _dataBuffer.aligner().addTypedElement<graphics::model_uniform_data>();
-		graphics::uniforms::convert_model_material(element,
-												   queued_draw.render_material,
-												   queued_draw.transform,
-												   queued_draw.scale,
-												   queued_draw.transform_buffer_offset);
-		queued_draw.uniform_buffer_offset = _dataBuffer.getCurrentAlignerOffset();
-	}
+	});
 
 	TRACE_SCOPE(tracing::UploadModelUniforms);
 
@@ -895,10 +1041,48 @@ void model_render_add_lightning(model_draw_list *scene, const model_render_param
 	}
 }
 
+void model_render_set_object_distance(int obj_num, int model_num, const matrix* orient, const vec3d* pos, const vec3d* eye_pos, float distance)
+{
+	Assertion(obj_num >= 0 && obj_num < MAX_OBJECTS, "Invalid object number %d!", obj_num);
+
+	if (Model_object_distances.empty()) {
+		Model_object_distances.resize(MAX_OBJECTS);
+	}
+
+	auto& entry = Model_object_distances[obj_num];
+	entry.model_num = model_num;
+	entry.orient = *orient;
+	entry.pos = *pos;
+	entry.eye_pos = *eye_pos;
+	entry.distance = distance;
+}
+
+static bool model_render_get_object_distance(int obj_num, int model_num, const matrix* orient, const vec3d* pos, float* distance)
+{
+	if (obj_num < 0 || obj_num >= static_cast<int>(Model_object_distances.size())) {
+		return false;
+	}
+
+	const auto& entry = Model_object_distances[obj_num];
+
+	// the same object may be rendered from other views or with other models in the same frame
+	if (entry.model_num != model_num || entry.pos != *pos || entry.eye_pos != Eye_position
+		|| entry.orient.vec.rvec != orient->vec.rvec || entry.orient.vec.uvec != orient->vec.uvec
+		|| entry.orient.vec.fvec != orient->vec.fvec) {
+		return false;
+	}
+
+	*distance = entry.distance;
+	return true;
+}
+
 float model_render_determine_depth(int obj_num, int model_num, const matrix* orient, const vec3d* pos, int detail_level_locked)
 {
-	vec3d closest_pos;
-	float depth = model_find_closest_point( &closest_pos, model_num, -1, orient, pos, &Eye_position );
+	float depth;
+	if ( !model_render_get_object_distance(obj_num, model_num, orient, pos, &depth) ) {
+		vec3d closest_pos;
+		depth = model_find_closest_point( &closest_pos, model_num, -1, orient, pos, &Eye_position );
+	}
 
 	if ( detail_level_locked < 0 ) {
 		switch (Detail.detail_distance) {
@@ -188,6 +188,7 @@ struct insignia_draw_data
 struct queued_buffer_draw
 {
 	size_t transform_buffer_offset = 0;
+	size_t transform_buffer_models = 0;	// the number of transforms of the batch this draw belongs to
 	size_t uniform_buffer_offset = 0;
 
 	model_material render_material;
@@ -201,6 +202,9 @@ struct queued_buffer_draw
 	int flags;
 	int sdr_flags;
 
+	// Packed render state used to order the draw list, see model_draw_list::build_sort_key()
+	uint64_t sort_key = 0;
+
 	light_indexing_info lights;
 
 	queued_buffer_draw()
@@ -224,20 +228,26 @@ class model_batch_buffer
 	size_t Mem_alloc_size;
 
 	size_t Current_offset;
+	size_t Current_num_models;
 
 	void allocate_memory();
 public:
-	model_batch_buffer() : Mem_alloc(NULL), Mem_alloc_size(0), Current_offset(0) {};
+	model_batch_buffer() : Mem_alloc(NULL), Mem_alloc_size(0), Current_offset(0), Current_num_models(0) {};
 
 	void reset();
 
 	size_t get_buffer_offset() const;
+	size_t get_num_models() const;
 	void set_num_models(int n_models);
 	void set_model_transform(const matrix4 &transform, int model_id);
 
 	void submit_buffer_data();
 
 	void add_matrix(const matrix4 &mat);
+
+	// Copies the transforms of the given batches behind each other to the end of the buffer and returns the offset of
+	// the first copy
+	size_t add_instances(const SCP_vector<size_t> &offsets, size_t num_models);
 };
 
 class model_draw_list
@@ -256,6 +266,16 @@ class model_draw_list
 	SCP_vector<queued_buffer_draw> Render_elements;
 	SCP_vector<int> Render_keys;
 
+	struct draw_sort_entry {
+		uint64_t key;
+		int index;
+	};
+	SCP_vector<draw_sort_entry> Sort_entries;
+	SCP_vector<draw_sort_entry> Sort_scratch;
+
+	SCP_vector<int> Instance_next;		// the next draw of the same instanced draw, indexed by render element
+	SCP_vector<size_t> Instance_offsets;
+
 	SCP_vector<arc_effect> Arcs;
 	SCP_vector<insignia_draw_data> Insignias;
 	SCP_vector<outline_draw> Outlines;
@@ -264,9 +284,12 @@ class model_draw_list
 
 	bool Render_initialized = false; //!< A flag for checking if init_render has been called before a render_all call
 	
-	static bool sort_draw_pair(const model_draw_list* target, const int a, const int b);
+	static uint64_t build_sort_key(const queued_buffer_draw &draw);
 	void sort_draws();
 
+	bool can_instance(const queued_buffer_draw &first, const queued_buffer_draw &draw) const;
+	void merge_instances();
+
 	void build_uniform_buffer();
 public:
 	model_draw_list();
@@ -301,6 +324,8 @@ public:
 	void init_render(bool sort = true);
 	void render_all(gr_zbuffer_type depth_mode = ZBUFFER_TYPE_DEFAULT);
 	void reset();
+
+	size_t get_num_draws() const { return Render_keys.size(); }
 };
 
 void model_render_only_glowpoint_lights(const model_render_params* interp, int model_num, int model_instance_num, const matrix* orient, const vec3d* pos);
@@ -314,6 +339,9 @@ void submodel_render_immediate(const model_render_params* render_info, const pol
 void submodel_render_queue(const model_render_params* render_info, model_draw_list* scene, const polymodel* pm, const polymodel_instance* pmi, int submodel_num, const matrix* orient, const vec3d* pos);
 void model_render_buffers(model_draw_list* scene, model_material* rendering_material, const model_render_params* interp, const vertex_buffer* buffer, const polymodel* pm, int mn, int detail_level, uint tmap_flags);
 bool model_render_check_detail_box(const vec3d* view_pos, const polymodel* pm, int submodel_num, uint64_t flags);
+// Remembers the distance from the eye to the bounding box of the model of an object when it was computed before queueing
+// the object, so that selecting the detail level does not have to compute it again
+void model_render_set_object_distance(int obj_num, int model_num, const matrix* orient, const vec3d* pos, const vec3d* eye_pos, float distance);
 void model_render_arc(const vec3d* v1, const vec3d* v2, const SCP_vector<vec3d> *persistent_arc_points, const color* primary, const color* secondary, float arc_width, ubyte depth_limit);
 void model_render_insignias(const insignia_draw_data* insignia);
 void model_render_set_wireframe_color(const color* clr);
@@ -76,9 +76,10 @@ class player;
 // Version 60 - 3/27/2023 - Added generic lua data packet
 // Version 61 - 4/17/2023 - Added compatibility for whackable asteroids (added force)
 // Version 62 - 5/26/2025 - Added some modular curve input data to turret firing packets; 5/31/2025 - Added another input
+// Version 63 - 10/18/2026 - Object update position deltas against acknowledged frames
 // STANDALONE_ONLY
 
-#define MULTI_FS_SERVER_VERSION							62
+#define MULTI_FS_SERVER_VERSION							63
 
 #define MULTI_FS_SERVER_COMPATIBLE_VERSION			MULTI_FS_SERVER_VERSION
 
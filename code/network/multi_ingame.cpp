@@ -1684,6 +1684,9 @@ void process_ingame_ship_request_packet(ubyte *data, header *hinfo)
 
 		// initialize datarate limiting for this guy
 		multi_oo_rate_init(&Net_players[player_num]);
+
+		// and make sure he doesn't get position deltas meant for whoever had his slot before
+		multi_oo_player_reset_all(&Net_players[player_num]);
 		
 		// ack him
 		send_ingame_ship_request_packet(INGAME_SR_CONFIRM,OBJ_INDEX(objp),&Net_players[player_num]);
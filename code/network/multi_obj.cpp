@@ -9,6 +9,7 @@
 
 
 #include <algorithm>
+#include <mutex>
 
 #include "network/multi_obj.h"
 #include "globalincs/globals.h"
@@ -34,13 +35,32 @@
 #include "debugconsole/console.h"
 #include "object/waypoint.h"
 #include "weapon/weapon.h"
+#include "utils/threading.h"
 
 // ---------------------------------------------------------------------------------------------------
 // OBJECT UPDATE STRUCTS
 // 
 
 extern const std::uint32_t MAX_TIME;
-constexpr int OO_MAIN_HEADER_SIZE = 9;  // two ints and a ubyte (recall! fix is basically an int)
+constexpr int OO_MAIN_HEADER_SIZE = 10;  // two ints and two ubytes (recall! fix is basically an int)
+constexpr int OO_CLIENT_MAIN_HEADER_SIZE = 17;	// two ints, a ubyte, and the delta acknowledgement int and uint
+constexpr int OO_POSITION_UPDATE_SIZE = 28; // see the position section of pack_data() to know where this number is coming from.
+constexpr int OO_AI_UPDATE_SIZE = 6;		// mode, submode, target signature and weapon energy
+constexpr int OO_SUPPORT_UPDATE_SIZE = 18;	// ai flags, mode, submode and dock signature
+
+// which sections of an oo_packed_object have been packed
+constexpr int OO_PACKED_POSITION = (1 << 0);
+constexpr int OO_PACKED_HULL = (1 << 1);
+constexpr int OO_PACKED_SHIELDS = (1 << 2);
+constexpr int OO_PACKED_AI = (1 << 3);
+constexpr int OO_PACKED_SUPPORT = (1 << 4);
+constexpr int OO_PACKED_SUBSYSTEMS = (1 << 5);
+
+// position deltas
+constexpr int OO_DELTA_FRAMES = 256;			// how many frames back a position delta can reach, the age is sent as a ubyte
+constexpr int OO_DELTA_SHIP_HISTORY = 32;		// how many of the last positions received for each ship a client keeps
+constexpr ubyte OO_FRAME_PACKET_LAST = 0x80;		// set in the packet index of the last update packet of a frame
+constexpr ubyte OO_FRAME_PACKET_UNTRACKED = 0xff;	// the packet index of an update sent outside the regular per frame updates
 
 
 // One frame record per ship with each contained array holding one element for each frame.
@@ -77,10 +97,31 @@ struct oo_info_sent_to_players {
 	SCP_vector<float> subsystem_x;
 	SCP_vector<float> subsystem_y;
 	SCP_vector<float> subsystem_z;
+
+	// position deltas are sent against the newest position the player acknowledged
+	int delta_send_count;						// how many tracked positions of this ship were sent to the player
+	int baseline_frame;							// the frame of the acknowledged position, -1 if there is none
+	int baseline_send_count;					// the delta_send_count of the acknowledged position
+	multi_quantized_transform baseline;			// the acknowledged position
+};
+
+// a position sent to a player in a tracked update frame
+struct oo_delta_sent_record {
+	ushort net_signature;
+	int send_count;
+	multi_quantized_transform transform;
+};
+
+// all tracked positions sent to a player in one frame
+struct oo_delta_sent_frame {
+	int frame = -1;
+	bool acked = false;
+	SCP_vector<oo_delta_sent_record> sent;
 };
 
 struct oo_netplayer_records{
 	SCP_vector<oo_info_sent_to_players> last_sent;			// Subcategory of which player did I send this info to?  Corresponds to net_player index.
+	SCP_vector<oo_delta_sent_frame> delta_frames;			// the positions sent in the last OO_DELTA_FRAMES frames, uses frame % OO_DELTA_FRAMES as the index
 	// This is not yet implemented, but may be necessary for autoaim to work in more busy scenes.  Basically, if you're switching targets,
 	// autoaim may succeed on the client but head to the wrong target on the server.
 //	int player_target_record[MAX_FRAMES_RECORDED];			// For rollback, we need to keep track of the player's targets. Uses frame as its index.
@@ -104,6 +145,56 @@ struct rollback_unsimulated_shots {
 	bool secondary_shot;	// is this a dumbfire missile shot?
 };
 
+// The rotation of a subsystem, extracted once per frame instead of once for every player the ship is sent to.
+struct oo_packed_subsystem {
+	bool has_angles_1;
+	bool has_angles_2;
+	angles angles_1;
+	angles angles_2;
+};
+
+// The parts of a ship's update which do not depend on the player it is sent to. When the server builds the update
+// packets for all players, each ship is packed once per frame and the packets of the players copy the bytes from here.
+struct oo_packed_object {
+	int frame = -1;					// which oo_general_info::pack_frame this was built for
+	int signature = 0;				// the object signature this was built for, in case the object slot was reused
+	int valid_sections = 0;			// the OO_PACKED_* sections which have been packed already this frame
+
+	// position, orientation, velocity, rotational velocity and desired velocities
+	ubyte position[OO_POSITION_UPDATE_SIZE];
+	int position_size, orient_size, vel_size, rotvel_size, desired_size;
+	bool full_physics;
+
+	multi_quantized_transform transform;	// the quantized position and orientation, for position deltas
+
+	std::uint8_t hull;
+	SCP_vector<std::uint8_t> shields;
+
+	ubyte ai[OO_AI_UPDATE_SIZE];
+	ubyte support[OO_SUPPORT_UPDATE_SIZE];
+
+	SCP_vector<oo_packed_subsystem> subsystems;
+};
+
+// a position a client received for a ship, kept so that the server can send deltas against it
+struct oo_delta_received_record {
+	int frame = -1;
+	multi_quantized_transform transform;
+};
+
+struct oo_delta_ship_history {
+	oo_delta_received_record records[OO_DELTA_SHIP_HISTORY];
+	int next = 0;
+};
+
+// The update packets built for one player in a frame. They are built on the task pool and sent from the main thread.
+struct oo_player_packets {
+	SCP_vector<short> ship_list;	// the ship indices to check for this player, in the order they are checked
+	SCP_vector<ubyte> data;			// the packets, back to back
+	SCP_vector<int> sizes;			// the size of each packet in data
+	bool capped = false;			// did the player hit their datarate limit
+};
+
 // our main struct for keeping track of all interpolation and oo packet info.
 struct oo_general_info {
 	// info that helps us figure out what is the best reference object available when sending a rollback shot.
@@ -135,6 +226,18 @@ struct oo_general_info {
 	SCP_vector<int>rollback_collide_list;					// the list of ships and weapons that we need to pass to collision detection during rollback.
 														
 	SCP_vector<const ship_registry_entry*> rotation_list;	// subsystem rotation
+
+	// shared packet sections
+	bool sharing_packed_sections;							// is the server building the update packets for all players right now
+	int pack_frame;											// incremented every time the server builds the update packets for all players
+	SCP_vector<oo_packed_object> packed_objects;			// the player independent parts of the ship updates. Uses objnum as its index.
+	bool packed_read_only;									// are the packets being built on the task pool, which means packed_objects must not be written to
+	SCP_vector<int> snapshot_objects;						// the objnums of the ships packed up front for the task pool
+	SCP_vector<oo_player_packets> player_packets;			// the update packets for each player this frame. Uses the Net_players index.
+
+	// client side of the position deltas
+	SCP_unordered_map<ushort, oo_delta_ship_history> delta_history;	// the last positions received for each ship, by net_signature
+	multi_frame_receipt delta_frame_receipts[MULTI_FRAME_RECEIPT_FRAMES];	// which update packets of the last frames arrived
 };
 
 oo_general_info Oo_info;
@@ -179,6 +282,7 @@ float multi_oo_calc_pos_time_difference(int player_id, int net_sig_idx);
 #define OO_PRIMARY_LINKED			(1<<9)		// if this is set, banks are linked
 #define OO_TRIGGER_DOWN				(1<<10)		// if this is set, trigger is DOWN
 #define OO_SUPPORT_SHIP				(1<<11)		// Send extra info for the support ship.
+#define OO_POS_DELTA				(1<<12)		// Position and orientation are sent as a delta against a position the player acknowledged
 
 #define OO_SBUSYS_ROTATION_CUTOFF	0.1f		// if the squared difference between the old and new angles is less than this, don't send.
 
@@ -277,9 +381,6 @@ int Multi_oo_rear_far_update_times[MAX_OBJ_UPDATE_LEVELS] =
 	200,				// LAN, 5x a second
 };
 
-// ship index list for possibly sorting ships based upon distance, etc
-short OO_ship_index[MAX_SHIPS];
-
 // Cyborg17 - I'm leaving this system in place, just in case, although I never used it. 
 // It needs cleanup in keycontrol.cpp before it can be used.
 int OO_update_index = -1;							// The player index that allows us to look up multi rate through the debug
@@ -988,10 +1089,9 @@ void multi_oo_respawn_reset_info(object* objp)
 // OBJECT UPDATE FUNCTIONS
 //
 
-object *OO_player_obj;
 int OO_sort = 1;
 
-bool multi_oo_sort_func(const short &index1, const short &index2)
+static bool multi_oo_sort_func(const object *player_obj, short index1, short index2)
 {
 	object *obj1, *obj2;
 	float dist1, dist2;
@@ -1015,12 +1115,12 @@ bool multi_oo_sort_func(const short &index1, const short &index2)
 	}
 
 	// get the distance and dot product to the player obj for both
-	vm_vec_sub(&v1, &OO_player_obj->pos, &obj1->pos);
+	vm_vec_sub(&v1, &player_obj->pos, &obj1->pos);
 	dist1 = vm_vec_normalize_safe(&v1);
-	vm_vec_sub(&v2, &OO_player_obj->pos, &obj2->pos);
+	vm_vec_sub(&v2, &player_obj->pos, &obj2->pos);
 	dist2 = vm_vec_normalize_safe(&v2);
-	dot1 = vm_vec_dot(&OO_player_obj->orient.vec.fvec, &v1);
-	dot2 = vm_vec_dot(&OO_player_obj->orient.vec.fvec, &v2);
+	dot1 = vm_vec_dot(&player_obj->orient.vec.fvec, &v1);
+	dot2 = vm_vec_dot(&player_obj->orient.vec.fvec, &v2);
 
 	// objects in front take precedence
 	if((dot1 < 0.0f) && (dot2 >= 0.0f)){
@@ -1034,17 +1134,12 @@ bool multi_oo_sort_func(const short &index1, const short &index2)
 }
 
 // build the list of ship indices to use when updating for this player
-void multi_oo_build_ship_list(net_player *pl)
+void multi_oo_build_ship_list(net_player *pl, SCP_vector<short> &ship_list)
 {
-	int ship_index;
-	int idx;
 	ship_obj *moveup;
 	object *player_obj;
 
-	// set all indices to be -1
-	for(idx = 0;idx<MAX_SHIPS; idx++){
-		OO_ship_index[idx] = -1;
-	}
+	ship_list.clear();
 
 	// get the player object
 	if(pl->m_player->objnum < 0){
@@ -1053,7 +1148,6 @@ void multi_oo_build_ship_list(net_player *pl)
 	player_obj = &Objects[pl->m_player->objnum];
 	
 	// go through all other relevant objects
-	ship_index = 0;
 	for ( moveup = GET_FIRST(&Ship_obj_list); moveup != END_OF_LIST(&Ship_obj_list); moveup = GET_NEXT(moveup) ) {
 		// if it is an invalid ship object, skip it
 		if((moveup->objnum < 0) || (Objects[moveup->objnum].instance < 0) || (Objects[moveup->objnum].type != OBJ_SHIP)){
@@ -1091,23 +1185,21 @@ void multi_oo_build_ship_list(net_player *pl)
 		}
 
 		// add the ship 
-		if(ship_index < MAX_SHIPS){
-			OO_ship_index[ship_index++] = (short)Objects[moveup->objnum].instance;
-		}
+		ship_list.push_back((short)Objects[moveup->objnum].instance);
 	}
 
 	// maybe sort the thing here
-	OO_player_obj = player_obj;
 	if (OO_sort) {
-		std::sort(OO_ship_index, OO_ship_index + ship_index, multi_oo_sort_func);
+		std::sort(ship_list.begin(), ship_list.end(), [player_obj](short index1, short index2) {
+			return multi_oo_sort_func(player_obj, index1, index2);
+		});
 	}
 }
 
 
 constexpr int OO_CLIENT_HEADER_SIZE = 4;	// flags and data_size ushorts
 constexpr int OO_SERVER_HEADER_SIZE = 6; // flags, data_size, and net_signature ushorts
-constexpr int OO_POSITION_UPDATE_SIZE = 28; // see the position section of pack_data() to know where this number is coming from.
-constexpr int OO_MAX_CLIENT_DATA_SIZE = MAX_PACKET_SIZE - OO_MAIN_HEADER_SIZE - OO_CLIENT_HEADER_SIZE - OO_POSITION_UPDATE_SIZE;
+constexpr int OO_MAX_CLIENT_DATA_SIZE = MAX_PACKET_SIZE - OO_CLIENT_MAIN_HEADER_SIZE - OO_CLIENT_HEADER_SIZE - OO_POSITION_UPDATE_SIZE;
 constexpr int OO_MAX_DATA_SIZE = MAX_PACKET_SIZE - OO_MAIN_HEADER_SIZE - OO_SERVER_HEADER_SIZE;
 
 // whatever crazy thing happens, keep the buffer from overflowing because we can just "erase" the part that overflowed it
@@ -1220,20 +1312,407 @@ int multi_oo_pack_client_data(ubyte *data, ship* shipp)
 	return packet_size;
 }
 
+// the update packets of the players are built on the task pool, so the log has to be serialized while packing
+static std::mutex Oo_log_mutex;
+#define OO_NPRINTF(args) do { std::lock_guard<std::mutex> oo_log_guard(Oo_log_mutex); nprintf(args); } while (false)
+
 // pack the appropriate info into the data
-#define PACK_PERCENT(v) { std::uint8_t upercent; if(v < 0.0f){v = 0.0f;} upercent = (v * 255.0f) <= 255.0f ? (std::uint8_t)(v * 255.0f) : (std::uint8_t)255; memcpy(data + packet_size + header_bytes, &upercent, sizeof(std::uint8_t)); packet_size++; }
 #define PACK_BYTE(v) { memcpy( data + packet_size + header_bytes, &v, 1 ); packet_size += 1; }
 #define PACK_SHORT(v) { std::int16_t swap = INTEL_SHORT(v); memcpy( data + packet_size + header_bytes, &swap, sizeof(std::int16_t) ); packet_size += sizeof(std::int16_t); }
 #define PACK_USHORT(v) { std::uint16_t swap = INTEL_SHORT(v); memcpy( data + packet_size + header_bytes, &swap, sizeof(std::uint16_t) ); packet_size += sizeof(std::uint16_t); }
 #define PACK_INT(v) { std::int32_t swap = INTEL_INT(v); memcpy( data + packet_size + header_bytes, &swap, sizeof(std::int32_t) ); packet_size += sizeof(std::int32_t); }
 #define PACK_ULONG(v) { std::uint64_t swap = INTEL_LONG(v); memcpy( data + packet_size + header_bytes, &swap, sizeof(std::uint64_t) ); packet_size += sizeof(std::uint64_t); }
-int multi_oo_pack_data(net_player *pl, object *objp, ushort oo_flags, ubyte *data_out)
+static std::uint8_t multi_oo_pack_percent(float v)
+{
+	if (v < 0.0f) {
+		v = 0.0f;
+	}
+	return (v * 255.0f) <= 255.0f ? (std::uint8_t)(v * 255.0f) : (std::uint8_t)255;
+}
+
+// get the storage for the player independent parts of this object's update
+static oo_packed_object* multi_oo_get_packed_object(object *objp)
+{
+	// outside of multi_oo_process() every packet is built for a single player so there is nothing to share
+	static thread_local oo_packed_object scratch;
+	if (!Oo_info.sharing_packed_sections) {
+		scratch.valid_sections = 0;
+		return &scratch;
+	}
+
+	auto& packed = Oo_info.packed_objects[OBJ_INDEX(objp)];
+
+	// the task pool can only read what multi_oo_pack_snapshot() packed, anything else is packed just for this player
+	if (Oo_info.packed_read_only) {
+		if (packed.frame != Oo_info.pack_frame || packed.signature != objp->signature) {
+			scratch.valid_sections = 0;
+			return &scratch;
+		}
+		return &packed;
+	}
+
+	if (packed.frame != Oo_info.pack_frame || packed.signature != objp->signature) {
+		packed.frame = Oo_info.pack_frame;
+		packed.signature = objp->signature;
+		packed.valid_sections = 0;
+	}
+
+	return &packed;
+}
+
+// position, orientation, velocity, rotational velocity, desired velocity and desired rotational velocity
+static void multi_oo_pack_position(oo_packed_object *packed, object *objp)
+{
+	if (packed->valid_sections & OO_PACKED_POSITION) {
+		return;
+	}
+
+	ubyte *data = packed->position;
+
+	packed->position_size = multi_pack_unpack_position( 1, data, &objp->pos ); // 10 bytes
+	data += packed->position_size;
+
+	// orientation (now done via angles)
+	angles temp_angles;
+	vm_extract_angles_matrix_alternate(&temp_angles, &objp->orient);
+
+	// actual packing function, 6 bytes
+	packed->orient_size = multi_pack_unpack_orient( 1, data, &temp_angles );
+
+	multi_quantize_transform(&objp->pos, &temp_angles, &packed->transform);
+	data += packed->orient_size;
+
+	// velocity, 4 bytes-- Tried to do this by calculation instead but kept running into issues.
+	packed->vel_size = multi_pack_unpack_vel( 1, data, &objp->orient, &objp->phys_info );
+	data += packed->vel_size;
+
+	// Rotational Velocity, 4 bytes
+	packed->rotvel_size = multi_pack_unpack_rotvel( 1, data, &objp->phys_info );
+	data += packed->rotvel_size;
+
+	// in order to send data by axis we must rotate the global velocity into local coordinates
+	vec3d local_desired_vel;
+
+	vm_vec_rotate(&local_desired_vel, &objp->phys_info.desired_vel, &objp->orient);
+
+	// is this a ship with full phyiscs? (just player-controled for now)
+	packed->full_physics = objp->flags[Object::Object_Flags::Player_ship];
+
+	// actual packing function, 4 bytes if full_physics, 3 bytes if not
+	packed->desired_size = multi_pack_unpack_desired_vel_and_desired_rotvel( 1, packed->full_physics, data, &objp->phys_info, &local_desired_vel );
+
+	Assertion(packed->position_size + packed->orient_size + packed->vel_size + packed->rotvel_size + packed->desired_size <= OO_POSITION_UPDATE_SIZE,
+		"The position section of an object update packet is bigger than expected. Please report!");
+
+	packed->valid_sections |= OO_PACKED_POSITION;
+}
+
+static void multi_oo_pack_hull(oo_packed_object *packed, object *objp)
+{
+	if (packed->valid_sections & OO_PACKED_HULL) {
+		return;
+	}
+
+	float temp_float = get_hull_pct(objp);
+	if ((temp_float < 0.004f) && (temp_float > 0.0f)) {
+		temp_float = 0.004f;		// 0.004 is the lowest positive value we can have before we zero out when packing
+	}
+	packed->hull = multi_oo_pack_percent(temp_float);
+
+	packed->valid_sections |= OO_PACKED_HULL;
+}
+
+static void multi_oo_pack_shields(oo_packed_object *packed, object *objp)
+{
+	if (packed->valid_sections & OO_PACKED_SHIELDS) {
+		return;
+	}
+
+	float quad = shield_get_max_quad(objp);
+
+	packed->shields.clear();
+	for (float temp_quadrant : objp->shield_quadrant) {
+		packed->shields.push_back(multi_oo_pack_percent(temp_quadrant / quad));
+	}
+
+	packed->valid_sections |= OO_PACKED_SHIELDS;
+}
+
+static void multi_oo_pack_ai(oo_packed_object *packed, ship *shipp, ship_info *sip)
+{
+	if (packed->valid_sections & OO_PACKED_AI) {
+		return;
+	}
+
+	// for the PACK_* macros
+	ubyte *data = packed->ai;
+	int packet_size = 0;
+	const int header_bytes = 0;
+
+	ai_info *aip = &Ai_info[shipp->ai_index];
+
+	// ai mode info
+	auto umode = (ubyte)(aip->mode);
+	auto submode = (short)(aip->submode);
+	ushort target_signature = 0;
+
+	// either send out the waypoint they are trying to get to *or* their current target
+	if (umode == AIM_WAYPOINTS) {
+		// if it's already started pointing to a waypoint, grab its net_signature and send that instead
+		waypoint* wp;
+		if ((wp = find_waypoint_at_indexes(aip->wp_list_index, aip->wp_index)) != nullptr) {
+			target_signature = Objects[wp->get_objnum()].net_signature;
+		}
+	} // send the target signature. 2021 Version!
+	else if ((aip->goals[0].target_name != nullptr) && strlen(aip->goals[0].target_name) != 0) {
+
+		int instance = ship_name_lookup(aip->goals[0].target_name);
+		if (instance > -1) {
+			target_signature = Objects[Ships[instance].objnum].net_signature;
+		}
+	}
+
+	PACK_BYTE( umode );
+	PACK_SHORT( submode );
+	PACK_USHORT( target_signature );
+
+	// primary weapon energy
+	std::uint8_t energy = multi_oo_pack_percent(shipp->weapon_energy / sip->max_weapon_reserve);
+	PACK_BYTE( energy );
+
+	Assertion(packet_size == OO_AI_UPDATE_SIZE, "The AI section of an object update packet has an unexpected size. Please report!");
+
+	packed->valid_sections |= OO_PACKED_AI;
+}
+
+static void multi_oo_pack_support(oo_packed_object *packed, ship *shipp)
+{
+	if (packed->valid_sections & OO_PACKED_SUPPORT) {
+		return;
+	}
+
+	// for the PACK_* macros
+	ubyte *data = packed->support;
+	int packet_size = 0;
+	const int header_bytes = 0;
+
+	ushort dock_sig;
+
+	PACK_ULONG( Ai_info[shipp->ai_index].ai_flags.to_u64() );
+	PACK_INT( Ai_info[shipp->ai_index].mode );
+	PACK_INT( Ai_info[shipp->ai_index].submode );
+
+	if((Ai_info[shipp->ai_index].support_ship_objnum < 0) || (Ai_info[shipp->ai_index].support_ship_objnum >= MAX_OBJECTS)){
+		dock_sig = 0;
+	} else {
+		dock_sig = Objects[Ai_info[shipp->ai_index].support_ship_objnum].net_signature;
+	}
+
+	PACK_USHORT( dock_sig );
+
+	Assertion(packet_size == OO_SUPPORT_UPDATE_SIZE, "The support ship section of an object update packet has an unexpected size. Please report!");
+
+	packed->valid_sections |= OO_PACKED_SUPPORT;
+}
+
+// the subsystem rotations, which players they need to be sent to is decided per player
+static void multi_oo_pack_subsystems(oo_packed_object *packed, ship *shipp)
+{
+	if (packed->valid_sections & OO_PACKED_SUBSYSTEMS) {
+		return;
+	}
+
+	packed->subsystems.clear();
+
+	for (auto subsystem : list_range(&shipp->subsys_list)) {
+		packed->subsystems.emplace_back();
+		auto& packed_subsys = packed->subsystems.back();
+
+		packed_subsys.has_angles_1 = false;
+		packed_subsys.has_angles_2 = false;
+
+		if (subsystem->system_info->flags[Model::Subsystem_Flags::Rotates]) {
+			if (subsystem->submodel_instance_1) {
+				packed_subsys.has_angles_1 = true;
+				vm_extract_angles_matrix_alternate(&packed_subsys.angles_1, &subsystem->submodel_instance_1->canonical_orient);
+			}
+			if (subsystem->submodel_instance_2) {
+				packed_subsys.has_angles_2 = true;
+				vm_extract_angles_matrix_alternate(&packed_subsys.angles_2, &subsystem->submodel_instance_2->canonical_orient);
+			}
+		}
+	}
+
+	packed->valid_sections |= OO_PACKED_SUBSYSTEMS;
+}
+
+// pack the shared sections of every ship up front, so that the task pool can build the players' packets from them
+static void multi_oo_pack_snapshot()
+{
+	auto& objnums = Oo_info.snapshot_objects;
+	objnums.clear();
+
+	for (auto moveup : list_range(&Ship_obj_list)) {
+		if ((moveup->objnum < 0) || (Objects[moveup->objnum].type != OBJ_SHIP) || (Objects[moveup->objnum].instance < 0)) {
+			continue;
+		}
+		if (Ships[Objects[moveup->objnum].instance].ship_info_index < 0) {
+			continue;
+		}
+
+		objnums.push_back(moveup->objnum);
+	}
+
+	// every ship only writes its own entry
+	threading::parallel_for(objnums.size(), 8, [&objnums](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			object *objp = &Objects[objnums[i]];
+			ship *shipp = &Ships[objp->instance];
+			ship_info *sip = &Ship_info[shipp->ship_info_index];
+			oo_packed_object *packed = multi_oo_get_packed_object(objp);
+
+			multi_oo_pack_position(packed, objp);
+			multi_oo_pack_hull(packed, objp);
+			multi_oo_pack_shields(packed, objp);
+			multi_oo_pack_ai(packed, shipp, sip);
+			multi_oo_pack_subsystems(packed, shipp);
+
+			if ((sip->flags[Ship::Info_Flags::Support]) && (shipp->ai_index >= 0) && (shipp->ai_index < MAX_AI_INFO)) {
+				multi_oo_pack_support(packed, shipp);
+			}
+		}
+	});
+}
+
+// can the server send position deltas, for comparing the bandwidth with and without them
+bool Oo_delta_enabled = true;
+
+// the acknowledged position of this ship a delta can be sent against, nullptr if the full position has to be sent
+static const oo_info_sent_to_players* multi_oo_get_delta_baseline(net_player *pl, object *objp)
+{
+	if (!Oo_delta_enabled) {
+		return nullptr;
+	}
+
+	const auto& sent = Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature];
+	if (sent.baseline_frame < 0) {
+		return nullptr;
+	}
+
+	int age = Oo_info.number_of_frames - sent.baseline_frame;
+	if (age <= 0 || age >= OO_DELTA_FRAMES) {
+		return nullptr;
+	}
+
+	// the client only keeps the last few positions it got for each ship
+	if (sent.delta_send_count - sent.baseline_send_count >= OO_DELTA_SHIP_HISTORY - 1) {
+		return nullptr;
+	}
+
+	return &sent;
+}
+
+// remember which position was sent to this player in this frame, it becomes the baseline once the frame is acknowledged
+static void multi_oo_record_delta_sent(net_player *pl, object *objp, const multi_quantized_transform *transform)
+{
+	auto& records = Oo_info.player_frame_info[pl->player_id];
+	auto& sent = records.last_sent[objp->net_signature];
+
+	sent.delta_send_count++;
+
+	auto& frame = records.delta_frames[Oo_info.number_of_frames % OO_DELTA_FRAMES];
+	if (frame.frame != Oo_info.number_of_frames) {
+		frame.frame = Oo_info.number_of_frames;
+		frame.acked = false;
+		frame.sent.clear();
+	}
+
+	frame.sent.push_back({objp->net_signature, sent.delta_send_count, *transform});
+}
+
+// server handling of the frames a client says it received completely
+static void multi_oo_process_delta_ack(net_player *pl, int ack_frame, uint ack_bits)
+{
+	if (ack_frame < 0) {
+		return;
+	}
+
+	auto& records = Oo_info.player_frame_info[pl->player_id];
+
+	for (int i = 0; i <= MULTI_FRAME_ACK_BITS; i++) {
+		if ((i > 0) && !(ack_bits & (1u << (i - 1)))) {
+			continue;
+		}
+
+		int frame_num = ack_frame - i;
+		if (frame_num < 0) {
+			break;
+		}
+
+		auto& frame = records.delta_frames[frame_num % OO_DELTA_FRAMES];
+		if ((frame.frame != frame_num) || frame.acked) {
+			continue;
+		}
+		frame.acked = true;
+
+		for (const auto& record : frame.sent) {
+			if (record.net_signature >= records.last_sent.size()) {
+				continue;
+			}
+
+			auto& sent = records.last_sent[record.net_signature];
+			if (frame_num > sent.baseline_frame) {
+				sent.baseline_frame = frame_num;
+				sent.baseline_send_count = record.send_count;
+				sent.baseline = record.transform;
+			}
+		}
+	}
+}
+
+// client side, keep a received position around for decoding later deltas
+static void multi_oo_record_delta_received(ushort net_sig, int frame, const multi_quantized_transform *transform)
+{
+	auto& history = Oo_info.delta_history[net_sig];
+
+	history.records[history.next].frame = frame;
+	history.records[history.next].transform = *transform;
+	history.next = (history.next + 1) % OO_DELTA_SHIP_HISTORY;
+}
+
+static const multi_quantized_transform* multi_oo_find_delta_baseline(ushort net_sig, int frame)
+{
+	auto history = Oo_info.delta_history.find(net_sig);
+	if (history == Oo_info.delta_history.end()) {
+		return nullptr;
+	}
+
+	for (const auto& record : history->second.records) {
+		if (record.frame == frame) {
+			return &record.transform;
+		}
+	}
+
+	return nullptr;
+}
+
+// client side, note that a packet of a server frame arrived. The frame is only acknowledged if every position in its
+// packets was stored, otherwise the server would send deltas against a position this client does not have.
+static void multi_oo_record_frame_packet(int frame, ubyte frame_packet, bool stored)
+{
+	if (frame_packet == OO_FRAME_PACKET_UNTRACKED) {
+		return;
+	}
+
+	multi_frame_receipt_add(Oo_info.delta_frame_receipts, frame, frame_packet & ~OO_FRAME_PACKET_LAST, (frame_packet & OO_FRAME_PACKET_LAST) != 0, stored);
+}
+
+int multi_oo_pack_data(net_player *pl, object *objp, ushort oo_flags, ubyte *data_out, bool track_delta)
 {
 	ubyte data[OO_SAFE_BUFFER_SIZE];
 	ushort data_size = 0;	// now a ushort because of IPv6 size extensions
 	ship *shipp;	
 	ship_info *sip;
-	float temp_float;	
 	int header_bytes;
 	int packet_size = 0, ret = 0;
 
@@ -1277,58 +1756,62 @@ int multi_oo_pack_data(net_player *pl, object *objp, ushort oo_flags, ubyte *dat
 		packet_size += multi_oo_pack_client_data(data + packet_size + header_bytes, shipp);		
 	}		
 		
+	// the sections which are the same for every player are only packed once per frame and then copied
+	oo_packed_object *packed = multi_oo_get_packed_object(objp);
+
 	// position - Now includes, position, orientation, velocity, rotational velocity, desired velocity and desired rotational velocity.
 	// this should always be sent when it is determined to be needed.
 	if ( oo_flags & OO_POS_AND_ORIENT_NEW ) {	
-		ret = multi_pack_unpack_position( 1, data + packet_size + header_bytes, &objp->pos ); // 10 bytes
-		packet_size += ret;
+		multi_oo_pack_position(packed, objp);
+
+		// send the difference to what the player already has if we can
+		auto delta_baseline = track_delta ? multi_oo_get_delta_baseline(pl, objp) : nullptr;
+
+		// a delta across a long jump can take more bytes than the full position and orientation, with its age byte
+		ubyte delta[32];
+		int delta_size = 0;
+		if (delta_baseline != nullptr) {
+			delta_size = multi_pack_unpack_transform_delta(1, delta, &delta_baseline->baseline, &packed->transform);
+			if (1 + delta_size >= packed->position_size + packed->orient_size) {
+				delta_baseline = nullptr;
+			}
+		}
 
-		// datarate tracking.
-		multi_rate_add(NET_PLAYER_NUM(pl), "pos", ret);
+		if (delta_baseline != nullptr) {
+			auto age = (ubyte)(Oo_info.number_of_frames - delta_baseline->baseline_frame);
+			PACK_BYTE( age );
 
-		// orientation (now done via angles)
-		angles temp_angles;
-		vm_extract_angles_matrix_alternate(&temp_angles, &objp->orient);	
+			ret = delta_size;
+			memcpy(data + packet_size + header_bytes, delta, ret);
+			packet_size += ret;
 
-		// actual packing function, 6 bytes
-		ret = multi_pack_unpack_orient( 1, data + packet_size + header_bytes, &temp_angles); 
+			oo_flags |= OO_POS_DELTA;
 
-		packet_size += ret;
-		// datarate tracking.
-		multi_rate_add(NET_PLAYER_NUM(pl), "ori", ret);	
+			// datarate tracking.
+			multi_rate_add(NET_PLAYER_NUM(pl), "pos", 1 + ret);
+		} else {
+			ret = packed->position_size + packed->orient_size;
+			memcpy(data + packet_size + header_bytes, packed->position, ret);
+			packet_size += ret;
 
-		// velocity, 4 bytes-- Tried to do this by calculation instead but kept running into issues. 
-		ret = multi_pack_unpack_vel(1, data + packet_size + header_bytes, &objp->orient, &objp->phys_info);
+			// datarate tracking.
+			multi_rate_add(NET_PLAYER_NUM(pl), "pos", packed->position_size);
+			multi_rate_add(NET_PLAYER_NUM(pl), "ori", packed->orient_size);
+		}
 
+		// velocities are always sent in full
+		ret = packed->vel_size + packed->rotvel_size + packed->desired_size;
+		memcpy(data + packet_size + header_bytes, packed->position + packed->position_size + packed->orient_size, ret);
 		packet_size += ret;
-		// datarate tracking.
-		multi_rate_add(NET_PLAYER_NUM(pl), "pos", ret);	
-
-		// Rotational Velocity, 4 bytes
-		ret = multi_pack_unpack_rotvel( 1, data + packet_size + header_bytes, &objp->phys_info );
 
-		packet_size += ret;	
+		multi_rate_add(NET_PLAYER_NUM(pl), "pos", packed->vel_size);
+		multi_rate_add(NET_PLAYER_NUM(pl), "ori", packed->rotvel_size);
 
-		// datarate tracking.		
-		multi_rate_add(NET_PLAYER_NUM(pl), "ori", ret);		
-		ret = 0;
-
-		// in order to send data by axis we must rotate the global velocity into local coordinates
-		vec3d local_desired_vel;
-
-		vm_vec_rotate(&local_desired_vel, &objp->phys_info.desired_vel, &objp->orient);
-
-		// is this a ship with full phyiscs? (just player-controled for now)
-		bool full_physics = false;
-		if (objp->flags[Object::Object_Flags::Player_ship]) {
-			full_physics = true;
+		if (packed->full_physics) {
 			oo_flags |= OO_FULL_PHYSICS;
 		}
 
-		// actual packing function, 4 bytes if full_physics, 3 bytes if not
-		ret = multi_pack_unpack_desired_vel_and_desired_rotvel(1, full_physics, data + packet_size + header_bytes, &objp->phys_info, &local_desired_vel);
-
-		packet_size += ret;
+		ret = packed->desired_size;
 	}
 
 	// datarate records	
@@ -1338,32 +1821,25 @@ int multi_oo_pack_data(net_player *pl, object *objp, ushort oo_flags, ubyte *dat
 	// at this point it is impossible to overflow the buffer.
 	if (oo_flags & OO_HULL_NEW) {
 		// add the hull value for this guy		
-		temp_float = get_hull_pct(objp);
-		if ((temp_float < 0.004f) && (temp_float > 0.0f)) {
-			temp_float = 0.004f;		// 0.004 is the lowest positive value we can have before we zero out when packing
-		}
-		PACK_PERCENT(temp_float);
+		multi_oo_pack_hull(packed, objp);
+		PACK_BYTE( packed->hull );
 		multi_rate_add(NET_PLAYER_NUM(pl), "hul", 1);
 	}
 
 	// add shields, which can have now have a dynamic number of quadrants, we need to start checking for buffer overflow here
 	if (oo_flags & OO_SHIELDS_NEW) {
-		int pre_section_size = packet_size;
+		multi_oo_pack_shields(packed, objp);
 
-		float quad = shield_get_max_quad(objp);
-
-		for (float temp_quadrant: objp->shield_quadrant) {
-			temp_float = temp_quadrant / quad;
-			PACK_PERCENT(temp_float);
-		}
-				
 		// Check that we are not sending too much data, if so, don't actually send.
-		if (packet_size > OO_MAX_DATA_SIZE) {
-			nprintf(("Network","Had to remove shields section from data packet for %s\n", shipp->ship_name));
-			packet_size = pre_section_size;
+		if (packet_size + static_cast<int>(packed->shields.size()) > OO_MAX_DATA_SIZE) {
+			OO_NPRINTF(("Network","Had to remove shields section from data packet for %s\n", shipp->ship_name));
 			oo_flags &= ~OO_SHIELDS_NEW;
 		}
 		else {
+			if (!packed->shields.empty()) {
+				memcpy(data + packet_size + header_bytes, packed->shields.data(), packed->shields.size());
+				packet_size += static_cast<int>(packed->shields.size());
+			}
 			multi_rate_add(NET_PLAYER_NUM(pl), "shl", static_cast<int>(objp->shield_quadrant.size()));
 		}
 	}	
@@ -1377,85 +1853,81 @@ int multi_oo_pack_data(net_player *pl, object *objp, ushort oo_flags, ubyte *dat
 		flags.reserve(MAX_MODEL_SUBSYSTEMS);
 		subsys_data.reserve(MAX_MODEL_SUBSYSTEMS); // propbably won't exceed this, and even if it does, it will get cut off.
 
+		// the rotations are the same for everyone, only what was last sent to this player differs
+		multi_oo_pack_subsystems(packed, shipp);
+		auto& last_sent = Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature];
+
 		for (ship_subsys* subsystem = GET_FIRST(&shipp->subsys_list); subsystem != END_OF_LIST(&shipp->subsys_list);
 			subsystem = GET_NEXT(subsystem)) {
 			flags.push_back(0);
 			// Don't send destroyed subsystems, (another packet handles that), but check to see if the subsystem changed since the last update. 
-			if (MULTIPLAYER_MASTER && (subsystem->current_hits != 0.0f) && (subsystem->current_hits != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_health[i])) {
+			if (MULTIPLAYER_MASTER && (subsystem->current_hits != 0.0f) && (subsystem->current_hits != last_sent.subsystem_health[i])) {
 				flags[i] |= OO_SUBSYS_HEALTH;
 				subsys_data.push_back(subsystem->current_hits / subsystem->max_hits);
 				// good thing this cheap because we have to calculate this twice to avoid iterating through the whole system list twice.
-				Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_health[i] = subsystem->current_hits;
+				last_sent.subsystem_health[i] = subsystem->current_hits;
 
 				// this should be safe because we only work with subsystems that have health.
 				// and also track the list of subsystems that we packed by index
 			}
 			
 
-			// retrieve the submodel for rotation info.
-			if (subsystem->system_info->flags[Model::Subsystem_Flags::Rotates]) {
-				angles *angs_1 = nullptr;
-				angles *angs_2 = nullptr;
-				if (subsystem->submodel_instance_1) {
-					angs_1 = new angles;
-					vm_extract_angles_matrix_alternate(angs_1, &subsystem->submodel_instance_1->canonical_orient);
-				}
-				if (subsystem->submodel_instance_2) {
-					angs_2 = new angles;
-					vm_extract_angles_matrix_alternate(angs_2, &subsystem->submodel_instance_2->canonical_orient);
-				}
+			// here we're checking to see if the subsystems rotated enough to send.
+			const auto& packed_subsys = packed->subsystems[i];
 
-				// here we're checking to see if the subsystems rotated enough to send.
-				if (angs_1 != nullptr && angs_1->b != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_1b[i]) {
+			if (packed_subsys.has_angles_1) {
+				const angles& angs_1 = packed_subsys.angles_1;
+
+				if (angs_1.b != last_sent.subsystem_1b[i]) {
 					flags[i] |= OO_SUBSYS_ROTATION_1b;
-					subsys_data.push_back(angs_1->b / PI2);
+					subsys_data.push_back(angs_1.b / PI2);
 				}
 
-				if (angs_1 != nullptr && angs_1->h != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_1h[i]) {
+				if (angs_1.h != last_sent.subsystem_1h[i]) {
 					flags[i] |= OO_SUBSYS_ROTATION_1h;
-					subsys_data.push_back(angs_1->h / PI2);
+					subsys_data.push_back(angs_1.h / PI2);
 				}
 
-				if (angs_1 != nullptr && angs_1->p != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_1p[i]) {
+				if (angs_1.p != last_sent.subsystem_1p[i]) {
 					flags[i] |= OO_SUBSYS_ROTATION_1p;
-					subsys_data.push_back(angs_1->p / PI2);
+					subsys_data.push_back(angs_1.p / PI2);
 				}
+			}
+
+			if (packed_subsys.has_angles_2) {
+				const angles& angs_2 = packed_subsys.angles_2;
 
-				if (angs_2 != nullptr && angs_2->b != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_2b[i]) {
+				if (angs_2.b != last_sent.subsystem_2b[i]) {
 					flags[i] |= OO_SUBSYS_ROTATION_2b;
-					subsys_data.push_back(angs_2->b / PI2);
+					subsys_data.push_back(angs_2.b / PI2);
 				}
 
-				if (angs_2 != nullptr && angs_2->h != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_2h[i]) {
+				if (angs_2.h != last_sent.subsystem_2h[i]) {
 					flags[i] |= OO_SUBSYS_ROTATION_2h;
-					subsys_data.push_back(angs_2->h / PI2);
+					subsys_data.push_back(angs_2.h / PI2);
 				}
 
-				if (angs_2 != nullptr && angs_2->p != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_2p[i]) {
+				if (angs_2.p != last_sent.subsystem_2p[i]) {
 					flags[i] |= OO_SUBSYS_ROTATION_2p;
-					subsys_data.push_back(angs_2->p / PI2);
+					subsys_data.push_back(angs_2.p / PI2);
 				}
-
-				// clang says deleting null pointer has no effect
-				delete angs_1;
-				delete angs_2;
 			}
 
 			// ditto for translation
 			if (subsystem->system_info->flags[Model::Subsystem_Flags::Translates]) {
 				auto smi = subsystem->submodel_instance_1;
 
-				if (smi && smi->canonical_offset.xyz.x != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_x[i]) {
+				if (smi && smi->canonical_offset.xyz.x != last_sent.subsystem_x[i]) {
 					flags[i] |= OO_SUBSYS_TRANSLATION_x;
 					subsys_data.push_back(smi->canonical_offset.xyz.x);
 				}
 
-				if (smi && smi->canonical_offset.xyz.y != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_y[i]) {
+				if (smi && smi->canonical_offset.xyz.y != last_sent.subsystem_y[i]) {
 					flags[i] |= OO_SUBSYS_TRANSLATION_y;
 					subsys_data.push_back(smi->canonical_offset.xyz.y);
 				}
 
-				if (smi && smi->canonical_offset.xyz.z != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_z[i]) {
+				if (smi && smi->canonical_offset.xyz.z != last_sent.subsystem_z[i]) {
 					flags[i] |= OO_SUBSYS_TRANSLATION_z;
 					subsys_data.push_back(smi->canonical_offset.xyz.z);
 				}
@@ -1475,79 +1947,38 @@ int multi_oo_pack_data(net_player *pl, object *objp, ushort oo_flags, ubyte *dat
 				oo_flags |= OO_SUBSYSTEMS_NEW;		
 				packet_size += ret;
 			} else {
-				nprintf(("Network","Had to remove subsystems section from data packet for %s\n", shipp->ship_name));
+				OO_NPRINTF(("Network","Had to remove subsystems section from data packet for %s\n", shipp->ship_name));
 			}
 		}
 	}
 
 	// Cyborg17 - only server should send this
 	if (oo_flags & OO_AI_NEW){
-		int pre_section_size = packet_size;
-		ai_info *aip = &Ai_info[shipp->ai_index];
+		multi_oo_pack_ai(packed, shipp, sip);
 
-		// ai mode info
-		auto umode = (ubyte)(aip->mode);
-		auto submode = (short)(aip->submode);
-		ushort target_signature = 0;
-
-		// either send out the waypoint they are trying to get to *or* their current target
-		if (umode == AIM_WAYPOINTS) {
-			// if it's already started pointing to a waypoint, grab its net_signature and send that instead
-			waypoint* wp;
-			if ((wp = find_waypoint_at_indexes(aip->wp_list_index, aip->wp_index)) != nullptr) {
-				target_signature = Objects[wp->get_objnum()].net_signature;
-			}
-		} // send the target signature. 2021 Version!
-		else if ((aip->goals[0].target_name != nullptr) && strlen(aip->goals[0].target_name) != 0) {
-			
-			int instance = ship_name_lookup(aip->goals[0].target_name);
-			if (instance > -1) {
-				target_signature = Objects[Ships[instance].objnum].net_signature;
-			}
-		}
-
-		PACK_BYTE( umode );
-		PACK_SHORT( submode );
-		PACK_USHORT( target_signature );	
-
-		// primary weapon energy
-		temp_float = shipp->weapon_energy / sip->max_weapon_reserve;
-		PACK_PERCENT(temp_float);
-
-		// check for adding too much data, if so don't send what we just wrote.
-		if (packet_size > OO_MAX_DATA_SIZE) {
-			nprintf(("Network","Had to remove AI section from data packet for %s\n", shipp->ship_name));
-			packet_size = pre_section_size;
+		// check for adding too much data, if so don't send it.
+		if (packet_size + OO_AI_UPDATE_SIZE > OO_MAX_DATA_SIZE) {
+			OO_NPRINTF(("Network","Had to remove AI section from data packet for %s\n", shipp->ship_name));
 			oo_flags &= ~OO_AI_NEW;
 		} // otherwise, make sure it gets counted int the rate limiting system.
 		else {
+			memcpy(data + packet_size + header_bytes, packed->ai, OO_AI_UPDATE_SIZE);
+			packet_size += OO_AI_UPDATE_SIZE;
 			multi_rate_add(NET_PLAYER_NUM(pl), "aim", 5);
 		}
 	}		
 
 	// if this ship is a support ship, send some extra info
 	if(MULTIPLAYER_MASTER && (sip->flags[Ship::Info_Flags::Support]) && (shipp->ai_index >= 0) && (shipp->ai_index < MAX_AI_INFO)){
-		int pre_section_size = packet_size;
-		ushort dock_sig;
-
-		PACK_ULONG( Ai_info[shipp->ai_index].ai_flags.to_u64() );
-		PACK_INT( Ai_info[shipp->ai_index].mode );
-		PACK_INT( Ai_info[shipp->ai_index].submode );
+		multi_oo_pack_support(packed, shipp);
 
-		if((Ai_info[shipp->ai_index].support_ship_objnum < 0) || (Ai_info[shipp->ai_index].support_ship_objnum >= MAX_OBJECTS)){
-			dock_sig = 0;
-		} else {
-			dock_sig = Objects[Ai_info[shipp->ai_index].support_ship_objnum].net_signature;
-		}		
-
-		PACK_USHORT( dock_sig );
-
-		// check for adding too much data, if so don't send what we just wrote.
-		if (packet_size > OO_MAX_DATA_SIZE) {
-			nprintf(("Network","Had to remove support ship section from data packet for %s\n", shipp->ship_name));
-			packet_size = pre_section_size;
+		// check for adding too much data, if so don't send it.
+		if (packet_size + OO_SUPPORT_UPDATE_SIZE > OO_MAX_DATA_SIZE) {
+			OO_NPRINTF(("Network","Had to remove support ship section from data packet for %s\n", shipp->ship_name));
 		}
 		else {
+			memcpy(data + packet_size + header_bytes, packed->support, OO_SUPPORT_UPDATE_SIZE);
+			packet_size += OO_SUPPORT_UPDATE_SIZE;
 			oo_flags |= OO_SUPPORT_SHIP;
 		}
 	}
@@ -1583,6 +2014,10 @@ int multi_oo_pack_data(net_player *pl, object *objp, ushort oo_flags, ubyte *dat
 
 	// copy to the outgoing data
 	memcpy(data_out, data, packet_size);	
+
+	if (track_delta && (oo_flags & OO_POS_AND_ORIENT_NEW)) {
+		multi_oo_record_delta_sent(pl, objp, &packed->transform);
+	}
 	
 	return packet_size;	
 }
@@ -1770,7 +2205,8 @@ int multi_oo_unpack_client_data(net_player* pl, ubyte* data, bool keep_data)
 // more recently, but the packet has the newest AI info, we will still use the AI info, even though it's not the newest
 // packet.
 #define UNPACK_PERCENT(v)					{ ubyte temp_byte; memcpy(&temp_byte, data + offset, sizeof(ubyte)); v = (float)temp_byte / 255.0f; offset++;}
-int multi_oo_unpack_data(net_player* pl, ubyte* data, int seq_num, int time_delta)
+// position_stored is cleared if the update has a position which could not be stored
+int multi_oo_unpack_data(net_player* pl, ubyte* data, int seq_num, int time_delta, bool tracked, bool* position_stored)
 {
 	int offset = 0;
 	object* pobjp;
@@ -1818,6 +2254,9 @@ int multi_oo_unpack_data(net_player* pl, ubyte* data, int seq_num, int time_delt
 
 	// if we can't find the object, skip the packet
 	if ( (pobjp == nullptr) || (pobjp->type != OBJ_SHIP) || (pobjp->instance < 0) || (pobjp->instance >= MAX_SHIPS) || (Ships[pobjp->instance].ship_info_index < 0) || (Ships[pobjp->instance].ship_info_index >= ship_info_size())) {
+		if (oo_flags & OO_POS_AND_ORIENT_NEW) {
+			*position_stored = false;
+		}
 		offset += data_size;
 		return offset;
 	}
@@ -1856,17 +2295,36 @@ int multi_oo_unpack_data(net_player* pl, ubyte* data, int seq_num, int time_delt
 	physics_info new_phys_info = pobjp->phys_info;
 
 	if ( oo_flags & OO_POS_AND_ORIENT_NEW) {
+		multi_quantized_transform transform;
+		bool transform_valid = true;
+
+		// unpack position and orientation
+		if (oo_flags & OO_POS_DELTA) {
+			ubyte age;
+			GET_DATA(age);
+
+			// if we lost the position this is based on, the delta still has to be read to get past it
+			auto baseline = multi_oo_find_delta_baseline(net_sig, seq_num - age);
+			multi_quantized_transform missing_baseline = {};
+
+			transform_valid = (baseline != nullptr);
+			offset += multi_pack_unpack_transform_delta(0, data + offset, transform_valid ? baseline : &missing_baseline, &transform);
+		} else {
+			offset += multi_pack_unpack_transform(0, data + offset, &transform, true);
+		}
 
-		// unpack position
-		int r1 = multi_pack_unpack_position(0, data + offset, &new_pos);
-		offset += r1;
+		if (transform_valid) {
+			multi_dequantize_transform(&transform, &new_pos, &new_angles);
 
-		// unpack orientation
-		int r2 = multi_pack_unpack_orient( 0, data + offset, &new_angles );
-		offset += r2;
+			// new version of the orient packer sends angles instead to save on bandwidth, so we'll need the orienation from that.
+			vm_angles_2_matrix(&new_orient, &new_angles);
 
-		// new version of the orient packer sends angles instead to save on bandwidth, so we'll need the orienation from that.
-		vm_angles_2_matrix(&new_orient, &new_angles);
+			if (tracked) {
+				multi_oo_record_delta_received(net_sig, seq_num, &transform);
+			}
+		} else {
+			*position_stored = false;
+		}
 
 		int r3 = multi_pack_unpack_vel(0, data + offset, &new_orient, &new_phys_info);
 		offset += r3;
@@ -1891,7 +2349,9 @@ int multi_oo_unpack_data(net_player* pl, ubyte* data, int seq_num, int time_delt
 			new_phys_info.desired_rotvel = new_phys_info.rotvel;
 		}
 
-		Interp_info[objnum].add_packet(objnum, seq_num, time_delta, &new_pos, &new_phys_info.vel, &new_phys_info.rotvel, &new_phys_info.desired_vel, &new_phys_info.desired_rotvel, &new_angles, pl->player_id);
+		if (transform_valid) {
+			Interp_info[objnum].add_packet(objnum, seq_num, time_delta, &new_pos, &new_phys_info.vel, &new_phys_info.rotvel, &new_phys_info.desired_vel, &new_phys_info.desired_rotvel, &new_angles, pl->player_id);
+		}
 	}
 
 	// Packet processing needs to stop here if the ship is still arriving, leaving, dead or dying to prevent bugs.
@@ -2459,16 +2919,30 @@ int multi_oo_maybe_update(net_player *pl, object *obj, ubyte *data)
 	}
 
 	// finally, pack stuff only if we have to 	
-	int packed = multi_oo_pack_data(pl, obj, oo_flags, data);	
+	int packed = multi_oo_pack_data(pl, obj, oo_flags, data, true);	
 
 	// bytes packed
 	return packed;
 }
 
 
-// process all other objects for this player
-void multi_oo_process_all(net_player *pl)
+// add a finished update packet to the ones for this player
+static void multi_oo_queue_packet(net_player *pl, oo_player_packets *packets, const ubyte *data, int packet_size)
+{
+	packets->data.insert(packets->data.end(), data, data + packet_size);
+	packets->sizes.push_back(packet_size);
+
+	// counted right away since the datarate limit is checked while building the rest of the packets
+	pl->s_info.rate_bytes += packet_size + UDP_HEADER_SIZE;
+}
+
+// process all other objects for this player, may run on the task pool so the packets are only built here
+void multi_oo_process_all(net_player *pl, oo_player_packets *packets)
 {
+	packets->data.clear();
+	packets->sizes.clear();
+	packets->capped = false;
+
 	// if the player has an invalid objnum abort..
 	if(pl->m_player->objnum < 0){
 		return;
@@ -2479,7 +2953,7 @@ void multi_oo_process_all(net_player *pl)
 	int packet_size = 0;	
 
 	// build the list of ships to check against
-	multi_oo_build_ship_list(pl);
+	multi_oo_build_ship_list(pl, packets->ship_list);
 
 	// build the header
 	BUILD_HEADER(OBJECT_UPDATE);		
@@ -2491,6 +2965,11 @@ void multi_oo_process_all(net_player *pl)
 
 	ADD_INT(time_out);
 
+	// which packet of this frame this is, so the client can tell if it got all of them
+	ubyte frame_packet = 0;
+	int frame_packet_offset = packet_size;
+	ADD_DATA(frame_packet);
+
 	ubyte stop;
 	int add_size;	
 	ubyte data_add[MAX_PACKET_SIZE * 2]; // we could have up to two maximum sized packets in the array without it overflowing.
@@ -2516,18 +2995,16 @@ void multi_oo_process_all(net_player *pl)
 	}
 	
 	bool packet_sent = false;
-	int idx = 0;
 
-	// rely on logical-AND shortcut evaluation to prevent array out-of-bounds read of OO_ship_index[idx]
-	while((idx < MAX_SHIPS) && (OO_ship_index[idx] >= 0)){
+	for (auto ship_index : packets->ship_list) {
 		// if this guy is over his datarate limit, do nothing
 		if(multi_oo_rate_exceeded(pl)){
-			nprintf(("Network","Capping client\n"));
+			packets->capped = true;
 			break;
 		}			
 
 		// get the object
-		object *moveup = &Objects[Ships[OO_ship_index[idx]].objnum];
+		object *moveup = &Objects[Ships[ship_index].objnum];
 
 		// maybe send some info		
 		add_size = multi_oo_maybe_update(pl, moveup, data_add);
@@ -2538,15 +3015,21 @@ void multi_oo_process_all(net_player *pl)
 			multi_rate_add(NET_PLAYER_NUM(pl), "stp", 1);
 			ADD_DATA(stop);
 									
-			multi_io_send(pl, data, packet_size);
+			multi_oo_queue_packet(pl, packets, data, packet_size);
 			packet_sent = true;
-			pl->s_info.rate_bytes += packet_size + UDP_HEADER_SIZE;
 
 			packet_size = 0;
 			BUILD_HEADER(OBJECT_UPDATE);
 			// Cyborg17 - regurgitate shared header
 			ADD_INT(Oo_info.number_of_frames);
 			ADD_INT(time_out);
+
+			// the client does not track more than 32 packets per frame anyway
+			if (frame_packet < 32) {
+				frame_packet++;
+			}
+			frame_packet_offset = packet_size;
+			ADD_DATA(frame_packet);
 		}
 
 		if(add_size){
@@ -2558,9 +3041,6 @@ void multi_oo_process_all(net_player *pl)
 			memcpy(data + packet_size,data_add,add_size);
 			packet_size += add_size;
 		}
-
-		// next ship
-		idx++;
 	}
 
 	// Cyborg17 - Now that this is basically an object update and timing update packet, we always should send at least one.
@@ -2569,8 +3049,9 @@ void multi_oo_process_all(net_player *pl)
 		multi_rate_add(NET_PLAYER_NUM(pl), "stp", 1);
 		ADD_DATA(stop);
 
-		multi_io_send(pl, data, packet_size);
-		pl->s_info.rate_bytes += packet_size + UDP_HEADER_SIZE;
+		data[frame_packet_offset] |= OO_FRAME_PACKET_LAST;
+
+		multi_oo_queue_packet(pl, packets, data, packet_size);
 	}
 }
 
@@ -2578,21 +3059,60 @@ void multi_oo_process_all(net_player *pl)
 void multi_oo_process()
 {
 	int idx;	
-	
-	// process each player
+	int update_players[MAX_PLAYERS];
+	int num_update_players = 0;
+
 	for(idx=0; idx<MAX_PLAYERS; idx++){
 		if(MULTI_CONNECTED(Net_players[idx]) && !MULTI_STANDALONE(Net_players[idx]) && (Net_player != &Net_players[idx]) /*&& !MULTI_OBSERVER(Net_players[idx])*/ ){
-			// now process the rest of the objects
-			multi_oo_process_all(&Net_players[idx]);
+			update_players[num_update_players++] = idx;
+		}
+	}
 
-			// do firing stuff for this player
-			if((Net_players[idx].m_player != nullptr) && (Net_players[idx].m_player->objnum >= 0) && !(Net_players[idx].flags & NETINFO_FLAG_LIMBO) && !(Net_players[idx].flags & NETINFO_FLAG_RESPAWNING)){
-				if((Objects[Net_players[idx].m_player->objnum].flags[Object::Object_Flags::Player_ship]) && !(Objects[Net_players[idx].m_player->objnum].flags[Object::Object_Flags::Should_be_dead])){
-					obj_player_fire_stuff( &Objects[Net_players[idx].m_player->objnum], Net_players[idx].m_player->ci );
-				}
+	// every player gets the same position, hull, shield, ai and subsystem rotation bytes for a ship so only pack them once
+	Oo_info.sharing_packed_sections = true;
+	Oo_info.pack_frame++;
+
+	// with more than one player the packets are built on the task pool, which only reads a snapshot of the shared sections
+	if (threading::is_threading() && (num_update_players > 1)) {
+		multi_oo_pack_snapshot();
+		Oo_info.packed_read_only = true;
+	}
+
+	// the players only write to their own records and packets, so they can be built independently of each other
+	threading::parallel_for(static_cast<size_t>(num_update_players), 1, [&update_players](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			multi_oo_process_all(&Net_players[update_players[i]], &Oo_info.player_packets[update_players[i]]);
+		}
+	});
+
+	Oo_info.packed_read_only = false;
+	Oo_info.sharing_packed_sections = false;
+
+	// send everything from here, in the same order as the packets were built for each player
+	psnet_send_batch_begin();
+
+	for (int i = 0; i < num_update_players; i++) {
+		idx = update_players[i];
+		auto& packets = Oo_info.player_packets[idx];
+
+		if (packets.capped) {
+			nprintf(("Network","Capping client\n"));
+		}
+
+		size_t offset = 0;
+		for (auto size : packets.sizes) {
+			multi_io_send(&Net_players[idx], packets.data.data() + offset, size);
+			offset += size;
+		}
+
+		// do firing stuff for this player, after all packets are built so that every player gets the same weapon energy
+		if((Net_players[idx].m_player != nullptr) && (Net_players[idx].m_player->objnum >= 0) && !(Net_players[idx].flags & NETINFO_FLAG_LIMBO) && !(Net_players[idx].flags & NETINFO_FLAG_RESPAWNING)){
+			if((Objects[Net_players[idx].m_player->objnum].flags[Object::Object_Flags::Player_ship]) && !(Objects[Net_players[idx].m_player->objnum].flags[Object::Object_Flags::Should_be_dead])){
+				obj_player_fire_stuff( &Objects[Net_players[idx].m_player->objnum], Net_players[idx].m_player->ci );
 			}
 		}
 	}
+	psnet_send_batch_end();
 }
 
 // process incoming object update data
@@ -2619,15 +3139,38 @@ void multi_oo_process_update(ubyte *data, header *hinfo)
 	// TODO: ADD COMPLICATED TIMESTAMP LOGIC HERE
 	GET_INT(seq_num);
 	GET_INT(timestamp);
+
+	bool tracked = false;
+	ubyte frame_packet = OO_FRAME_PACKET_UNTRACKED;
+	if (MULTIPLAYER_MASTER) {
+		int ack_frame;
+		uint ack_bits;
+
+		GET_INT(ack_frame);
+		GET_UINT(ack_bits);
+
+		if (player_index != -1) {
+			multi_oo_process_delta_ack(pl, ack_frame, ack_bits);
+		}
+	} else {
+		GET_DATA(frame_packet);
+		tracked = (frame_packet != OO_FRAME_PACKET_UNTRACKED);
+	}
+
 	GET_DATA(stop);
-	
+
+	bool positions_stored = true;
 	while(stop == 0xff){
 		// process the data
-		offset += multi_oo_unpack_data(pl, data + offset, seq_num, timestamp);
+		offset += multi_oo_unpack_data(pl, data + offset, seq_num, timestamp, tracked, &positions_stored);
 
 		GET_DATA(stop);
 	}
 	PACKET_SET_SIZE();
+
+	if (tracked) {
+		multi_oo_record_frame_packet(seq_num, frame_packet, positions_stored);
+	}
 }
 
 // initialize all object update info (call whenever entering gameplay state)
@@ -2655,6 +3198,20 @@ void multi_init_oo_and_ship_tracker()
 	Oo_info.rollback_collide_list.clear();
 	Oo_info.rollback_ships.clear();
 
+	Oo_info.sharing_packed_sections = false;
+	Oo_info.pack_frame = 0;
+	Oo_info.packed_objects.clear();
+	Oo_info.packed_objects.resize(MAX_OBJECTS);
+	Oo_info.packed_read_only = false;
+	Oo_info.snapshot_objects.clear();
+	Oo_info.player_packets.clear();
+	Oo_info.player_packets.resize(MAX_PLAYERS);
+
+	Oo_info.delta_history.clear();
+	for (auto& receipt : Oo_info.delta_frame_receipts) {
+		receipt = multi_frame_receipt();
+	}
+
 	for (int i = 0; i < MAX_FRAMES_RECORDED; i++) { // NOLINT
 		Oo_info.rollback_shots_to_be_fired[i].clear();
 		Oo_info.rollback_shots_to_be_fired[i].reserve(20);
@@ -2690,6 +3247,11 @@ void multi_init_oo_and_ship_tracker()
 	temp_sent_to_player.target_signature = 0;
 	temp_sent_to_player.perfect_shields_sent = false;
 
+	temp_sent_to_player.delta_send_count = 0;
+	temp_sent_to_player.baseline_frame = -1;
+	temp_sent_to_player.baseline_send_count = 0;
+	temp_sent_to_player.baseline = {};
+
 	// See if *any* of the subsystems changed, so we have to allow for a variable number of subsystems within a variable number of ships.
 	temp_sent_to_player.subsystem_health.reserve(MAX_MODEL_SUBSYSTEMS);
 	temp_sent_to_player.subsystem_health.push_back(0.0f);
@@ -2722,6 +3284,7 @@ void multi_init_oo_and_ship_tracker()
 	temp_sent_to_player.subsystem_z.push_back(0.0f);
 
 	temp_netplayer_records.last_sent.push_back(temp_sent_to_player);
+	temp_netplayer_records.delta_frames.resize(OO_DELTA_FRAMES);
 	Oo_info.frame_info.push_back(temp_position_records);
 	
 	for (int i = 0; i < MAX_PLAYERS; i++) {
@@ -2775,6 +3338,37 @@ void multi_close_oo_and_ship_tracker()
 	Oo_info.frame_info.shrink_to_fit();
 	Oo_info.player_frame_info.clear();
 	Oo_info.player_frame_info.shrink_to_fit();
+
+	Oo_info.sharing_packed_sections = false;
+	Oo_info.packed_objects.clear();
+	Oo_info.packed_objects.shrink_to_fit();
+	Oo_info.packed_read_only = false;
+	Oo_info.snapshot_objects.clear();
+	Oo_info.player_packets.clear();
+
+	Oo_info.delta_history.clear();
+}
+
+// notify of a player join, forgets the positions the player acknowledged so a new client in the same slot does not get
+// deltas against positions it never received. Resets all players if pl is NULL.
+void multi_oo_player_reset_all(net_player *pl)
+{
+	for (int i = 0; i < (int)Oo_info.player_frame_info.size(); i++) {
+		if ((pl != nullptr) && (i != pl->player_id)) {
+			continue;
+		}
+
+		auto& records = Oo_info.player_frame_info[i];
+
+		for (auto& sent : records.last_sent) {
+			sent.baseline_frame = -1;
+		}
+
+		for (auto& frame : records.delta_frames) {
+			frame.frame = -1;
+			frame.sent.clear();
+		}
+	}
 }
 
 
@@ -2803,11 +3397,19 @@ void multi_oo_send_control_info()
 
 	ADD_INT(time_out);
 
+	// and which of the server's update frames we got, so it can send us position deltas
+	int ack_frame;
+	uint ack_bits;
+	multi_frame_receipt_get_ack(Oo_info.delta_frame_receipts, &ack_frame, &ack_bits);
+
+	ADD_INT(ack_frame);
+	ADD_UINT(ack_bits);
+
 	// pos and orient always
 	oo_flags = OO_POS_AND_ORIENT_NEW;		
 
 	// pack the appropriate info into the data
-	add_size = multi_oo_pack_data(Net_player, Player_obj, oo_flags, data_add);
+	add_size = multi_oo_pack_data(Net_player, Player_obj, oo_flags, data_add, false);
 
 	// copy in any relevant data
 	if(add_size){
@@ -2866,11 +3468,15 @@ void multi_oo_send_changed_object(object *changedobj)
 
 	ADD_INT(time_out);
 
+	// this is not one of the regular updates the client acknowledges
+	ubyte frame_packet = OO_FRAME_PACKET_UNTRACKED;
+	ADD_DATA(frame_packet);
+
 	// pos and orient always
 	oo_flags = (OO_POS_AND_ORIENT_NEW);
 
 	// pack the appropriate info into the data
-	add_size = multi_oo_pack_data(&Net_players[idx], changedobj, oo_flags, data_add);
+	add_size = multi_oo_pack_data(&Net_players[idx], changedobj, oo_flags, data_add, false);
 
 	// copy in any relevant data
 	if(add_size){
@@ -2933,6 +3539,8 @@ DCF(oog, "Sets bandwidth granularity (Multiplayer)")
 	dc_printf("Ganularity set to %i", OO_gran);
 }
 
+DCF_BOOL(oo_delta, Oo_delta_enabled);
+
 // process datarate limiting stuff for the server
 void multi_oo_server_process();
 
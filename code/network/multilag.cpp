@@ -840,3 +840,120 @@ DCF(lag_good, "Lag system shortcut - Sets for 'good' lag simulation (Multiplayer
 	Multi_streak_stamp = -1;
 	Multi_current_streak = -1;
 }
+
+
+// ----------------------------------------------------------------------------------------------------
+// BANDWIDTH RECORDING
+//
+// Records how many bytes the server sends to each client every second, to compare the bandwidth of different builds
+// or settings (like oo_delta) over the same stretch of a mission. Can be combined with the lag/loss simulation above.
+//
+
+// when the current recording ends, -1 if there is none
+int Multi_bw_record_end = -1;
+
+// when the current second of the recording started
+int Multi_bw_second_start = -1;
+
+int Multi_bw_seconds = 0;
+int Multi_bw_second_bytes[MAX_PLAYERS];
+int Multi_bw_total_bytes[MAX_PLAYERS];
+int Multi_bw_peak_bytes[MAX_PLAYERS];
+
+void multi_lag_bandwidth_finish_second()
+{
+	SCP_string line = "BW: " + std::to_string(Multi_bw_seconds);
+
+	for (int idx = 0; idx < MAX_PLAYERS; idx++) {
+		line += " " + std::to_string(Multi_bw_second_bytes[idx]);
+
+		Multi_bw_total_bytes[idx] += Multi_bw_second_bytes[idx];
+		Multi_bw_peak_bytes[idx] = MAX(Multi_bw_peak_bytes[idx], Multi_bw_second_bytes[idx]);
+		Multi_bw_second_bytes[idx] = 0;
+	}
+
+	// one line per second so the log can be turned into a graph
+	mprintf(("%s\n", line.c_str()));
+
+	Multi_bw_seconds++;
+}
+
+void multi_lag_bandwidth_report()
+{
+	dc_printf("Bandwidth over %d seconds (bytes per second):\n", Multi_bw_seconds);
+	dc_printf("Player\t\tAverage\t\tPeak\n");
+
+	for (int idx = 0; idx < MAX_PLAYERS; idx++) {
+		if (Multi_bw_total_bytes[idx] == 0) {
+			continue;
+		}
+
+		int average = Multi_bw_seconds > 0 ? Multi_bw_total_bytes[idx] / Multi_bw_seconds : 0;
+		dc_printf("%d\t\t%d\t\t%d\n", idx, average, Multi_bw_peak_bytes[idx]);
+		mprintf(("BW: player %d average %d peak %d bytes per second\n", idx, average, Multi_bw_peak_bytes[idx]));
+	}
+}
+
+void multi_lag_bandwidth_add(int np_index, int bytes)
+{
+	if (Multi_bw_record_end < 0) {
+		return;
+	}
+
+	int now = timer_get_milliseconds();
+
+	// close all the seconds that passed since the last packet
+	while (now - Multi_bw_second_start >= 1000) {
+		multi_lag_bandwidth_finish_second();
+		Multi_bw_second_start += 1000;
+	}
+
+	if (now >= Multi_bw_record_end) {
+		Multi_bw_record_end = -1;
+		multi_lag_bandwidth_report();
+		return;
+	}
+
+	if ((np_index >= 0) && (np_index < MAX_PLAYERS)) {
+		Multi_bw_second_bytes[np_index] += bytes;
+	}
+}
+
+DCF(bw_record, "Records the bytes sent to each client per second (Multiplayer)")
+{
+	int seconds;
+
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: bw_record <seconds>\n");
+		dc_printf("Records how many bytes the server sends to each player every second. Each second is written to the log\n");
+		dc_printf("as a 'BW:' line and the average and peak per player are shown when the recording is done.\n");
+		return;
+	}
+
+	if (dc_optional_string_either("status", "--status") || dc_optional_string_either("?", "--?")) {
+		if (Multi_bw_record_end < 0) {
+			dc_printf("Not recording\n");
+		} else {
+			dc_printf("Recording, %d seconds done\n", Multi_bw_seconds);
+		}
+		return;
+	}
+
+	dc_stuff_int(&seconds);
+	if (seconds <= 0) {
+		dc_printf("Ignoring invalid value (must be positive)\n");
+		return;
+	}
+
+	for (int idx = 0; idx < MAX_PLAYERS; idx++) {
+		Multi_bw_second_bytes[idx] = 0;
+		Multi_bw_total_bytes[idx] = 0;
+		Multi_bw_peak_bytes[idx] = 0;
+	}
+
+	Multi_bw_seconds = 0;
+	Multi_bw_second_start = timer_get_milliseconds();
+	Multi_bw_record_end = Multi_bw_second_start + seconds * 1000;
+
+	dc_printf("Recording bandwidth for %d seconds\n", seconds);
+}
@@ -35,4 +35,7 @@ int multi_lag_select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *except
 // recvfrom for multilag
 int multi_lag_recvfrom(SOCKET s, char *buf, int len, int flags, SOCKADDR *from, int *fromlen);
 
+// count bytes sent to a player for the bandwidth recording (see the bw_record command), works in all builds
+void multi_lag_bandwidth_add(int np_index, int bytes);
+
 #endif
@@ -38,6 +38,7 @@
 #include "ship/shipfx.h"
 #include "popup/popup.h"
 #include "network/multi_ingame.h"
+#include "network/multilag.h"
 #include "network/multiteamselect.h"
 #include "ai/aigoals.h"
 #include "ai/ai.h"
@@ -464,6 +465,7 @@ void multi_io_send_force(net_player *pl)
 
 		// add the bytes sent to this player
 		pl->sv_bytes_sent += pl->s_info.unreliable_buffer_size;
+		multi_lag_bandwidth_add(NET_PLAYER_NUM(pl), pl->s_info.unreliable_buffer_size);
 	} else {
 		psnet_send(&Netgame.server_addr, pl->s_info.unreliable_buffer, pl->s_info.unreliable_buffer_size, NET_PLAYER_NUM(pl));		
 	}		
@@ -549,6 +551,7 @@ void multi_io_send_reliable_force(net_player *pl)
 	// send everything in 
 	if(MULTIPLAYER_MASTER) {
 		psnet_rel_send(pl->reliable_socket, pl->s_info.reliable_buffer, pl->s_info.reliable_buffer_size, NET_PLAYER_NUM(pl));
+		multi_lag_bandwidth_add(NET_PLAYER_NUM(pl), pl->s_info.reliable_buffer_size);
 	} else if(Net_player != NULL){
 		psnet_rel_send(Net_player->reliable_socket, pl->s_info.reliable_buffer, pl->s_info.reliable_buffer_size, NET_PLAYER_NUM(pl));
 	}		
@@ -565,6 +568,8 @@ void multi_io_send_buffered_packets()
 		return;
 	}
 
+	psnet_send_batch_begin();
+
 	// server
 	if(MULTIPLAYER_MASTER){
 		for(idx=0; idx<MAX_PLAYERS; idx++){
@@ -597,6 +602,8 @@ void multi_io_send_buffered_packets()
 			Net_player->s_info.reliable_buffer_size = 0;
 		}
 	}
+
+	psnet_send_batch_end();
 }
 
 //*********************************************************************************************************
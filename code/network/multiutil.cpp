@@ -3379,93 +3379,273 @@ int bitbuffer_get_signed( bitbuffer *bitbuf, int bit_count )
 	
 
 
+// the number of bits for each component of a quantized position and orientation
+static const int Multi_transform_bits[6] = { 27, 26, 27, 16, 16, 16 };
+
+// set up some constants to facilitate orientation compression 
+static const float Multi_orient_scale = 32768.0f / PI;
+
+static void multi_quantize_position(const vec3d *pos, int out[3])
+{
+	out[0] = (int)round(pos->xyz.x*512.0f);
+	out[1] = (int)round(pos->xyz.y*512.0f); 
+	out[2] = (int)round(pos->xyz.z*512.0f);
+	CAP(out[0], -67108864, 67108863);		
+	CAP(out[1], -33554432, 33554431);		
+	CAP(out[2], -67108864, 67108863);		
+}
+
+static void multi_quantize_orient(const angles *angs, int out[3])
+{
+	const int n_min_range = -32768;
+	const int n_max_range =  32767;
+
+	// Subtract PI/2 because the output of vm_extract_angles_matrix is from -PI/2 to 3PI/2
+	out[0] = fl2i(round((angs->b/* - PI/2*/) * Multi_orient_scale)); 
+	out[1] = fl2i(round((angs->h/* - PI/2*/) * Multi_orient_scale));
+	out[2] = fl2i(round((angs->p/* - PI/2*/) * Multi_orient_scale));
+
+	CAP(out[0], n_min_range, n_max_range);
+	CAP(out[1], n_min_range, n_max_range);
+	CAP(out[2], n_min_range, n_max_range);
+}
+
+void multi_quantize_transform(const vec3d *pos, const angles *orient, multi_quantized_transform *transform)
+{
+	multi_quantize_position(pos, transform->pos);
+	multi_quantize_orient(orient, transform->orient);
+}
+
+void multi_dequantize_transform(const multi_quantized_transform *transform, vec3d *pos, angles *orient)
+{
+	pos->xyz.x = i2fl(transform->pos[0])/512.0f;
+	pos->xyz.y = i2fl(transform->pos[1])/512.0f;
+	pos->xyz.z = i2fl(transform->pos[2])/512.0f;
+
+	orient->b =/* PI/2 +*/ (i2fl(transform->orient[0])/Multi_orient_scale);
+	orient->h =/* PI/2 +*/ (i2fl(transform->orient[1])/Multi_orient_scale);
+	orient->p =/* PI/2 +*/ (i2fl(transform->orient[2])/Multi_orient_scale);
+}
+
 // Packs/unpacks an object position.
 // Returns number of bytes read or written.
 // Cyborg17 This packer saves 2 bytes over sending the whole vector.  
 // It now has a maximum effective range of ~130k in the x and z and ~65K in the y
 int multi_pack_unpack_position( int write, ubyte *data, vec3d *pos)
+{
+	multi_quantized_transform transform;
+	angles unused = vmd_zero_angles;
+	int ret;
+
+	if ( write )	{
+		multi_quantize_transform(pos, &unused, &transform);
+		ret = multi_pack_unpack_transform(1, data, &transform, false);
+	} else {
+		ret = multi_pack_unpack_transform(0, data, &transform, false);
+		multi_dequantize_transform(&transform, pos, &unused);
+	}
+
+	return ret;
+}
+
+// Packs/unpacks an orientation matrix.
+// Returns number of bytes read or written.
+// Cyborg17 - Because of testing and a bugfix from Wookiejedi, this is now used in tandem with
+// vm_extract_angles_matrix() to save bandwidth. We return the raw angles by reference
+// because they are also useful in rotational interpolation.
+int multi_pack_unpack_orient( int write, ubyte *data, angles *angles)
 {
 	bitbuffer buf;
 
-	bitbuffer_init(&buf,data);
+	bitbuffer_init(&buf, data);
 
-	int a, b, c;
+	int quantized[3];
 
-	if ( write )	{
+	if ( write )	{			
+		multi_quantize_orient(angles, quantized);
+					
+		bitbuffer_put( &buf, (uint)quantized[0], 16 );
+		bitbuffer_put( &buf, (uint)quantized[1], 16 );
+		bitbuffer_put( &buf, (uint)quantized[2], 16 );
 
-		// Output pos
-		a = (int)round(pos->xyz.x*512.0f);
-		b = (int)round(pos->xyz.y*512.0f); 
-		c = (int)round(pos->xyz.z*512.0f);
-		CAP(a, -67108864, 67108863);		
-		CAP(b, -33554432, 33554431);		
-		CAP(c, -67108864, 67108863);		
+		return bitbuffer_write_flush(&buf);
+	} else {
+
+		quantized[0] = bitbuffer_get_signed(&buf,16);
+		quantized[1] = bitbuffer_get_signed(&buf,16);
+		quantized[2] = bitbuffer_get_signed(&buf,16);
+
+		angles->b =/* PI/2 +*/ (i2fl(quantized[0])/Multi_orient_scale);
+		angles->h =/* PI/2 +*/ (i2fl(quantized[1])/Multi_orient_scale);
+		angles->p =/* PI/2 +*/ (i2fl(quantized[2])/Multi_orient_scale);
 		
-		bitbuffer_put( &buf, (uint)a, 27 );
-		bitbuffer_put( &buf, (uint)b, 26 ); // Cyborg17 this is set to 26 bits on purpose.			
-		bitbuffer_put( &buf, (uint)c, 27 );
+		return bitbuffer_read_flush(&buf);
+	}
+}
 
-		return bitbuffer_write_flush(&buf);
+// Packs/unpacks a quantized position, and the orientation if requested, in the format of multi_pack_unpack_position()
+// and multi_pack_unpack_orient().
+// Returns number of bytes read or written.
+int multi_pack_unpack_transform(int write, ubyte *data, multi_quantized_transform *transform, bool with_orient)
+{
+	bitbuffer buf;
+	int ret;
+
+	bitbuffer_init(&buf, data);
 
+	if (write) {
+		for (int i = 0; i < 3; i++) {
+			bitbuffer_put(&buf, (uint)transform->pos[i], Multi_transform_bits[i]);
+		}
+		ret = bitbuffer_write_flush(&buf);
 	} else {
+		for (int i = 0; i < 3; i++) {
+			transform->pos[i] = bitbuffer_get_signed(&buf, Multi_transform_bits[i]);
+		}
+		ret = bitbuffer_read_flush(&buf);
+	}
 
-		// unpack pos
-		a = bitbuffer_get_signed(&buf,27);
-		b = bitbuffer_get_signed(&buf,26); // Cyborg17 this is set to 26 bits on purpose.
-		c = bitbuffer_get_signed(&buf,27);
+	if (!with_orient) {
+		return ret;
+	}
 
-		pos->xyz.x = i2fl(a)/512.0f;
-		pos->xyz.y = i2fl(b)/512.0f;
-		pos->xyz.z = i2fl(c)/512.0f;
+	// the orientation starts at the next full byte
+	bitbuffer_init(&buf, data + ret);
 
-		return bitbuffer_read_flush(&buf);
+	if (write) {
+		for (int i = 0; i < 3; i++) {
+			bitbuffer_put(&buf, (uint)transform->orient[i], Multi_transform_bits[i + 3]);
+		}
+		return ret + bitbuffer_write_flush(&buf);
+	} else {
+		for (int i = 0; i < 3; i++) {
+			transform->orient[i] = bitbuffer_get_signed(&buf, Multi_transform_bits[i + 3]);
+		}
+		return ret + bitbuffer_read_flush(&buf);
 	}
 }
 
-// Packs/unpacks an orientation matrix.
+// sign extend the lowest bit_count bits of value
+static int multi_sign_extend(int value, int bit_count)
+{
+	auto shifted = (uint)value << (32 - bit_count);
+	return ((int)shifted) >> (32 - bit_count);
+}
+
+// Packs/unpacks a quantized position and orientation as the difference to a baseline that both sides have.
+// Each component is a 2 bit size class followed by nothing (unchanged), 8, 16 or all of its bits. The differences wrap
+// around within the bits of the component so that an orientation going from PI to -PI is still a small change.
 // Returns number of bytes read or written.
-// Cyborg17 - Because of testing and a bugfix from Wookiejedi, this is now used in tandem with
-// vm_extract_angles_matrix() to save bandwidth. We return the raw angles by reference
-// because they are also useful in rotational interpolation.
-int multi_pack_unpack_orient( int write, ubyte *data, angles *angles)
+int multi_pack_unpack_transform_delta(int write, ubyte *data, const multi_quantized_transform *baseline, multi_quantized_transform *transform)
 {
 	bitbuffer buf;
 
 	bitbuffer_init(&buf, data);
 
-	int a, b, c;
+	for (int i = 0; i < 6; i++) {
+		const int bits = Multi_transform_bits[i];
+		int base = (i < 3) ? baseline->pos[i] : baseline->orient[i - 3];
+		int& value = (i < 3) ? transform->pos[i] : transform->orient[i - 3];
+
+		if (write) {
+			int delta = multi_sign_extend(value - base, bits);
+
+			if (delta == 0) {
+				bitbuffer_put(&buf, 0, 2);
+			} else if (delta >= -128 && delta <= 127) {
+				bitbuffer_put(&buf, 1, 2);
+				bitbuffer_put(&buf, (uint)delta, 8);
+			} else if (bits > 16 && delta >= -32768 && delta <= 32767) {
+				bitbuffer_put(&buf, 2, 2);
+				bitbuffer_put(&buf, (uint)delta, 16);
+			} else {
+				bitbuffer_put(&buf, 3, 2);
+				bitbuffer_put(&buf, (uint)delta, bits);
+			}
+		} else {
+			int delta;
 
-	// set up some constants to facilitate compression 
-	const float n_scale = 32768.0f/ PI;
-	const int n_min_range = -32768;
-	const int n_max_range =  32767;
+			switch (bitbuffer_get_unsigned(&buf, 2)) {
+			case 0:
+				delta = 0;
+				break;
+			case 1:
+				delta = bitbuffer_get_signed(&buf, 8);
+				break;
+			case 2:
+				delta = bitbuffer_get_signed(&buf, 16);
+				break;
+			default:
+				delta = bitbuffer_get_signed(&buf, bits);
+				break;
+			}
 
-	if ( write )	{			
-		// Subtract PI/2 because the output of vm_extract_angles_matrix is from -PI/2 to 3PI/2
-		a = fl2i(round((angles->b/* - PI/2*/) * n_scale)); 
-		b = fl2i(round((angles->h/* - PI/2*/) * n_scale));
-		c = fl2i(round((angles->p/* - PI/2*/) * n_scale));
-
-		CAP(a, n_min_range, n_max_range);
-		CAP(b, n_min_range, n_max_range);
-		CAP(c, n_min_range, n_max_range);
-					
-		bitbuffer_put( &buf, (uint)a, 16 );
-		bitbuffer_put( &buf, (uint)b, 16 );
-		bitbuffer_put( &buf, (uint)c, 16 );
+			value = multi_sign_extend(base + delta, bits);
+		}
+	}
 
+	if (write) {
 		return bitbuffer_write_flush(&buf);
 	} else {
+		return bitbuffer_read_flush(&buf);
+	}
+}
 
-		a = bitbuffer_get_signed(&buf,16);
-		b = bitbuffer_get_signed(&buf,16);
-		c = bitbuffer_get_signed(&buf,16);
+void multi_frame_receipt_add(multi_frame_receipt *receipts, int frame, int index, bool last, bool stored)
+{
+	if ((frame < 0) || (index < 0) || (index >= 32)) {
+		return;
+	}
 
-		angles->b =/* PI/2 +*/ (i2fl(a)/n_scale);
-		angles->h =/* PI/2 +*/ (i2fl(b)/n_scale);
-		angles->p =/* PI/2 +*/ (i2fl(c)/n_scale);
-		
-		return bitbuffer_read_flush(&buf);
+	auto& receipt = receipts[frame % MULTI_FRAME_RECEIPT_FRAMES];
+	if (receipt.frame != frame) {
+		receipt = multi_frame_receipt();
+		receipt.frame = frame;
+	}
+
+	receipt.received |= (1u << index);
+	if (last) {
+		receipt.last_index = index;
+	}
+	if (!stored) {
+		receipt.dropped = true;
+	}
+}
+
+static bool multi_frame_receipt_complete(const multi_frame_receipt *receipts, int frame)
+{
+	if (frame < 0) {
+		return false;
+	}
+
+	const auto& receipt = receipts[frame % MULTI_FRAME_RECEIPT_FRAMES];
+	if ((receipt.frame != frame) || (receipt.last_index < 0) || receipt.dropped) {
+		return false;
+	}
+
+	auto all_packets = (receipt.last_index == 31) ? ~0u : ((1u << (receipt.last_index + 1)) - 1);
+	return receipt.received == all_packets;
+}
+
+void multi_frame_receipt_get_ack(const multi_frame_receipt *receipts, int *ack_frame, uint *ack_bits)
+{
+	*ack_frame = -1;
+	*ack_bits = 0;
+
+	for (int i = 0; i < MULTI_FRAME_RECEIPT_FRAMES; i++) {
+		if ((receipts[i].frame > *ack_frame) && multi_frame_receipt_complete(receipts, receipts[i].frame)) {
+			*ack_frame = receipts[i].frame;
+		}
+	}
+
+	if (*ack_frame < 0) {
+		return;
+	}
+
+	for (int i = 1; i <= MULTI_FRAME_ACK_BITS; i++) {
+		if (multi_frame_receipt_complete(receipts, *ack_frame - i)) {
+			*ack_bits |= (1u << (i - 1));
+		}
 	}
 }
 
@@ -184,10 +184,52 @@ void multi_display_chat_msg(const char *msg, int player_index, int add_id);
 // fill in Current_file_checksum and Current_file_length
 void multi_get_mission_checksum(const char *filename);
 
+// A position and orientation at the precision of multi_pack_unpack_position() and multi_pack_unpack_orient()
+struct multi_quantized_transform {
+	int pos[3];
+	int orient[3];
+};
+
+// Quantizes a position and orientation the same way the object update packers do.
+void multi_quantize_transform(const vec3d *pos, const angles *orient, multi_quantized_transform *transform);
+
+// Converts a quantized position and orientation back.
+void multi_dequantize_transform(const multi_quantized_transform *transform, vec3d *pos, angles *orient);
+
 // Packs/unpacks an object position.
 // Returns number of bytes read or written.
 int multi_pack_unpack_position(int write, ubyte *data, vec3d *pos);
 
+// Packs/unpacks a quantized position, and the orientation if requested, with the same bytes as
+// multi_pack_unpack_position() and multi_pack_unpack_orient().
+// Returns number of bytes read or written.
+int multi_pack_unpack_transform(int write, ubyte *data, multi_quantized_transform *transform, bool with_orient);
+
+// Packs/unpacks a quantized position and orientation as the difference to a baseline that both sides have.
+// Returns number of bytes read or written.
+int multi_pack_unpack_transform_delta(int write, ubyte *data, const multi_quantized_transform *baseline, multi_quantized_transform *transform);
+
+// how many server frames a client keeps the receipts of, and how many frames before the newest complete one each
+// acknowledgement covers
+constexpr int MULTI_FRAME_RECEIPT_FRAMES = 64;
+constexpr int MULTI_FRAME_ACK_BITS = 32;
+
+// Which object update packets of a server frame a client received, and whether it stored every position in them
+struct multi_frame_receipt {
+	int frame = -1;
+	uint received = 0;		// bit mask of the packet indices
+	int last_index = -1;	// the index of the last packet of the frame, -1 until that one arrived
+	bool dropped = false;	// a position of the frame was not stored, so later deltas against it could not be decoded
+};
+
+// Notes that a packet of a frame arrived, stored is false if a position in it could not be stored.
+// receipts holds MULTI_FRAME_RECEIPT_FRAMES entries and uses frame % MULTI_FRAME_RECEIPT_FRAMES as the index.
+void multi_frame_receipt_add(multi_frame_receipt *receipts, int frame, int index, bool last, bool stored);
+
+// Finds the newest frame whose packets all arrived with every position stored, and sets a bit for each of the
+// MULTI_FRAME_ACK_BITS frames before it which did as well. ack_frame is -1 if there is none.
+void multi_frame_receipt_get_ack(const multi_frame_receipt *receipts, int *ack_frame, uint *ack_bits);
+
 // Packs/unpacks an orientation matrix.
 // Returns number of bytes read or written.
 int multi_pack_unpack_orient(int write, ubyte *data, angles *angles_out);
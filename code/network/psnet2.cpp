@@ -38,6 +38,12 @@
 #include "network/multi_log.h"
 #include "network/multi_rate.h"
 #include "cmdline/cmdline.h"
+#include "tracing/Monitor.h"
+
+// Linux can read and write a whole batch of datagrams with a single call
+#ifdef __linux__
+#define PSNET_BATCHED_IO
+#endif
 
 // -------------------------------------------------------------------------------------------------------
 // PSNET 2 DEFINES/VARS
@@ -70,30 +76,39 @@ uint16_t Psnet_default_port;
 // use the pack pragma to pack these structures to 2 byte aligment.  Really only needed for
 // the naked packet.
 #define MAX_PACKET_BUFFERS		75
+#define PSNET_IO_BATCH			32			// how many datagrams are read or written with one call
 
 #pragma pack(push, 2)
 
 /**
- * Structure definition for our packet buffers
+ * Structure definition for our packet buffers, these live in the packet arena
  */
 typedef struct network_packet_buffer
 {
-	int		sequence_number;
-	SSIZE_T		len;
+	SSIZE_T		len;								// including the type byte
 	SOCKADDR_IN6	from_addr;
-	ubyte		data[MAX_TOP_LAYER_PACKET_SIZE];
+	ubyte		data[MAX_TOP_LAYER_PACKET_SIZE];	// the type byte followed by the packet, just like it was read off the socket
 } network_packet_buffer;
 
 /**
- * Structure for a bunch of network packet buffers
+ * Structure for the packets of one type waiting to be read, in the order they arrived
  */
 typedef struct network_packet_buffer_list {
-	network_packet_buffer psnet_buffers[MAX_PACKET_BUFFERS];
-	int psnet_seq_number;
-	int psnet_lowest_id;
-	int psnet_highest_id;
+	int psnet_buffers[MAX_PACKET_BUFFERS];		// indices into the packet arena, used as a ring
+	int psnet_first;							// where the oldest packet is in psnet_buffers
+	int psnet_count;							// how many packets are waiting
 } network_packet_buffer_list;
 
+/**
+ * An outgoing datagram waiting to be written by psnet_send_flush()
+ */
+typedef struct network_send_buffer
+{
+	SOCKADDR_IN6	to_addr;
+	int		len;								// including the type byte
+	ubyte		data[MAX_TOP_LAYER_PACKET_SIZE];
+} network_send_buffer;
+
 #pragma pack(pop)
 
 
@@ -193,6 +208,24 @@ static time_t Psnet_bad_packet_time = 0;
 // top layer buffers
 static network_packet_buffer_list Psnet_top_buffers[PSNET_NUM_TYPES];
 
+// Every received packet is read straight into the arena and stays there until it is handed out. It has room for
+// full buffers of every type plus one batch that is being read.
+#define PSNET_PACKET_ARENA_SIZE		(PSNET_NUM_TYPES * MAX_PACKET_BUFFERS + PSNET_IO_BATCH)
+
+static network_packet_buffer Psnet_packet_arena[PSNET_PACKET_ARENA_SIZE];
+static int Psnet_free_packets[PSNET_PACKET_ARENA_SIZE];
+static int Psnet_num_free_packets = 0;
+
+// unreliable packets sent between psnet_send_batch_begin() and psnet_send_batch_end() are written together
+static network_send_buffer Psnet_send_queue[PSNET_IO_BATCH];
+static int Psnet_send_queue_count = 0;
+static int Psnet_send_batch_depth = 0;
+
+// socket statistics
+MONITOR(PsnetPacketsDropped)
+static tracing::Monitor<float> Psnet_packets_per_recv("PsnetPacketsPerRecv", 0.0f);
+static tracing::Monitor<float> Psnet_packets_per_send("PsnetPacketsPerSend", 0.0f);
+
 // -------------------------------------------------------------------------------------------------------
 // PSNET 2 FORWARD DECLARATIONS
 //
@@ -218,8 +251,23 @@ void psnet_rel_close();
 // initialize the buffering system
 void psnet_buffer_init(network_packet_buffer_list *l);
 
+// mark every packet in the arena as free
+static void psnet_arena_init();
+
+// get a free packet from the arena
+static int psnet_arena_alloc();
+
+// give a packet back to the arena
+static void psnet_arena_free(int packet);
+
+// sort a packet read into the arena into the buffer for its type
+static void psnet_store_packet(int packet);
+
 // buffer a packet (maintain order!)
-static void psnet_buffer_packet(network_packet_buffer_list *l, const ubyte *data, const SSIZE_T length, const SOCKADDR_IN6 *from);
+static void psnet_buffer_packet(network_packet_buffer_list *l, int packet);
+
+// write all queued unreliable packets
+static void psnet_send_flush();
 
 // get the index of the next packet in order!
 int psnet_buffer_get_next(network_packet_buffer_list *l, ubyte *data, SSIZE_T *length, SOCKADDR_IN6 *from);
@@ -302,7 +350,7 @@ int SELECT(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds, struc
 	l = &Psnet_top_buffers[psnet_type];
 
 	// do we have any buffers in here?
-	if ( (l->psnet_lowest_id == -1) || (l->psnet_lowest_id > l->psnet_highest_id) ) {
+	if (l->psnet_count == 0) {
 		if (readfds) {
 			FD_ZERO(readfds);
 		}
@@ -346,20 +394,66 @@ int SENDTO(SOCKET s, char * buf, int len, int flags, SOCKADDR *to, int tolen, in
  */
 void PSNET_TOP_LAYER_PROCESS()
 {
-	// read socket stuff
-	fd_set rfds;
-	timeval timeout;
-	SSIZE_T read_len;
-	socklen_t from_len;
-	SOCKADDR_IN6 from_addr;
-	uint8_t packet_data[MAX_TOP_LAYER_PACKET_SIZE];
+	int num_calls = 0;
+	int num_packets = 0;
 
 	if ( !Psnet_active ) {
 		return;
 	}
 
-	// clear the addresses to remove compiler warnings
-	memset(&from_addr, 0, sizeof(from_addr));
+#ifdef PSNET_BATCHED_IO
+	mmsghdr msgs[PSNET_IO_BATCH];
+	iovec iovs[PSNET_IO_BATCH];
+	int packets[PSNET_IO_BATCH];
+
+	while (true) {
+		// let the kernel write straight into free packets of the arena
+		for (int i = 0; i < PSNET_IO_BATCH; i++) {
+			packets[i] = psnet_arena_alloc();
+			auto buffer = &Psnet_packet_arena[packets[i]];
+
+			iovs[i].iov_base = buffer->data;
+			iovs[i].iov_len = sizeof(buffer->data);
+
+			memset(&msgs[i], 0, sizeof(msgs[i]));
+			msgs[i].msg_hdr.msg_name = &buffer->from_addr;
+			msgs[i].msg_hdr.msg_namelen = sizeof(buffer->from_addr);
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		int count = recvmmsg(Psnet_socket, msgs, PSNET_IO_BATCH, MSG_DONTWAIT, nullptr);
+		++num_calls;
+
+		if (count < 0) {
+			if ( (errno != EAGAIN) && (errno != EWOULDBLOCK) ) {
+				ml_string("Socket error on socket_get_data()");
+			}
+
+			count = 0;
+		}
+
+		for (int i = 0; i < count; i++) {
+			Psnet_packet_arena[packets[i]].len = static_cast<SSIZE_T>(msgs[i].msg_len);
+			psnet_store_packet(packets[i]);
+		}
+
+		for (int i = count; i < PSNET_IO_BATCH; i++) {
+			psnet_arena_free(packets[i]);
+		}
+
+		num_packets += count;
+
+		// a partial batch means the socket is empty
+		if (count < PSNET_IO_BATCH) {
+			break;
+		}
+	}
+#else
+	// read socket stuff
+	fd_set rfds;
+	timeval timeout;
+	socklen_t from_len;
 
 	while (true) {
 		// check if there is any data on the socket to be read.  The amount of data that can be 
@@ -377,32 +471,35 @@ void PSNET_TOP_LAYER_PROCESS()
 
 		// if the read file descriptor is not set, then bail!
 		if ( !FD_ISSET(Psnet_socket, &rfds) ) {
-			return;
+			break;
 		}
 
-		// get data off the socket and process
-		from_len = sizeof(from_addr);
-		read_len = recvfrom(Psnet_socket, reinterpret_cast<char *>(packet_data), sizeof(packet_data),
-							0, reinterpret_cast<LPSOCKADDR>(&from_addr), &from_len);
+		// get data off the socket and process, straight into the arena
+		int packet = psnet_arena_alloc();
+		auto buffer = &Psnet_packet_arena[packet];
+
+		memset(&buffer->from_addr, 0, sizeof(buffer->from_addr));
+		from_len = sizeof(buffer->from_addr);
+		buffer->len = recvfrom(Psnet_socket, reinterpret_cast<char *>(buffer->data), sizeof(buffer->data),
+							0, reinterpret_cast<LPSOCKADDR>(&buffer->from_addr), &from_len);
+		++num_calls;
 
-		if (read_len <= 0) {
-			if (read_len == -1) {
+		if (buffer->len <= 0) {
+			if (buffer->len == -1) {
 				ml_string("Socket error on socket_get_data()");
 			}
 
+			psnet_arena_free(packet);
 			break;
 		}
 
-		// determine the packet type
-		int packet_type = packet_data[0];
+		psnet_store_packet(packet);
+		++num_packets;
+	}
+#endif
 
-		if ( (packet_type >= 0) && (packet_type < PSNET_NUM_TYPES) ) {
-			// buffer the packet
-			psnet_buffer_packet(&Psnet_top_buffers[packet_type], packet_data + 1, read_len - 1, &from_addr);
-		} else {
-			// got something that's definitely not from a psnet client, so dump it
-			psnet_debug_bad_packet(packet_type, packet_data, from_len, &from_addr);
-		}
+	if (num_calls > 0) {
+		Psnet_packets_per_recv = static_cast<float>(num_packets) / static_cast<float>(num_calls);
 	}
 }
 
@@ -443,6 +540,8 @@ void psnet_init(uint16_t port_num)
 	}
 
 	// initialize all packet type buffers
+	psnet_arena_init();
+
 	for (idx = 0; idx < PSNET_NUM_TYPES; idx++) {
 		psnet_buffer_init(&Psnet_top_buffers[idx]);
 	}
@@ -809,6 +908,27 @@ int psnet_send(net_addr *who_to_addr, void *data, int len, int np_index)	// NOLI
 		return 0;
 	}
 
+	// queue it up to be written with the rest of the batch
+	if (Psnet_send_batch_depth > 0) {
+		Assert(len < MAX_TOP_LAYER_PACKET_SIZE);
+
+		multi_rate_add(np_index, "udp(h)", len + UDP_HEADER_SIZE);
+		multi_rate_add(np_index, "udp", len);
+
+		auto buffer = &Psnet_send_queue[Psnet_send_queue_count++];
+
+		buffer->to_addr = who_to;
+		buffer->data[0] = PSNET_TYPE_UNRELIABLE;
+		memcpy(&buffer->data[1], data, static_cast<size_t>(len));
+		buffer->len = len + 1;
+
+		if (Psnet_send_queue_count == PSNET_IO_BATCH) {
+			psnet_send_flush();
+		}
+
+		return 1;
+	}
+
 	FD_ZERO(&wfds);
 	FD_SET(Psnet_socket, &wfds);
 
@@ -839,6 +959,98 @@ int psnet_send(net_addr *who_to_addr, void *data, int len, int np_index)	// NOLI
 	return 0;
 }
 
+/**
+ * Start collecting unreliable packets to write them together
+ */
+void psnet_send_batch_begin()
+{
+	++Psnet_send_batch_depth;
+}
+
+/**
+ * Write the packets collected since the matching psnet_send_batch_begin()
+ */
+void psnet_send_batch_end()
+{
+	Assertion(Psnet_send_batch_depth > 0, "psnet_send_batch_end() called without psnet_send_batch_begin()!");
+
+	if (--Psnet_send_batch_depth == 0) {
+		psnet_send_flush();
+	}
+}
+
+/**
+ * Write all queued unreliable packets
+ */
+static void psnet_send_flush()
+{
+	int num_sent = 0;
+	int num_calls = 0;
+
+	if (Psnet_send_queue_count == 0) {
+		return;
+	}
+
+	if ( !Psnet_active ) {
+		Psnet_send_queue_count = 0;
+		return;
+	}
+
+#ifdef PSNET_BATCHED_IO
+	mmsghdr msgs[PSNET_IO_BATCH];
+	iovec iovs[PSNET_IO_BATCH];
+
+	for (int i = 0; i < Psnet_send_queue_count; i++) {
+		auto buffer = &Psnet_send_queue[i];
+
+		iovs[i].iov_base = buffer->data;
+		iovs[i].iov_len = static_cast<size_t>(buffer->len);
+
+		memset(&msgs[i], 0, sizeof(msgs[i]));
+		msgs[i].msg_hdr.msg_name = &buffer->to_addr;
+		msgs[i].msg_hdr.msg_namelen = sizeof(buffer->to_addr);
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	while (num_sent < Psnet_send_queue_count) {
+		int ret = sendmmsg(Psnet_socket, msgs + num_sent, static_cast<unsigned int>(Psnet_send_queue_count - num_sent), MSG_DONTWAIT);
+		++num_calls;
+
+		// the socket is full or broken, the rest is dropped just like psnet_send() does when the socket isn't writable
+		if (ret <= 0) {
+			if ( (ret < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK) ) {
+				ml_printf("Error %d on batched socket send", errno);
+			}
+
+			break;
+		}
+
+		num_sent += ret;
+	}
+#else
+	for (int i = 0; i < Psnet_send_queue_count; i++) {
+		auto buffer = &Psnet_send_queue[i];
+
+		auto ret = sendto(Psnet_socket, reinterpret_cast<char *>(buffer->data), buffer->len, 0,
+						  reinterpret_cast<LPSOCKADDR>(&buffer->to_addr), sizeof(buffer->to_addr));
+		++num_calls;
+
+		if (ret != SOCKET_ERROR) {
+			++num_sent;
+		}
+	}
+#endif
+
+	if (num_sent < Psnet_send_queue_count) {
+		MONITOR_INC(PsnetPacketsDropped, Psnet_send_queue_count - num_sent);
+	}
+
+	Psnet_packets_per_send = static_cast<float>(num_sent) / static_cast<float>(num_calls);
+
+	Psnet_send_queue_count = 0;
+}
+
 /**
  * Get data from the unreliable socket
  */
@@ -2176,58 +2388,86 @@ void psnet_rel_close()
  */
 void psnet_buffer_init(network_packet_buffer_list *l)
 {
-	int idx;
-
-	// blast the buffer clean
-	memset(l->psnet_buffers, 0, sizeof(network_packet_buffer) * MAX_PACKET_BUFFERS);
+	// the packets themselves belong to the arena, see psnet_arena_init()
+	l->psnet_first = 0;
+	l->psnet_count = 0;
+}
 
-	// set all buffer sequence #'s to -1
-	for (idx = 0;idx < MAX_PACKET_BUFFERS; idx++) {
-		l->psnet_buffers[idx].sequence_number = -1;
+/**
+ * Mark every packet in the arena as free
+ */
+static void psnet_arena_init()
+{
+	for (int idx = 0; idx < PSNET_PACKET_ARENA_SIZE; idx++) {
+		Psnet_free_packets[idx] = idx;
 	}
 
-	// initialize the sequence #
-	l->psnet_seq_number = 0;
-	l->psnet_lowest_id = -1;
-	l->psnet_highest_id = -1;
+	Psnet_num_free_packets = PSNET_PACKET_ARENA_SIZE;
 }
 
 /**
- * Buffer a packet (maintain order!)
+ * Get a free packet from the arena
  */
-static void psnet_buffer_packet(network_packet_buffer_list *l, const ubyte *data, const SSIZE_T length, const SOCKADDR_IN6 *from)
+static int psnet_arena_alloc()
 {
-	int idx;
-	bool found_buf = false;
+	// the type buffers can't hold more than MAX_PACKET_BUFFERS each, so there is always a full batch left
+	Assertion(Psnet_num_free_packets > 0, "Ran out of packets in the psnet packet arena!");
 
-	Assert(length > 0);
+	return Psnet_free_packets[--Psnet_num_free_packets];
+}
 
-	// find the first empty packet
-	for (idx = 0; idx < MAX_PACKET_BUFFERS; idx++) {
-		if (l->psnet_buffers[idx].sequence_number == -1) {
-			found_buf = true;
-			break;
-		}
+/**
+ * Give a packet back to the arena
+ */
+static void psnet_arena_free(int packet)
+{
+	Assert(Psnet_num_free_packets < PSNET_PACKET_ARENA_SIZE);
+
+	Psnet_free_packets[Psnet_num_free_packets++] = packet;
+}
+
+/**
+ * Sort a packet read into the arena into the buffer for its type
+ */
+static void psnet_store_packet(int packet)
+{
+	auto buffer = &Psnet_packet_arena[packet];
+
+	// nothing but the type byte
+	if (buffer->len <= 1) {
+		psnet_arena_free(packet);
+		return;
 	}
 
-	// if we didn't find the buffer, report an overrun
-	if ( !found_buf ) {
-		ml_string("WARNING - Buffer overrun in psnet");
+	// determine the packet type
+	int packet_type = buffer->data[0];
+
+	if ( (packet_type >= 0) && (packet_type < PSNET_NUM_TYPES) ) {
+		// buffer the packet
+		psnet_buffer_packet(&Psnet_top_buffers[packet_type], packet);
 	} else {
-		// copy in the data
-		memcpy(l->psnet_buffers[idx].data, data, static_cast<size_t>(length));
-		l->psnet_buffers[idx].len = length;
-		l->psnet_buffers[idx].sequence_number = l->psnet_seq_number;
-		memcpy(&l->psnet_buffers[idx].from_addr, from, sizeof(l->psnet_buffers[idx].from_addr));
+		// got something that's definitely not from a psnet client, so dump it
+		psnet_debug_bad_packet(packet_type, buffer->data, buffer->len, &buffer->from_addr);
+		psnet_arena_free(packet);
+	}
+}
 
-		// keep track of the highest id#
-		l->psnet_highest_id = l->psnet_seq_number++;
+/**
+ * Buffer a packet (maintain order!)
+ */
+static void psnet_buffer_packet(network_packet_buffer_list *l, int packet)
+{
+	// if we don't have room for it, report an overrun
+	if (l->psnet_count >= MAX_PACKET_BUFFERS) {
+		ml_string("WARNING - Buffer overrun in psnet");
+		MONITOR_INC(PsnetPacketsDropped, 1);
 
-		// set the lowest id# for the first time
-		if (l->psnet_lowest_id == -1) {
-			l->psnet_lowest_id = l->psnet_highest_id;
-		}
+		psnet_arena_free(packet);
+		return;
 	}
+
+	l->psnet_buffers[(l->psnet_first + l->psnet_count) % MAX_PACKET_BUFFERS] = packet;
+	l->psnet_count++;
 }
 
 /**
@@ -2235,38 +2475,26 @@ static void psnet_buffer_packet(network_packet_buffer_list *l, const ubyte *data
  */
 int psnet_buffer_get_next(network_packet_buffer_list *l, ubyte *data, SSIZE_T *length, SOCKADDR_IN6 *from)
 {	
-	int idx;
-	int found_buf = 0;
-
 	// if there are no buffers, do nothing
-	if ( (l->psnet_lowest_id == -1) || (l->psnet_lowest_id > l->psnet_highest_id) ) {
+	if (l->psnet_count == 0) {
 		return 0;
 	}
 
-	// search until we find the lowest packet index id#
-	for (idx = 0; idx < MAX_PACKET_BUFFERS; idx++) {
-		// if we found the buffer
-		if (l->psnet_buffers[idx].sequence_number == l->psnet_lowest_id) {
-			found_buf = 1;
-			break;
-		}
-	}
-
-	// at this point, we should _always_ have found the buffer
-	Assert(found_buf);
+	int packet = l->psnet_buffers[l->psnet_first];
+	auto buffer = &Psnet_packet_arena[packet];
 
-	Assert(l->psnet_buffers[idx].len > 0);
+	Assert(buffer->len > 1);
 
-	// copy out the buffer data
-	memcpy(data, l->psnet_buffers[idx].data, static_cast<size_t>(l->psnet_buffers[idx].len));
-	*length = l->psnet_buffers[idx].len;
-	memcpy(from, &l->psnet_buffers[idx].from_addr, sizeof(*from));
+	// copy out the buffer data, without the type byte
+	memcpy(data, buffer->data + 1, static_cast<size_t>(buffer->len - 1));
+	*length = buffer->len - 1;
+	memcpy(from, &buffer->from_addr, sizeof(*from));
 
 	// now we need to cleanup the packet list
+	l->psnet_first = (l->psnet_first + 1) % MAX_PACKET_BUFFERS;
+	l->psnet_count--;
 
-	// mark the buffer as free
-	l->psnet_buffers[idx].sequence_number = -1;
-	l->psnet_lowest_id++;
+	psnet_arena_free(packet);
 
 	return 1;
 }
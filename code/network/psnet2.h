@@ -157,6 +157,10 @@ bool psnet_is_local_addr(const net_addr *addr);
 // send data unreliably
 int psnet_send(net_addr *who_to, void *data, int len, int np_index = -1);
 
+// collect the unreliable packets sent until psnet_send_batch_end() and write them with as few calls as possible, can be nested
+void psnet_send_batch_begin();
+void psnet_send_batch_end();
+
 // get data from the unreliable socket
 int psnet_get(void *data, net_addr *from_addr);
 
@@ -33,6 +33,7 @@
 #include "ship/ship.h"
 #include "ship/shipfx.h"
 #include "ship/shiphit.h"
+#include "weapon/weapon.h"
 
 
 #define COLLIDE_DEBUG
@@ -843,6 +844,10 @@ void calculate_ship_ship_collision_physics(collision_info_struct *ship_ship_hit_
 		vm_vec_scale_add2(&lighter->pos, &ship_ship_hit_info->collision_normal,  0.1f * heavy_light_mass_ratio);
 	}
 
+	// weapons hitting something during collision detection may already have looked up objects by position
+	weapon_area_object_moved(heavy);
+	weapon_area_object_moved(lighter);
+
 	// restore mass in case of special cruiser / asteroid collision
 	if (special_cruiser_asteroid_collision) {
 		if (cruiser_light) {
@@ -33,6 +33,7 @@
 #include "object/object.h"
 #include "object/objectdock.h"
 #include "object/objectshield.h"
+#include "object/objectsnapshot.h"
 #include "object/objectsnd.h"
 #include "observer/observer.h"
 #include "prop/prop.h"
@@ -81,6 +82,8 @@ int Num_objects=-1;
 int Highest_object_index=-1;
 int Highest_ever_object_index=0;
 int Object_next_signature = 1;	//0 is bogus, start at 1
+int Obj_used_list_version = 0;
+int Obj_positions_version = 0;
 int Object_inited = 0;
 int Show_waypoints = 0;
 
@@ -438,6 +441,7 @@ void obj_init()
 	Object_inited = 1;
 	for (i = 0; i < MAX_OBJECTS; ++i)
 		Objects[i].clear();
+	obj_snapshot_close();
 	Viewer_obj = NULL;
 
 	list_init( &obj_free_list );
@@ -452,6 +456,7 @@ void obj_init()
 	}
 
 	Object_next_signature = 1;	//0 is invalid, others start at 1
+	Obj_used_list_version++;
 	Num_objects = 0;
 	Highest_object_index = 0;
 
@@ -462,6 +467,8 @@ void obj_init()
 
 void obj_shutdown()
 {
+	obj_snapshot_close();
+
 	for (auto& obj : Objects) {
 		obj.clear();
 	}
@@ -551,6 +558,7 @@ void obj_free(int objnum)
 
 	// remove objp from the used list
 	list_remove( &obj_used_list, objp );
+	Obj_used_list_version++;
 
 	// add objp to the end of the free
 	list_append( &obj_free_list, objp );
@@ -837,6 +845,7 @@ void obj_merge_created_list(void)
 
 		// Then add it to the object used list
 		list_append( &obj_used_list, objp );
+		Obj_used_list_version++;
 
 		objp = GET_FIRST(&obj_create_list);
 	}
@@ -1698,8 +1707,12 @@ void obj_move_all(float frametime)
 		if (objp->type == OBJ_SHIP)
 			ship_model_replicate_submodels(objp);
 
+		// area effects of this frame may already have looked up objects by position
+		weapon_area_object_moved(objp);
+
 		// move post
 		obj_move_all_post(objp, frametime);
+		weapon_area_object_moved(objp);
 
 		// Equipment script processing
 		if (objp->type == OBJ_SHIP) {
@@ -1768,6 +1781,9 @@ void obj_move_all(float frametime)
 		}
 	}
 
+	// docked objects have been dragged along with their parents
+	Obj_positions_version++;
+
 	if (!cmeasure_list.empty())
 		find_homing_object_cmeasures(cmeasure_list);	//	If any cmeasures are active, maybe steer away homing missiles
 
@@ -1779,6 +1795,9 @@ void obj_move_all(float frametime)
 		obj_sort_and_collide();
 	}
 
+	// collision responses may have pushed objects apart
+	Obj_positions_version++;
+
 	turret_swarm_check_validity();
 
 	// do post-collision stuff for beam weapons
@@ -232,6 +232,8 @@ extern int Object_inited;
 extern int Show_waypoints;
 
 extern int Object_next_signature;		// The next signature for the next newly created object. Zero is bogus
+extern int Obj_used_list_version;		// Changes whenever objects are added to or removed from obj_used_list
+extern int Obj_positions_version;		// Changes whenever objects may have been moved
 extern int Highest_object_index;		//highest objnum
 extern int Highest_ever_object_index;
 
@@ -388,6 +390,12 @@ polymodel_instance *object_get_model_instance(const object *objp);
 
 void obj_render_queue_all();
 
+// Returns 1 if the sphere might be visible, 0 if it is outside of the view cone
+int obj_in_view_cone(const vec3d *pos, float radius);
+
+// The radius of the sphere around the object which is tested against the view cone
+float obj_get_cull_radius(object *objp);
+
 /**
  * @brief Compares two object pointers and determines if they refer to the same object
  *
@@ -0,0 +1,344 @@
+#include "object/objectsnapshot.h"
+
+#include "model/model.h"
+#include "object/object.h"
+#include "render/3d.h"
+#include "render/3dinternal.h"
+#include "tracing/tracing.h"
+#include "utils/threading.h"
+#include "weapon/weapon.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+const vec3d Cull_offsets[8] = {
+	{ { { -1.0f, -1.0f, -1.0f } } },
+	{ { { -1.0f, -1.0f,  1.0f } } },
+	{ { { -1.0f,  1.0f, -1.0f } } },
+	{ { { -1.0f,  1.0f,  1.0f } } },
+	{ { {  1.0f, -1.0f, -1.0f } } },
+	{ { {  1.0f, -1.0f,  1.0f } } },
+	{ { {  1.0f,  1.0f, -1.0f } } },
+	{ { {  1.0f,  1.0f,  1.0f } } }
+};
+
+obj_render_snapshot Snapshots[2];
+int Current_snapshot = 0;
+int Snapshot_frame = 0;
+
+// Only the objects which are rendered as a whole model select a detail level when they are queued
+int obj_render_model_num(const object* objp)
+{
+	switch (objp->type) {
+	case OBJ_SHIP:
+	case OBJ_ASTEROID:
+	case OBJ_DEBRIS:
+	case OBJ_RAW_POF:
+		return object_get_model_num(objp);
+
+	case OBJ_WEAPON:
+		if (Weapon_info[Weapons[objp->instance].weapon_info_index].render_type == WRT_POF) {
+			return object_get_model_num(objp);
+		}
+		return -1;
+
+	default:
+		return -1;
+	}
+}
+
+// Culls the snapshot of one frame while the main thread sets up rendering it
+class render_cull_thread {
+  public:
+	~render_cull_thread() { stop(); }
+
+	void begin(const obj_render_snapshot* snapshot, const obj_render_frustum& frustum)
+	{
+		// nobody picked up the last result
+		end();
+
+		std::unique_lock<std::mutex> lock(m_lock);
+
+		if (!m_thread.joinable()) {
+			m_exit = false;
+			m_thread = std::thread([this]() { run(); });
+		}
+
+		m_snapshot = snapshot;
+		m_frustum = frustum;
+		m_working = true;
+		m_pending = true;
+
+		m_cond.notify_all();
+	}
+
+	const obj_render_cull_result* end()
+	{
+		if (!m_pending) {
+			return nullptr;
+		}
+		m_pending = false;
+
+		std::unique_lock<std::mutex> lock(m_lock);
+		m_cond.wait(lock, [this]() { return !m_working; });
+
+		return &m_result;
+	}
+
+	// Makes sure the snapshot is not read anymore
+	void release(const obj_render_snapshot* snapshot)
+	{
+		if (m_pending && m_snapshot == snapshot) {
+			end();
+		}
+	}
+
+	void stop()
+	{
+		end();
+
+		if (!m_thread.joinable()) {
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			m_exit = true;
+		}
+		m_cond.notify_all();
+
+		m_thread.join();
+	}
+
+  private:
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(m_lock);
+
+		while (true) {
+			m_cond.wait(lock, [this]() { return m_exit || m_working; });
+
+			if (m_exit) {
+				return;
+			}
+
+			lock.unlock();
+			obj_render_cull(*m_snapshot, m_frustum, &m_result);
+			lock.lock();
+
+			m_working = false;
+			m_cond.notify_all();
+		}
+	}
+
+	std::thread m_thread;
+	std::mutex m_lock;
+	std::condition_variable m_cond;
+	bool m_exit = false;
+	bool m_working = false;		// the thread has a job it has not finished yet
+
+	bool m_pending = false;		// begin() was called but end() was not, only used on the main thread
+
+	const obj_render_snapshot* m_snapshot = nullptr;
+	obj_render_frustum m_frustum;
+	obj_render_cull_result m_result;
+};
+
+render_cull_thread Cull_thread;
+
+obj_render_cull_result Cull_result;
+
+} // namespace
+
+void obj_render_snapshot::clear()
+{
+	objnum.clear();
+	signature.clear();
+	pos.clear();
+	cull_radius.clear();
+	orient.clear();
+	model_num.clear();
+}
+
+void obj_render_cull_result::clear()
+{
+	visible.clear();
+	in_view.clear();
+	model_distance.clear();
+}
+
+void obj_snapshot_take()
+{
+	TRACE_SCOPE(tracing::ObjectSnapshot);
+
+	auto& snapshot = Snapshots[1 - Current_snapshot];
+
+	// the cull thread may still be working on the snapshot before the current one
+	Cull_thread.release(&snapshot);
+
+	snapshot.clear();
+	snapshot.frame = ++Snapshot_frame;
+
+	for (int i = 0; i <= Highest_object_index; i++) {
+		auto objp = &Objects[i];
+
+		if ((objp->type == OBJ_NONE) || !objp->flags[Object::Object_Flags::Renders]) {
+			continue;
+		}
+
+		snapshot.objnum.push_back(i);
+		snapshot.signature.push_back(objp->signature);
+		snapshot.pos.push_back(objp->pos);
+		snapshot.cull_radius.push_back(obj_get_cull_radius(objp));
+		snapshot.orient.push_back(objp->orient);
+		snapshot.model_num.push_back(obj_render_model_num(objp));
+	}
+
+	Current_snapshot = 1 - Current_snapshot;
+}
+
+const obj_render_snapshot& obj_snapshot_get()
+{
+	return Snapshots[Current_snapshot];
+}
+
+void obj_render_frustum_init(obj_render_frustum* frustum)
+{
+	frustum->position = View_position;
+	frustum->orient = View_matrix;
+
+	frustum->asymmetric = std::holds_alternative<asymmetric_fov>(Proj_fov);
+	if (frustum->asymmetric) {
+		frustum->afov = std::get<asymmetric_fov>(Proj_fov);
+	}
+
+	frustum->user_clip = G3_user_clip != 0;
+	frustum->clip_point = G3_user_clip_point;
+	frustum->clip_normal = G3_user_clip_normal;
+}
+
+bool obj_render_frustum_sphere_visible(const obj_render_frustum& frustum, const vec3d* pos, float radius)
+{
+	// Center isn't in... are other points?
+	ubyte and_codes = 0xff;
+
+	for (const auto& offset : Cull_offsets) {
+		vec3d pt, tmp, rotated;
+		vm_vec_scale_add(&pt, pos, &offset, radius);
+
+		vm_vec_sub(&tmp, &pt, &frustum.position);
+		vm_vec_rotate(&rotated, &tmp, &frustum.orient);
+
+		if (frustum.asymmetric) {
+			float angle = atan2(rotated.xyz.z, rotated.xyz.x) + (frustum.afov.left + frustum.afov.right);
+			rotated.xyz.x = angle == PI_2 ? 0.0f : rotated.xyz.z / tanf(angle);
+
+			angle = atan2(rotated.xyz.z, rotated.xyz.y) + (frustum.afov.up + frustum.afov.down);
+			rotated.xyz.y = angle == PI_2 ? 0.0f : rotated.xyz.z / tanf(angle);
+		}
+
+		ubyte codes = 0;
+
+		if (rotated.xyz.x > rotated.xyz.z)
+			codes |= CC_OFF_RIGHT;
+
+		if (rotated.xyz.y > rotated.xyz.z)
+			codes |= CC_OFF_TOP;
+
+		if (rotated.xyz.x < -rotated.xyz.z)
+			codes |= CC_OFF_LEFT;
+
+		if (rotated.xyz.y < -rotated.xyz.z)
+			codes |= CC_OFF_BOT;
+
+		if (rotated.xyz.z < 0.0f)
+			codes |= CC_BEHIND;
+
+		if (frustum.user_clip) {
+			vm_vec_sub(&tmp, &pt, &frustum.clip_point);
+			if (vm_vec_dot(&tmp, &frustum.clip_normal) <= 0.0f) {
+				codes |= CC_OFF_USER;
+			}
+		}
+
+		if (!codes) {
+			return true;		// this point is in, so render it
+		}
+		and_codes &= codes;
+	}
+
+	// all points off screen if they are all off the same side
+	return and_codes == 0;
+}
+
+void obj_render_cull(const obj_render_snapshot& snapshot, const obj_render_frustum& frustum, obj_render_cull_result* result)
+{
+	TRACE_SCOPE(tracing::CullObjects);
+
+	const auto count = snapshot.size();
+
+	result->visible.clear();
+	result->in_view.resize(count);
+	result->model_distance.resize(count);
+	result->eye_position = frustum.position;
+
+	// every object only writes its own entries, so they can be culled in any order
+	threading::parallel_for(count, 64, [&snapshot, &frustum, result](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			bool in_view = obj_render_frustum_sphere_visible(frustum, &snapshot.pos[i], snapshot.cull_radius[i]);
+			result->in_view[i] = in_view ? 1 : 0;
+
+			if (in_view && snapshot.model_num[i] >= 0) {
+				vec3d closest_pos;
+				result->model_distance[i] = model_find_closest_point(&closest_pos, snapshot.model_num[i], -1,
+					&snapshot.orient[i], &snapshot.pos[i], &frustum.position);
+			} else {
+				result->model_distance[i] = -1.0f;
+			}
+		}
+	});
+
+	for (size_t i = 0; i < count; ++i) {
+		if (result->in_view[i]) {
+			result->visible.push_back(static_cast<int>(i));
+		}
+	}
+}
+
+void obj_render_cull_begin()
+{
+	obj_render_frustum frustum;
+	obj_render_frustum_init(&frustum);
+
+	Cull_thread.begin(&obj_snapshot_get(), frustum);
+}
+
+const obj_render_cull_result& obj_render_cull_end()
+{
+	auto result = Cull_thread.end();
+	if (result != nullptr) {
+		return *result;
+	}
+
+	obj_snapshot_take();
+
+	obj_render_frustum frustum;
+	obj_render_frustum_init(&frustum);
+
+	obj_render_cull(obj_snapshot_get(), frustum, &Cull_result);
+
+	return Cull_result;
+}
+
+void obj_snapshot_close()
+{
+	Cull_thread.stop();
+
+	for (auto& snapshot : Snapshots) {
+		snapshot.clear();
+	}
+	Cull_result.clear();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+#include "camera/camera.h"
+
+// The parts of the objects which culling them for rendering needs, copied at the end of each simulation frame.  Two
+// snapshots are kept, so the one of the last frame can still be read on the cull thread while the next one is taken.
+struct obj_render_snapshot {
+	int frame = 0;
+
+	// one entry per renderable object
+	SCP_vector<int> objnum;
+	SCP_vector<int> signature;
+	SCP_vector<vec3d> pos;
+	SCP_vector<float> cull_radius;	// the radius of the sphere which is tested against the view frustum
+	SCP_vector<matrix> orient;
+	SCP_vector<int> model_num;		// -1 if the detail level of the object is not selected ahead of queueing it
+
+	size_t size() const { return objnum.size(); }
+
+	void clear();
+};
+
+// The objects of a snapshot which are in view
+struct obj_render_cull_result {
+	SCP_vector<int> visible;			// indices into the snapshot, in the order of the snapshot
+
+	// one entry per object of the snapshot
+	SCP_vector<ubyte> in_view;
+	SCP_vector<float> model_distance;	// the distance from the eye to the bounding box of the model, if it is in view
+	vec3d eye_position = vmd_zero_vector;	// the eye the model distances were measured from
+
+	void clear();
+};
+
+// The view objects are culled against, copied from the current 3d view so culling doesn't read the globals of the
+// render code while the main thread uses them
+struct obj_render_frustum {
+	vec3d position;
+	matrix orient;
+
+	bool asymmetric = false;
+	asymmetric_fov afov;
+
+	bool user_clip = false;
+	vec3d clip_point;
+	vec3d clip_normal;
+};
+
+// Copies the state of all renderable objects into the next snapshot and makes it the current one
+void obj_snapshot_take();
+
+// The snapshot taken last
+const obj_render_snapshot& obj_snapshot_get();
+
+void obj_render_frustum_init(obj_render_frustum* frustum);
+
+// The same test as obj_in_view_cone(), but against the given view
+bool obj_render_frustum_sphere_visible(const obj_render_frustum& frustum, const vec3d* pos, float radius);
+
+// Culls all objects of the snapshot and computes the distances the detail levels of the visible ones are selected by.
+// The objects are split across the task pool when this is called on the main thread.
+void obj_render_cull(const obj_render_snapshot& snapshot, const obj_render_frustum& frustum, obj_render_cull_result* result);
+
+// Starts culling the objects of the current snapshot against the current view on the cull thread
+void obj_render_cull_begin();
+
+// Waits for the culling started by obj_render_cull_begin() and returns its result.  If no culling was started since the
+// last call, a new snapshot is taken and culled against the current view right away.
+const obj_render_cull_result& obj_render_cull_end();
+
+void obj_snapshot_close();
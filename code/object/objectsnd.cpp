@@ -71,6 +71,25 @@ static TIMESTAMP Flyby_next_sound;
 static TIMESTAMP Flyby_next_repeat;
 object	*Flyby_last_objp;
 
+// The emitters of an update, gathered before any sound channel is touched so sounds which are out of range
+// cost nothing more than their position
+struct obj_snd_emitters {
+	SCP_vector<obj_snd*> osp;
+	SCP_vector<vec3d> pos;				// world position of the sound
+	SCP_vector<float> distance;			// distance from the viewer, less add_distance
+	SCP_vector<float> add_distance;		// how much extra distance before attenuation starts
+
+	void clear()
+	{
+		osp.clear();
+		pos.clear();
+		distance.clear();
+		add_distance.clear();
+	}
+};
+
+static obj_snd_emitters Obj_snd_emitters;
+
 // return the world pos of the sound source on a ship.  
 void obj_snd_source_pos(vec3d *sound_pos, obj_snd *osp)
 {
@@ -446,7 +465,6 @@ void obj_snd_do_frame()
 	obj_snd			*osp;
 	object			*objp, *closest_objp;
 	game_snd			*gs;
-	int				channel;
 	vec3d			source_pos;
 	float				add_distance;
 
@@ -472,6 +490,10 @@ void obj_snd_do_frame()
 		observer_obj = Player_obj;
 	}
 
+	// gather the emitters which are playing or close enough to start playing
+	auto& emitters = Obj_snd_emitters;
+	emitters.clear();
+
 	for ( osp = GET_FIRST(&obj_snd_list); osp !=END_OF_LIST(&obj_snd_list); osp = GET_NEXT(osp) ) {
 		Assert(osp != nullptr);
 		objp = &Objects[osp->objnum];
@@ -486,8 +508,6 @@ void obj_snd_do_frame()
 			continue;
 		}
 
-		bool obj_is_ship = (objp->type == OBJ_SHIP);
-
 		obj_snd_source_pos(&source_pos, osp);
 		distance = vm_vec_dist_quick( &source_pos, &View_position );
 
@@ -503,13 +523,37 @@ void obj_snd_do_frame()
 		}
 
 		// save closest distance (used for flyby sound) if this is a small ship (and not the observer)
-		if ( (obj_is_ship) && (distance < closest_dist) && (objp != observer_obj) ) {
+		if ( (objp->type == OBJ_SHIP) && (distance < closest_dist) && (objp != observer_obj) ) {
 			if ( Ship_info[Ships[objp->instance].ship_info_index].is_small_ship() ) {
 				closest_dist = distance;
 				closest_objp = objp;
 			}
 		}
 
+		// a sound which isn't playing can't start out of range
+		if ( !osp->instance.isValid() && (distance >= gs->max) ) {
+			continue;
+		}
+
+		emitters.osp.push_back(osp);
+		emitters.pos.push_back(source_pos);
+		emitters.distance.push_back(distance);
+		emitters.add_distance.push_back(add_distance);
+	}
+
+	// all the source changes of this update reach the mixer together
+	ds_defer_updates();
+
+	for (size_t i = 0; i < emitters.osp.size(); i++) {
+		osp = emitters.osp[i];
+		objp = &Objects[osp->objnum];
+		gs = gamesnd_get_game_sound(osp->id);
+		source_pos = emitters.pos[i];
+		distance = emitters.distance[i];
+		add_distance = emitters.add_distance[i];
+
+		bool obj_is_ship = (objp->type == OBJ_SHIP);
+
 		speed_vol_multiplier = 1.0f;
 		rot_vol_mult = 1.0f;
 		alive_vol_mult = 1.0f;
@@ -636,14 +680,9 @@ void obj_snd_do_frame()
 		else {
 			// sound has finished playing and won't be played again
 			if ((osp->flags & OS_LOOPING_DISABLED) && !snd_is_playing(osp->instance)) {
-				auto osp_prev = GET_PREV(osp);
-
 				// non-looping sounds that have already played once need to be removed from the object sound list
 				int sound_index = obj_snd_find(objp, osp);
 				obj_snd_delete(objp, sound_index);
-
-				// don't corrupt the iterating loop (next iteration will move to the deleted osp's next sibling)
-				osp = osp_prev;
 				continue;
 			}
 
@@ -670,7 +709,6 @@ void obj_snd_do_frame()
 			}
 		}
 
-		channel = ds_get_channel(osp->instance);
 		// for DirectSound3D sounds, re-establish the maximum speed based on the
 		//	speed_vol_multiplier
 		if ( sound_allowed ) {
@@ -690,10 +728,12 @@ void obj_snd_do_frame()
 			}
 		}
 
-		ds3d_update_buffer(channel, i2fl(gs->min), i2fl(gs->max), &source_pos, &vel);
+		ds3d_update_voice(osp->instance, i2fl(gs->min), i2fl(gs->max), &source_pos, &vel);
 		snd_get_3d_vol_and_pan(gs, &source_pos, &osp->vol, &osp->pan, add_distance);
 	}	// end for
 
+	ds_process_updates();
+
 	// see if we want to play a flyby sound
 	maybe_play_flyby_snd(closest_dist, closest_objp, observer_obj);
 }
@@ -22,10 +22,12 @@
 #include "model/modelrender.h"
 #include "nebula/neb.h"
 #include "object/object.h"
+#include "object/objectsnapshot.h"
 #include "prop/prop.h"
 #include "scripting/scripting.h"
 #include "render/3d.h"
 #include "render/batching.h"
+#include "render/occlusion.h"
 #include "ship/ship.h"
 #include "tracing/tracing.h"
 #include "weapon/weapon.h"
@@ -144,15 +146,11 @@ vec3d check_offsets[8] = {
 // offscreen.  Not the best considering we're looking at a sphere.
 int obj_in_view_cone( object * objp )
 {
-	int i;
-	vec3d tmp,pt;
-	ubyte codes;
-
-	// Center isn't in... are other points?
-	ubyte and_codes = 0xff;
-
-	float obj_size;
+	return obj_in_view_cone(&objp->pos, obj_get_cull_radius(objp));
+}
 
+float obj_get_cull_radius( object *objp )
+{
 	if (objp->type == OBJ_WEAPON && Weapon_info[Weapons[objp->instance].weapon_info_index].render_type == WRT_LASER) {
 		auto wp = &Weapons[objp->instance];
 		auto wip = &Weapon_info[wp->weapon_info_index];
@@ -161,13 +159,24 @@ int obj_in_view_cone( object * objp )
 			length_scalar *= flFrametime;
 		}
 		float radius_scalar = wip->weapon_curves.get_output(weapon_info::WeaponCurveOutputs::LASER_RADIUS_MULT, *wp, &wp->modular_curves_instance);
-		obj_size = (wip->laser_length * length_scalar) + (wip->laser_head_radius * radius_scalar);
-	} else {
-		obj_size = objp->radius;
+		return (wip->laser_length * length_scalar) + (wip->laser_head_radius * radius_scalar);
 	}
 
+	return objp->radius;
+}
+
+// Same as above for a sphere which is not an object
+int obj_in_view_cone( const vec3d *pos, float obj_size )
+{
+	int i;
+	vec3d tmp,pt;
+	ubyte codes;
+
+	// Center isn't in... are other points?
+	ubyte and_codes = 0xff;
+
 	for (i=0; i<8; i++ ) {
-		vm_vec_scale_add( &pt, &objp->pos, &check_offsets[i], obj_size );
+		vm_vec_scale_add( &pt, pos, &check_offsets[i], obj_size );
 		codes=g3_rotate_vector(&tmp,&pt);
 		if ( !codes ) {
 			//mprintf(( "A point is inside, so render it.\n" ));
@@ -324,6 +333,88 @@ void obj_render_all(const std::function<void(object*)>& render_function, bool *d
 	batching_render_all(true);
 }
 
+namespace {
+
+// Only the hulls which cover the most of the view are rasterized
+const int Max_occluders = 16;
+
+struct occluder_candidate {
+	float size;
+	object *objp;
+	const occluder_mesh *mesh;
+};
+
+occlusion_buffer Occlusion;
+SCP_vector<occluder_candidate> Occluders;
+SCP_vector<object*> Render_candidates;
+
+}
+
+// The occluder of an object if its hull is drawn solid and in full right now
+static const occluder_mesh *obj_get_occluder(object *objp)
+{
+	if ( (objp->type != OBJ_SHIP) || (objp == Viewer_obj) ) {
+		return nullptr;
+	}
+
+	auto shipp = &Ships[objp->instance];
+
+	if ( shipp->is_arriving() || shipp->is_dying_or_departing() || shipp->flags[Ship::Ship_Flags::Cloaked]
+		|| shipp->flags[Ship::Ship_Flags::Render_with_alpha_mult] || shipp->shader_effect_timestamp.isValid() ) {
+		return nullptr;
+	}
+
+	auto pm = model_get(Ship_info[shipp->ship_info_index].model_num);
+
+	return pm->occluder.empty() ? nullptr : &pm->occluder;
+}
+
+// Rasterizes the hulls of the largest ships of the candidates into the occlusion buffer
+static void obj_render_occlusion_setup(const SCP_vector<object*> &candidates)
+{
+	TRACE_SCOPE(tracing::RasterizeOccluders);
+
+	Occluders.clear();
+
+	for ( auto objp : candidates ) {
+		auto mesh = obj_get_occluder(objp);
+		if ( mesh == nullptr ) {
+			continue;
+		}
+
+		float dist = vm_vec_dist(&objp->pos, &View_position);
+		Occluders.push_back({objp->radius / MAX(dist, 1.0f), objp, mesh});
+	}
+
+	std::sort(Occluders.begin(), Occluders.end(), [](const occluder_candidate &l, const occluder_candidate &r) { return l.size > r.size; });
+	if ( Occluders.size() > static_cast<size_t>(Max_occluders) ) {
+		Occluders.resize(Max_occluders);
+	}
+
+	Occlusion.begin(&View_position, &View_matrix);
+
+	for ( const auto &occluder : Occluders ) {
+		Occlusion.add_occluder(*occluder.mesh, &occluder.objp->pos, &occluder.objp->orient);
+	}
+
+	Occlusion.finish();
+}
+
+// Only the objects which are contained in their cull radius can be hidden
+static bool obj_render_occluded(object *objp)
+{
+	switch ( objp->type ) {
+	case OBJ_SHIP:
+	case OBJ_DEBRIS:
+	case OBJ_ASTEROID:
+	case OBJ_WEAPON:
+		return Occlusion.sphere_occluded(&objp->pos, obj_get_cull_radius(objp));
+
+	default:
+		return false;
+	}
+}
+
 void obj_render_queue_all()
 {
 	GR_DEBUG_SCOPE("Render all objects");
@@ -341,33 +432,66 @@ void obj_render_queue_all()
 
 	bool full_neb = is_full_nebula();
 
+	// the objects are culled and the distances for their detail levels are computed in one pass over a snapshot of them,
+	// with -pipeline_render that happened on the cull thread while the rest of the scene was set up
+	const auto& culled = obj_render_cull_end();
+	const auto& snapshot = obj_snapshot_get();
+
 	for ( i = 0; i <= Highest_object_index; i++,objp++ ) {
-		if ( (objp->type != OBJ_NONE) && ( objp->flags [Object::Object_Flags::Renders] ) )	{
-            objp->flags.remove(Object::Object_Flags::Was_rendered);
+		objp->flags.remove(Object::Object_Flags::Was_rendered);
+	}
 
-			if ( !obj_in_view_cone(objp) ) {
-				continue;
-			}
+	Render_candidates.clear();
 
-			if ( full_neb ) {
-				vec3d to_obj;
-				vm_vec_sub( &to_obj, &objp->pos, &Eye_position );
-				float z = vm_vec_dot( &Eye_matrix.vec.fvec, &to_obj );
+	for ( auto index : culled.visible ) {
+		objp = &Objects[snapshot.objnum[index]];
 
-				if ( neb2_skip_render(objp, z) ){
-					continue;
-				}
-			}
+		// the object may have been deleted since the snapshot was taken
+		if ( (objp->type == OBJ_NONE) || (objp->signature != snapshot.signature[index]) || !objp->flags[Object::Object_Flags::Renders] ) {
+			continue;
+		}
+
+		if ( snapshot.model_num[index] >= 0 ) {
+			model_render_set_object_distance(snapshot.objnum[index], snapshot.model_num[index], &snapshot.orient[index],
+				&snapshot.pos[index], &culled.eye_position, culled.model_distance[index]);
+		}
 
+		if ( full_neb ) {
+			vec3d to_obj;
+			vm_vec_sub( &to_obj, &objp->pos, &Eye_position );
+			float z = vm_vec_dot( &Eye_matrix.vec.fvec, &to_obj );
 
-			if ( (objp->type == OBJ_SHIP) && Ships[objp->instance].shader_effect_timestamp.isValid() ) {
-				effect_ships.push_back(objp);
+			if ( neb2_skip_render(objp, z) ){
 				continue;
 			}
+		}
+
+		if ( (objp->type == OBJ_SHIP) && Ships[objp->instance].shader_effect_timestamp.isValid() ) {
+			effect_ships.push_back(objp);
+			continue;
+		}
+
+		Render_candidates.push_back(objp);
+	}
+
+	// with -occlusion_cull the objects behind the hulls of large ships are not queued, the occlusion buffer only knows
+	// symmetric views
+	bool occlusion_cull = Cmdline_occlusion_cull && !std::holds_alternative<asymmetric_fov>(Proj_fov);
+	if ( occlusion_cull ) {
+		obj_render_occlusion_setup(Render_candidates);
+	}
 
-            objp->flags.set(Object::Object_Flags::Was_rendered);
-			obj_queue_render(objp, &scene);
+	for ( auto candidate : Render_candidates ) {
+		if ( occlusion_cull && obj_render_occluded(candidate) ) {
+			continue;
 		}
+
+		candidate->flags.set(Object::Object_Flags::Was_rendered);
+		obj_queue_render(candidate, &scene);
+	}
+
+	if (Asteroids_enabled) {
+		asteroid_render_instanced(&scene);
 	}
 
 	scene.init_render();
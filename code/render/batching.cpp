@@ -19,6 +19,23 @@ static SCP_map<batch_info, primitive_batch> Batching_primitives;
 static SCP_map<batch_buffer_key, primitive_batch_buffer> Batching_buffers;
 static int lineTexture = -1;
 
+// Triangle batches of each material, with and without the thruster flag
+static const int BATCH_TABLE_VARIANTS = batch_info::NUM_RENDER_TYPES * 2;
+
+struct batch_table_entry {
+	uint generation = 0;
+	primitive_batch* batch = nullptr;
+};
+
+// Remembers the batch of each bitmap handle so the batch only has to be looked up in Batching_primitives once per frame.
+// Indexed like the bitmap blocks of bmpman, by the upper and lower 16 bits of the handle.
+static SCP_vector<SCP_vector<batch_table_entry>> Batching_table;
+static uint Batching_table_generation = 1;
+
+// The views the bitmaps which are waiting in the batches are turned towards
+static SCP_vector<batch_view> Batching_views;
+static size_t Batching_num_bitmaps = 0;
+
 void primitive_batch::add_triangle(batch_vertex* v0, batch_vertex* v1, batch_vertex *v2)
 {
 	Vertices.push_back(*v0);
@@ -31,20 +48,140 @@ void primitive_batch::add_point_sprite(batch_vertex *p)
 	Vertices.push_back(*p);
 }
 
+void primitive_batch::add_bitmap(const batch_bitmap& bitmap)
+{
+	Bitmaps.push_back(bitmap);
+	++Batching_num_bitmaps;
+}
+
 size_t primitive_batch::load_buffer(batch_vertex* buffer, size_t n_verts)
 {
-	size_t verts_to_render = Vertices.size();
+	std::copy(Vertices.begin(), Vertices.end(), buffer + n_verts);
 
-	for ( size_t i = 0; i < verts_to_render; ++i) {
-		buffer[n_verts+i] = Vertices[i];
-	}
+	batching_expand_bitmaps(Bitmaps.data(), Bitmaps.size(), Batching_views.data(), buffer + n_verts + Vertices.size());
 
-	return verts_to_render;
+	return num_verts();
 }
 
 void primitive_batch::clear()
 {
 	Vertices.clear();
+
+	Assert(Batching_num_bitmaps >= Bitmaps.size());
+	Batching_num_bitmaps -= Bitmaps.size();
+	Bitmaps.clear();
+}
+
+void batching_init_view(batch_view* view, const vec3d* position, const matrix* orient)
+{
+	view->position = *position;
+	view->orient = *orient;
+
+	// make a right vector from the f and up vector, this r vec is exactly what we want, so...
+	vm_vec_cross(&view->rvec, &orient->vec.fvec, &orient->vec.uvec);
+	vm_vec_normalize_safe(&view->rvec);
+
+	// fix the u vec with it
+	vm_vec_cross(&view->uvec, &orient->vec.fvec, &view->rvec);
+}
+
+static uint batching_current_view()
+{
+	if ( Batching_views.empty()
+		|| memcmp(&Batching_views.back().position, &View_position, sizeof(View_position)) != 0
+		|| memcmp(&Batching_views.back().orient, &View_matrix, sizeof(View_matrix)) != 0 ) {
+		Batching_views.emplace_back();
+		batching_init_view(&Batching_views.back(), &View_position, &View_matrix);
+	}
+
+	return (uint)(Batching_views.size() - 1);
+}
+
+/*
+0----1
+|\   |
+|  \ |
+3----2
+*/
+void batching_expand_bitmaps(const batch_bitmap* bitmaps, size_t count, const batch_view* views, batch_vertex* out)
+{
+	// the corners of the two triangles, in the order they are emitted
+	static const int corners[6] = { 3, 2, 1, 3, 1, 0 };
+	static const int rotated_corners[6] = { 0, 1, 3, 1, 2, 3 };
+
+	for ( size_t i = 0; i < count; ++i ) {
+		const batch_bitmap& bitmap = bitmaps[i];
+		const batch_view& view = views[bitmap.view];
+
+		float rad = bitmap.radius * 1.41421356f;//1/0.707, becase these are the points of a square or width and height rad
+
+		vec3d PNT = bitmap.position;
+		vec3d rvec, uvec;
+
+		if ( bitmap.rotated ) {
+			vm_rot_point_around_line(&uvec, &view.orient.vec.uvec, bitmap.angle, &vmd_zero_vector, &view.orient.vec.fvec);
+
+			vm_vec_cross(&rvec, &view.orient.vec.fvec, &uvec);
+			vm_vec_normalize_safe(&rvec);
+			vm_vec_cross(&uvec, &view.orient.vec.fvec, &rvec);
+		} else {
+			rvec = view.rvec;
+			uvec = view.uvec;
+		}
+
+		// move the center of the sprite based on the depth parameter
+		if ( bitmap.depth != 0.0f ) {
+			vec3d fvec;
+			vm_vec_sub(&fvec, &view.position, &PNT);
+			vm_vec_normalize_safe(&fvec);
+			vm_vec_scale_add2(&PNT, &fvec, bitmap.depth);
+		}
+
+		vec3d right, up;
+		vm_vec_copy_scale(&right, &rvec, rad);
+		vm_vec_copy_scale(&up, &uvec, rad);
+
+		vec3d p[4];
+		p[0].xyz.x = PNT.xyz.x + right.xyz.x + up.xyz.x;
+		p[0].xyz.y = PNT.xyz.y + right.xyz.y + up.xyz.y;
+		p[0].xyz.z = PNT.xyz.z + right.xyz.z + up.xyz.z;
+		p[1].xyz.x = PNT.xyz.x - right.xyz.x + up.xyz.x;
+		p[1].xyz.y = PNT.xyz.y - right.xyz.y + up.xyz.y;
+		p[1].xyz.z = PNT.xyz.z - right.xyz.z + up.xyz.z;
+		p[2].xyz.x = PNT.xyz.x - right.xyz.x - up.xyz.x;
+		p[2].xyz.y = PNT.xyz.y - right.xyz.y - up.xyz.y;
+		p[2].xyz.z = PNT.xyz.z - right.xyz.z - up.xyz.z;
+		p[3].xyz.x = PNT.xyz.x + right.xyz.x - up.xyz.x;
+		p[3].xyz.y = PNT.xyz.y + right.xyz.y - up.xyz.y;
+		p[3].xyz.z = PNT.xyz.z + right.xyz.z - up.xyz.z;
+
+		// the texture coordinates of the corners, rotated bitmaps are never flipped
+		float u_right = (bitmap.orient & 1) ? 1.0f : 0.0f;
+		float v_up = (bitmap.orient & 2) ? 0.0f : 1.0f;
+		float tex_u[4] = { u_right, 1.0f - u_right, 1.0f - u_right, u_right };
+		float tex_v[4] = { v_up, v_up, 1.0f - v_up, 1.0f - v_up };
+
+		const int* order = bitmap.rotated ? rotated_corners : corners;
+		batch_vertex* verts = &out[i * 6];
+
+		for ( int j = 0; j < 6; ++j ) {
+			int corner = order[j];
+
+			verts[j].position = p[corner];
+			verts[j].tex_coord.xyzw.x = tex_u[corner];
+			verts[j].tex_coord.xyzw.y = tex_v[corner];
+			verts[j].tex_coord.xyzw.z = bitmap.array_index;
+			verts[j].tex_coord.xyzw.w = 1.0f;
+
+			verts[j].r = bitmap.r;
+			verts[j].g = bitmap.g;
+			verts[j].b = bitmap.b;
+			verts[j].a = bitmap.a;
+
+			verts[j].radius = bitmap.radius;
+			verts[j].uvec = vmd_zero_vector;
+		}
+	}
 }
 
 void batching_setup_vertex_layout(vertex_layout *layout, uint vert_mask)
@@ -111,7 +248,7 @@ primitive_batch_buffer* batching_find_buffer(uint vertex_mask, primitive_type pr
 	}
 }
 
-primitive_batch* batching_find_batch(int texture, batch_info::material_type material_id, primitive_type prim_type, bool thruster)
+static primitive_batch* batching_find_batch_internal(int texture, batch_info::material_type material_id, primitive_type prim_type, bool thruster)
 {
 	// Use the base texture for finding the batch item since all items can reuse the same texture array
 	auto base_tex = bm_get_base_frame(texture);
@@ -131,6 +268,33 @@ primitive_batch* batching_find_batch(int texture, batch_info::material_type mate
 	}
 }
 
+primitive_batch* batching_find_batch(int texture, batch_info::material_type material_id, primitive_type prim_type, bool thruster)
+{
+	if ( texture < 0 || prim_type != PRIM_TYPE_TRIS ) {
+		return batching_find_batch_internal(texture, material_id, prim_type, thruster);
+	}
+
+	auto block = (size_t)(texture >> 16);
+	auto index = (size_t)(texture & 0xFFFF) * BATCH_TABLE_VARIANTS + material_id * 2 + (thruster ? 1 : 0);
+
+	if ( block >= Batching_table.size() ) {
+		Batching_table.resize(block + 1);
+	}
+
+	auto& entries = Batching_table[block];
+	if ( index >= entries.size() ) {
+		entries.resize(index + BATCH_TABLE_VARIANTS);
+	}
+
+	auto& entry = entries[index];
+	if ( entry.generation != Batching_table_generation ) {
+		entry.batch = batching_find_batch_internal(texture, material_id, prim_type, thruster);
+		entry.generation = Batching_table_generation;
+	}
+
+	return entry.batch;
+}
+
 uint batching_determine_vertex_layout(batch_info *info)
 {
 	if ( info->prim_type == PRIM_TYPE_POINTS ) {
@@ -156,125 +320,28 @@ void batching_add_bitmap_internal(primitive_batch *batch, int texture, vertex *p
 {
 	Assert(batch->get_render_info().prim_type == PRIM_TYPE_TRIS);
 
-	float radius = rad;
-	rad *= 1.41421356f;//1/0.707, becase these are the points of a square or width and height rad
-
-	vec3d PNT(pnt->world);
-	vec3d p[4];
-	vec3d fvec, rvec, uvec;
-	batch_vertex verts[6];
-
-	// get the direction from the point to the eye
-	vm_vec_sub(&fvec, &View_position, &PNT);
-	vm_vec_normalize_safe(&fvec);
-
-	// get an up vector in the general direction of what we want
-	uvec = View_matrix.vec.uvec;
-
-	// make a right vector from the f and up vector, this r vec is exactly what we want, so...
-	vm_vec_cross(&rvec, &View_matrix.vec.fvec, &uvec);
-	vm_vec_normalize_safe(&rvec);
-
-	// fix the u vec with it
-	vm_vec_cross(&uvec, &View_matrix.vec.fvec, &rvec);
-
-	// move the center of the sprite based on the depth parameter
-	if ( depth != 0.0f )
-		vm_vec_scale_add(&PNT, &PNT, &fvec, depth);
-
-	// move one of the verts to the left
-	vm_vec_scale_add(&p[0], &PNT, &rvec, rad);
-
-	// and one to the right
-	vm_vec_scale_add(&p[2], &PNT, &rvec, -rad);
-
-	// now move all oof the verts to were they need to be
-	vm_vec_scale_add(&p[1], &p[2], &uvec, rad);
-	vm_vec_scale_add(&p[3], &p[0], &uvec, -rad);
-	vm_vec_scale_add(&p[0], &p[0], &uvec, rad);
-	vm_vec_scale_add(&p[2], &p[2], &uvec, -rad);
-
-	//move all the data from the vecs into the verts
-	//tri 1
-	verts[5].position = p[3];
-	verts[4].position = p[2];
-	verts[3].position = p[1];
-
-	//tri 2
-	verts[2].position = p[3];
-	verts[1].position = p[1];
-	verts[0].position = p[0];
-
-	// set up the UV coords
-	if ( orient & 1 ) {
-		// tri 1
-		verts[5].tex_coord.xyzw.x = 1.0f;
-		verts[4].tex_coord.xyzw.x = 0.0f;
-		verts[3].tex_coord.xyzw.x = 0.0f;
-
-		// tri 2
-		verts[2].tex_coord.xyzw.x = 1.0f;
-		verts[1].tex_coord.xyzw.x = 0.0f;
-		verts[0].tex_coord.xyzw.x = 1.0f;
-	} else {
-		// tri 1
-		verts[5].tex_coord.xyzw.x = 0.0f;
-		verts[4].tex_coord.xyzw.x = 1.0f;
-		verts[3].tex_coord.xyzw.x = 1.0f;
-
-		// tri 2
-		verts[2].tex_coord.xyzw.x = 0.0f;
-		verts[1].tex_coord.xyzw.x = 1.0f;
-		verts[0].tex_coord.xyzw.x = 0.0f;
-	}
-
-	if ( orient & 2 ) {
-		// tri 1
-		verts[5].tex_coord.xyzw.y = 1.0f;
-		verts[4].tex_coord.xyzw.y = 1.0f;
-		verts[3].tex_coord.xyzw.y = 0.0f;
-
-		// tri 2
-		verts[2].tex_coord.xyzw.y = 1.0f;
-		verts[1].tex_coord.xyzw.y = 0.0f;
-		verts[0].tex_coord.xyzw.y = 0.0f;
-	} else {
-		// tri 1
-		verts[5].tex_coord.xyzw.y = 0.0f;
-		verts[4].tex_coord.xyzw.y = 0.0f;
-		verts[3].tex_coord.xyzw.y = 1.0f;
-
-		// tri 2
-		verts[2].tex_coord.xyzw.y = 0.0f;
-		verts[1].tex_coord.xyzw.y = 1.0f;
-		verts[0].tex_coord.xyzw.y = 1.0f;
-	}
-
-	auto array_index = texture - batch->get_render_info().texture;
-	for (int i = 0; i < 6 ; i++) {
-		verts[i].r = clr->red;
-		verts[i].g = clr->green;
-		verts[i].b = clr->blue;
-		verts[i].a = clr->alpha;
-
-		verts[i].radius = radius;
-
-		// Set array index
-		verts[i].tex_coord.xyzw.z = (float) array_index;
-		verts[i].tex_coord.xyzw.w = 1.0f;
-	}
-
-	batch->add_triangle(&verts[5], &verts[4], &verts[3]);
-	batch->add_triangle(&verts[2], &verts[1], &verts[0]);
+	batch_bitmap bitmap;
+
+	bitmap.position = pnt->world;
+	bitmap.radius = rad;
+	bitmap.depth = depth;
+	bitmap.angle = 0.0f;
+	bitmap.array_index = (float)(texture - batch->get_render_info().texture);
+	bitmap.r = clr->red;
+	bitmap.g = clr->green;
+	bitmap.b = clr->blue;
+	bitmap.a = clr->alpha;
+	bitmap.view = batching_current_view();
+	bitmap.orient = (ubyte)(orient & 3);
+	bitmap.rotated = false;
+
+	batch->add_bitmap(bitmap);
 }
 
 void batching_add_bitmap_rotated_internal(primitive_batch *batch, int texture, vertex *pnt, float angle, float rad, color *clr, float depth)
 {
 	Assert(batch->get_render_info().prim_type == PRIM_TYPE_TRIS);
 
-	float radius = rad;
-	rad *= 1.41421356f;//1/0.707, becase these are the points of a square or width and height rad
-
 	extern float Physics_viewer_bank;
 	angle -= Physics_viewer_bank;
 
@@ -283,65 +350,22 @@ void batching_add_bitmap_rotated_internal(primitive_batch *batch, int texture, v
 	else if ( angle > PI2 )
 		angle -= PI2;
 
-	vec3d PNT(pnt->world);
-	vec3d p[4];
-	vec3d fvec, rvec, uvec;
-	batch_vertex verts[6];
-
-	vm_vec_sub(&fvec, &View_position, &PNT);
-	vm_vec_normalize_safe(&fvec);
-
-	vm_rot_point_around_line(&uvec, &View_matrix.vec.uvec, angle, &vmd_zero_vector, &View_matrix.vec.fvec);
-
-	vm_vec_cross(&rvec, &View_matrix.vec.fvec, &uvec);
-	vm_vec_normalize_safe(&rvec);
-	vm_vec_cross(&uvec, &View_matrix.vec.fvec, &rvec);
-
-	vm_vec_scale_add(&PNT, &PNT, &fvec, depth);
-	vm_vec_scale_add(&p[0], &PNT, &rvec, rad);
-	vm_vec_scale_add(&p[2], &PNT, &rvec, -rad);
-
-	vm_vec_scale_add(&p[1], &p[2], &uvec, rad);
-	vm_vec_scale_add(&p[3], &p[0], &uvec, -rad);
-	vm_vec_scale_add(&p[0], &p[0], &uvec, rad);
-	vm_vec_scale_add(&p[2], &p[2], &uvec, -rad);
-
-
-	//move all the data from the vecs into the verts
-	//tri 1
-	verts[5].position = p[3];
-	verts[4].position = p[2];
-	verts[3].position = p[1];
-
-	//tri 2
-	verts[2].position = p[3];
-	verts[1].position = p[1];
-	verts[0].position = p[0];
-
-	//tri 1
-	verts[5].tex_coord.xyzw.x = 0.0f;	verts[5].tex_coord.xyzw.y = 0.0f;
-	verts[4].tex_coord.xyzw.x = 1.0f;	verts[4].tex_coord.xyzw.y = 0.0f;
-	verts[3].tex_coord.xyzw.x = 1.0f;	verts[3].tex_coord.xyzw.y = 1.0f;
-
-	//tri 2
-	verts[2].tex_coord.xyzw.x = 0.0f;	verts[2].tex_coord.xyzw.y = 0.0f;
-	verts[1].tex_coord.xyzw.x = 1.0f;	verts[1].tex_coord.xyzw.y = 1.0f;
-	verts[0].tex_coord.xyzw.x = 0.0f;	verts[0].tex_coord.xyzw.y = 1.0f;
-
-	auto array_index = texture - batch->get_render_info().texture;
-	for (int i = 0; i < 6 ; i++) {
-		verts[i].r = clr->red;
-		verts[i].g = clr->green;
-		verts[i].b = clr->blue;
-		verts[i].a = clr->alpha;
-
-		verts[i].radius = radius;
-		verts[i].tex_coord.xyzw.z = (float)array_index;
-		verts[i].tex_coord.xyzw.w = 1.0f;
-	}
-
-	batch->add_triangle(&verts[0], &verts[1], &verts[2]);
-	batch->add_triangle(&verts[3], &verts[4], &verts[5]);
+	batch_bitmap bitmap;
+
+	bitmap.position = pnt->world;
+	bitmap.radius = rad;
+	bitmap.depth = depth;
+	bitmap.angle = angle;
+	bitmap.array_index = (float)(texture - batch->get_render_info().texture);
+	bitmap.r = clr->red;
+	bitmap.g = clr->green;
+	bitmap.b = clr->blue;
+	bitmap.a = clr->alpha;
+	bitmap.view = batching_current_view();
+	bitmap.orient = 0;
+	bitmap.rotated = true;
+
+	batch->add_bitmap(bitmap);
 }
 
 void batching_add_polygon_internal(primitive_batch *batch, int texture, const vec3d *pos, const matrix *orient, float width, float height, color *clr)
@@ -1069,6 +1093,16 @@ void batching_render_all(bool render_distortions)
 
 	batching_load_buffers(render_distortions);
 
+	// the bitmaps of the other kind of batches still use their views until those are rendered
+	if ( Batching_num_bitmaps == 0 ) {
+		Batching_views.clear();
+	}
+
+	// bitmap handles may refer to something else by the next frame
+	if ( ++Batching_table_generation == 0 ) {
+		Batching_table_generation = 1;
+	}
+
 	SCP_map<batch_buffer_key, primitive_batch_buffer>::iterator bi;
 
 	for ( bi = Batching_buffers.begin(); bi != Batching_buffers.end(); ++bi ) {
@@ -19,6 +19,29 @@ struct batch_vertex {
 	vec3d uvec;
 };
 
+// The view bitmaps are turned towards, captured when the bitmaps are added
+struct batch_view {
+	vec3d position;
+	matrix orient;
+
+	// the corner directions of bitmaps which are not rotated
+	vec3d rvec;
+	vec3d uvec;
+};
+
+// A camera facing bitmap, kept in this compact form until its batch is loaded into a vertex buffer
+struct batch_bitmap {
+	vec3d position;
+	float radius;
+	float depth;
+	float angle;		// rotation around the view direction, rotated bitmaps only
+	float array_index;
+	ubyte r, g, b, a;
+	uint view;			// index of the batch_view
+	ubyte orient;		// texture flips, bitmaps which are not rotated only
+	bool rotated;
+};
+
 struct batch_info {
 	enum material_type {
 		FLAT_EMISSIVE,
@@ -73,6 +96,7 @@ class primitive_batch
 {
 	batch_info render_info;
 	SCP_vector<batch_vertex> Vertices;
+	SCP_vector<batch_bitmap> Bitmaps;
 
 public:
 	primitive_batch() : render_info() {}
@@ -83,9 +107,14 @@ public:
 	void add_triangle(batch_vertex* v0, batch_vertex* v1, batch_vertex* v2);
 	void add_point_sprite(batch_vertex *p);
 
+	// bitmaps are expanded into two triangles each by load_buffer(), after the triangles of the batch
+	void add_bitmap(const batch_bitmap& bitmap);
+
 	size_t load_buffer(batch_vertex* buffer, size_t n_verts);
 
-	size_t num_verts() { return Vertices.size();  }
+	size_t num_verts() { return Vertices.size() + Bitmaps.size() * 6; }
+
+	size_t num_bitmaps() { return Bitmaps.size(); }
 
 	void clear();
 };
@@ -133,4 +162,10 @@ void batching_add_tri(int texture, vertex *verts, primitive_batch* batch);
 
 void batching_render_all(bool render_distortions = false);
 
+// Sets up the view bitmaps are turned towards for the given camera
+void batching_init_view(batch_view* view, const vec3d* position, const matrix* orient);
+
+// Writes the six vertices of each bitmap to out
+void batching_expand_bitmaps(const batch_bitmap* bitmaps, size_t count, const batch_view* views, batch_vertex* out);
+
 void batching_shutdown();
@@ -0,0 +1,672 @@
+#include "render/occlusion.h"
+
+#include "tracing/tracing.h"
+
+#include <algorithm>
+
+namespace {
+
+// Occluder faces closer than this are clipped, the depth of view space is scaled like View_matrix
+const float Occlusion_near_z = 0.1f;
+
+// Moves the points the inside of a hull is sampled at off the grid, so the rays through them do not run exactly
+// through the vertices and edges of the hull. In cells.
+const float Ray_jitter[3] = {0.000137f, 0.000291f, 0.000173f};
+
+// The view covers all but a border of one pixel around the buffer. Occluders are rasterized into the border as well,
+// so a pixel at the edge of the view whose center an occluder covers still has a neighbor to tell whether the
+// occluder ends inside of it.
+float buffer_x(float screen_x)
+{
+	return (screen_x + 1.0f) * 0.5f * (occlusion_buffer::WIDTH - 2) + 1.0f;
+}
+
+float buffer_y(float screen_y)
+{
+	return (1.0f - screen_y) * 0.5f * (occlusion_buffer::HEIGHT - 2) + 1.0f;
+}
+
+int level_width(int level)
+{
+	return std::max(1, occlusion_buffer::WIDTH >> level);
+}
+
+int level_height(int level)
+{
+	return std::max(1, occlusion_buffer::HEIGHT >> level);
+}
+
+struct grid_box {
+	int min[3];
+	int max[3];		// exclusive
+	int volume;
+};
+
+void add_box(occluder_mesh* out, const vec3d* min, const vec3d* max)
+{
+	for (int i = 0; i < 8; ++i) {
+		vec3d corner;
+		corner.xyz.x = (i & 1) ? max->xyz.x : min->xyz.x;
+		corner.xyz.y = (i & 2) ? max->xyz.y : min->xyz.y;
+		corner.xyz.z = (i & 4) ? max->xyz.z : min->xyz.z;
+		out->verts.push_back(corner);
+	}
+}
+
+// Whether the triangle reaches into the inside of the box, by the separating axis test. Triangles which only touch the
+// surface of the box do not count.
+bool triangle_crosses_box(const vec3d& p0, const vec3d& p1, const vec3d& p2, const vec3d& center, const vec3d& half_size)
+{
+	// shrink the box a little so that the hull faces on the grid planes do not cut the cells next to them
+	vec3d half;
+	vm_vec_copy_scale(&half, &half_size, 0.999f);
+
+	vec3d v[3];
+	vm_vec_sub(&v[0], &p0, &center);
+	vm_vec_sub(&v[1], &p1, &center);
+	vm_vec_sub(&v[2], &p2, &center);
+
+	auto separated = [&](const vec3d& axis) {
+		float d0 = vm_vec_dot(&v[0], &axis);
+		float d1 = vm_vec_dot(&v[1], &axis);
+		float d2 = vm_vec_dot(&v[2], &axis);
+		float r = half.xyz.x * fabs(axis.xyz.x) + half.xyz.y * fabs(axis.xyz.y) + half.xyz.z * fabs(axis.xyz.z);
+
+		return std::min(d0, std::min(d1, d2)) >= r || std::max(d0, std::max(d1, d2)) <= -r;
+	};
+
+	// the axes of the box
+	for (int a = 0; a < 3; ++a) {
+		vec3d axis = vmd_zero_vector;
+		axis.a1d[a] = 1.0f;
+		if (separated(axis)) {
+			return false;
+		}
+	}
+
+	vec3d edges[3];
+	vm_vec_sub(&edges[0], &v[1], &v[0]);
+	vm_vec_sub(&edges[1], &v[2], &v[1]);
+	vm_vec_sub(&edges[2], &v[0], &v[2]);
+
+	// the normal of the triangle
+	vec3d normal;
+	vm_vec_cross(&normal, &edges[0], &edges[1]);
+	if (separated(normal)) {
+		return false;
+	}
+
+	// the edges of the triangle crossed with the axes of the box
+	for (const auto& edge : edges) {
+		for (int a = 0; a < 3; ++a) {
+			vec3d box_axis = vmd_zero_vector;
+			box_axis.a1d[a] = 1.0f;
+
+			vec3d axis;
+			vm_vec_cross(&axis, &edge, &box_axis);
+			if (vm_vec_mag_squared(&axis) > 0.0f && separated(axis)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+struct screen_point {
+	float x, y;
+	float w;	// 1 / depth
+};
+
+float cross(const screen_point& o, const screen_point& a, const screen_point& b)
+{
+	return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+// The convex hull of the points in counterclockwise order, by Andrew's monotone chain
+int convex_hull(screen_point* points, int num_points, screen_point* hull)
+{
+	std::sort(points, points + num_points,
+		[](const screen_point& l, const screen_point& r) { return l.x < r.x || (l.x == r.x && l.y < r.y); });
+
+	int n = 0;
+	for (int i = 0; i < num_points; ++i) {
+		while (n >= 2 && cross(hull[n - 2], hull[n - 1], points[i]) <= 0.0f) {
+			--n;
+		}
+		hull[n++] = points[i];
+	}
+
+	int lower = n + 1;
+	for (int i = num_points - 2; i >= 0; --i) {
+		while (n >= lower && cross(hull[n - 2], hull[n - 1], points[i]) <= 0.0f) {
+			--n;
+		}
+		hull[n++] = points[i];
+	}
+
+	// the first point was added again at the end
+	return std::max(0, n - 1);
+}
+
+} // namespace
+
+void occluder_mesh::clear()
+{
+	verts.clear();
+}
+
+void occluder_build(occluder_mesh* out, const SCP_vector<vec3d>& tri_verts, const vec3d* min, const vec3d* max,
+	int resolution, int max_boxes)
+{
+	out->clear();
+
+	if (tri_verts.size() < 3 || resolution < 1 || max_boxes < 1) {
+		return;
+	}
+
+	vec3d size;
+	vm_vec_sub(&size, max, min);
+
+	float longest = std::max(size.xyz.x, std::max(size.xyz.y, size.xyz.z));
+	if (longest <= 0.0f) {
+		return;
+	}
+
+	int n[3];
+	float cell[3];
+	for (int a = 0; a < 3; ++a) {
+		n[a] = std::max(1, std::min(resolution, static_cast<int>(ceilf(size.a1d[a] * resolution / longest))));
+		cell[a] = size.a1d[a] / n[a];
+	}
+
+	if (cell[0] <= 0.0f || cell[1] <= 0.0f || cell[2] <= 0.0f) {
+		return;
+	}
+
+	auto corner_index = [&n](int i, int j, int k) { return (k * (n[1] + 1) + j) * (n[0] + 1) + i; };
+	auto voxel_index = [&n](int i, int j, int k) { return (k * n[1] + j) * n[0] + i; };
+
+	// A corner of the grid is inside the hull if a ray from it crosses the hull an odd number of times. Hulls are not
+	// always closed so a ray along every axis is cast and the majority decides. The rays of all axes start at the same
+	// point next to the corner so that they agree on the corners on the surface of the hull.
+	SCP_vector<ubyte> votes((n[0] + 1) * (n[1] + 1) * (n[2] + 1), 0);
+	SCP_vector<SCP_vector<float>> hits;
+
+	// The corners of a cell can all be inside while a notch of the hull narrower than the cell cuts through it, so the
+	// cells the surface of the hull passes through are never solid
+	SCP_vector<ubyte> crossed(n[0] * n[1] * n[2], 0);
+	vec3d half_cell;
+	half_cell.xyz.x = cell[0] * 0.5f;
+	half_cell.xyz.y = cell[1] * 0.5f;
+	half_cell.xyz.z = cell[2] * 0.5f;
+
+	for (int a = 0; a < 3; ++a) {
+		int b = (a + 1) % 3;
+		int c = (a + 2) % 3;
+
+		float jitter_a = Ray_jitter[a] * cell[a];
+		float jitter_b = Ray_jitter[b] * cell[b];
+		float jitter_c = Ray_jitter[c] * cell[c];
+
+		hits.assign((n[b] + 1) * (n[c] + 1), SCP_vector<float>());
+
+		for (size_t t = 0; t + 2 < tri_verts.size(); t += 3) {
+			const auto& p0 = tri_verts[t];
+			const auto& p1 = tri_verts[t + 1];
+			const auto& p2 = tri_verts[t + 2];
+
+			// once per triangle, in the pass along the first axis
+			if (a == 0) {
+				int first[3], last[3];
+				for (int d = 0; d < 3; ++d) {
+					float tri_min = std::min(p0.a1d[d], std::min(p1.a1d[d], p2.a1d[d]));
+					float tri_max = std::max(p0.a1d[d], std::max(p1.a1d[d], p2.a1d[d]));
+					first[d] = std::max(0, static_cast<int>(floorf((tri_min - min->a1d[d]) / cell[d])));
+					last[d] = std::min(n[d] - 1, static_cast<int>(floorf((tri_max - min->a1d[d]) / cell[d])));
+				}
+
+				for (int k = first[2]; k <= last[2]; ++k) {
+					for (int j = first[1]; j <= last[1]; ++j) {
+						for (int i = first[0]; i <= last[0]; ++i) {
+							vec3d center;
+							center.xyz.x = min->xyz.x + (i + 0.5f) * cell[0];
+							center.xyz.y = min->xyz.y + (j + 0.5f) * cell[1];
+							center.xyz.z = min->xyz.z + (k + 0.5f) * cell[2];
+
+							if (triangle_crosses_box(p0, p1, p2, center, half_cell)) {
+								crossed[voxel_index(i, j, k)] = 1;
+							}
+						}
+					}
+				}
+			}
+
+			float e1b = p1.a1d[b] - p0.a1d[b];
+			float e1c = p1.a1d[c] - p0.a1d[c];
+			float e2b = p2.a1d[b] - p0.a1d[b];
+			float e2c = p2.a1d[c] - p0.a1d[c];
+
+			float den = e1b * e2c - e2b * e1c;
+			if (fabs(den) < 1e-12f) {
+				continue;
+			}
+
+			float tri_min_b = std::min(p0.a1d[b], std::min(p1.a1d[b], p2.a1d[b]));
+			float tri_max_b = std::max(p0.a1d[b], std::max(p1.a1d[b], p2.a1d[b]));
+			float tri_min_c = std::min(p0.a1d[c], std::min(p1.a1d[c], p2.a1d[c]));
+			float tri_max_c = std::max(p0.a1d[c], std::max(p1.a1d[c], p2.a1d[c]));
+
+			// only the rays which pass the bounds of the triangle can hit it
+			int jb0 = std::max(0, static_cast<int>(ceilf((tri_min_b - min->a1d[b] - jitter_b) / cell[b])));
+			int jb1 = std::min(n[b], static_cast<int>(floorf((tri_max_b - min->a1d[b] - jitter_b) / cell[b])));
+			int jc0 = std::max(0, static_cast<int>(ceilf((tri_min_c - min->a1d[c] - jitter_c) / cell[c])));
+			int jc1 = std::min(n[c], static_cast<int>(floorf((tri_max_c - min->a1d[c] - jitter_c) / cell[c])));
+
+			for (int jc = jc0; jc <= jc1; ++jc) {
+				float qc = min->a1d[c] + jc * cell[c] + jitter_c - p0.a1d[c];
+
+				for (int jb = jb0; jb <= jb1; ++jb) {
+					float qb = min->a1d[b] + jb * cell[b] + jitter_b - p0.a1d[b];
+
+					float u = (qb * e2c - e2b * qc) / den;
+					float v = (e1b * qc - qb * e1c) / den;
+
+					if (u < 0.0f || v < 0.0f || u + v > 1.0f) {
+						continue;
+					}
+
+					float hit = p0.a1d[a] + u * (p1.a1d[a] - p0.a1d[a]) + v * (p2.a1d[a] - p0.a1d[a]);
+					hits[jc * (n[b] + 1) + jb].push_back(hit);
+				}
+			}
+		}
+
+		for (int jc = 0; jc <= n[c]; ++jc) {
+			for (int jb = 0; jb <= n[b]; ++jb) {
+				auto& line = hits[jc * (n[b] + 1) + jb];
+				std::sort(line.begin(), line.end());
+
+				for (int i = 0; i <= n[a]; ++i) {
+					float pos = min->a1d[a] + i * cell[a] + jitter_a;
+					auto crossings = std::lower_bound(line.begin(), line.end(), pos) - line.begin();
+
+					if (crossings & 1) {
+						int corner[3];
+						corner[a] = i;
+						corner[b] = jb;
+						corner[c] = jc;
+						++votes[corner_index(corner[0], corner[1], corner[2])];
+					}
+				}
+			}
+		}
+	}
+
+	// a cell is solid if all of its corners are inside and the hull does not pass through it
+	SCP_vector<ubyte> solid(n[0] * n[1] * n[2], 0);
+	for (int k = 0; k < n[2]; ++k) {
+		for (int j = 0; j < n[1]; ++j) {
+			for (int i = 0; i < n[0]; ++i) {
+				bool inside = !crossed[voxel_index(i, j, k)];
+				for (int corner = 0; corner < 8 && inside; ++corner) {
+					inside = votes[corner_index(i + (corner & 1), j + ((corner >> 1) & 1), k + ((corner >> 2) & 1))] >= 2;
+				}
+				solid[voxel_index(i, j, k)] = inside ? 1 : 0;
+			}
+		}
+	}
+
+	// merge the solid cells into boxes by growing each one along x, then y, then z
+	SCP_vector<grid_box> boxes;
+	for (int k = 0; k < n[2]; ++k) {
+		for (int j = 0; j < n[1]; ++j) {
+			for (int i = 0; i < n[0]; ++i) {
+				if (!solid[voxel_index(i, j, k)]) {
+					continue;
+				}
+
+				int ex = i + 1;
+				while (ex < n[0] && solid[voxel_index(ex, j, k)]) {
+					++ex;
+				}
+
+				auto row_solid = [&](int y, int z) {
+					for (int x = i; x < ex; ++x) {
+						if (!solid[voxel_index(x, y, z)]) {
+							return false;
+						}
+					}
+					return true;
+				};
+
+				int ey = j + 1;
+				while (ey < n[1] && row_solid(ey, k)) {
+					++ey;
+				}
+
+				int ez = k + 1;
+				while (ez < n[2]) {
+					bool layer_solid = true;
+					for (int y = j; y < ey && layer_solid; ++y) {
+						layer_solid = row_solid(y, ez);
+					}
+					if (!layer_solid) {
+						break;
+					}
+					++ez;
+				}
+
+				for (int z = k; z < ez; ++z) {
+					for (int y = j; y < ey; ++y) {
+						for (int x = i; x < ex; ++x) {
+							solid[voxel_index(x, y, z)] = 0;
+						}
+					}
+				}
+
+				grid_box box = {{i, j, k}, {ex, ey, ez}, (ex - i) * (ey - j) * (ez - k)};
+				boxes.push_back(box);
+			}
+		}
+	}
+
+	std::stable_sort(boxes.begin(), boxes.end(), [](const grid_box& l, const grid_box& r) { return l.volume > r.volume; });
+	if (boxes.size() > static_cast<size_t>(max_boxes)) {
+		boxes.resize(max_boxes);
+	}
+
+	for (const auto& box : boxes) {
+		vec3d box_min, box_max;
+		for (int a = 0; a < 3; ++a) {
+			box_min.a1d[a] = min->a1d[a] + box.min[a] * cell[a];
+			box_max.a1d[a] = min->a1d[a] + box.max[a] * cell[a];
+		}
+
+		add_box(out, &box_min, &box_max);
+	}
+}
+
+void occlusion_buffer::begin(const vec3d* view_pos, const matrix* view_orient)
+{
+	View_pos = *view_pos;
+	View_orient = *view_orient;
+	Num_occluders = 0;
+
+	Levels.resize(1);
+	Levels[0].assign(WIDTH * HEIGHT, 0.0f);
+}
+
+void occlusion_buffer::add_occluder(const occluder_mesh& mesh, const vec3d* pos, const matrix* orient)
+{
+	if (mesh.empty()) {
+		return;
+	}
+
+	vec3d tmp, eye_local;
+	vm_vec_sub(&tmp, &View_pos, pos);
+	vm_vec_rotate(&eye_local, &tmp, orient);
+
+	for (size_t box = 0; box + 7 < mesh.verts.size(); box += 8) {
+		const auto& min = mesh.verts[box];
+		const auto& max = mesh.verts[box + 7];
+
+		// the hull around the viewer is not drawn from the inside, so nothing is hidden behind it
+		if (eye_local.xyz.x >= min.xyz.x && eye_local.xyz.x <= max.xyz.x && eye_local.xyz.y >= min.xyz.y
+			&& eye_local.xyz.y <= max.xyz.y && eye_local.xyz.z >= min.xyz.z && eye_local.xyz.z <= max.xyz.z) {
+			continue;
+		}
+
+		vec3d corners[8];
+		for (int i = 0; i < 8; ++i) {
+			vec3d world;
+			vm_vec_unrotate(&world, &mesh.verts[box + i], orient);
+			vm_vec_add2(&world, pos);
+			vm_vec_sub(&tmp, &world, &View_pos);
+			vm_vec_rotate(&corners[i], &tmp, &View_orient);
+		}
+
+		rasterize_box(corners);
+	}
+
+	++Num_occluders;
+}
+
+void occlusion_buffer::rasterize_box(const vec3d* corners)
+{
+	// the part of the box in front of the near plane is convex, so it covers the convex hull of its corners and of the
+	// points where its edges cross the near plane
+	screen_point points[8 + 12];
+	int num_points = 0;
+
+	auto project = [&](const vec3d& v) {
+		float w = 1.0f / v.xyz.z;
+		points[num_points].x = buffer_x(v.xyz.x * w);
+		points[num_points].y = buffer_y(v.xyz.y * w);
+		points[num_points].w = w;
+		++num_points;
+	};
+
+	for (int i = 0; i < 8; ++i) {
+		if (corners[i].xyz.z >= Occlusion_near_z) {
+			project(corners[i]);
+		}
+	}
+
+	for (int bit = 1; bit < 8; bit <<= 1) {
+		for (int i = 0; i < 8; ++i) {
+			if (i & bit) {
+				continue;
+			}
+
+			const auto& a = corners[i];
+			const auto& b = corners[i | bit];
+
+			if ((a.xyz.z >= Occlusion_near_z) != (b.xyz.z >= Occlusion_near_z)) {
+				vec3d delta, crossing;
+				vm_vec_sub(&delta, &b, &a);
+				vm_vec_scale_add(&crossing, &a, &delta, (Occlusion_near_z - a.xyz.z) / delta.xyz.z);
+				crossing.xyz.z = Occlusion_near_z;
+				project(crossing);
+			}
+		}
+	}
+
+	if (num_points < 3) {
+		return;
+	}
+
+	// nothing in front of the farthest point of the box is hidden by it
+	float w = points[0].w;
+	float min_x = points[0].x;
+	float max_x = points[0].x;
+	float min_y = points[0].y;
+	float max_y = points[0].y;
+
+	for (int i = 1; i < num_points; ++i) {
+		w = std::min(w, points[i].w);
+		min_x = std::min(min_x, points[i].x);
+		max_x = std::max(max_x, points[i].x);
+		min_y = std::min(min_y, points[i].y);
+		max_y = std::max(max_y, points[i].y);
+	}
+
+	screen_point hull[8 + 12 + 1];
+	int num_hull = convex_hull(points, num_points, hull);
+	if (num_hull < 3) {
+		return;
+	}
+
+	int x0 = std::max(0, static_cast<int>(floorf(min_x)));
+	int x1 = std::min(WIDTH - 1, static_cast<int>(floorf(max_x)));
+	int y0 = std::max(0, static_cast<int>(floorf(min_y)));
+	int y1 = std::min(HEIGHT - 1, static_cast<int>(floorf(max_y)));
+
+	auto& depth = Levels[0];
+
+	for (int y = y0; y <= y1; ++y) {
+		for (int x = x0; x <= x1; ++x) {
+			// only the pixels which lie inside every edge with all of their area, tested at the corner closest to it
+			bool covered = true;
+			for (int i = 0; i < num_hull && covered; ++i) {
+				const auto& a = hull[i];
+				const auto& b = hull[(i + 1) % num_hull];
+
+				float dx = b.x - a.x;
+				float dy = b.y - a.y;
+				float edge = dx * (y - a.y) - dy * (x - a.x) + std::min(dx, 0.0f) - std::max(dy, 0.0f);
+
+				covered = edge >= 0.0f;
+			}
+
+			if (!covered) {
+				continue;
+			}
+
+			auto& pixel = depth[y * WIDTH + x];
+			if (w > pixel) {
+				pixel = w;
+			}
+		}
+	}
+}
+
+void occlusion_buffer::finish()
+{
+	TRACE_SCOPE(tracing::BuildOcclusionPyramid);
+
+	int level = 0;
+	while (level_width(level) > 1 || level_height(level) > 1) {
+		++level;
+
+		int width = level_width(level);
+		int height = level_height(level);
+		int child_width = level_width(level - 1);
+		int child_height = level_height(level - 1);
+
+		Levels.resize(level + 1);
+		auto& texels = Levels[level];
+		const auto& children = Levels[level - 1];
+
+		texels.resize(width * height);
+
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; ++x) {
+				float farthest = children[(2 * y) * child_width + 2 * x];
+
+				if (2 * x + 1 < child_width) {
+					farthest = std::min(farthest, children[(2 * y) * child_width + 2 * x + 1]);
+				}
+				if (2 * y + 1 < child_height) {
+					farthest = std::min(farthest, children[(2 * y + 1) * child_width + 2 * x]);
+
+					if (2 * x + 1 < child_width) {
+						farthest = std::min(farthest, children[(2 * y + 1) * child_width + 2 * x + 1]);
+					}
+				}
+
+				texels[y * width + x] = farthest;
+			}
+		}
+	}
+}
+
+bool occlusion_buffer::texel_occluded(int level, int x, int y, int x0, int y0, int x1, int y1, float w) const
+{
+	if (Levels[level][y * level_width(level) + x] > w) {
+		return true;
+	}
+
+	if (level == 0) {
+		return false;
+	}
+
+	// the tile is not behind the occluders as a whole, maybe the part of it the sphere covers is
+	int child_level = level - 1;
+
+	for (int cy = 2 * y; cy <= 2 * y + 1 && cy < level_height(child_level); ++cy) {
+		if ((cy << child_level) > y1 || ((cy + 1) << child_level) - 1 < y0) {
+			continue;
+		}
+
+		for (int cx = 2 * x; cx <= 2 * x + 1 && cx < level_width(child_level); ++cx) {
+			if ((cx << child_level) > x1 || ((cx + 1) << child_level) - 1 < x0) {
+				continue;
+			}
+
+			if (!texel_occluded(child_level, cx, cy, x0, y0, x1, y1, w)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool occlusion_buffer::sphere_occluded(const vec3d* pos, float radius) const
+{
+	if (Num_occluders == 0 || Levels.size() < 2) {
+		return false;
+	}
+
+	vec3d tmp, center;
+	vm_vec_sub(&tmp, pos, &View_pos);
+	vm_vec_rotate(&center, &tmp, &View_orient);
+
+	// the sphere is an axis aligned ellipsoid in view space since the rows of the view matrix are scaled
+	float ex = radius * vm_vec_mag(&View_orient.vec.rvec);
+	float ey = radius * vm_vec_mag(&View_orient.vec.uvec);
+	float ez = radius * vm_vec_mag(&View_orient.vec.fvec);
+
+	float near_z = center.xyz.z - ez;
+	float far_z = center.xyz.z + ez;
+
+	if (near_z <= Occlusion_near_z) {
+		return false;
+	}
+
+	// bounds of the projected box around the ellipsoid
+	float min_x = center.xyz.x - ex;
+	float max_x = center.xyz.x + ex;
+	float min_y = center.xyz.y - ey;
+	float max_y = center.xyz.y + ey;
+
+	float left = min_x / (min_x < 0.0f ? near_z : far_z);
+	float right = max_x / (max_x > 0.0f ? near_z : far_z);
+	float bottom = min_y / (min_y < 0.0f ? near_z : far_z);
+	float top = max_y / (max_y > 0.0f ? near_z : far_z);
+
+	// one more pixel on every side since only the pixels whose centers an occluder covers are written
+	int x0 = static_cast<int>(floorf(buffer_x(left))) - 1;
+	int x1 = static_cast<int>(floorf(buffer_x(right))) + 1;
+	int y0 = static_cast<int>(floorf(buffer_y(top))) - 1;
+	int y1 = static_cast<int>(floorf(buffer_y(bottom))) + 1;
+
+	x0 = std::max(x0, 0);
+	y0 = std::max(y0, 0);
+	x1 = std::min(x1, WIDTH - 1);
+	y1 = std::min(y1, HEIGHT - 1);
+
+	if (x0 > x1 || y0 > y1) {
+		return false;
+	}
+
+	float w = 1.0f / near_z;
+
+	// start at the level where the bounds span at most two texels in each direction
+	int level = 0;
+	while (level + 1 < static_cast<int>(Levels.size())
+		&& ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)) {
+		++level;
+	}
+
+	for (int y = y0 >> level; y <= (y1 >> level); ++y) {
+		for (int x = x0 >> level; x <= (x1 >> level); ++x) {
+			if (!texel_occluded(level, x, y, x0, y0, x1, y1, w)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
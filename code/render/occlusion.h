@@ -0,0 +1,54 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+#include "math/vecmat.h"
+
+// A simplified mesh made of boxes which lie inside the hull of a model. The objects behind it can be skipped before
+// they are queued for rendering.
+struct occluder_mesh {
+	SCP_vector<vec3d> verts;	// the eight corners of every box, numbered by their x, y and z bits
+
+	int get_num_boxes() const { return static_cast<int>(verts.size() / 8); }
+	bool empty() const { return verts.empty(); }
+	void clear();
+};
+
+// Fills the inside of a closed hull with boxes on a grid with resolution cells along the longest side of min and max and
+// turns the max_boxes largest ones into an occluder. tri_verts holds three vertices per triangle of the hull.
+void occluder_build(occluder_mesh* out, const SCP_vector<vec3d>& tri_verts, const vec3d* min, const vec3d* max,
+	int resolution, int max_boxes);
+
+// A low resolution depth buffer which occluders are rasterized into on the CPU, and a pyramid of the farthest depth
+// of each of its tiles which spheres are tested against
+class occlusion_buffer {
+  public:
+	static const int WIDTH = 256;
+	static const int HEIGHT = 128;
+
+	// The view is the same as View_position and View_matrix, the rows of the orientation are scaled by the field of view
+	void begin(const vec3d* view_pos, const matrix* view_orient);
+
+	// Every box is rasterized into the pixels it covers completely, at the depth of its farthest corner. The boxes
+	// the viewer is inside of are skipped.
+	void add_occluder(const occluder_mesh& mesh, const vec3d* pos, const matrix* orient);
+
+	// Builds the depth pyramid, must be called after the last occluder was added and before the first test
+	void finish();
+
+	// True if the whole sphere is behind the occluders
+	bool sphere_occluded(const vec3d* pos, float radius) const;
+
+	int get_num_occluders() const { return Num_occluders; }
+
+  private:
+	void rasterize_box(const vec3d* corners);
+	bool texel_occluded(int level, int x, int y, int x0, int y0, int x1, int y1, float w) const;
+
+	vec3d View_pos = vmd_zero_vector;
+	matrix View_orient = vmd_identity_matrix;
+	int Num_occluders = 0;
+
+	// level 0 holds the nearest depth of each pixel, every further level the farthest depth of four texels of the
+	// one before it, all stored as 1 / depth so that nothing rasterized there is 0
+	SCP_vector<SCP_vector<float>> Levels;
+};
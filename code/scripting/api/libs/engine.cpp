@@ -52,6 +52,7 @@ ADE_FUNC(addHook,
 
 	action.hook.hook_function.language = SC_LUA;
 	action.hook.hook_function.function = std::move(hook);
+	action.trace_category = Script_system.GetHookTraceCategory(SCP_string("engine.addHook - ") + hook_name);
 
 	if (override_func.isValid()) {
 		action.hook.override_function.language = SC_LUA;
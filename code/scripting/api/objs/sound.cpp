@@ -144,7 +144,7 @@ bool sound_h::isValid() const
 {
 	// We can have both regular and raw file sounds here, so the sound itself
 	// can be valid even if the soundentry is not.
-	if (!sig.isValid() || ds_get_channel(sig) < 0)
+	if (!sig.isValid() || (ds_get_channel(sig) < 0 && !ds_is_virtual(sig)))
 		return false;
 
 	return true;
@@ -19,6 +19,12 @@
 	build.emplace(conditionParseName, ::make_unique<ParseableConditionImpl<conditionsClassName, \
 		decltype(std::declval<conditionsClassName>().argument), decltype(argumentParse(std::declval<SCP_string>()))>> \
 		(documentation, &conditionsClassName::argument, argumentParse, argumentValid))
+// Like HOOK_CONDITION but also buckets the hooks using the condition by the parsed value so that only hooks which can
+// match need to be checked. argumentKeys must list every parsed value for which argumentValid can be true.
+#define HOOK_CONDITION_INDEXED(conditionsClassName, conditionParseName, documentation, argument, argumentParse, argumentValid, selectivity, argumentKeys) \
+	build.emplace(conditionParseName, ::make_unique<ParseableConditionImpl<conditionsClassName, \
+		decltype(std::declval<conditionsClassName>().argument), decltype(argumentParse(std::declval<SCP_string>()))>> \
+		(documentation, &conditionsClassName::argument, argumentParse, argumentValid, selectivity, argumentKeys))
 
 extern const char *Scan_code_text_english[];
 
@@ -32,6 +38,8 @@ class ParseableConditionImpl : public ParseableCondition {
 	const operating_t conditions_t::* object;
 	std::function<cache_t(const SCP_string&)> cache;
 	std::function<bool(operating_t, const cache_t&)> evaluate;
+	int selectivity;
+	std::function<void(operating_t, SCP_vector<int>&)> keys;
 
 	template<typename _conditions_t, typename _operating_t, typename _cache_t> friend class EvaluatableConditionImpl;
 public:
@@ -39,8 +47,20 @@ public:
 		return ::make_unique<EvaluatableConditionImpl<conditions_t, operating_t, cache_t>>(*this, input);
 	}
 
-	ParseableConditionImpl(SCP_string documentation_, const operating_t conditions_t::* object_, std::function<cache_t(const SCP_string&)> cache_, std::function<bool(operating_t, const cache_t&)> evaluate_) :
-		ParseableCondition(std::move(documentation_)), object(object_), cache(std::move(cache_)), evaluate(std::move(evaluate_)) { }
+	int getIndexSelectivity() const override {
+		return selectivity;
+	}
+
+	void getIndexKeys(const std::any& conditionContext, SCP_vector<int>& keys_out) const override {
+		const conditions_t& conditions = std::any_cast<const conditions_t&>(conditionContext);
+		keys(conditions.*object, keys_out);
+	}
+
+	ParseableConditionImpl(SCP_string documentation_, const operating_t conditions_t::* object_, std::function<cache_t(const SCP_string&)> cache_, std::function<bool(operating_t, const cache_t&)> evaluate_,
+		int selectivity_ = 0, std::function<void(operating_t, SCP_vector<int>&)> keys_ = nullptr) :
+		ParseableCondition(std::move(documentation_)), object(object_), cache(std::move(cache_)), evaluate(std::move(evaluate_)), selectivity(selectivity_), keys(std::move(keys_)) {
+		Assertion(selectivity == 0 || keys, "Indexed hook conditions must provide their keys!");
+	}
 };
 
 template<typename conditions_t, typename operating_t, typename cache_t>
@@ -52,9 +72,20 @@ public:
 	EvaluatableConditionImpl(const ParseableConditionImpl<conditions_t, operating_t, cache_t>& _condition, const SCP_string& input) : condition(_condition), cached(condition.cache(input)) { }
 
 	bool evaluate(const std::any& conditionContext) const override {
-		const conditions_t& conditions = std::any_cast<conditions_t>(conditionContext);
+		const conditions_t& conditions = std::any_cast<const conditions_t&>(conditionContext);
 		return condition.evaluate(conditions.*(condition.object), cached);
 	}
+
+	bool getIndexKey(const ParseableCondition*& condition_out, int& key) const override {
+		if constexpr (std::is_same<cache_t, int>::value) {
+			if (condition.selectivity > 0) {
+				condition_out = &condition;
+				key = cached;
+				return true;
+			}
+		}
+		return false;
+	}
 };
 
 
@@ -116,6 +147,53 @@ static int conditionCompareRawControl(int keypress, const int& cached_key) {
 	return cached_key == key_down;
 }
 
+// ---- Hook Condition Index Keys ----
+
+// How much an indexed condition narrows down the hooks to check. Object types only split hooks into a few buckets.
+static constexpr int INDEX_OBJECT_TYPE = 1;
+static constexpr int INDEX_SHIP_TYPE = 2;
+static constexpr int INDEX_CLASS = 3;
+
+static void conditionKeysShipType(const ship* shipp, SCP_vector<int>& keys) {
+	if (shipp != nullptr)
+		keys.push_back(Ship_info[shipp->ship_info_index].class_type);
+}
+
+static void conditionKeysShipClass(const ship* shipp, SCP_vector<int>& keys) {
+	if (shipp != nullptr)
+		keys.push_back(shipp->ship_info_index);
+}
+
+static void conditionKeysWeaponClass(const weapon* wep, SCP_vector<int>& keys) {
+	if (wep != nullptr)
+		keys.push_back(wep->weapon_info_index);
+}
+
+static void conditionKeysObjecttype(const object* objp, SCP_vector<int>& keys) {
+	if (objp != nullptr)
+		keys.push_back(objp->type);
+}
+
+template<typename fnc_t>
+static void conditionKeysObjectIsShip(fnc_t fnc, const object* objp, SCP_vector<int>& keys) {
+	if (objp != nullptr && objp->type == OBJ_SHIP)
+		fnc(&Ships[objp->instance], keys);
+}
+
+template<typename fnc_t>
+static void conditionKeysObjectIsWeapon(fnc_t fnc, const object* objp, SCP_vector<int>& keys) {
+	if (objp != nullptr && objp->type == OBJ_WEAPON)
+		fnc(&Weapons[objp->instance], keys);
+}
+
+static void conditionKeysWeaponClassList(const SCP_vector<int>& weaponclass_list, SCP_vector<int>& keys) {
+	keys.insert(keys.end(), weaponclass_list.cbegin(), weaponclass_list.cend());
+}
+
+static void conditionKeysInt(int value, SCP_vector<int>& keys) {
+	keys.push_back(value);
+}
+
 
 static SCP_string conditionParseString(const SCP_string& name) {
 	return name;
@@ -161,18 +239,22 @@ static int conditionParseRawControl(const SCP_string& name) {
 
 #define HOOK_CONDITION_SHIPP(classname, prefix, documentationAddendum, shipp) \
 	HOOK_CONDITION(classname, prefix "Ship", "Specifies the name of the ship " documentationAddendum, shipp, conditionParseString, conditionCompareShip); \
-	HOOK_CONDITION(classname, prefix "Ship class", "Specifies the class of the ship " documentationAddendum, shipp, conditionParseShipClass, conditionCompareShipClass); \
-	HOOK_CONDITION(classname, prefix "Ship type", "Specifies the type of the ship " documentationAddendum, shipp, conditionParseShipType, conditionCompareShipType); 
+	HOOK_CONDITION_INDEXED(classname, prefix "Ship class", "Specifies the class of the ship " documentationAddendum, shipp, conditionParseShipClass, conditionCompareShipClass, INDEX_CLASS, conditionKeysShipClass); \
+	HOOK_CONDITION_INDEXED(classname, prefix "Ship type", "Specifies the type of the ship " documentationAddendum, shipp, conditionParseShipType, conditionCompareShipType, INDEX_SHIP_TYPE, conditionKeysShipType); 
 
 #define HOOK_CONDITION_SHIP_OBJP(classname, prefix, documentationAddendum, objp_) \
 	HOOK_CONDITION(classname, prefix "Ship", "Specifies the name of the ship " documentationAddendum, objp_, conditionParseString, [](const object* objp, const SCP_string& shipname) -> bool { \
 		return conditionObjectIsShipDo(&conditionCompareShip, objp, shipname); \
 	}); \
-	HOOK_CONDITION(classname, prefix "Ship class", "Specifies the class of the ship " documentationAddendum, objp_, conditionParseShipClass, [](const object* objp, const int& shipclass) -> bool { \
+	HOOK_CONDITION_INDEXED(classname, prefix "Ship class", "Specifies the class of the ship " documentationAddendum, objp_, conditionParseShipClass, [](const object* objp, const int& shipclass) -> bool { \
 		return conditionObjectIsShipDo(&conditionCompareShipClass, objp, shipclass); \
+	}, INDEX_CLASS, [](const object* objp, SCP_vector<int>& keys) { \
+		conditionKeysObjectIsShip(&conditionKeysShipClass, objp, keys); \
 	}); \
-	HOOK_CONDITION(classname, prefix "Ship type", "Specifies the type of the ship " documentationAddendum, objp_, conditionParseShipType, [](const object* objp, const int& shiptype) -> bool { \
+	HOOK_CONDITION_INDEXED(classname, prefix "Ship type", "Specifies the type of the ship " documentationAddendum, objp_, conditionParseShipType, [](const object* objp, const int& shiptype) -> bool { \
 		return conditionObjectIsShipDo(&conditionCompareShipType, objp, shiptype); \
+	}, INDEX_SHIP_TYPE, [](const object* objp, SCP_vector<int>& keys) { \
+		conditionKeysObjectIsShip(&conditionKeysShipType, objp, keys); \
 	});
 
 // ---- Hook Conditions ----
@@ -198,33 +280,45 @@ HOOK_CONDITIONS_START(CollisionConditions)
 			return true;
 		return false;
 	});
-	HOOK_CONDITION(CollisionConditions, "Ship class", "Specifies the class of the ship which was part of the collision. At least one ship must be part of the collision and match.", participating_objects, conditionParseShipClass, [](CollisionConditions::ParticipatingObjects po, const int& shipclass) -> bool {
+	HOOK_CONDITION_INDEXED(CollisionConditions, "Ship class", "Specifies the class of the ship which was part of the collision. At least one ship must be part of the collision and match.", participating_objects, conditionParseShipClass, [](CollisionConditions::ParticipatingObjects po, const int& shipclass) -> bool {
 		if (conditionObjectIsShipDo(&conditionCompareShipClass, po.objp_a, shipclass))
 			return true;
 		if (conditionObjectIsShipDo(&conditionCompareShipClass, po.objp_b, shipclass))
 			return true;
 		return false;
+	}, INDEX_CLASS, [](CollisionConditions::ParticipatingObjects po, SCP_vector<int>& keys) {
+		conditionKeysObjectIsShip(&conditionKeysShipClass, po.objp_a, keys);
+		conditionKeysObjectIsShip(&conditionKeysShipClass, po.objp_b, keys);
 	});
-	HOOK_CONDITION(CollisionConditions, "Ship type", "Specifies the type of the ship which was part of the collision. At least one ship must be part of the collision and match.", participating_objects, conditionParseShipType, [](CollisionConditions::ParticipatingObjects po, const int& shiptype) -> bool {
+	HOOK_CONDITION_INDEXED(CollisionConditions, "Ship type", "Specifies the type of the ship which was part of the collision. At least one ship must be part of the collision and match.", participating_objects, conditionParseShipType, [](CollisionConditions::ParticipatingObjects po, const int& shiptype) -> bool {
 		if (conditionObjectIsShipDo(&conditionCompareShipType, po.objp_a, shiptype))
 			return true;
 		if (conditionObjectIsShipDo(&conditionCompareShipType, po.objp_b, shiptype))
 			return true;
 		return false;
+	}, INDEX_SHIP_TYPE, [](CollisionConditions::ParticipatingObjects po, SCP_vector<int>& keys) {
+		conditionKeysObjectIsShip(&conditionKeysShipType, po.objp_a, keys);
+		conditionKeysObjectIsShip(&conditionKeysShipType, po.objp_b, keys);
 	});
-	HOOK_CONDITION(CollisionConditions, "Weapon class", "Specifies the name of the weapon class which was part of the collision. At least one weapon must be part of the collision and match.", participating_objects, conditionParseWeaponClass, [](CollisionConditions::ParticipatingObjects po, const int& weaponclass) -> bool {
+	HOOK_CONDITION_INDEXED(CollisionConditions, "Weapon class", "Specifies the name of the weapon class which was part of the collision. At least one weapon must be part of the collision and match.", participating_objects, conditionParseWeaponClass, [](CollisionConditions::ParticipatingObjects po, const int& weaponclass) -> bool {
 		if (conditionObjectIsWeaponDo(&conditionCompareWeaponClass, po.objp_a, weaponclass))
 			return true;
 		if (conditionObjectIsWeaponDo(&conditionCompareWeaponClass, po.objp_b, weaponclass))
 			return true;
 		return false;
+	}, INDEX_CLASS, [](CollisionConditions::ParticipatingObjects po, SCP_vector<int>& keys) {
+		conditionKeysObjectIsWeapon(&conditionKeysWeaponClass, po.objp_a, keys);
+		conditionKeysObjectIsWeapon(&conditionKeysWeaponClass, po.objp_b, keys);
 	});
-	HOOK_CONDITION(CollisionConditions, "Object type", "Specifies the type of the object which was part of the collision. At least one object must match.", participating_objects, conditionParseObjectType, [](CollisionConditions::ParticipatingObjects po, const int& objecttype) -> bool {
+	HOOK_CONDITION_INDEXED(CollisionConditions, "Object type", "Specifies the type of the object which was part of the collision. At least one object must match.", participating_objects, conditionParseObjectType, [](CollisionConditions::ParticipatingObjects po, const int& objecttype) -> bool {
 		if (conditionIsObjecttype(po.objp_a, objecttype))
 			return true;
 		if (conditionIsObjecttype(po.objp_b, objecttype))
 			return true;
 		return false;
+	}, INDEX_OBJECT_TYPE, [](CollisionConditions::ParticipatingObjects po, SCP_vector<int>& keys) {
+		conditionKeysObjecttype(po.objp_a, keys);
+		conditionKeysObjecttype(po.objp_b, keys);
 	});
 HOOK_CONDITIONS_END
 
@@ -241,15 +335,17 @@ HOOK_CONDITIONS_START(ShipDepartConditions)
 HOOK_CONDITIONS_END
 
 HOOK_CONDITIONS_START(WeaponDeathConditions)
-	HOOK_CONDITION(WeaponDeathConditions, "Weapon class", "Specifies the class of the weapon that died.", dying_wep, conditionParseWeaponClass, conditionCompareWeaponClass);
+	HOOK_CONDITION_INDEXED(WeaponDeathConditions, "Weapon class", "Specifies the class of the weapon that died.", dying_wep, conditionParseWeaponClass, conditionCompareWeaponClass, INDEX_CLASS, conditionKeysWeaponClass);
 HOOK_CONDITIONS_END
 
 HOOK_CONDITIONS_START(ObjectDeathConditions)
 	HOOK_CONDITION_SHIP_OBJP(ObjectDeathConditions, "", "that died.", dying_objp);
-	HOOK_CONDITION(ObjectDeathConditions, "Weapon class", "Specifies the class of the weapon that died.", dying_objp, conditionParseWeaponClass, [](const object* objp, const int& weaponclass) -> bool {
+	HOOK_CONDITION_INDEXED(ObjectDeathConditions, "Weapon class", "Specifies the class of the weapon that died.", dying_objp, conditionParseWeaponClass, [](const object* objp, const int& weaponclass) -> bool {
 		return conditionObjectIsWeaponDo(&conditionCompareWeaponClass, objp, weaponclass);
+	}, INDEX_CLASS, [](const object* objp, SCP_vector<int>& keys) {
+		conditionKeysObjectIsWeapon(&conditionKeysWeaponClass, objp, keys);
 	});
-	HOOK_CONDITION(ObjectDeathConditions, "Object type", "Specifies the type of the object that died.", dying_objp, conditionParseObjectType, conditionIsObjecttype);
+	HOOK_CONDITION_INDEXED(ObjectDeathConditions, "Object type", "Specifies the type of the object that died.", dying_objp, conditionParseObjectType, conditionIsObjecttype, INDEX_OBJECT_TYPE, conditionKeysObjecttype);
 HOOK_CONDITIONS_END
 
 HOOK_CONDITIONS_START(ShipArriveConditions)
@@ -258,8 +354,8 @@ HOOK_CONDITIONS_END
 
 HOOK_CONDITIONS_START(WeaponCreatedConditions)
 	HOOK_CONDITION_SHIP_OBJP(WeaponCreatedConditions, "", "that fired the weapon.", parent_objp);
-	HOOK_CONDITION(WeaponCreatedConditions, "Object type", "Specifies the type of the object that is the parent of this weapon.", parent_objp, conditionParseObjectType, conditionIsObjecttype);
-	HOOK_CONDITION(WeaponCreatedConditions, "Weapon class", "Specifies the class of the weapon that was fired.", spawned_wep, conditionParseWeaponClass, conditionCompareWeaponClass);
+	HOOK_CONDITION_INDEXED(WeaponCreatedConditions, "Object type", "Specifies the type of the object that is the parent of this weapon.", parent_objp, conditionParseObjectType, conditionIsObjecttype, INDEX_OBJECT_TYPE, conditionKeysObjecttype);
+	HOOK_CONDITION_INDEXED(WeaponCreatedConditions, "Weapon class", "Specifies the class of the weapon that was fired.", spawned_wep, conditionParseWeaponClass, conditionCompareWeaponClass, INDEX_CLASS, conditionKeysWeaponClass);
 HOOK_CONDITIONS_END
 
 HOOK_CONDITIONS_START(WeaponEquippedConditions)
@@ -279,27 +375,29 @@ HOOK_CONDITIONS_END
 
 HOOK_CONDITIONS_START(WeaponUsedConditions)
 	HOOK_CONDITION_SHIPP(WeaponUsedConditions, "", "that fired the weapon.", user_shipp);
-	HOOK_CONDITION(WeaponUsedConditions, "Weapon class", "Specifies the class of the weapon that was fired.", weaponclasses, conditionParseWeaponClass, [](const SCP_vector<int>& weaponclass_list, const int& weaponclass) -> bool {
+	HOOK_CONDITION_INDEXED(WeaponUsedConditions, "Weapon class", "Specifies the class of the weapon that was fired.", weaponclasses, conditionParseWeaponClass, [](const SCP_vector<int>& weaponclass_list, const int& weaponclass) -> bool {
 		return std::count(weaponclass_list.cbegin(), weaponclass_list.cend(), weaponclass) > 0;
-	});
+	}, INDEX_CLASS, conditionKeysWeaponClassList);
 HOOK_CONDITIONS_END
 
 HOOK_CONDITIONS_START(WeaponSelectedConditions)
 	HOOK_CONDITION_SHIPP(WeaponSelectedConditions, "", "that has selected the weapon.", user_shipp);
-	HOOK_CONDITION(WeaponSelectedConditions, "Weapon class", "Specifies the class of the weapon that was selected.", weaponclass, conditionParseWeaponClass, std::equal_to<int>());
+	HOOK_CONDITION_INDEXED(WeaponSelectedConditions, "Weapon class", "Specifies the class of the weapon that was selected.", weaponclass, conditionParseWeaponClass, std::equal_to<int>(), INDEX_CLASS, conditionKeysInt);
 HOOK_CONDITIONS_END
 
 HOOK_CONDITIONS_START(WeaponDeselectedConditions)
 	HOOK_CONDITION_SHIPP(WeaponDeselectedConditions, "", "that has deselected the weapon.", user_shipp);
-	HOOK_CONDITION(WeaponDeselectedConditions, "Weapon class", "Specifies the class of the weapon that was deselected.", weaponclass_prev, conditionParseWeaponClass, std::equal_to<int>());
+	HOOK_CONDITION_INDEXED(WeaponDeselectedConditions, "Weapon class", "Specifies the class of the weapon that was deselected.", weaponclass_prev, conditionParseWeaponClass, std::equal_to<int>(), INDEX_CLASS, conditionKeysInt);
 HOOK_CONDITIONS_END
 
 HOOK_CONDITIONS_START(ObjectDrawConditions)
 	HOOK_CONDITION_SHIP_OBJP(ObjectDrawConditions, "", "that was drawn / drawn from.", drawn_from_objp);
-	HOOK_CONDITION(ObjectDrawConditions, "Weapon class", "Specifies the class of the weapon that was drawn / drawn from.", drawn_from_objp, conditionParseWeaponClass, [](const object* objp, const int& weaponclass) -> bool {
+	HOOK_CONDITION_INDEXED(ObjectDrawConditions, "Weapon class", "Specifies the class of the weapon that was drawn / drawn from.", drawn_from_objp, conditionParseWeaponClass, [](const object* objp, const int& weaponclass) -> bool {
 		return conditionObjectIsWeaponDo(&conditionCompareWeaponClass, objp, weaponclass);
+	}, INDEX_CLASS, [](const object* objp, SCP_vector<int>& keys) {
+		conditionKeysObjectIsWeapon(&conditionKeysWeaponClass, objp, keys);
 	});
-	HOOK_CONDITION(ObjectDrawConditions, "Object type", "Specifies the type of the object that was drawn / drawn from.", drawn_from_objp, conditionParseObjectType, conditionIsObjecttype);
+	HOOK_CONDITION_INDEXED(ObjectDrawConditions, "Object type", "Specifies the type of the object that was drawn / drawn from.", drawn_from_objp, conditionParseObjectType, conditionIsObjecttype, INDEX_OBJECT_TYPE, conditionKeysObjecttype);
 HOOK_CONDITIONS_END
 
 HOOK_CONDITIONS_START(KeyPressConditions)
@@ -308,7 +406,7 @@ HOOK_CONDITIONS_END
 
 HOOK_CONDITIONS_START(CommOrderConditions)
 	HOOK_CONDITION_SHIPP(CommOrderConditions, "", "that sent the order.", source);
-	HOOK_CONDITION(CommOrderConditions, "Object type", "Specifies the type of object that is the target of the order.", target, conditionParseObjectType, conditionIsObjecttype);
+	HOOK_CONDITION_INDEXED(CommOrderConditions, "Object type", "Specifies the type of object that is the target of the order.", target, conditionParseObjectType, conditionIsObjecttype, INDEX_OBJECT_TYPE, conditionKeysObjecttype);
 	HOOK_CONDITION_SHIP_OBJP(CommOrderConditions, "Target ", "that is being targeted.", target);
 HOOK_CONDITIONS_END
 
@@ -13,12 +13,25 @@ enum class ArrivalLocation;
 
 namespace scripting {
 
+class ParseableCondition;
+
 class EvaluatableCondition {
 public:
 	virtual bool evaluate(const std::any& /*conditionContext*/) const {
 		return false;
 	};
 
+	/**
+	 * @brief Gets the value this condition is bucketed by when the hooks of an action are indexed
+	 *
+	 * @param[out] condition The indexable condition this was parsed from
+	 * @param[out] key The parsed value which the condition compares against
+	 * @return @c false if this condition cannot be used for indexing
+	 */
+	virtual bool getIndexKey(const ParseableCondition*& /*condition*/, int& /*key*/) const {
+		return false;
+	}
+
 	virtual ~EvaluatableCondition() = default;
 };
 
@@ -30,6 +43,22 @@ public:
 		return make_unique<EvaluatableCondition>();
 	};
 
+	/**
+	 * @brief How well this condition narrows down the hooks which have to be checked, 0 if it cannot be indexed
+	 *
+	 * If a hook has multiple indexable conditions it is indexed by the one with the highest selectivity.
+	 */
+	virtual int getIndexSelectivity() const {
+		return 0;
+	}
+
+	/**
+	 * @brief Gets all values a parsed condition of this type may compare against and evaluate to true
+	 *
+	 * A condition which has a value that is not in this list must never evaluate to true for this context.
+	 */
+	virtual void getIndexKeys(const std::any& /*conditionContext*/, SCP_vector<int>& /*keys*/) const { }
+
 	ParseableCondition() : documentation("Invalid Condition. Will never evaluate.") { }
 
 	virtual ~ParseableCondition() = default;
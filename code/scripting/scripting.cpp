@@ -107,8 +107,6 @@ void script_parse_table(const char* filename)
 			while (st->ParseCondition(filename));
 			required_string("#End");
 		}
-
-		st->ProcessAddedHooks();
 	}
 	catch (const parse::ParseException& e)
 	{
@@ -179,6 +177,9 @@ void script_init()
 	mprintf(("SCRIPTING: Beginning main hook parse sequence....\n"));
 	script_parse_table("scripting.tbl");
 	parse_modular_table(NOX("*-sct.tbm"), script_parse_table);
+
+	// the hooks of all tables are indexed at once instead of once per table
+	Script_system.ProcessAddedHooks();
 	mprintf(("SCRIPTING: Parsing pure Lua scripts\n"));
 	parse_modular_table(NOX("*-sct.lua"), script_parse_lua_script);
 	mprintf(("SCRIPTING: Initialization complete.\n"));
@@ -501,15 +502,24 @@ int script_state::RunCondition(int action_type, const std::any& local_condition_
 	if (action_it == ConditionalHooks.end())
 		return num;
 
-	for(const auto& action : action_it->second) 
+	const auto& actions = action_it->second;
+
+	auto& candidates = AcquireCandidateBuffer();
+	GetCandidateActions(action_type, local_condition_data, candidates);
+
+	for (auto idx : candidates)
 	{
+		const auto& action = actions[idx];
 		if (action.ConditionsValid(local_condition_data))
 		{
+			TRACE_SCOPE(*action.trace_category);
 			RunBytecode(action.hook.hook_function);
 			num++;
 		}
 	}
 
+	ReleaseCandidateBuffer();
+
 	ProcessAddedHooks();
 	return num;
 }
@@ -520,25 +530,114 @@ bool script_state::IsConditionOverride(int action_type, const std::any& local_co
 	if (action_it == ConditionalHooks.end())
 		return false;
 
-	for (const auto& action : action_it->second)
+	const auto& actions = action_it->second;
+
+	auto& candidates = AcquireCandidateBuffer();
+	GetCandidateActions(action_type, local_condition_data, candidates);
+
+	bool overridden = false;
+	for (auto idx : candidates)
 	{
+		const auto& action = actions[idx];
 		if (action.ConditionsValid(local_condition_data))
 		{
-			if (IsOverride(action.hook))
-				return true;
+			if (IsOverride(action.hook)) {
+				overridden = true;
+				break;
+			}
+		}
+	}
+
+	ReleaseCandidateBuffer();
+	return overridden;
+}
+
+SCP_vector<size_t>& script_state::AcquireCandidateBuffer()
+{
+	if (CandidateDepth == CandidateBuffers.size()) {
+		CandidateBuffers.emplace_back();
+	}
+
+	auto& candidates = CandidateBuffers[CandidateDepth++];
+	candidates.clear();
+	return candidates;
+}
+
+void script_state::ReleaseCandidateBuffer()
+{
+	Assertion(CandidateDepth > 0, "Released more candidate buffers than were acquired!");
+	--CandidateDepth;
+}
+
+// Collects the indices of the hooks of an action which may pass their conditions, in the order the hooks were added
+void script_state::GetCandidateActions(int action_type, const std::any& local_condition_data, SCP_vector<size_t>& candidates) const
+{
+	auto index_it = ActionIndices.find(action_type);
+	if (index_it == ActionIndices.end())
+		return;
+
+	const auto& index = index_it->second;
+
+	// Without condition data the local conditions can't be looked up, in that case everything has to be checked
+	if (!index.isIndexed() || !local_condition_data.has_value()) {
+		auto num_actions = ConditionalHooks.at(action_type).size();
+		for (size_t i = 0; i < num_actions; ++i) {
+			candidates.push_back(i);
+		}
+		return;
+	}
+
+	// Every list is sorted already, so only candidates gathered from more than one of them have to be sorted again
+	int num_lists = 0;
+	auto add_list = [&candidates, &num_lists](const SCP_vector<size_t>& list) {
+		if (!list.empty()) {
+			candidates.insert(candidates.end(), list.begin(), list.end());
+			++num_lists;
+		}
+	};
+
+	add_list(index.unindexed);
+
+	if (!index.by_state.empty() && gameseq_get_depth() >= 0) {
+		auto state_it = index.by_state.find(gameseq_get_state());
+		if (state_it != index.by_state.end()) {
+			add_list(state_it->second);
+		}
+	}
+
+	for (const auto& condition : index.by_condition) {
+		IndexKeys.clear();
+		condition.first->getIndexKeys(local_condition_data, IndexKeys);
+
+		for (auto key : IndexKeys) {
+			auto bucket_it = condition.second.find(key);
+			if (bucket_it != condition.second.end()) {
+				add_list(bucket_it->second);
+			}
 		}
 	}
-	return false;
+
+	if (num_lists > 1) {
+		// Restore the order of the hooks, a hook may also be in more than one matching bucket (e.g. both collision
+		// objects have the same class)
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	}
 }
 
 void script_state::Clear()
 {
 	// Free all lua value references
 	ConditionalHooks.clear();
+	AddedHooks.clear();
 	HookVariableValues.clear();
 
 	AssayActions();
 
+	// Hook events may still be queued for the trace writer and those point to the categories
+	tracing::wait_for_pending_events();
+	HookTraceCategories.clear();
+
 	if (LuaState != nullptr) {
 		OnStateDestroy(LuaState);
 
@@ -886,7 +985,11 @@ void script_state::ParseGlobalChunk(ConditionalActions hookType, const char* deb
 		}
 	}
 
-	ConditionalHooks[hookType].emplace_back(std::move(sat));
+	SCP_string trace_name;
+	sprintf(trace_name, "%s - %s", Current_filename, debug_str);
+	sat.trace_category = GetHookTraceCategory(trace_name);
+
+	AddConditionedHook(hookType, std::move(sat));
 }
 bool script_state::ParseCondition(const char *filename)
 {
@@ -931,6 +1034,7 @@ bool script_state::ParseCondition(const char *filename)
 		sprintf(buf, "%s - %s", filename, currHook->getHookName().c_str());
 
 		ParseChunk(&sat.hook, buf.c_str());
+		sat.trace_category = GetHookTraceCategory(buf);
 
 		sat.global_conditions = parsed_conditions;
 		for (const SCP_string& local_condition : conditions) {
@@ -994,10 +1098,14 @@ bool script_state::ParseCondition(const char *filename)
 }
 
 void script_state::AddConditionedHook(int action_id, script_action hook) {
+	Assertion(hook.trace_category != nullptr, "Hooks must have a tracing category!");
 	AddedHooks[action_id].emplace_back(std::move(hook));
 }
 
 void script_state::ProcessAddedHooks() {
+	if (AddedHooks.empty())
+		return;
+
 	for (auto& hook : AddedHooks) {
 		auto& conditionalHooks = ConditionalHooks[hook.first];
 		conditionalHooks.insert(conditionalHooks.end(), std::make_move_iterator(hook.second.begin()), std::make_move_iterator(hook.second.end()));
@@ -1013,10 +1121,53 @@ void script_state::AddGameInitFunction(script_function func) { GameInitFunctions
 // AssayActions() after modifying ConditionalHooks before returning to normal operation of the scripting system!
 void script_state::AssayActions() {
 	ActiveActions.clear();
+	ActionIndices.clear();
 
 	for (const auto &hook : ConditionalHooks) {
 		ActiveActions[hook.first] = !hook.second.empty();
+
+		// Bucket each action by its most selective condition. A local condition on a class or type splits the hooks
+		// much finer than the game state so those are preferred.
+		auto& index = ActionIndices[hook.first];
+		for (size_t i = 0; i < hook.second.size(); ++i) {
+			const auto& action = hook.second[i];
+
+			const ParseableCondition* best_condition = nullptr;
+			int best_key = 0;
+			for (const auto& local_condition : action.local_conditions) {
+				const ParseableCondition* condition;
+				int key;
+				if (local_condition->getIndexKey(condition, key) &&
+					(best_condition == nullptr || condition->getIndexSelectivity() > best_condition->getIndexSelectivity())) {
+					best_condition = condition;
+					best_key = key;
+				}
+			}
+
+			if (best_condition != nullptr) {
+				index.by_condition[best_condition][best_key].push_back(i);
+				continue;
+			}
+
+			auto state_condition = std::find_if(action.global_conditions.begin(), action.global_conditions.end(),
+				[](const script_condition& condition) { return condition.condition_type == CHC_STATE; });
+			if (state_condition != action.global_conditions.end()) {
+				index.by_state[state_condition->condition_cached_value].push_back(i);
+				continue;
+			}
+
+			index.unindexed.push_back(i);
+		}
+	}
+}
+
+const tracing::Category* script_state::GetHookTraceCategory(const SCP_string& name)
+{
+	auto& category = HookTraceCategories[name];
+	if (!category) {
+		category.reset(new tracing::Category(name.c_str(), false));
 	}
+	return category.get();
 }
 
 bool script_state::IsActiveAction(int action_id) {
@@ -22,6 +22,10 @@ struct ScriptingDocumentation;
 class HookBase;
 }
 
+namespace tracing {
+class Category;
+}
+
 struct image_desc
 {
 	char fname[MAX_FILENAME_LEN];
@@ -113,9 +117,25 @@ public:
 
 	script_hook hook;
 
+	// Times the hook function when tracing is enabled
+	const tracing::Category* trace_category = nullptr;
+
 	bool ConditionsValid(const std::any& local_condition_data) const;
 };
 
+// The hooks of one action bucketed by their most selective condition. Only the buckets matching the current game state
+// and the condition data of a hook call need to be checked. The values are indices into the hook vector of the action.
+struct script_action_index {
+	// Hooks without any indexable condition, these always need to be checked
+	SCP_vector<size_t> unindexed;
+	// Hooks with a state condition, by the game state
+	SCP_unordered_map<int, SCP_vector<size_t>> by_state;
+	// Hooks with an indexable local condition, by the condition and its value
+	SCP_unordered_map<const scripting::ParseableCondition*, SCP_unordered_map<int, SCP_vector<size_t>>> by_condition;
+
+	bool isIndexed() const { return !by_state.empty() || !by_condition.empty(); }
+};
+
 //**********Main script_state function
 class script_state
 {
@@ -144,11 +164,26 @@ class script_state
 	// ActiveActions lets code that might run scripting hooks know whether any scripts are even registered for it.
 	// AssayActions is responsible for keeping it up to date.
 	SCP_unordered_map<int, bool> ActiveActions;
+	// Also rebuilt by AssayActions
+	SCP_unordered_map<int, script_action_index> ActionIndices;
+
+	// Scratch space for dispatching hooks so it doesn't allocate on every event. Hooks can trigger other hooks while
+	// their own candidates are still in use, so every nesting level gets its own candidate buffer.
+	SCP_deque<SCP_vector<size_t>> CandidateBuffers;
+	size_t CandidateDepth = 0;
+	mutable SCP_vector<int> IndexKeys;
+
+	// Trace categories of the hooks by name, the hook actions only keep a pointer to them
+	SCP_unordered_map<SCP_string, std::unique_ptr<tracing::Category>> HookTraceCategories;
 
 	void ParseChunkSub(script_function& out_func, const char* debug_str=NULL);
 
 	void SetLuaSession(struct lua_State *L);
 
+	void GetCandidateActions(int action_type, const std::any& local_condition_data, SCP_vector<size_t>& candidates) const;
+	SCP_vector<size_t>& AcquireCandidateBuffer();
+	void ReleaseCandidateBuffer();
+
 	static void OutputLuaDocumentation(scripting::ScriptingDocumentation& doc,
 		const scripting::DocumentationErrorReporter& errorReporter);
 
@@ -199,6 +234,8 @@ public:
 	void ParseGlobalChunk(ConditionalActions hookType, const char* debug_str=nullptr, const std::shared_ptr<scripting::HookBase> parentHook=nullptr);
 	bool ParseCondition(const char *filename="<Unknown>");
 	void AddConditionedHook(int action_id, script_action hook);
+	// Gets the category used to trace the hooks with this name, owned by this state until it is cleared
+	const tracing::Category* GetHookTraceCategory(const SCP_string& name);
 	void AssayActions();
 	bool IsActiveAction(int hookId);
 
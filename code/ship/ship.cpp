@@ -6761,7 +6761,7 @@ static int ship_allocate_subsystems(int num_so, bool page_in = false)
 	for (auto so : list_range(&Ship_obj_list))
 	{
 		// don't skip should-be-dead ships for this flag removal
-		Ships[Objects[so->objnum].instance].flags.remove(Ship::Ship_Flags::Subsystem_cache_valid);
+		Ships[Objects[so->objnum].instance].subsys_cache_valid = false;
 	}
 
 	mprintf(("a total of %i is now available (%i in-use).\n", Num_ship_subsystems_allocated, Num_ship_subsystems));
@@ -7177,6 +7177,9 @@ void ship::clear()
 	orders_allowed_against.clear();
 
 	subsys_list_indexer.reset();
+	subsys_type_indexer.reset();
+	memset(subsys_type_offsets, 0, sizeof(subsys_type_offsets));
+	subsys_cache_valid = false;
 	subsys_list.clear();
 	// since these aren't cleared by clear()
 	subsys_list.next = NULL;
@@ -7983,7 +7986,8 @@ static int subsys_set(int objnum, int ignore_subsys_info)
 	// for each subsystem, get a new ship_subsys instance and set up the pointers and other values
 	list_init ( &shipp->subsys_list );								// initialize the ship's list of subsystems
 	shipp->subsys_list_indexer.reset();
-	shipp->flags.remove(Ship::Ship_Flags::Subsystem_cache_valid);
+	shipp->subsys_type_indexer.reset();
+	shipp->subsys_cache_valid = false;
 
 	// make sure to have allocated the number of subsystems we require
 	if (!ship_allocate_subsystems( sinfo->n_subsystems )) {
@@ -8808,7 +8812,8 @@ static void ship_subsystems_delete(ship *shipp)
 		}
 
 		shipp->subsys_list_indexer.reset();
-		shipp->flags.remove(Ship::Ship_Flags::Subsystem_cache_valid);
+		shipp->subsys_type_indexer.reset();
+		shipp->subsys_cache_valid = false;
 	}
 }
 
@@ -15692,7 +15697,6 @@ void object_get_eye(vec3d *eye_pos, matrix *eye_orient, const object *obj, bool
 #define MAX_SUBSYS_ATTACKERS 3
 ship_subsys *ship_get_best_subsys_to_attack(ship *sp, int subsys_type, const vec3d *attacker_pos)
 {
-	ship_subsys	*ss;
 	ship_subsys *best_in_sight_subsys, *lowest_attacker_subsys, *ss_return;
 	int			lowest_num_attackers, lowest_in_sight_attackers, num_attackers;
 	vec3d		gsubpos;
@@ -15700,23 +15704,36 @@ ship_subsys *ship_get_best_subsys_to_attack(ship *sp, int subsys_type, const vec
 	lowest_in_sight_attackers = lowest_num_attackers = 1000;
 	ss_return = best_in_sight_subsys = lowest_attacker_subsys = NULL;
 
-	for (ss = GET_FIRST(&sp->subsys_list); ss != END_OF_LIST(&sp->subsys_list); ss = GET_NEXT(ss) ) {
-		if ( (ss->system_info->type == subsys_type) && (ss->current_hits > 0) ) {
+	auto subsystems = ship_get_subsystems_of_type(sp, subsys_type);
+	if (subsystems.size() == 0)
+		return nullptr;
+
+	// find the number of ships attacking each subsystem of this ship with a single pass through the ships list,
+	// by checking which subsystem aip->targeted_subsys refers to
+	// the counts buffer is reused between calls so targeting doesn't allocate every time a subsystem is picked
+	static SCP_vector<int> attackers_per_subsys;
+	auto n_subsystems = Ship_info[sp->ship_info_index].n_subsystems;
+	attackers_per_subsys.assign(n_subsystems, 0);
+	for (auto sop: list_range(&Ship_obj_list)){
+		if (Objects[sop->objnum].flags[Object::Object_Flags::Should_be_dead])
+			continue;
+
+		auto targeted = Ai_info[Ships[Objects[sop->objnum].instance].ai_index].targeted_subsys;
+		if ( (targeted != nullptr) && (targeted->parent_objnum == sp->objnum) ) {
+			auto index = targeted->parent_subsys_index;
+			if ( (index >= 0) && (index < n_subsystems) && (sp->subsys_list_indexer[index] == targeted) )
+				attackers_per_subsys[index]++;
+		}
+	}
+
+	for (auto ss : subsystems) {
+		if ( ss->current_hits > 0 ) {
 
 			// get world pos of subsystem
 			vm_vec_unrotate(&gsubpos, &ss->system_info->pnt, &Objects[sp->objnum].orient);
 			vm_vec_add2(&gsubpos, &Objects[sp->objnum].pos);
-			
-			// now find the number of ships attacking this subsystem by iterating through the ships list,
-			// and checking if aip->targeted_subsys matches the subsystem we're checking
-			num_attackers = 0;
-			for (auto sop: list_range(&Ship_obj_list)){
-				if (Objects[sop->objnum].flags[Object::Object_Flags::Should_be_dead])
-					continue;
-				if ( Ai_info[Ships[Objects[sop->objnum].instance].ai_index].targeted_subsys == ss ) {
-					num_attackers++;
-				}
-			}
+
+			num_attackers = attackers_per_subsys[ss->parent_subsys_index];
 
 			if ( num_attackers < lowest_num_attackers ) {
 				lowest_num_attackers = num_attackers;
@@ -15765,10 +15782,10 @@ ship_subsys *ship_find_first_subsys(ship *sp, int subsys_type, const vec3d *atta
 	if ( attacker_pos != nullptr ) {
 		return ship_get_best_subsys_to_attack(sp, subsys_type, attacker_pos);
 	} else {
-		// next, scan the list of subsystems and search for the first subsystem of the particular
-		// type which has > 0 hits remaining.
-		for (auto ss : list_range(&sp->subsys_list)) {
-			if ( (ss->system_info->type == subsys_type) && (ss->current_hits > 0) )
+		// next, scan the subsystems of the particular type and search for the first one
+		// which has > 0 hits remaining.
+		for (auto ss : ship_get_subsystems_of_type(sp, subsys_type)) {
+			if ( ss->current_hits > 0 )
 				return ss;
 		}
 	}
@@ -15781,13 +15798,35 @@ ship_subsys *ship_find_first_subsys(ship *sp, int subsys_type, const vec3d *atta
 /**
  * Create or recreate the subsystem index cache.
  */
-void ship_index_subsystems(ship *shipp)
+void ship_index_subsystems(const ship *shipp)
 {
 	auto sinfo = &Ship_info[shipp->ship_info_index];
 
-	// if the indexer already exists, its size won't change, so don't reallocate it
+	// if the indexers already exist, their size won't change, so don't reallocate them
 	if (shipp->subsys_list_indexer.get() == nullptr)
 		shipp->subsys_list_indexer.reset(new ship_subsys* [sinfo->n_subsystems]);
+	if (shipp->subsys_type_indexer.get() == nullptr)
+		shipp->subsys_type_indexer.reset(new ship_subsys* [sinfo->n_subsystems]);
+
+	// group the subsystems by type with a counting sort so the per-type walks don't have to touch every subsystem
+	int type_counts[SUBSYSTEM_MAX] = {};
+	int num_linked = 0;
+	for (auto ss = GET_FIRST(&shipp->subsys_list); ss != END_OF_LIST(&shipp->subsys_list); ss = GET_NEXT(ss))
+	{
+		Assert((ss->system_info->type >= 0) && (ss->system_info->type < SUBSYSTEM_MAX));
+		++type_counts[ss->system_info->type];
+		++num_linked;
+	}
+	Assertion(num_linked <= sinfo->n_subsystems, "Ship %s has more subsystems than its class defines!", shipp->ship_name);
+
+	shipp->subsys_type_offsets[0] = 0;
+	for (int type = 0; type < SUBSYSTEM_MAX; ++type)
+		shipp->subsys_type_offsets[type + 1] = shipp->subsys_type_offsets[type] + type_counts[type];
+
+	int type_fill[SUBSYSTEM_MAX];
+	memcpy(type_fill, shipp->subsys_type_offsets, sizeof(type_fill));
+	for (auto ss = GET_FIRST(&shipp->subsys_list); ss != END_OF_LIST(&shipp->subsys_list); ss = GET_NEXT(ss))
+		shipp->subsys_type_indexer[type_fill[ss->system_info->type]++] = ss;
 
 	auto ss = GET_FIRST(&shipp->subsys_list);
 	for (int index = 0; index < sinfo->n_subsystems; ++index)
@@ -15806,7 +15845,7 @@ void ship_index_subsystems(ship *shipp)
 		}
 	}
 
-	shipp->flags.set(Ship::Ship_Flags::Subsystem_cache_valid);
+	shipp->subsys_cache_valid = true;
 }
 
 /**
@@ -15818,12 +15857,30 @@ ship_subsys *ship_get_indexed_subsys(ship *sp, int index)
 	Assertion(index < Ship_info[sp->ship_info_index].n_subsystems, "Subsystem index out of range!");
 
 	// might need to refresh the cache
-	if (!sp->flags[Ship::Ship_Flags::Subsystem_cache_valid])
+	if (!sp->subsys_cache_valid)
 		ship_index_subsystems(sp);
 
 	return sp->subsys_list_indexer[index];
 }
 
+/**
+ * Returns the subsystems of one type as a contiguous range.  The index cache is refreshed if needed.
+ */
+ship_subsys_type_range ship_get_subsystems_of_type(const ship *shipp, int type)
+{
+	Assertion((type >= 0) && (type < SUBSYSTEM_MAX), "ship_get_subsystems_of_type() subsystem type %d is out of range!", type);
+
+	// might need to refresh the cache
+	if (!shipp->subsys_cache_valid)
+		ship_index_subsystems(shipp);
+
+	auto indexer = shipp->subsys_type_indexer.get();
+	if (indexer == nullptr)
+		return { nullptr, nullptr };
+
+	return { indexer + shipp->subsys_type_offsets[type], indexer + shipp->subsys_type_offsets[type + 1] };
+}
+
 /**
 * Returns the index number of the ship_subsys parameter within its ship's subsytem list
 */
@@ -15838,7 +15895,7 @@ int ship_get_subsys_index(const ship_subsys *subsys)
 
 	// might need to refresh the cache
 	auto sp = &Ships[Objects[subsys->parent_objnum].instance];
-	if (!sp->flags[Ship::Ship_Flags::Subsystem_cache_valid])
+	if (!sp->subsys_cache_valid)
 		ship_index_subsystems(sp);
 
 	Assertion(subsys->parent_subsys_index >= 0, "Somehow a subsystem could not be found in its parent ship %s's subsystem list!", sp->ship_name);
@@ -15893,7 +15950,6 @@ bool ship_subsystems_blown(const ship* shipp, int type, bool skip_dying_check)
 float ship_get_subsystem_strength(const ship *shipp, int type, bool skip_dying_check, bool no_minimum_engine_str)
 {
 	float strength;
-	ship_subsys *ssp;
 
 	Assertion( (type >= 0) && (type < SUBSYSTEM_MAX), "ship_get_subsystem_strength() subsystem type %d is out of range!", type );
 
@@ -15917,19 +15973,14 @@ float ship_get_subsystem_strength(const ship *shipp, int type, bool skip_dying_c
 		float percent;
 
 		percent = 0.0f;
-		ssp = GET_FIRST(&shipp->subsys_list);
-		while ( ssp != END_OF_LIST( &shipp->subsys_list ) ) {
+		for (auto ssp : ship_get_subsystems_of_type(shipp, SUBSYSTEM_ENGINE)) {
+			float ratio;
 
-			if ( ssp->system_info->type == SUBSYSTEM_ENGINE ) {
-				float ratio;
+			ratio = ssp->current_hits / ssp->max_hits;
+			if ( ratio < ENGINE_MIN_STR )
+				ratio = ENGINE_MIN_STR;
 
-				ratio = ssp->current_hits / ssp->max_hits;
-				if ( ratio < ENGINE_MIN_STR )
-					ratio = ENGINE_MIN_STR;
-
-				percent += ratio;
-			}
-			ssp = GET_NEXT( ssp );
+			percent += ratio;
 		}
 		strength = percent / (float)shipp->subsys_info[type].type_count;
 	}
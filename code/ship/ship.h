@@ -653,7 +653,11 @@ public:
 	// types of subsystems.  (i.e. the list might contain 3 engines.  There will be one subsys_info entry
 	// describing the state of all engines combined) -- MWA 4/1/97
 	ship_subsys	subsys_list;									//	linked list of subsystems for this ship.
-	std::unique_ptr<ship_subsys*[]> subsys_list_indexer;		//	provides random-access lookup to the linked list
+	// the index caches are rebuilt on demand and aren't part of the logical state of the ship, so they are mutable
+	mutable std::unique_ptr<ship_subsys*[]> subsys_list_indexer;		//	provides random-access lookup to the linked list
+	mutable std::unique_ptr<ship_subsys*[]> subsys_type_indexer;		//	the subsystems grouped by type, so the subsystems of one type are contiguous
+	mutable int	subsys_type_offsets[SUBSYSTEM_MAX + 1];				//	the subsystems of type t are at [subsys_type_offsets[t], subsys_type_offsets[t+1]) in subsys_type_indexer
+	mutable bool	subsys_cache_valid;								//	Goober5000 - whether the subsystem index caches can be used
 	ship_subsys	*last_targeted_subobject[MAX_PLAYERS];	// Last subobject that has been targeted.  NULL if none;(player specific)
 	ship_subsys_info	subsys_info[SUBSYSTEM_MAX];		// info on particular generic types of subsystems	
 
@@ -1828,6 +1832,19 @@ extern void object_get_eye(vec3d *eye_pos, matrix *eye_orient, const object *obj
 
 extern ship_subsys *ship_find_first_subsys(ship *sp, int subsys_type, const vec3d *attacker_pos = nullptr);
 extern ship_subsys *ship_get_indexed_subsys(ship *sp, int index);	// returns index'th subsystem of this ship
+
+// the subsystems of one type on a ship, in the order of the subsystem list
+struct ship_subsys_type_range {
+	ship_subsys* const* first;
+	ship_subsys* const* last;
+
+	ship_subsys* const* begin() const { return first; }
+	ship_subsys* const* end() const { return last; }
+	size_t size() const { return static_cast<size_t>(last - first); }
+};
+
+// returns all subsystems of the given type without walking the whole subsystem list
+extern ship_subsys_type_range ship_get_subsystems_of_type(const ship *shipp, int type);
 extern int ship_find_subsys(const ship *sp, const char *ss_name);		// returns numerical index in linked list of subsystems
 extern int ship_get_subsys_index(const ship_subsys *subsys);
 
@@ -24,18 +24,24 @@
 #include "sound/ffmpeg/FFmpegWaveFile.h"
 #endif
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #define MAX_STREAM_BUFFERS 4
 
+// how many stream buffers are decoded ahead of the ones queued on the source
+#define STREAM_DECODE_AHEAD		4
+#define STREAM_DECODE_WORKERS	2
+
 // status
 #define ASF_FREE	0
 #define ASF_USED	1
 
 // constants
 #define BIGBUF_SIZE					176400
-ubyte *Wavedata_load_buffer = NULL;		// buffer used for cueing audiostreams
-ubyte *Wavedata_service_buffer = NULL;	// buffer used for servicing audiostreams
-
-SDL_mutex* Global_service_lock;
 
 typedef bool (*TIMERCALLBACK)(ptr_u);
 
@@ -79,6 +85,274 @@ static std::unique_ptr<sound::IAudioFile> openAudioMem(const uint8_t* snddata, s
 
 int Audiostream_inited = 0;
 
+namespace {
+
+// The result of one IAudioFile::Read() of a stream buffer
+struct stream_chunk
+{
+	SCP_vector<ubyte> data;
+	int num_bytes = 0;		// negative once the end of the file was reached
+	bool rewound = false;	// the file was looped back to its start before this was read
+};
+
+// Reads a stream ahead of playback on the decode workers so servicing the stream only has to copy the data into an
+// OpenAL buffer.  The chunks come out in the order the file was read in, whichever thread decoded them, and anything
+// the workers have not decoded yet is read on the thread asking for it.
+class StreamDecoder
+{
+public:
+	StreamDecoder(std::unique_ptr<sound::IAudioFile> file, uint chunk_size)
+		: m_file(std::move(file)), m_chunk_size(chunk_size)
+	{
+	}
+
+	// Start reading at the beginning of the file again.  The chunks decoded so far are kept if none of them were
+	// taken and they don't depend on the loop setting.
+	void cue(bool looping)
+	{
+		std::lock_guard<std::mutex> file_guard(m_file_lock);
+		std::lock_guard<std::mutex> queue_guard(m_queue_lock);
+
+		if ( !m_taken && ((looping == m_looping) || !m_hit_end) ) {
+			m_looping = looping;
+			return;
+		}
+
+		m_file->Cue();
+
+		while ( !m_queue.empty() ) {
+			recycle(m_queue.front());
+			m_queue.pop_front();
+		}
+
+		m_looping = looping;
+		m_taken = false;
+		m_hit_end = false;
+		m_done = false;
+	}
+
+	// Take the next chunk of the stream
+	void next(stream_chunk &out)
+	{
+		{
+			std::lock_guard<std::mutex> queue_guard(m_queue_lock);
+			if ( take(out) ) {
+				return;
+			}
+		}
+
+		// the workers haven't gotten this far yet
+		std::lock_guard<std::mutex> file_guard(m_file_lock);
+		{
+			std::lock_guard<std::mutex> queue_guard(m_queue_lock);
+			if ( take(out) ) {
+				return;
+			}
+			m_taken = true;
+		}
+
+		read(out);
+	}
+
+	// Decode one more chunk if there is room for it.  Returns false if there was nothing to do.
+	bool decode_ahead()
+	{
+		std::lock_guard<std::mutex> file_guard(m_file_lock);
+
+		stream_chunk chunk;
+		{
+			std::lock_guard<std::mutex> queue_guard(m_queue_lock);
+
+			if ( m_done || (m_queue.size() >= STREAM_DECODE_AHEAD) ) {
+				return false;
+			}
+
+			if ( !m_spare.empty() ) {
+				chunk.data = std::move(m_spare.back());
+				m_spare.pop_back();
+			}
+		}
+
+		read(chunk);
+
+		std::lock_guard<std::mutex> queue_guard(m_queue_lock);
+		m_queue.push_back(std::move(chunk));
+
+		return true;
+	}
+
+private:
+	// m_file_lock must be held
+	void read(stream_chunk &chunk)
+	{
+		chunk.data.resize(m_chunk_size);
+		chunk.rewound = false;
+		chunk.num_bytes = m_file->Read(chunk.data.data(), m_chunk_size);
+
+		// if looping then maybe reset wavefile and keep going
+		if ( (chunk.num_bytes < 0) && m_looping ) {
+			m_file->Cue();
+			chunk.rewound = true;
+			chunk.num_bytes = m_file->Read(chunk.data.data(), m_chunk_size);
+		}
+
+		if ( (chunk.num_bytes < 0) || chunk.rewound ) {
+			m_hit_end = true;
+		}
+
+		m_done = (chunk.num_bytes < 0);
+	}
+
+	// m_queue_lock must be held
+	bool take(stream_chunk &out)
+	{
+		if ( m_queue.empty() ) {
+			return false;
+		}
+
+		std::swap(out, m_queue.front());
+		recycle(m_queue.front());
+		m_queue.pop_front();
+		m_taken = true;
+
+		return true;
+	}
+
+	// m_queue_lock must be held
+	void recycle(stream_chunk &chunk)
+	{
+		if ( m_spare.size() < STREAM_DECODE_AHEAD ) {
+			m_spare.push_back(std::move(chunk.data));
+		}
+	}
+
+	std::unique_ptr<sound::IAudioFile> m_file;
+	uint m_chunk_size;
+
+	std::mutex m_file_lock;		// held while the file is read
+	bool m_looping = false;
+	bool m_hit_end = false;		// the end of the file was reached since the last cue
+	bool m_done = false;		// the end of the file was reached and there is nothing left to decode
+
+	std::mutex m_queue_lock;
+	std::deque<stream_chunk> m_queue;
+	SCP_vector<SCP_vector<ubyte>> m_spare;
+	bool m_taken = false;		// a chunk was taken since the last cue
+};
+
+// The threads which decode ahead for all open streams
+class StreamDecodePool
+{
+public:
+	void start()
+	{
+		m_exit = false;
+
+		for (int i = 0; i < STREAM_DECODE_WORKERS; i++) {
+			m_threads.emplace_back([this]() { run(); });
+		}
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			m_exit = true;
+		}
+		m_work.notify_all();
+
+		for (auto &thread : m_threads) {
+			thread.join();
+		}
+		m_threads.clear();
+	}
+
+	void add(StreamDecoder *decoder)
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			m_decoders.push_back(decoder);
+		}
+		m_work.notify_one();
+	}
+
+	// Once this returns, no worker uses the decoder anymore
+	void remove(StreamDecoder *decoder)
+	{
+		std::unique_lock<std::mutex> lock(m_lock);
+
+		auto it = std::find(m_decoders.begin(), m_decoders.end(), decoder);
+		if (it == m_decoders.end()) {
+			return;
+		}
+
+		m_decoders.erase(it);
+		m_idle.wait(lock, [this, decoder]() { return std::find(m_busy.begin(), m_busy.end(), decoder) == m_busy.end(); });
+	}
+
+	// Let the workers know a chunk was taken
+	void wake()
+	{
+		m_work.notify_one();
+	}
+
+private:
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(m_lock);
+		size_t idle_count = 0;
+
+		while ( !m_exit ) {
+			StreamDecoder *decoder = nullptr;
+
+			for (size_t i = 0; i < m_decoders.size(); i++) {
+				size_t index = (m_next + i) % m_decoders.size();
+
+				if (std::find(m_busy.begin(), m_busy.end(), m_decoders[index]) == m_busy.end()) {
+					decoder = m_decoders[index];
+					m_next = index + 1;
+					break;
+				}
+			}
+
+			if (decoder == nullptr) {
+				m_work.wait_for(lock, std::chrono::milliseconds(20));
+				continue;
+			}
+
+			m_busy.push_back(decoder);
+			lock.unlock();
+
+			bool decoded = decoder->decode_ahead();
+
+			lock.lock();
+			m_busy.erase(std::find(m_busy.begin(), m_busy.end(), decoder));
+			m_idle.notify_all();
+
+			// sleep once every stream is full
+			if (decoded) {
+				idle_count = 0;
+			} else if (++idle_count >= m_decoders.size()) {
+				idle_count = 0;
+				m_work.wait_for(lock, std::chrono::milliseconds(20));
+			}
+		}
+	}
+
+	std::mutex m_lock;
+	std::condition_variable m_work;
+	std::condition_variable m_idle;
+	SCP_vector<StreamDecoder*> m_decoders;
+	SCP_vector<StreamDecoder*> m_busy;		// decoders a worker is decoding for right now
+	size_t m_next = 0;
+	bool m_exit = false;
+	SCP_vector<std::thread> m_threads;
+};
+
+StreamDecodePool Stream_decode_pool;
+
+} // namespace
+
 class Timer
 {
 public:
@@ -131,12 +405,16 @@ protected:
 	bool ServiceBuffer ();
 	static bool TimerCallback (ptr_u dwUser);
 	bool PlaybackDone();
+	void Release_Decoder();
 
 	ALuint m_source_id;	// name of openAL source
 	ALuint m_buffer_ids[MAX_STREAM_BUFFERS];	// names of buffers
 
 	Timer m_timer;			// ptr to Timer object
-	std::unique_ptr<sound::IAudioFile> m_pwavefile;	// ptr to WaveFile object
+	std::unique_ptr<sound::IAudioFile> m_pwavefile;	// ptr to WaveFile object, until it is handed to m_decoder
+	std::unique_ptr<StreamDecoder> m_decoder;
+	stream_chunk m_load_chunk;		// the chunk being queued during a load/cue
+	stream_chunk m_service_chunk;	// the chunk being queued during a service interval
 	sound::AudioFileProperties m_fileProps;
 	bool m_fCued;			// semaphore (stream cued)
 	bool m_fPlaying;		// semaphore (stream playing)
@@ -264,6 +542,7 @@ void AudioStream::Init_Data ()
 	m_bReadingDone = false;
 
 	m_pwavefile = nullptr;
+	Release_Decoder();
 	m_fPlaying = m_fCued = false;
 	m_cbBufOffset = 0;
 	m_cbBufSize = 0;
@@ -314,6 +593,10 @@ bool AudioStream::prepareOpened(const char *filename)
 
 	Snd_sram += (m_cbBufSize * MAX_STREAM_BUFFERS);
 
+	// start decoding right away, the stream is usually played soon after it was opened
+	m_decoder.reset(new StreamDecoder(std::move(m_pwavefile), m_cbBufSize));
+	Stream_decode_pool.add(m_decoder.get());
+
 ErrorExit:
 	if ( (fRtn == false) && (m_pwavefile) ) {
 		mprintf(("AUDIOSTR => ErrorExit for ::prepareOpened() on wave file: %s\n", filename));
@@ -395,7 +678,7 @@ bool AudioStream::Destroy (void)
 	Snd_sram -= (m_cbBufSize * MAX_STREAM_BUFFERS);
 
 	// Delete WaveFile object
-	m_pwavefile = nullptr;
+	Release_Decoder();
 
 	status = ASF_FREE;
 
@@ -411,7 +694,6 @@ bool AudioStream::Destroy (void)
 bool AudioStream::WriteWaveData (uint size, uint *num_bytes_written, int service)
 {
 	bool fRtn = true;
-	ubyte *uncompressed_wave_data;
 
 	*num_bytes_written = 0;
 
@@ -419,43 +701,29 @@ bool AudioStream::WriteWaveData (uint size, uint *num_bytes_written, int service
 		return fRtn;
 	}
 
-	if ( (m_buffer_ids[0] == 0) || !m_pwavefile ) {
+	if ( (m_buffer_ids[0] == 0) || !m_decoder ) {
 		return fRtn;
 	}
 
-	if ( service ) {
-		SDL_LockMutex(Global_service_lock);
-	}
-
-	if ( service ) {
-		uncompressed_wave_data = Wavedata_service_buffer;
-	} else {
-		uncompressed_wave_data = Wavedata_load_buffer;
-	}
-
-	int num_bytes_read = 0;
-
 	const auto alFormat = openal_get_format(m_fileProps.bytes_per_sample * 8, m_fileProps.num_channels);
+	stream_chunk &chunk = service ? m_service_chunk : m_load_chunk;
 
 	if ( !service ) {
 		for (int ib = 0; ib < MAX_STREAM_BUFFERS; ib++) {
-			num_bytes_read = m_pwavefile->Read(uncompressed_wave_data, m_cbBufSize);
+			m_decoder->next(chunk);
 
-			// if looping then maybe reset wavefile and keep going
-			if ( (num_bytes_read < 0) && m_bLooping) {
-				m_pwavefile->Cue();
+			if (chunk.rewound) {
 				m_total_uncompressed_bytes_read = 0;
-				num_bytes_read = m_pwavefile->Read(uncompressed_wave_data, m_cbBufSize);
 			}
 
-			if (num_bytes_read < 0) {
+			if (chunk.num_bytes < 0) {
 				m_bReadingDone = 1;
 				break;
-			} else if (num_bytes_read > 0) {
-				OpenAL_ErrorCheck( alBufferData(m_buffer_ids[ib], alFormat, uncompressed_wave_data, num_bytes_read, m_fileProps.sample_rate), { fRtn = false; goto ErrorExit; } );
+			} else if (chunk.num_bytes > 0) {
+				OpenAL_ErrorCheck( alBufferData(m_buffer_ids[ib], alFormat, chunk.data.data(), chunk.num_bytes, m_fileProps.sample_rate), { fRtn = false; goto ErrorExit; } );
 				OpenAL_ErrorCheck( alSourceQueueBuffers(m_source_id, 1, &m_buffer_ids[ib]), { fRtn = false; goto ErrorExit; } );
 
-				*num_bytes_written += num_bytes_read;
+				*num_bytes_written += chunk.num_bytes;
 			}
 		}
 	} else {
@@ -466,22 +734,19 @@ bool AudioStream::WriteWaveData (uint size, uint *num_bytes_written, int service
 			ALuint buffer_id = 0;
 			OpenAL_ErrorPrint( alSourceUnqueueBuffers(m_source_id, 1, &buffer_id) );
 
-			num_bytes_read = m_pwavefile->Read(uncompressed_wave_data, m_cbBufSize);
+			m_decoder->next(chunk);
 
-			// if looping then maybe reset wavefile and keep going
-			if ( (num_bytes_read < 0) && m_bLooping) {
-				m_pwavefile->Cue();
+			if (chunk.rewound) {
 				m_total_uncompressed_bytes_read = 0;
-				num_bytes_read = m_pwavefile->Read(uncompressed_wave_data, m_cbBufSize);
 			}
 
-			if (num_bytes_read < 0) {
+			if (chunk.num_bytes < 0) {
 				m_bReadingDone = 1;
-			} else if (num_bytes_read > 0) {
-				OpenAL_ErrorPrint( alBufferData(buffer_id, alFormat, uncompressed_wave_data, num_bytes_read, m_fileProps.sample_rate) );
+			} else if (chunk.num_bytes > 0) {
+				OpenAL_ErrorPrint( alBufferData(buffer_id, alFormat, chunk.data.data(), chunk.num_bytes, m_fileProps.sample_rate) );
 				OpenAL_ErrorPrint( alSourceQueueBuffers(m_source_id, 1, &buffer_id) );
 
-				*num_bytes_written += num_bytes_read;
+				*num_bytes_written += chunk.num_bytes;
 			}
 
 			buffers_processed--;
@@ -491,9 +756,8 @@ bool AudioStream::WriteWaveData (uint size, uint *num_bytes_written, int service
 ErrorExit:
 	m_total_uncompressed_bytes_read += *num_bytes_written;
 
-	if ( service ) {
-		SDL_UnlockMutex(Global_service_lock);
-	}
+	// there is room to decode ahead again
+	Stream_decode_pool.wake();
 
 	return (fRtn);
 }
@@ -648,7 +912,7 @@ void AudioStream::Cue (void)
 		m_cbBufOffset = 0;
 
 		// Reset file ptr, etc
-		m_pwavefile->Cue ();
+		m_decoder->cue(m_bLooping);
 
 		// Unqueue all buffers
 		ALint buffers_processed = 0;
@@ -718,7 +982,7 @@ bool AudioStream::TimerCallback (ptr_u dwUser)
 
 void AudioStream::Set_Sample_Cutoff(unsigned int sample_cutoff)
 {
-	if ( m_pwavefile == NULL )
+	if ( m_decoder == NULL )
 		return;
 
 	m_max_uncompressed_bytes_to_read = (sample_cutoff * m_fileProps.bytes_per_sample);
@@ -726,7 +990,7 @@ void AudioStream::Set_Sample_Cutoff(unsigned int sample_cutoff)
 
 uint AudioStream::Get_Samples_Committed(void)
 {
-	if ( m_pwavefile == NULL )
+	if ( m_decoder == NULL )
 		return 0;
 
 	return (uint) (m_total_uncompressed_bytes_read / m_fileProps.bytes_per_sample);
@@ -825,6 +1089,14 @@ double AudioStream::Get_Duration()
 	return m_fileProps.duration;
 }
 
+void AudioStream::Release_Decoder()
+{
+	if (m_decoder) {
+		Stream_decode_pool.remove(m_decoder.get());
+		m_decoder = nullptr;
+	}
+}
+
 bool AudioStream::PlaybackDone()
 {
 	ALint state = 0;
@@ -847,20 +1119,6 @@ void audiostream_init()
 	if ( Audiostream_inited == 1 )
 		return;
 
-	// Allocate memory for the buffer which holds the uncompressed wave data that is streamed from the
-	// disk during a load/cue
-	if ( Wavedata_load_buffer == NULL ) {
-		Wavedata_load_buffer = (ubyte*)vm_malloc(BIGBUF_SIZE);
-		Assert(Wavedata_load_buffer != NULL);
-	}
-
-	// Allocate memory for the buffer which holds the uncompressed wave data that is streamed from the
-	// disk during a service interval
-	if ( Wavedata_service_buffer == NULL ) {
-		Wavedata_service_buffer = (ubyte*)vm_malloc(BIGBUF_SIZE);
-		Assert(Wavedata_service_buffer != NULL);
-	}
-
 	// Allocate memory for the buffer which holds the compressed wave data that is read from the hard disk
 	if ( Compressed_buffer == NULL ) {
 		Compressed_buffer = (ubyte*)vm_malloc(COMPRESSED_BUFFER_SIZE);
@@ -881,7 +1139,7 @@ void audiostream_init()
 
 	SDL_InitSubSystem(SDL_INIT_TIMER);
 
-	Global_service_lock = SDL_CreateMutex();
+	Stream_decode_pool.start();
 
 	Audiostream_inited = 1;
 }
@@ -902,17 +1160,9 @@ void audiostream_close()
 		}
 	}
 
-	// free global buffers
-	if ( Wavedata_load_buffer ) {
-		vm_free(Wavedata_load_buffer);
-		Wavedata_load_buffer = NULL;
-	}
-
-	if ( Wavedata_service_buffer ) {
-		vm_free(Wavedata_service_buffer);
-		Wavedata_service_buffer = NULL;
-	}
+	Stream_decode_pool.stop();
 
+	// free global buffers
 	if ( Compressed_buffer ) {
 		vm_free(Compressed_buffer);
 		Compressed_buffer = NULL;
@@ -923,8 +1173,6 @@ void audiostream_close()
 		Compressed_service_buffer = NULL;
 	}
 
-	SDL_DestroyMutex( Global_service_lock );
-
 	Audiostream_inited = 0;
 
 }
@@ -12,6 +12,7 @@
 #include "cfile/cfile.h"
 #include "cmdline/cmdline.h"
 #include "globalincs/pstypes.h"
+#include "io/timer.h"
 #include "osapi/osapi.h"
 #include "sound/audiostr.h"
 #include "sound/channel.h"
@@ -44,7 +45,52 @@ typedef struct sound_buffer
 
 static int MAX_CHANNELS;		// initialized properly in ds_init_channels()
 channel *Channels = NULL;
-static int channel_next_sig = 1;
+
+// A handle holds the index of its voice in the low bits and the generation of the voice in the others, so finding the
+// channel of a sound does not need a search and an old handle never matches a newer sound of the same voice.
+#define DS_VOICE_INDEX_BITS		12
+#define DS_MAX_VOICES			(1 << DS_VOICE_INDEX_BITS)
+#define DS_MAX_GENERATION		((1 << (31 - DS_VOICE_INDEX_BITS)) - 1)
+
+// Virtual voices are 3D sounds which go on playing without an OpenAL source while all sources are taken by more
+// audible sounds.  ds_do_frame() moves them onto a source again once they are audible enough.
+#define DS_MAX_VIRTUAL_VOICES	512
+#define DS_VOICE_SWAP_MARGIN	1.5f	// how much more audible a virtual voice has to be to take the source of a real one
+
+typedef struct ds_voice
+{
+	ds_sound_handle sig;	// invalid while the voice is unused
+	int generation;
+	int channel_id;			// Channels[] index, -1 while the voice is virtual
+	bool is_3d;
+
+	// what is needed to start a 3D sound on a source again
+	int sid;
+	int snd_id;
+	int priority;
+	vec3d pos;
+	vec3d vel;
+	bool has_vel;
+	float min;
+	float max;
+	float vol;
+	float pitch;
+	bool looping;
+	bool is_ambient;
+	int start_time;			// timestamp() when the sound would have started if it had never been paused
+	int pause_time;			// timestamp() when the sound was paused, -1 while it is not paused
+
+	ds_voice() :
+		sig(ds_sound_handle::invalid()), generation(0), channel_id(-1), is_3d(false), sid(-1), snd_id(-1),
+		priority(0), pos(vmd_zero_vector), vel(vmd_zero_vector), has_vel(false), min(0.0f), max(0.0f), vol(1.0f),
+		pitch(1.0f), looping(false), is_ambient(false), start_time(0), pause_time(-1)
+	{
+	}
+} ds_voice;
+
+static SCP_vector<ds_voice> Voices;
+static SCP_vector<int> Free_voices;
+static SCP_vector<int> Virtual_voices;	// Voices[] indices
 
 const int BUFFER_BUMP = 50;
 SCP_vector<sound_buffer> sound_buffers;
@@ -143,6 +189,13 @@ typedef ALvoid (AL_APIENTRY * ALAUXILIARYEFFECTSLOTIV) (ALuint, ALenum, ALint*);
 typedef ALvoid (AL_APIENTRY * ALAUXILIARYEFFECTSLOTF) (ALuint, ALenum, ALfloat);
 typedef ALvoid (AL_APIENTRY * ALAUXILIARYEFFECTSLOTFV) (ALuint, ALenum, ALfloat*);
 
+typedef ALvoid (AL_APIENTRY * ALDEFERUPDATESSOFT) (void);
+typedef ALvoid (AL_APIENTRY * ALPROCESSUPDATESSOFT) (void);
+
+// AL_SOFT_deferred_updates, NULL if the driver lacks it
+static ALDEFERUPDATESSOFT v_alDeferUpdatesSOFT = NULL;
+static ALPROCESSUPDATESSOFT v_alProcessUpdatesSOFT = NULL;
+
 
 ALGENFILTERS v_alGenFilters = NULL;
 ALDELETEFILTERS v_alDeleteFilters = NULL;
@@ -259,38 +312,20 @@ int ds_get_sid()
 	return (int)(sound_buffers.size() - 1);
 }
 
-int ds_load_buffer(int *sid, int  /*flags*/, sound::IAudioFile* file)
+bool ds_decode_buffer(sound::IAudioFile* file, ds_decoded_buffer* decoded)
 {
-	Assert(sid != NULL);
 	Assert(file != NULL);
-
-	// All sounds are required to have a software buffer
-	*sid = ds_get_sid();
-	if (*sid == -1) {
-		nprintf(("Sound", "SOUND ==> No more sound buffers available\n"));
-		return -1;
-	}
-
-	ALuint pi;
-	OpenAL_ErrorCheck(alGenBuffers(1, &pi), return -1);
+	Assert(decoded != NULL);
 
 	const auto fileProps = file->getFileProperties();
+	decoded->props = fileProps;
 
-	ALenum format;
-	ALsizei size = fileProps.total_samples * fileProps.bytes_per_sample * fileProps.num_channels;
-	ALint n_channels = fileProps.num_channels;
-	ALsizei frequency;
-		
-	// format is now in pcm
-	frequency = fileProps.sample_rate;
-	format = openal_get_format(fileProps.bytes_per_sample * 8, fileProps.num_channels);
-
-	if (format == AL_INVALID_VALUE) {
-		return -1;
+	if (openal_get_format(fileProps.bytes_per_sample * 8, fileProps.num_channels) == AL_INVALID_VALUE) {
+		return false;
 	}
 
-	SCP_vector<uint8_t> audio_buffer;
-	audio_buffer.reserve(size);
+	decoded->data.clear();
+	decoded->data.reserve(fileProps.total_samples * fileProps.bytes_per_sample * fileProps.num_channels);
 
 	SCP_vector<uint8_t> buffer(fileProps.sample_rate * fileProps.bytes_per_sample * fileProps.num_channels);
 	int read;
@@ -299,25 +334,64 @@ int ds_load_buffer(int *sid, int  /*flags*/, sound::IAudioFile* file)
 			// buffer not large enough
 			buffer.resize(buffer.size() * 2);
 		} else {
-			audio_buffer.insert(audio_buffer.end(), buffer.begin(), std::next(buffer.begin(), read));
+			decoded->data.insert(decoded->data.end(), buffer.begin(), std::next(buffer.begin(), read));
 		}
 	}
 
-	Snd_sram += audio_buffer.size();
+	return true;
+}
+
+int ds_load_decoded_buffer(int *sid, const ds_decoded_buffer& decoded)
+{
+	Assert(sid != NULL);
+
+	const auto& fileProps = decoded.props;
+
+	ALenum format = openal_get_format(fileProps.bytes_per_sample * 8, fileProps.num_channels);
+
+	if (format == AL_INVALID_VALUE) {
+		return -1;
+	}
+
+	// All sounds are required to have a software buffer
+	*sid = ds_get_sid();
+	if (*sid == -1) {
+		nprintf(("Sound", "SOUND ==> No more sound buffers available\n"));
+		return -1;
+	}
 
-	OpenAL_ErrorCheck(alBufferData(pi, format, audio_buffer.data(), (ALsizei)audio_buffer.size(), frequency), return -1; );
+	ALuint pi;
+	OpenAL_ErrorCheck(alGenBuffers(1, &pi), return -1);
+
+	// format is now in pcm
+	ALsizei frequency = fileProps.sample_rate;
+
+	Snd_sram += decoded.data.size();
+
+	OpenAL_ErrorCheck(alBufferData(pi, format, decoded.data.data(), (ALsizei)decoded.data.size(), frequency), return -1; );
 
 	sound_buffers[*sid].buf_id = pi;
 	sound_buffers[*sid].channel_id = -1;
 	sound_buffers[*sid].frequency = frequency;
 	sound_buffers[*sid].bits_per_sample = fileProps.bytes_per_sample * 8;
-	sound_buffers[*sid].nchannels = n_channels;
+	sound_buffers[*sid].nchannels = fileProps.num_channels;
 	sound_buffers[*sid].nseconds = fl2i(fileProps.duration);
-	sound_buffers[*sid].nbytes = (int)audio_buffer.size();
+	sound_buffers[*sid].nbytes = (int)decoded.data.size();
 
 	return 0;
 }
 
+int ds_load_buffer(int *sid, int  /*flags*/, sound::IAudioFile* file)
+{
+	ds_decoded_buffer decoded;
+
+	if ( !ds_decode_buffer(file, &decoded) ) {
+		return -1;
+	}
+
+	return ds_load_decoded_buffer(sid, decoded);
+}
+
 /**
  * Initialise the ::Channels[] array dynamically based on system resources.
  */
@@ -342,11 +416,22 @@ void ds_init_channels()
 			}
 		}
 	}
+
+	// every channel and virtual voice needs an index in the sound handles
+	MAX_CHANNELS = MIN(MAX_CHANNELS, DS_MAX_VOICES - DS_MAX_VIRTUAL_VOICES);
+
 	try {
 		Channels = new channel[MAX_CHANNELS];
 	} catch (const std::bad_alloc&) {
 		Error(LOCATION, "Unable to allocate " SIZE_T_ARG " bytes for %d audio channels.", sizeof(channel) * MAX_CHANNELS, MAX_CHANNELS);
 	}
+
+	Voices.assign(MAX_CHANNELS + DS_MAX_VIRTUAL_VOICES, ds_voice());
+	Free_voices.clear();
+	for (int i = (int)Voices.size() - 1; i >= 0; i--) {
+		Free_voices.push_back(i);
+	}
+	Virtual_voices.clear();
 }
 
 /**
@@ -465,6 +550,17 @@ int ds_init()
 		Ds_float_supported = 1;
 	}
 
+	if ( alIsExtensionPresent( (const ALchar*)"AL_SOFT_deferred_updates" ) == AL_TRUE ) {
+		mprintf(("  Found extension \"AL_SOFT_deferred_updates\".\n"));
+		v_alDeferUpdatesSOFT = (ALDEFERUPDATESSOFT) alGetProcAddress("alDeferUpdatesSOFT");
+		v_alProcessUpdatesSOFT = (ALPROCESSUPDATESSOFT) alGetProcAddress("alProcessUpdatesSOFT");
+
+		if ( (v_alDeferUpdatesSOFT == NULL) || (v_alProcessUpdatesSOFT == NULL) ) {
+			v_alDeferUpdatesSOFT = NULL;
+			v_alProcessUpdatesSOFT = NULL;
+		}
+	}
+
 	Ds_use_eax = 0;
 
 	if ( alcIsExtensionPresent(ds_sound_device, (const ALchar*)"ALC_EXT_EFX") == AL_TRUE ) {
@@ -574,6 +670,103 @@ AL_InitError:
 	return -1;
 }
 
+/**
+ * Look up the voice of a sound handle
+ *
+ * @returns The voice, or NULL if the handle is invalid or belongs to a sound which was stopped since
+ */
+static ds_voice *ds_get_voice(ds_sound_handle sig)
+{
+	if ( !sig.isValid() ) {
+		return NULL;
+	}
+
+	auto index = (size_t)(sig.value() & (DS_MAX_VOICES - 1));
+
+	if ( (index >= Voices.size()) || (Voices[index].sig != sig) ) {
+		return NULL;
+	}
+
+	return &Voices[index];
+}
+
+/**
+ * Take an unused voice and give it a new handle
+ *
+ * @returns The voice, or NULL if all voices are in use
+ */
+static ds_voice *ds_voice_create(int channel_id)
+{
+	if (Free_voices.empty()) {
+		return NULL;
+	}
+
+	int index = Free_voices.back();
+	Free_voices.pop_back();
+
+	ds_voice *voice = &Voices[index];
+	int generation = (voice->generation % DS_MAX_GENERATION) + 1;
+
+	*voice = ds_voice();
+	voice->generation = generation;
+	voice->sig = ds_sound_handle((generation << DS_VOICE_INDEX_BITS) | index);
+	voice->channel_id = channel_id;
+
+	return voice;
+}
+
+static void ds_voice_remove_virtual(int index)
+{
+	auto it = std::find(Virtual_voices.begin(), Virtual_voices.end(), index);
+
+	if (it != Virtual_voices.end()) {
+		*it = Virtual_voices.back();
+		Virtual_voices.pop_back();
+	}
+}
+
+/**
+ * Mark a voice as unused, which invalidates its handle
+ */
+static void ds_voice_release(ds_voice *voice)
+{
+	int index = (int)(voice - Voices.data());
+
+	if (voice->channel_id < 0) {
+		ds_voice_remove_virtual(index);
+	}
+
+	voice->sig = ds_sound_handle::invalid();
+	voice->channel_id = -1;
+	Free_voices.push_back(index);
+}
+
+/**
+ * How long a voice has been playing in milliseconds of game time, so it stands still while the game or the sound is
+ * paused and runs faster under time compression
+ */
+static int ds_voice_get_elapsed(const ds_voice *voice)
+{
+	int now = (voice->pause_time >= 0) ? voice->pause_time : timestamp();
+
+	return now - voice->start_time;
+}
+
+/**
+ * How long a buffer plays in milliseconds
+ */
+static int ds_get_buffer_duration(int sid)
+{
+	const sound_buffer *buf = &sound_buffers[sid];
+	int bytes_per_second = buf->frequency * (buf->bits_per_sample / 8) * buf->nchannels;
+
+	if (bytes_per_second <= 0) {
+		return 0;
+	}
+
+	return (int)(((int64_t)buf->nbytes * 1000) / bytes_per_second);
+}
+
 /**
  * Free a single channel
  */
@@ -597,6 +790,11 @@ void ds_close_channel(int i)
 			sound_buffers[Channels[i].sid].channel_id = -1;
 		}
 
+		ds_voice *voice = ds_get_voice(Channels[i].sig);
+		if (voice != NULL) {
+			ds_voice_release(voice);
+		}
+
 		Channels[i].source_id = 0;
 		Channels[i].sid = -1;
 		Channels[i].sig       = ds_sound_handle::invalid();
@@ -622,6 +820,11 @@ void ds_close_channel_fast(int i)
 			sound_buffers[Channels[i].sid].channel_id = -1;
 		}
 
+		ds_voice *voice = ds_get_voice(Channels[i].sig);
+		if (voice != NULL) {
+			ds_voice_release(voice);
+		}
+
 		Channels[i].sid = -1;
 		Channels[i].sig    = ds_sound_handle::invalid();
 		Channels[i].snd_id = -1;
@@ -640,6 +843,29 @@ void ds_close_all_channels()
 	}
 }
 
+/**
+ * Free a channel for a more important sound.  A 3D sound on it goes on as a virtual voice if there is room for one.
+ */
+static void ds_evict_channel(int i)
+{
+	ds_voice *voice = ds_get_voice(Channels[i].sig);
+
+	if ( (voice != NULL) && voice->is_3d && !Channels[i].is_ambient && (Virtual_voices.size() < DS_MAX_VIRTUAL_VOICES) ) {
+		// go on from where the source actually is, it may have been paused for a while
+		ALfloat offset;
+		OpenAL_ErrorCheck( alGetSourcef(Channels[i].source_id, AL_SEC_OFFSET, &offset), offset = 0.0f );
+		voice->start_time = timestamp() - (int)(offset * 1000.0f);
+
+		voice->channel_id = -1;
+		Virtual_voices.push_back((int)(voice - Voices.data()));
+
+		// detach the voice so closing the channel does not release it
+		Channels[i].sig = ds_sound_handle::invalid();
+	}
+
+	ds_close_channel_fast(i);
+}
+
 /**
  * Unload a buffer
  */
@@ -649,6 +875,17 @@ void ds_unload_buffer(int sid)
 		return;
 	}
 
+	// virtual voices can't be started again without their buffer
+	for (size_t i = 0; i < Virtual_voices.size();) {
+		ds_voice *voice = &Voices[Virtual_voices[i]];
+
+		if (voice->sid == sid) {
+			ds_voice_release(voice);
+		} else {
+			i++;
+		}
+	}
+
 	if (sound_buffers[sid].channel_id >= 0) {
 		ds_close_channel_fast(sound_buffers[sid].channel_id);
 		sound_buffers[sid].channel_id = -1;
@@ -690,6 +927,10 @@ void ds_close()
 	delete [] Channels;
 	Channels = NULL;
 
+	Voices.clear();
+	Free_voices.clear();
+	Virtual_voices.clear();
+
 	alcMakeContextCurrent(NULL);	// hangs on me for some reason
 
 	if (ds_sound_context != NULL) {
@@ -704,6 +945,30 @@ void ds_close()
 }
 
 
+/**
+ * Determine the limit of concurrent instances of a sound from its retail priority
+ */
+static int ds_get_retail_limit(int priority)
+{
+	switch (priority) {
+		case DS_MUST_PLAY:
+			return 100;
+
+		case DS_LIMIT_ONE:
+			return 1;
+
+		case DS_LIMIT_TWO:
+			return 2;
+
+		case DS_LIMIT_THREE:
+			return 3;
+
+		default:
+			Int3();			// get Alan
+			return 100;
+	}
+}
+
 /**
  * Find a free channel to play a sound on.  If no free channels exists, free up one based on volume levels.
  * This is the original retail version of ds_get_free_channel().
@@ -711,14 +976,16 @@ void ds_close()
  * @param new_volume Volume for sound to play at
  * @param snd_id Which kind of sound to play
  * @param priority ::DS_MUST_PLAY, ::DS_LIMIT_ONE, ::DS_LIMIT_TWO, ::DS_LIMIT_THREE
+ * @param out_of_channels Set if no channel was found because all of them play more important sounds, as opposed to
+ *                        the sound being over its instance limit
  *
  * @returns	Channel number to play sound on, or -1 if no channel could be found
  *
  * NOTE: snd_id is needed since we limit the number of concurrent samples
  */
-int ds_get_free_channel_retail(float new_volume, int snd_id, int priority)
+static int ds_get_free_channel_retail(float new_volume, int snd_id, int priority, bool &out_of_channels)
 {
-	int			i, first_free_channel, limit = 100;
+	int			i, first_free_channel, limit;
 	int			instance_count;	// number of instances of sound already playing
 	int			lowest_vol_index = -1, lowest_instance_vol_index = -1;
 	float		lowest_vol = 1.0f, lowest_instance_vol = 1.0f;
@@ -727,30 +994,9 @@ int ds_get_free_channel_retail(float new_volume, int snd_id, int priority)
 
 	instance_count = 0;
 	first_free_channel = -1;
+	out_of_channels = false;
 
-	// determine the limit of concurrent instances of this sound
-	switch (priority) {
-		case DS_MUST_PLAY:
-			limit = 100;
-		break;
-
-		case DS_LIMIT_ONE:
-			limit = 1;
-		break;
-
-		case DS_LIMIT_TWO:
-			limit = 2;
-		break;
-
-		case DS_LIMIT_THREE:
-			limit = 3;
-		break;
-
-		default:
-			Int3();			// get Alan
-			limit = 100;
-		break;
-	}
+	limit = ds_get_retail_limit(priority);
 
 	// Look for a channel to use to play this sample
 	for ( i = 0; i < MAX_CHANNELS; i++ ) {
@@ -826,10 +1072,12 @@ continue_channels: ;
 			// Check if the lowest volume playing is less than the volume of the requested sound.
 			// If so, then we are going to trash the lowest volume sound.
 			if ( Channels[lowest_vol_index].vol <= new_volume ) {
-				ds_close_channel_fast(lowest_vol_index);
+				ds_evict_channel(lowest_vol_index);
 				first_free_channel = lowest_vol_index;
 			}
 		}
+
+		out_of_channels = (first_free_channel == -1);
 	}
 
 	if ( (first_free_channel >= 0) && (Channels[first_free_channel].source_id == 0) ) {
@@ -846,12 +1094,15 @@ continue_channels: ;
  * @param snd_id Which kind of sound to play
  * @param enhanced_priority Priority level, see EnhancedSoundPriority enum in gamesnd.h
  * @param enhanced_limit Per-sound concurrency limit
+ * @param out_of_channels Set if no channel was found because all of them play more important sounds, as opposed to
+ *                        the sound being over its instance limit
  *
  * @returns	Channel number to play sound on, or -1 if no channel could be found
  *
  * NOTE: snd_id is needed since we limit the number of concurrent samples
  */
-int ds_get_free_channel_enhanced(float new_volume, int snd_id, int enhanced_priority, unsigned int enhanced_limit)
+static int ds_get_free_channel_enhanced(float new_volume, int snd_id, int enhanced_priority, unsigned int enhanced_limit,
+	bool &out_of_channels)
 {
 	int			i, first_free_channel;
 	int			instance_count;	// number of instances of sound already playing
@@ -865,6 +1116,7 @@ int ds_get_free_channel_enhanced(float new_volume, int snd_id, int enhanced_prio
 
 	instance_count = 0;
 	first_free_channel = -1;
+	out_of_channels = false;
 
 	// Look for a channel to use to play this sample
 	for ( i = 0; i < MAX_CHANNELS; i++ ) {
@@ -947,11 +1199,13 @@ continue_channels: ;
 			// If so, then we are going to trash the least important sound.
 			if ( (enhanced_priority == SND_ENHANCED_PRIORITY_MUST_PLAY) || (Channels[least_important_index].priority - enhanced_priority >= 2)) {
 				if ( Channels[least_important_index].vol <= new_volume ) {
-					ds_close_channel_fast(least_important_index);
+					ds_evict_channel(least_important_index);
 					first_free_channel = least_important_index;
 				}
 			}
 		}
+
+		out_of_channels = (first_free_channel == -1);
 	}
 
 	if ( (first_free_channel >= 0) && (Channels[first_free_channel].source_id == 0) ) {
@@ -974,12 +1228,14 @@ continue_channels: ;
  * @param snd_id Which kind of sound to play
  * @param priority From retail :DS_MUST_PLAY, ::DS_LIMIT_ONE, ::DS_LIMIT_TWO, ::DS_LIMIT_THREE
  * @param enhanced_priority Output param that's updated with correct priority if enhanced sound is enabled
+ * @param out_of_channels Set if no channel was found because all of them play more important sounds
  *
  * @returns	Channel number to play sound on, or -1 if no channel could be found
  *
  * NOTE: snd_id is needed since we limit the number of concurrent samples
  */
-int ds_get_free_channel(float volume, int snd_id, int priority, int & enhanced_priority, const EnhancedSoundData & enhanced_sound_data)
+static int ds_get_free_channel(float volume, int snd_id, int priority, int & enhanced_priority,
+	const EnhancedSoundData & enhanced_sound_data, bool & out_of_channels)
 {
 	int first_free_channel = -1;
 	unsigned int enhanced_limit = 0;
@@ -994,9 +1250,9 @@ int ds_get_free_channel(float volume, int snd_id, int priority, int & enhanced_p
 			enhanced_priority = SND_ENHANCED_PRIORITY_MUST_PLAY;
 		}
 
-		first_free_channel = ds_get_free_channel_enhanced(volume, snd_id, enhanced_priority, enhanced_limit);
+		first_free_channel = ds_get_free_channel_enhanced(volume, snd_id, enhanced_priority, enhanced_limit, out_of_channels);
 	} else { // enhanced sound is off
-		first_free_channel = ds_get_free_channel_retail(volume, snd_id, priority);
+		first_free_channel = ds_get_free_channel_retail(volume, snd_id, priority, out_of_channels);
 	}
 
 	return first_free_channel;
@@ -1088,12 +1344,13 @@ ds_sound_handle ds_play(int sid, int snd_id, int priority, const EnhancedSoundDa
 {
 	int ch_idx;
 	int enhanced_priority = SND_ENHANCED_PRIORITY_INVALID;
+	bool out_of_channels;
 
 	if (!ds_initialized) {
 		return ds_sound_handle::invalid();
 	}
 
-	ch_idx = ds_get_free_channel(volume, snd_id, priority, enhanced_priority, *enhanced_sound_data);
+	ch_idx = ds_get_free_channel(volume, snd_id, priority, enhanced_priority, *enhanced_sound_data, out_of_channels);
 
 	if (ch_idx < 0) {
 		return ds_sound_handle::invalid();
@@ -1136,13 +1393,20 @@ ds_sound_handle ds_play(int sid, int snd_id, int priority, const EnhancedSoundDa
 								is_voice_msg ? AL_EFFECTSLOT_NULL : AL_EFX_aux_id, 0, AL_FILTER_NULL) );
 	}
 
+	ds_voice *voice = ds_voice_create(ch_idx);
+
+	if (voice == NULL) {
+		OpenAL_ErrorPrint( alSourcei(Channels[ch_idx].source_id, AL_BUFFER, 0) );
+		return ds_sound_handle::invalid();
+	}
+
 	OpenAL_ErrorPrint( alSourcePlay(Channels[ch_idx].source_id) );
 
 	sound_buffers[sid].channel_id = ch_idx;
 
 	Channels[ch_idx].sid = sid;
 	Channels[ch_idx].snd_id = snd_id;
-	Channels[ch_idx].sig           = ds_sound_handle(channel_next_sig++);
+	Channels[ch_idx].sig           = voice->sig;
 	Channels[ch_idx].last_position = 0;
 	Channels[ch_idx].is_voice_msg = is_voice_msg;
 	Channels[ch_idx].vol = volume;
@@ -1150,10 +1414,6 @@ ds_sound_handle ds_play(int sid, int snd_id, int priority, const EnhancedSoundDa
 	Channels[ch_idx].priority = enhanced_priority;
 	Channels[ch_idx].is_ambient = false; // no support for 2D ambient sounds
 
-	if (channel_next_sig < 0) {
-		channel_next_sig = 1;
-	}
-
 	return Channels[ch_idx].sig;
 }
 
@@ -1164,17 +1424,17 @@ ds_sound_handle ds_play(int sid, int snd_id, int priority, const EnhancedSoundDa
  */
 int ds_get_channel(ds_sound_handle sig)
 {
-	int i;
+	int i = ds_get_channel_raw(sig);
 
-	for ( i = 0; i < MAX_CHANNELS; i++ ) {
-		if ( Channels[i].source_id && (Channels[i].sig == sig) ) {
-			if ( ds_is_channel_playing(i) == TRUE ) {
-				return i;
-			}
-			if (ds_is_channel_paused(i) == TRUE) {
-				return i;
-			}
-		}
+	if (i < 0) {
+		return -1;
+	}
+
+	ALint status;
+	OpenAL_ErrorCheck( alGetSourcei(Channels[i].source_id, AL_SOURCE_STATE, &status), return -1 );
+
+	if ( (status == AL_PLAYING) || (status == AL_PAUSED) ) {
+		return i;
 	}
 
 	return -1;
@@ -1187,13 +1447,67 @@ int ds_get_channel(ds_sound_handle sig)
  */
 int ds_get_channel_raw(ds_sound_handle sig)
 {
-	for (int i = 0; i < MAX_CHANNELS; i++) {
-		if (Channels[i].source_id && (Channels[i].sig == sig)) {
-			return i;
-		}
+	ds_voice *voice = ds_get_voice(sig);
+
+	if ( (voice == NULL) || (voice->channel_id < 0) ) {
+		return -1;
 	}
 
-	return -1;
+	int i = voice->channel_id;
+
+	if ( (Channels[i].source_id == 0) || (Channels[i].sig != sig) ) {
+		return -1;
+	}
+
+	return i;
+}
+
+/**
+ * Return whether the sound identified by sig plays as a virtual voice, i.e. without a channel
+ */
+bool ds_is_virtual(ds_sound_handle sig)
+{
+	ds_voice *voice = ds_get_voice(sig);
+
+	return (voice != NULL) && (voice->channel_id < 0);
+}
+
+/**
+ * Stop a sound which plays as a virtual voice.  Does nothing for sounds playing on a channel.
+ */
+void ds_stop_virtual(ds_sound_handle sig)
+{
+	ds_voice *voice = ds_get_voice(sig);
+
+	if ( (voice != NULL) && (voice->channel_id < 0) ) {
+		ds_voice_release(voice);
+	}
+}
+
+/**
+ * Pause a sound which plays as a virtual voice, so it stops aging until it is resumed.  Does nothing for sounds playing
+ * on a channel.
+ */
+void ds_pause_virtual(ds_sound_handle sig)
+{
+	ds_voice *voice = ds_get_voice(sig);
+
+	if ( (voice != NULL) && (voice->channel_id < 0) && (voice->pause_time < 0) ) {
+		voice->pause_time = timestamp();
+	}
+}
+
+/**
+ * Resume a paused virtual voice.  Does nothing for sounds playing on a channel.
+ */
+void ds_resume_virtual(ds_sound_handle sig)
+{
+	ds_voice *voice = ds_get_voice(sig);
+
+	if ( (voice != NULL) && (voice->channel_id < 0) && (voice->pause_time >= 0) ) {
+		voice->start_time += timestamp() - voice->pause_time;
+		voice->pause_time = -1;
+	}
 }
 
 /**
@@ -1274,6 +1588,10 @@ void ds_stop_channel_all()
 			OpenAL_ErrorPrint( alSourceStop(Channels[i].source_id) );
 		}
 	}
+
+	while ( !Virtual_voices.empty() ) {
+		ds_voice_release(&Voices[Virtual_voices.back()]);
+	}
 }
 
 /**
@@ -1348,9 +1666,125 @@ void ds_set_pitch(int channel_id, float pitch)
 	}
 }
 
+/**
+ * Set the volume of a sound, whether it plays on a channel or as a virtual voice
+ */
+void ds_set_voice_volume(ds_sound_handle sig, float vol)
+{
+	ds_voice *voice = ds_get_voice(sig);
+
+	if (voice == NULL) {
+		return;
+	}
+
+	CAP(vol, 0.0f, 1.0f);
+	voice->vol = vol;
+
+	if (voice->channel_id >= 0) {
+		ds_set_volume(voice->channel_id, vol);
+	}
+}
+
+/**
+ * Set the pitch of a sound, whether it plays on a channel or as a virtual voice
+ */
+void ds_set_voice_pitch(ds_sound_handle sig, float pitch)
+{
+	ds_voice *voice = ds_get_voice(sig);
+
+	if (voice == NULL) {
+		return;
+	}
+
+	voice->pitch = pitch;
+
+	if (voice->channel_id >= 0) {
+		ds_set_pitch(voice->channel_id, pitch);
+	}
+}
+
+/**
+ * Start the 3D sound of a voice on a channel
+ *
+ * @param channel_id Channel to play the sound on, it has to have a source
+ * @param voice Voice of the sound, its channel_id has to be set already
+ * @param offset Seconds into the sound to start playing at
+ *
+ * @return true if the sound started
+ */
+static bool ds3d_start_channel(int channel_id, const ds_voice *voice, float offset)
+{
+	ALuint source_id = Channels[channel_id].source_id;
+
+	// set up 3D sound data here
+	ds3d_update_buffer(channel_id, voice->min, voice->max, &voice->pos, voice->has_vel ? &voice->vel : NULL);
+
+
+	OpenAL_ErrorPrint( alSourcef(source_id, AL_PITCH, voice->pitch) );
+
+	OpenAL_ErrorPrint( alSourcef(source_id, AL_GAIN, voice->vol) );
+
+	ALint status;
+	OpenAL_ErrorCheck( alGetSourcei(source_id, AL_SOURCE_STATE, &status), return false );
+
+	if (status == AL_PLAYING) {
+		OpenAL_ErrorPrint( alSourceStop(source_id) );
+	}
+
+	OpenAL_ErrorCheck( alSourcei(source_id, AL_BUFFER, sound_buffers[voice->sid].buf_id), return false );
+
+	if (Ds_eax_inited) {
+		OpenAL_ErrorPrint( alSource3i(source_id, AL_AUXILIARY_SEND_FILTER, AL_EFX_aux_id, 0, AL_FILTER_NULL) );
+	}
+
+	OpenAL_ErrorPrint( alSourcei(source_id, AL_SOURCE_RELATIVE, AL_FALSE) );
+
+	OpenAL_ErrorPrint( alSourcei(source_id, AL_LOOPING, (voice->looping) ? AL_TRUE : AL_FALSE) );
+
+	if (offset > 0.0f) {
+		OpenAL_ErrorPrint( alSourcef(source_id, AL_SEC_OFFSET, offset) );
+	}
+
+	OpenAL_ErrorPrint( alSourcePlay(source_id) );
+
+
+	sound_buffers[voice->sid].channel_id = channel_id;
+
+	Channels[channel_id].sid = voice->sid;
+	Channels[channel_id].snd_id = voice->snd_id;
+	Channels[channel_id].sig           = voice->sig;
+	Channels[channel_id].last_position = 0;
+	Channels[channel_id].is_voice_msg = false;
+	Channels[channel_id].vol = voice->vol;
+	Channels[channel_id].looping = voice->looping;
+	Channels[channel_id].priority = voice->priority;
+	Channels[channel_id].is_ambient = voice->is_ambient;
+
+	return true;
+}
+
+/**
+ * Count the virtual voices of a kind of sound
+ */
+static int ds_get_virtual_instance_count(int snd_id)
+{
+	int count = 0;
+
+	for (int index : Virtual_voices) {
+		if (Voices[index].snd_id == snd_id) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
 /**
  * Starts a ds3d sound playing
  *
+ * If all channels play more important sounds, the sound is started as a virtual voice instead.  It goes on playing
+ * without a channel and ds_do_frame() moves it onto one once it is audible enough.
+ *
  * @param sid Software id for sound to play
  * @param snd_id Identifies what type of sound is playing
  * @param pos World pos of sound
@@ -1370,69 +1804,92 @@ ds_sound_handle ds3d_play(int sid, int snd_id, const vec3d* pos, const vec3d* ve
 {
 	int channel_id;
 	int enhanced_priority = SND_ENHANCED_PRIORITY_INVALID;
+	bool out_of_channels;
 
 
 	if (!ds_initialized) {
 		return ds_sound_handle::invalid();
 	}
 
-	channel_id = ds_get_free_channel(estimated_vol, snd_id, priority, enhanced_priority, *enhanced_sound_data);
+	channel_id = ds_get_free_channel(estimated_vol, snd_id, priority, enhanced_priority, *enhanced_sound_data,
+		out_of_channels);
 
 	if (channel_id < 0) {
-		return ds_sound_handle::invalid();
-	}
+		// ambient sounds can't be preempted, so they never need to go virtual
+		if (!out_of_channels || is_ambient || (Virtual_voices.size() >= DS_MAX_VIRTUAL_VOICES)) {
+			return ds_sound_handle::invalid();
+		}
 
-	if ( Channels[channel_id].source_id == 0 ) {
+		// virtual voices of a sound count against its instance limit as well
+		int limit = Cmdline_no_enhanced_sound ? ds_get_retail_limit(priority) : (int)enhanced_sound_data->limit;
+		if (ds_get_virtual_instance_count(snd_id) >= limit) {
+			return ds_sound_handle::invalid();
+		}
+	} else if ( Channels[channel_id].source_id == 0 ) {
 		return ds_sound_handle::invalid();
 	}
 
-	// set up 3D sound data here
-	ds3d_update_buffer(channel_id, min, max, pos, vel);
-
+	ds_voice *voice = ds_voice_create(channel_id);
 
-	OpenAL_ErrorPrint( alSourcef(Channels[channel_id].source_id, AL_PITCH, 1.0f) );
-
-	OpenAL_ErrorPrint( alSourcef(Channels[channel_id].source_id, AL_GAIN, max_volume) );
-
-	ALint status;
-	OpenAL_ErrorCheck(alGetSourcei(Channels[channel_id].source_id, AL_SOURCE_STATE, &status),
-	                  return ds_sound_handle::invalid());
-
-	if (status == AL_PLAYING) {
-		OpenAL_ErrorPrint( alSourceStop(Channels[channel_id].source_id) );
+	if (voice == NULL) {
+		return ds_sound_handle::invalid();
 	}
 
-	OpenAL_ErrorCheck(alSourcei(Channels[channel_id].source_id, AL_BUFFER, sound_buffers[sid].buf_id),
-	                  return ds_sound_handle::invalid());
+	voice->is_3d = true;
+	voice->sid = sid;
+	voice->snd_id = snd_id;
+	voice->priority = enhanced_priority;
+	voice->pos = *pos;
+	voice->has_vel = (vel != NULL);
+	voice->vel = (vel != NULL) ? *vel : vmd_zero_vector;
+	voice->min = min;
+	voice->max = max;
+	voice->vol = max_volume;
+	voice->looping = looping;
+	voice->is_ambient = is_ambient;
+	voice->start_time = timestamp();
 
-	if (Ds_eax_inited) {
-		OpenAL_ErrorPrint( alSource3i(Channels[channel_id].source_id, AL_AUXILIARY_SEND_FILTER, AL_EFX_aux_id, 0, AL_FILTER_NULL) );
+	if (channel_id < 0) {
+		Virtual_voices.push_back((int)(voice - Voices.data()));
+		return voice->sig;
 	}
 
-	OpenAL_ErrorPrint( alSourcei(Channels[channel_id].source_id, AL_SOURCE_RELATIVE, AL_FALSE) );
+	if ( !ds3d_start_channel(channel_id, voice, 0.0f) ) {
+		ds_voice_release(voice);
+		return ds_sound_handle::invalid();
+	}
 
-	OpenAL_ErrorPrint( alSourcei(Channels[channel_id].source_id, AL_LOOPING, (looping) ? AL_TRUE : AL_FALSE) );
+	return voice->sig;
+}
 
-	OpenAL_ErrorPrint( alSourcePlay(Channels[channel_id].source_id) );
+/**
+ * Update the position and range of a 3D sound, whether it plays on a channel or as a virtual voice
+ *
+ * @return false if the sound is no longer playing
+ */
+bool ds3d_update_voice(ds_sound_handle sig, float min, float max, const vec3d *pos, const vec3d *vel)
+{
+	ds_voice *voice = ds_get_voice(sig);
 
+	if (voice == NULL) {
+		return false;
+	}
 
-	sound_buffers[sid].channel_id = channel_id;
+	if (voice->channel_id >= 0) {
+		ds3d_update_buffer(voice->channel_id, min, max, pos, vel);
+	}
 
-	Channels[channel_id].sid = sid;
-	Channels[channel_id].snd_id = snd_id;
-	Channels[channel_id].sig           = ds_sound_handle(channel_next_sig++);
-	Channels[channel_id].last_position = 0;
-	Channels[channel_id].is_voice_msg = false;
-	Channels[channel_id].vol = max_volume;
-	Channels[channel_id].looping = looping;
-	Channels[channel_id].priority = enhanced_priority;
-	Channels[channel_id].is_ambient = is_ambient;
+	voice->min = min;
+	voice->max = max;
 
-	if (channel_next_sig < 0 ) {
-		channel_next_sig = 1;
+	if (pos != NULL) {
+		voice->pos = *pos;
 	}
 
-	return Channels[channel_id].sig;
+	voice->has_vel = (vel != NULL);
+	voice->vel = (vel != NULL) ? *vel : vmd_zero_vector;
+
+	return true;
 }
 
 /**
@@ -1537,6 +1994,47 @@ int ds_get_number_channels()
 	return n;
 }
 
+/**
+ * Hold back changes to sources until ds_process_updates(), so a batch of them reaches the mixer at once instead of
+ * one at a time
+ */
+void ds_defer_updates()
+{
+	if (!ds_initialized) {
+		return;
+	}
+
+	if (v_alDeferUpdatesSOFT != NULL) {
+		v_alDeferUpdatesSOFT();
+	} else {
+		alcSuspendContext(ds_sound_context);
+	}
+}
+
+/**
+ * Apply the changes to sources made since ds_defer_updates()
+ */
+void ds_process_updates()
+{
+	if (!ds_initialized) {
+		return;
+	}
+
+	if (v_alProcessUpdatesSOFT != NULL) {
+		v_alProcessUpdatesSOFT();
+	} else {
+		alcProcessContext(ds_sound_context);
+	}
+}
+
+/**
+ * Returns the number of sounds which play as virtual voices
+ */
+int ds_get_number_virtual_voices()
+{
+	return (int)Virtual_voices.size();
+}
+
 /**
  * Retreive raw data from a sound buffer
  */
@@ -1906,7 +2404,117 @@ int ds_eax_is_inited()
 }
 
 /**
- * Called once per game frame to make sure voice messages aren't looping
+ * Drop virtual voices which would have finished playing by now, then move the most audible ones onto channels which
+ * are free or play a sound which is clearly less audible
+ */
+static void ds_update_virtual_voices()
+{
+	static SCP_vector<std::pair<float, int>> virtual_voices;	// audibility, Voices[] index
+	static SCP_vector<std::pair<float, int>> real_voices;		// audibility, Channels[] index
+	static SCP_vector<int> free_channels;
+
+	if (Virtual_voices.empty()) {
+		return;
+	}
+
+	virtual_voices.clear();
+
+	for (size_t i = 0; i < Virtual_voices.size();) {
+		ds_voice *voice = &Voices[Virtual_voices[i]];
+
+		if ( !voice->looping && (ds_voice_get_elapsed(voice) >= ds_get_buffer_duration(voice->sid)) ) {
+			ds_voice_release(voice);
+			continue;
+		}
+
+		// paused voices stay virtual until they are resumed
+		if (voice->pause_time >= 0) {
+			i++;
+			continue;
+		}
+
+		virtual_voices.emplace_back(ds3d_get_audibility(voice->vol, voice->min, voice->max, &voice->pos), Virtual_voices[i]);
+		i++;
+	}
+
+	if (virtual_voices.empty()) {
+		return;
+	}
+
+	std::sort(virtual_voices.begin(), virtual_voices.end(), std::greater<std::pair<float, int>>());
+
+	free_channels.clear();
+	real_voices.clear();
+
+	for (int i = 0; i < MAX_CHANNELS; i++) {
+		channel *chp = &Channels[i];
+
+		if ( (chp->source_id == 0) || (chp->sid == -1) ) {
+			free_channels.push_back(i);
+			continue;
+		}
+
+		ALint status;
+		ds_voice *voice;
+		OpenAL_ErrorCheck( alGetSourcei(chp->source_id, AL_SOURCE_STATE, &status), goto continue_channels );
+
+		if ( (status == AL_INITIAL) || (status == AL_STOPPED) ) {
+			ds_close_channel_fast(i);
+			free_channels.push_back(i);
+			continue;
+		}
+
+		// only 3D sounds which can go virtual themselves give up their channel
+		voice = ds_get_voice(chp->sig);
+
+		if ( (status == AL_PLAYING) && (voice != NULL) && voice->is_3d && !chp->is_ambient ) {
+			real_voices.emplace_back(ds3d_get_audibility(voice->vol, voice->min, voice->max, &voice->pos), i);
+		}
+continue_channels: ;
+	}
+
+	std::sort(real_voices.begin(), real_voices.end());
+
+	size_t next_free = 0, next_real = 0;
+
+	for (const auto &candidate : virtual_voices) {
+		int channel_id;
+
+		if (next_free < free_channels.size()) {
+			channel_id = free_channels[next_free++];
+		} else if ( (next_real < real_voices.size())
+			&& (candidate.first > real_voices[next_real].first * DS_VOICE_SWAP_MARGIN) ) {
+			channel_id = real_voices[next_real++].second;
+			ds_evict_channel(channel_id);
+		} else {
+			break;
+		}
+
+		if (Channels[channel_id].source_id == 0) {
+			OpenAL_ErrorCheck( alGenSources(1, &Channels[channel_id].source_id), return );
+		}
+
+		ds_voice *voice = &Voices[candidate.second];
+
+		ds_voice_remove_virtual(candidate.second);
+		voice->channel_id = channel_id;
+
+		// pick the sound up where it would be if it had been playing all along
+		float offset = ds_voice_get_elapsed(voice) / 1000.0f;
+		if (voice->looping) {
+			int duration = ds_get_buffer_duration(voice->sid);
+			offset = (duration > 0) ? fmodf(offset, duration / 1000.0f) : 0.0f;
+		}
+
+		if ( !ds3d_start_channel(channel_id, voice, offset) ) {
+			ds_voice_release(voice);
+		}
+	}
+}
+
+/**
+ * Called once per game frame to make sure voice messages aren't looping, and to give channels to the most audible
+ * virtual voices
  */
 void ds_do_frame()
 {
@@ -1936,6 +2544,8 @@ void ds_do_frame()
 			}
 		}
 	}
+
+	ds_update_virtual_voices();
 }
 
 /**
@@ -56,14 +56,28 @@ struct ds_sound_handle_tag {
 };
 using ds_sound_handle = ::util::ID<ds_sound_handle_tag, int, -1>;
 
+// The PCM data of a sound file, decoded but not uploaded to OpenAL yet
+struct ds_decoded_buffer {
+	SCP_vector<uint8_t> data;
+	sound::AudioFileProperties props;
+};
+
 int ds_init();
 void ds_close();
 int ds_load_buffer(int *sid, int flags, sound::IAudioFile* file);
+// Decodes the whole file, this does not touch OpenAL so it may run on any thread
+bool ds_decode_buffer(sound::IAudioFile* file, ds_decoded_buffer* decoded);
+// Uploads decoded data into a new sound buffer, main thread only
+int ds_load_decoded_buffer(int *sid, const ds_decoded_buffer& decoded);
 void ds_unload_buffer(int sid);
 ds_sound_handle ds_play(int sid, int snd_id, int priority, const EnhancedSoundData* enhanced_sound_data, float volume,
                         float pan, int looping, bool is_voice_msg = false);
 int ds_get_channel(ds_sound_handle sig);
 int ds_get_channel_raw(ds_sound_handle sig);
+bool ds_is_virtual(ds_sound_handle sig);
+void ds_stop_virtual(ds_sound_handle sig);
+void ds_pause_virtual(ds_sound_handle sig);
+void ds_resume_virtual(ds_sound_handle sig);
 int ds_is_channel_playing(int channel);
 bool ds_is_channel_paused(int channel_id);
 void ds_stop_channel(int channel);
@@ -84,6 +98,8 @@ float ds_get_pitch(int channel);
  * @details A pitch value of 1.0 means that the original sound is not changed.
  */
 void ds_set_pitch(int channel, float pitch);
+void ds_set_voice_volume(ds_sound_handle sig, float vol);
+void ds_set_voice_pitch(ds_sound_handle sig, float pitch);
 void ds_set_position(int channel, unsigned int offset);
 unsigned int ds_get_play_position(int channel);
 int ds_get_data(int sid, char *data);
@@ -99,9 +115,17 @@ int ds_get_sound_id(int channel);
 // Returns the number of channels that are actually playing
 int ds_get_number_channels();
 
+// Returns the number of sounds which play without a channel until they are audible enough to get one
+int ds_get_number_virtual_voices();
+
+// Batches changes to many sources, everything between the two calls takes effect together
+void ds_defer_updates();
+void ds_process_updates();
+
 ds_sound_handle ds3d_play(int sid, int snd_id, const vec3d* pos, const vec3d* vel, float min, float max, bool looping,
                           float max_volume, float estimated_vol, const EnhancedSoundData* enhanced_sound_data,
                           int priority = DS_MUST_PLAY, bool is_ambient = false);
+bool ds3d_update_voice(ds_sound_handle sig, float min, float max, const vec3d *pos, const vec3d *vel);
 
 void ds_do_frame();
 
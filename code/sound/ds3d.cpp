@@ -19,6 +19,27 @@
 #include "sound/sound.h"
 
 
+// last position passed to ds3d_update_listener(), in game coordinates
+static vec3d Ds3d_listener_pos = ZERO_VECTOR;
+
+// The rolloff factor which makes the sound fall off to MIN_GAIN at the max distance
+static float ds3d_get_rolloff(float min, float max)
+{
+	if (max <= min) {
+		return 0.0f;
+	}
+
+	#define MIN_GAIN	0.05f
+
+	float rolloff = (min / (min + (max - min))) / MIN_GAIN;
+
+	if (rolloff < 0.0f) {
+		rolloff = 0.0f;
+	}
+
+	return rolloff;
+}
+
 // ---------------------------------------------------------------------------------------
 // ds3d_update_buffer()
 //
@@ -44,7 +65,7 @@ int ds3d_update_buffer(int channel_id, float min, float max, const vec3d *pos, c
 	}
 
 	ALuint source_id = Channels[channel_id].source_id;
-	ALfloat rolloff = 1.0f;
+	ALfloat rolloff = ds3d_get_rolloff(min, max);
 
 	if (pos) {
 		OpenAL_ErrorPrint( alSource3f(source_id, AL_POSITION, pos->xyz.x, pos->xyz.y, -pos->xyz.z) );
@@ -58,18 +79,6 @@ int ds3d_update_buffer(int channel_id, float min, float max, const vec3d *pos, c
 		OpenAL_ErrorPrint( alDopplerFactor(0.0f) );
 	}
 
-	if (max <= min) {
-		rolloff = 0.0f;
-	} else {
-		#define MIN_GAIN	0.05f
-
-		rolloff = (min / (min + (max - min))) / MIN_GAIN;
-
-		if (rolloff < 0.0f) {
-			rolloff = 0.0f;
-		}
-	}
-
 	OpenAL_ErrorPrint( alSourcef(source_id, AL_ROLLOFF_FACTOR, rolloff) );
 
 	OpenAL_ErrorPrint( alSourcef(source_id, AL_REFERENCE_DISTANCE, min) );
@@ -98,6 +107,7 @@ int ds3d_update_listener(const vec3d *pos, const vec3d *vel, const matrix *orien
 
 	if (pos) {
 		OpenAL_ErrorPrint( alListener3f(AL_POSITION, pos->xyz.x, pos->xyz.y, -pos->xyz.z) );
+		Ds3d_listener_pos = *pos;
 	}
 
 	if (vel) {
@@ -121,3 +131,36 @@ int ds3d_update_listener(const vec3d *pos, const vec3d *vel, const matrix *orien
 	return 0;
 }
 
+
+// ---------------------------------------------------------------------------------------
+// ds3d_get_audibility()
+//
+//	Estimates how loud a 3D sound is at the listener, the same way OpenAL attenuates it with
+//	the inverse clamped distance model.  Used to decide which sounds get a channel.
+//
+//	parameters:		vol		=> volume of the sound at its min distance
+//						min		=>	the distance at which sound doesn't get any louder
+//						max		=>	the distance at which sound doesn't attenuate any further
+//						pos		=> world position of sound
+//
+//	returns:		the gain of the sound, from 0 to vol
+//
+float ds3d_get_audibility(float vol, float min, float max, const vec3d *pos)
+{
+	float rolloff = ds3d_get_rolloff(min, max);
+
+	if (rolloff <= 0.0f) {
+		return vol;
+	}
+
+	float dist = vm_vec_dist(pos, &Ds3d_listener_pos);
+	CLAMP(dist, min, max);
+
+	float denom = min + rolloff * (dist - min);
+
+	if (denom <= 0.0f) {
+		return vol;
+	}
+
+	return vol * (min / denom);
+}
@@ -14,5 +14,6 @@
 
 int	ds3d_update_listener(const vec3d *pos, const vec3d *vel, const matrix *orient);
 int	ds3d_update_buffer(int channel, float min, float max, const vec3d *pos, const vec3d *vel);
+float	ds3d_get_audibility(float vol, float min, float max, const vec3d *pos);
 
 #endif /* __DS3D_H__ */
@@ -82,6 +82,10 @@ int openal_find_capture_device_by_name(const SCP_string& device);
 #endif
 
 // not define by older OpenAL versions
+#ifndef AL_SEC_OFFSET
+#define AL_SEC_OFFSET	0x1024
+#endif
+
 #ifndef AL_BYTE_OFFSET
 #define AL_BYTE_OFFSET	0x1026
 #endif
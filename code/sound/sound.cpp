@@ -15,7 +15,9 @@
 #include "globalincs/alphacolors.h"
 #include "globalincs/pstypes.h"
 #include "globalincs/vmallocator.h"
+#include "io/timer.h"
 #include "menuui/mainhallmenu.h"
+#include "mission/missionmanifest.h"
 #include "mod_table/mod_table.h"
 #include "options/Option.h"
 #include "osapi/osapi.h"
@@ -26,6 +28,7 @@
 #include "sound/dscap.h"
 #include "tracing/Monitor.h"
 #include "tracing/tracing.h"
+#include "utils/threading.h"
 
 #ifdef WITH_FFMPEG
 #include "sound/ffmpeg/FFmpegWaveFile.h"
@@ -331,24 +334,14 @@ static std::unique_ptr<sound::IAudioFile> openAudioFile(const char* fileName)
 //						failure => -1
 //
 //int snd_load( char *filename, int hardware, int use_ds3d, int *sig)
-sound_load_id snd_load(game_snd_entry* entry, int *flags, int /*allow_hardware_load*/)
-{
-	int type;
-	sound_info* si;
-	loaded_sound* snd;
-	size_t n;
-
-	if (!ds_initialized)
-		return sound_load_id::invalid();
 
-	if (flags && *flags & GAME_SND_NOT_VALID)
-		return sound_load_id::invalid();
+namespace {
 
-	if (!VALID_FNAME(entry->filename)) {
-		if (flags)
-			*flags |= GAME_SND_NOT_VALID;
-		return sound_load_id::invalid();
-	}
+// Looks for an already loaded sound which can be used for entry.  If there is none, slot is set to the index the sound
+// should be loaded into.
+sound_load_id snd_find_loaded(game_snd_entry* entry, const int* flags, size_t* slot)
+{
+	size_t n;
 
 	for (n = 0; n < Sounds.size(); n++) {
 		if ( !(Sounds[n].flags & SND_F_USED) ) {
@@ -371,20 +364,15 @@ sound_load_id snd_load(game_snd_entry* entry, int *flags, int /*allow_hardware_l
 		}
 	}
 
-	if ( n == Sounds.size() ) {
-		loaded_sound new_sound;
-		new_sound.sid   = -1;
-		new_sound.flags = 0;
-
-		Sounds.push_back(new_sound);
-	}
-
-	snd = &Sounds[n];
+	if (slot)
+		*slot = n;
 
-	si = &snd->info;
-
-	TRACE_SCOPE(tracing::LoadSound);
+	return sound_load_id::invalid();
+}
 
+// Opens the file of a sound which is not loaded yet.  Has to run on the main thread since it uses cfile.
+std::unique_ptr<sound::IAudioFile> snd_open(game_snd_entry* entry, int *flags)
+{
 	nprintf(("Sound", "SOUND ==> Loading '%s'\n", entry->filename));
 
 	std::unique_ptr<sound::IAudioFile> audio_file = openAudioFile(entry->filename);
@@ -392,14 +380,11 @@ sound_load_id snd_load(game_snd_entry* entry, int *flags, int /*allow_hardware_l
 	if (audio_file == nullptr) {
 		if (flags)
 			*flags |= GAME_SND_NOT_VALID;
-		return sound_load_id::invalid();
+		return nullptr;
 	}
 
-	auto fileProps = audio_file->getFileProperties();
-
-	type = 0;
 	if (flags && *flags & GAME_SND_USE_DS3D) {
-		type |= DS_3D;
+		auto fileProps = audio_file->getFileProperties();
 
 		if (fileProps.num_channels > 1) {
 			// We need to resample the audio down to one channel
@@ -407,7 +392,6 @@ sound_load_id snd_load(game_snd_entry* entry, int *flags, int /*allow_hardware_l
 			resample.num_channels = 1;
 
 			audio_file->setResamplingProperties(resample);
-			fileProps = audio_file->getFileProperties(); // Refresh properties so that we have accurate information
 
 #ifndef NDEBUG
 			// Retail has a few sounds that triggers this warning so we need to ignore those
@@ -445,6 +429,34 @@ sound_load_id snd_load(game_snd_entry* entry, int *flags, int /*allow_hardware_l
 		}
 	}
 
+	return audio_file;
+}
+
+// Puts a decoded sound into Sounds[] and uploads it to OpenAL.  Main thread only.
+sound_load_id snd_commit(game_snd_entry* entry, int *flags, const ds_decoded_buffer& decoded, std::uint64_t load_time_us)
+{
+	size_t n;
+
+	// another entry of the same batch might have loaded the file already
+	auto existing = snd_find_loaded(entry, flags, &n);
+	if (existing.isValid()) {
+		return existing;
+	}
+
+	if ( n == Sounds.size() ) {
+		loaded_sound new_sound;
+		new_sound.sid   = -1;
+		new_sound.flags = 0;
+
+		Sounds.push_back(new_sound);
+	}
+
+	auto snd = &Sounds[n];
+	auto si = &snd->info;
+	const auto& fileProps = decoded.props;
+
+	auto upload_start = timer_get_microseconds();
+
 	// Load was a success
 	si->n_channels        = fileProps.num_channels; // 16-bit channel count (nChannels)
 	si->sample_rate       = fileProps.sample_rate;  // 32-bit sample rate (nSamplesPerSec)
@@ -455,7 +467,7 @@ sound_load_id snd_load(game_snd_entry* entry, int *flags, int /*allow_hardware_l
 
 	snd->uncompressed_size = si->size;
 
-	auto rc = ds_load_buffer(&snd->sid, type, audio_file.get());
+	auto rc = ds_load_decoded_buffer(&snd->sid, decoded);
 	if (rc == -1) {
 		nprintf(("Sound", "SOUND ==> Failed to load '%s'\n", entry->filename));
 		if (flags)
@@ -476,9 +488,163 @@ sound_load_id snd_load(game_snd_entry* entry, int *flags, int /*allow_hardware_l
 
 	nprintf(("Sound", "SOUND ==> Finished loading '%s'\n", entry->filename));
 
+	if (mission_manifest_recording()) {
+		// the file may have another extension than the one in the table
+		auto res = cf_find_file_location_ext(entry->filename, NUM_AUDIO_EXT, audio_ext_list, CF_TYPE_ANY);
+		if (res.found) {
+			mission_manifest_add(res.name_ext.c_str(), CF_TYPE_ANY,
+				load_time_us + (timer_get_microseconds() - upload_start));
+		}
+	}
+
 	return sound_load_id(static_cast<int>(n));
 }
 
+bool snd_should_load(game_snd_entry* entry, int *flags)
+{
+	if (!ds_initialized)
+		return false;
+
+	if (flags && *flags & GAME_SND_NOT_VALID)
+		return false;
+
+	if (!VALID_FNAME(entry->filename)) {
+		if (flags)
+			*flags |= GAME_SND_NOT_VALID;
+		return false;
+	}
+
+	return true;
+}
+
+} // namespace
+
+sound_load_id snd_load(game_snd_entry* entry, int *flags, int /*allow_hardware_load*/)
+{
+	if (!snd_should_load(entry, flags))
+		return sound_load_id::invalid();
+
+	auto existing = snd_find_loaded(entry, flags, nullptr);
+	if (existing.isValid()) {
+		return existing;
+	}
+
+	TRACE_SCOPE(tracing::LoadSound);
+	auto load_start = timer_get_microseconds();
+
+	auto audio_file = snd_open(entry, flags);
+	if (audio_file == nullptr) {
+		return sound_load_id::invalid();
+	}
+
+	ds_decoded_buffer decoded;
+	if ( !ds_decode_buffer(audio_file.get(), &decoded) ) {
+		nprintf(("Sound", "SOUND ==> Failed to load '%s'\n", entry->filename));
+		if (flags)
+			*flags |= GAME_SND_NOT_VALID;
+		return sound_load_id::invalid();
+	}
+	audio_file = nullptr;
+
+	return snd_commit(entry, flags, decoded, timer_get_microseconds() - load_start);
+}
+
+void snd_load_parallel(const SCP_vector<snd_load_request>& requests, const std::function<void()>& progress)
+{
+	struct pending_sound {
+		const snd_load_request* request;
+		std::unique_ptr<sound::IAudioFile> file;
+		ds_decoded_buffer decoded;
+		bool decoded_ok = false;
+		std::uint64_t load_time_us = 0;
+	};
+
+	TRACE_SCOPE(tracing::LoadSound);
+
+	// the decoded sounds of a batch are kept in memory until they are uploaded
+	const size_t SOUNDS_PER_BATCH = 64;
+
+	SCP_vector<pending_sound> pending;
+	pending.reserve(SOUNDS_PER_BATCH);
+
+	for (size_t first = 0; first < requests.size(); first += SOUNDS_PER_BATCH) {
+		const size_t last = MIN(first + SOUNDS_PER_BATCH, requests.size());
+
+		pending.clear();
+		for (size_t i = first; i < last; i++) {
+			auto& request = requests[i];
+
+			pending.emplace_back();
+			pending.back().request = &request;
+
+			if (!snd_should_load(request.entry, request.flags)) {
+				continue;
+			}
+
+			if (snd_find_loaded(request.entry, request.flags, nullptr).isValid()) {
+				continue;
+			}
+
+			// the same file only has to be decoded once per batch, snd_commit() finds the earlier one
+			bool duplicate = false;
+			for (size_t j = 0; j + 1 < pending.size(); j++) {
+				auto other = pending[j].request;
+				if (pending[j].file && !stricmp(other->entry->filename, request.entry->filename)
+					&& ((other->flags && *other->flags & GAME_SND_USE_DS3D) == (request.flags && *request.flags & GAME_SND_USE_DS3D))) {
+					duplicate = true;
+					break;
+				}
+			}
+			if (duplicate) {
+				continue;
+			}
+
+			auto open_start = timer_get_microseconds();
+			pending.back().file = snd_open(request.entry, request.flags);
+			pending.back().load_time_us = timer_get_microseconds() - open_start;
+		}
+
+		// decoding only touches the file of each sound, so that is done on the task pool
+		threading::parallel_for(pending.size(), 1, [&pending](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				auto& sound = pending[i];
+				if (sound.file) {
+					auto decode_start = timer_get_microseconds();
+					sound.decoded_ok = ds_decode_buffer(sound.file.get(), &sound.decoded);
+					sound.load_time_us += timer_get_microseconds() - decode_start;
+				}
+			}
+		});
+
+		for (auto& sound : pending) {
+			auto entry = sound.request->entry;
+			auto flags = sound.request->flags;
+
+			if (progress) {
+				progress();
+			}
+
+			// closing the file uses cfile, so it is done here
+			bool opened = (sound.file != nullptr);
+			sound.file = nullptr;
+
+			if (sound.decoded_ok) {
+				entry->id = snd_commit(entry, flags, sound.decoded, sound.load_time_us);
+			} else if (opened) {
+				nprintf(("Sound", "SOUND ==> Failed to load '%s'\n", entry->filename));
+				if (flags)
+					*flags |= GAME_SND_NOT_VALID;
+				entry->id = sound_load_id::invalid();
+			} else {
+				// not valid, already loaded or decoded by another entry of this batch
+				entry->id = snd_load(entry, flags);
+			}
+
+			sound.decoded = ds_decoded_buffer();
+		}
+	}
+}
+
 // ---------------------------------------------------------------------------------------
 // snd_unload() 
 //
@@ -817,23 +983,18 @@ void snd_update_3d_pos(sound_handle soundnum, game_snd* gs, vec3d* new_pos, floa
 		snd_set_pan(soundnum, pan);
 	} else {
 		// MageKing17 - It's a 3D sound effect, we should use the function for setting the position of a 3D sound effect.
-		int channel;
-
 		if (!ds_initialized)
 			return;
 
 		Assertion( gs != NULL, "*gs was NULL in snd_update_3d_pos(); get a coder!\n" );
 
-		channel = ds_get_channel(soundnum);
-		if (channel == -1) {
-			nprintf(( "Sound", "WARNING: Trying to set position for a non-playing sound.\n" ));
-			return;
-		}
-
 		float min_range = (float) (fl2i( (gs->min) * range_factor));
 		float max_range = (float) ((int)std::lround((gs->max) * range_factor));
 
-		ds3d_update_buffer(channel, min_range, max_range, new_pos, NULL);
+		// virtual voices keep the position for when they get a channel again
+		if ( !ds3d_update_voice(soundnum, min_range, max_range, new_pos, NULL) ) {
+			nprintf(( "Sound", "WARNING: Trying to set position for a non-playing sound.\n" ));
+		}
 	}
 }
 
@@ -982,8 +1143,15 @@ void snd_stop(sound_handle sig)
 		return;
 
 	channel = ds_get_channel(sig);
-	if ( channel == -1 )
+	if ( channel == -1 ) {
+		if ( ds_is_virtual(sig) ) {
+			currentlyLoopingSoundInfos.erase(sig);
+			currentlyLooping3dSoundInfos.erase(sig);
+
+			ds_stop_virtual(sig);
+		}
 		return;
+	}
 	
 	currentlyLoopingSoundInfos.erase(sig);
 	currentlyLooping3dSoundInfos.erase(sig);
@@ -1004,8 +1172,10 @@ void snd_pause(sound_handle sig)
 		return;
 
 	int channel = ds_get_channel(sig);
-	if (channel == -1)
+	if (channel == -1) {
+		ds_pause_virtual(sig);
 		return;
+	}
 
 	ds_pause_channel(channel);
 }
@@ -1023,8 +1193,10 @@ void snd_resume(sound_handle sig)
 		return;
 
 	int channel = ds_get_channel_raw(sig);
-	if (channel == -1)
+	if (channel == -1) {
+		ds_resume_virtual(sig);
 		return;
+	}
 
 	ds_resume_channel(channel);
 }
@@ -1053,7 +1225,6 @@ void snd_stop_all()
  */
 void snd_set_volume(sound_handle sig, float volume, bool is_voice)
 {
-	int	channel;
 	float	new_volume;
 
 	if (!ds_initialized)
@@ -1062,8 +1233,7 @@ void snd_set_volume(sound_handle sig, float volume, bool is_voice)
 	if (!sig.isValid())
 		return;
 
-	channel = ds_get_channel(sig);
-	if ( channel == -1 ) {
+	if ( (ds_get_channel(sig) == -1) && !ds_is_virtual(sig) ) {
 		nprintf(( "Sound", "WARNING: Trying to set volume for a non-playing sound.\n" ));
 		return;
 	}
@@ -1083,7 +1253,7 @@ void snd_set_volume(sound_handle sig, float volume, bool is_voice)
 	} else {
 		new_volume = volume * (Master_sound_volume * aav_effect_volume);
 	}
-	ds_set_volume( channel, new_volume );
+	ds_set_voice_volume( sig, new_volume );
 }
 
 // ---------------------------------------------------------------------------------------
@@ -1151,19 +1321,16 @@ float snd_get_pitch(sound_handle sig)
 //
 void snd_set_pitch(sound_handle sig, float pitch)
 {
-	int channel;
-
 	if (!ds_initialized) return;
 	if (!sig.isValid())
 		return;
 
-	channel = ds_get_channel(sig);
-	if ( channel == -1 ) {
+	if ( (ds_get_channel(sig) == -1) && !ds_is_virtual(sig) ) {
 		nprintf(( "Sound", "WARNING: Trying to set pitch for a non-playing sound.\n" ));
 		return;
 	}
 
-	ds_set_pitch(channel, pitch);
+	ds_set_voice_pitch(sig, pitch);
 }
 
 // ---------------------------------------------------------------------------------------
@@ -1186,6 +1353,10 @@ int snd_is_playing(sound_handle sig)
 	if (!sig.isValid())
 		return 0;
 
+	// a virtual voice plays on as far as the rest of the game is concerned
+	if ( ds_is_virtual(sig) )
+		return 1;
+
 	channel = ds_get_channel(sig);
 	if ( channel == -1 )
 		return 0;
@@ -1565,7 +1736,7 @@ void update_looping_sound_volumes(SCP_unordered_map<sound_handle, LoopingSoundIn
 
 		const float new_volume =
 			looping_sound.m_defaultVolume * looping_sound.m_dynamicVolume * (Master_sound_volume * aav_effect_volume);
-		ds_set_volume(ds_get_channel(dsHandle), new_volume);
+		ds_set_voice_volume(dsHandle, new_volume);
 	}
 }
 
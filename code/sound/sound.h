@@ -134,6 +134,15 @@ void snd_set_voice_volume(float volume);
 //int	snd_load( char *filename, int hardware=0, int three_d=0, int *sig=NULL );
 sound_load_id snd_load(game_snd_entry* entry, int* flags, int allow_hardware_load = 0);
 
+struct snd_load_request {
+	game_snd_entry* entry;
+	int* flags;
+};
+
+// Loads the sounds like snd_load() would and sets the id of their entries, but decodes them on the task pool.  Only
+// opening the files and uploading them to OpenAL happens on the calling thread, progress is called before each upload.
+void snd_load_parallel(const SCP_vector<snd_load_request>& requests, const std::function<void()>& progress);
+
 int snd_unload(sound_load_id sndnum);
 void	snd_unload_all();
 
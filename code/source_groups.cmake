@@ -860,6 +860,8 @@ add_file_folder("Mission"
 	mission/missionhotkey.h
 	mission/missionload.cpp
 	mission/missionload.h
+	mission/missionmanifest.cpp
+	mission/missionmanifest.h
 	mission/missionlog.cpp
 	mission/missionlog.h
 	mission/missionmessage.cpp
@@ -1065,6 +1067,8 @@ add_file_folder("Object"
 	object/objectdock.h
 	object/objectshield.cpp
 	object/objectshield.h
+	object/objectsnapshot.cpp
+	object/objectsnapshot.h
 	object/objectsnd.cpp
 	object/objectsnd.h
 	object/objectsort.cpp
@@ -1281,6 +1285,8 @@ add_file_folder("Render"
 	render/3dsetup.cpp
 	render/batching.cpp
 	render/batching.h
+	render/occlusion.cpp
+	render/occlusion.h
 )
 
 add_file_folder("ScpUi"
@@ -1708,6 +1714,8 @@ add_file_folder("TgaUtils"
 
 # Tracing files
 add_file_folder("Tracing"
+	tracing/BinaryTrace.cpp
+	tracing/BinaryTrace.h
 	tracing/categories.cpp
 	tracing/categories.h
 	tracing/FrameProfiler.h
@@ -1718,6 +1726,10 @@ add_file_folder("Tracing"
 	tracing/Monitor.cpp
 	tracing/scopes.cpp
 	tracing/scopes.h
+	tracing/SummaryProfiler.h
+	tracing/SummaryProfiler.cpp
+	tracing/Timedemo.h
+	tracing/Timedemo.cpp
 	tracing/ThreadedEventProcessor.h
 	tracing/TraceEventWriter.h
 	tracing/TraceEventWriter.cpp
@@ -1757,6 +1769,7 @@ add_file_folder("Utils"
 	utils/id.h
 	utils/join_string.h
 	utils/modular_curves.h
+	utils/radix_sort.h
 	utils/Random.cpp
 	utils/Random.h
 	utils/RandomRange.h
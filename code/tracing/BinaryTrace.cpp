@@ -0,0 +1,253 @@
+#include "tracing/BinaryTrace.h"
+#include "tracing/tracing.h"
+#include "parse/parselo.h"
+
+#include <fstream>
+#include <iomanip>
+
+namespace
+{
+using namespace tracing;
+
+class trace_reader {
+	std::streambuf* _buf;
+	bool _valid = true;
+
+ public:
+	explicit trace_reader(std::istream& in) : _buf(in.rdbuf()) {}
+
+	bool valid() const { return _valid; }
+
+	bool atEnd() { return _buf->sgetc() == std::char_traits<char>::eof(); }
+
+	std::uint8_t readByte() {
+		auto c = _buf->sbumpc();
+		if (c == std::char_traits<char>::eof()) {
+			_valid = false;
+			return 0;
+		}
+		return static_cast<std::uint8_t>(c);
+	}
+
+	std::uint64_t readLE(size_t bytes) {
+		std::uint64_t value = 0;
+		for (size_t i = 0; i < bytes; ++i) {
+			value |= static_cast<std::uint64_t>(readByte()) << (i * 8);
+		}
+		return value;
+	}
+
+	std::uint64_t readVarint() {
+		std::uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			auto byte = readByte();
+			value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+
+			if (!(byte & 0x80)) {
+				return value;
+			}
+		}
+
+		// More than 10 bytes is not a valid varint
+		_valid = false;
+		return 0;
+	}
+
+	SCP_string readString() {
+		auto length = readVarint();
+
+		SCP_string str;
+		for (std::uint64_t i = 0; i < length && _valid; ++i) {
+			str += static_cast<char>(readByte());
+		}
+		return str;
+	}
+};
+
+const char* getTypeStr(tracing::EventType type) {
+	switch(type) {
+		case tracing::EventType::Complete:
+			return "X";
+		case tracing::EventType::Begin:
+			return "B";
+		case tracing::EventType::End:
+			return "E";
+		case EventType::AsyncBegin:
+			return "b";
+		case EventType::AsyncStep:
+			return "n";
+		case EventType::AsyncEnd:
+			return "e";
+		case EventType::Counter:
+			return "C";
+		default:
+			return nullptr;
+	}
+}
+
+void writeTime(std::ofstream& out, std::uint64_t time) {
+	// Save stream state
+	auto flags = out.flags();
+	out << std::fixed << std::setprecision(3);
+
+	out << (time / 1000.);
+
+	// and now restore it
+	out.flags(flags);
+}
+
+void setName(SCP_vector<SCP_string>& names, std::uint64_t id, SCP_string name) {
+	if (id >= names.size()) {
+		names.resize(id + 1);
+	}
+	names[id] = std::move(name);
+}
+}
+
+namespace tracing {
+namespace binary {
+
+void write_varint(SCP_vector<std::uint8_t>& out, std::uint64_t value) {
+	while (value >= 0x80) {
+		out.push_back(static_cast<std::uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<std::uint8_t>(value));
+}
+
+bool convert_to_json(const char* binary_path, const char* json_path, SCP_string& error) {
+	std::ifstream in(binary_path, std::ios::binary);
+	if (!in.good()) {
+		sprintf(error, "Failed to open trace file '%s'!", binary_path);
+		return false;
+	}
+
+	trace_reader reader(in);
+
+	char magic[sizeof(MAGIC)];
+	for (auto& c : magic) {
+		c = static_cast<char>(reader.readByte());
+	}
+	if (!reader.valid() || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+		sprintf(error, "'%s' is not a trace file!", binary_path);
+		return false;
+	}
+
+	auto version = reader.readLE(sizeof(VERSION));
+	if (version != VERSION) {
+		sprintf(error, "Trace file '%s' has unsupported version %d!", binary_path, static_cast<int>(version));
+		return false;
+	}
+
+	std::ofstream out(json_path);
+	if (!out.good()) {
+		sprintf(error, "Failed to open '%s' for writing!", json_path);
+		return false;
+	}
+
+	SCP_vector<SCP_string> categories;
+	SCP_vector<SCP_string> scopes;
+
+	std::int64_t pid = -1;
+	std::uint64_t timestamp = 0;
+	bool first_line = true;
+
+	out << "[";
+
+	while (reader.valid() && !reader.atEnd()) {
+		auto tag = reader.readByte();
+
+		if (tag == TAG_CATEGORY) {
+			auto id = reader.readVarint();
+			setName(categories, id, reader.readString());
+			continue;
+		}
+		if (tag == TAG_SCOPE) {
+			auto id = reader.readVarint();
+			setName(scopes, id, reader.readString());
+			continue;
+		}
+		if (tag == TAG_PROCESS) {
+			pid = zigzag_decode(reader.readVarint());
+			continue;
+		}
+
+		auto type = static_cast<EventType>(tag & EVENT_TYPE_MASK);
+		auto type_str = getTypeStr(type);
+
+		auto category_id = reader.readVarint();
+		auto has_scope = (tag & EVENT_FLAG_SCOPE) != 0;
+		auto scope_id = has_scope ? reader.readVarint() : 0;
+		auto tid = zigzag_decode(reader.readVarint());
+		timestamp += static_cast<std::uint64_t>(zigzag_decode(reader.readVarint()));
+
+		if (!reader.valid()) {
+			break;
+		}
+
+		if (type_str == nullptr || category_id >= categories.size() || (has_scope && scope_id >= scopes.size())) {
+			sprintf(error, "Trace file '%s' contains an invalid event!", binary_path);
+			return false;
+		}
+
+		if (!first_line) {
+			out << ",";
+		}
+		out << "\n{\"tid\": " << tid << ",\"ts\":";
+
+		writeTime(out, timestamp);
+
+		out << ",\"pid\":";
+		if (tag & EVENT_FLAG_GPU) {
+			out << "\"GPU\"";
+		} else {
+			out << pid;
+		}
+
+		if (has_scope) {
+			out << ",\"cat\":\"" << scopes[scope_id] << "\"";
+			out << ",\"id\":\"0x" << std::hex << scope_id << std::dec << "\"";
+		}
+
+		out << ",\"name\":\"" << categories[category_id] << "\",\"ph\":\"" << type_str << "\"";
+
+		switch (type) {
+			case EventType::Complete:
+				out << ",\"dur\":";
+				writeTime(out, reader.readVarint());
+				break;
+			case EventType::Counter: {
+				auto bits = static_cast<std::uint32_t>(reader.readLE(sizeof(std::uint32_t)));
+				float value;
+				memcpy(&value, &bits, sizeof(value));
+
+				auto flags = out.flags();
+				out << std::fixed;
+
+				out << ",\"args\": {\"value\": " << value << "}";
+
+				// and now restore it
+				out.flags(flags);
+				break;
+			}
+			default:
+				// Nothing to do here...
+				break;
+		}
+
+		out << "}";
+
+		first_line = false;
+	}
+
+	out << "]\n";
+
+	if (!reader.valid()) {
+		sprintf(error, "Trace file '%s' ends in the middle of a record, the output is incomplete.", binary_path);
+	}
+
+	return true;
+}
+
+}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+/** @file
+ *  @ingroup tracing
+ *
+ *  The binary trace format written by the TraceEventWriter.
+ *
+ *  A file starts with the 8 byte magic value and the format version as a 32-bit little-endian integer. After that follows
+ *  a stream of records which each start with a tag byte. The name of a category or scope is written once, the first time
+ *  it is used, and events only refer to it by its index. The process id is written before the first CPU event. All other
+ *  integers are LEB128 varints. Signed values are zigzag encoded and timestamps are stored as the difference to the
+ *  timestamp of the previous event in the file.
+ *
+ *  Event records start with the event type in the lower bits of the tag, followed by the category index, the scope
+ *  index if the scope flag is set, the thread id and the timestamp delta. Complete events add their duration and
+ *  counter events their value as a 32-bit float.
+ */
+
+namespace tracing {
+namespace binary {
+
+const char MAGIC[8] = {'F', 'S', 'O', 'T', 'R', 'A', 'C', 'E'};
+const std::uint32_t VERSION = 1;
+
+const std::uint8_t TAG_CATEGORY = 0x80;
+const std::uint8_t TAG_SCOPE    = 0x81;
+const std::uint8_t TAG_PROCESS  = 0x82;
+
+const std::uint8_t EVENT_TYPE_MASK  = 0x0F;
+const std::uint8_t EVENT_FLAG_GPU   = 0x10;
+const std::uint8_t EVENT_FLAG_SCOPE = 0x20;
+
+inline std::uint64_t zigzag_encode(std::int64_t value) {
+	return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t zigzag_decode(std::uint64_t value) {
+	return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+void write_varint(SCP_vector<std::uint8_t>& out, std::uint64_t value);
+
+/**
+ * @brief Converts a binary trace file to the JSON trace event format read by chrome://tracing
+ *
+ * @param binary_path The trace file to read
+ * @param json_path The file to write the JSON to
+ * @param[out] error Set to a description of the problem if the conversion failed or the trace was truncated
+ * @return @c true if the conversion was successful, @c false if a file could not be opened or the trace is invalid
+ */
+bool convert_to_json(const char* binary_path, const char* json_path, SCP_string& error);
+
+}
+}
@@ -0,0 +1,52 @@
+#include "tracing/SummaryProfiler.h"
+
+namespace tracing {
+
+void SummaryProfiler::processEvent(const trace_event* event) {
+	if (event->type != EventType::Complete) {
+		return;
+	}
+
+	if (event->pid == GPU_PID) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(_summaryMutex);
+
+	auto& summary = _summaries[event->category];
+	if (summary.count == 0) {
+		summary.name = event->category->getName();
+	}
+
+	++summary.count;
+	summary.total_ns += event->duration;
+	summary.min_ns = std::min(summary.min_ns, event->duration);
+	summary.max_ns = std::max(summary.max_ns, event->duration);
+}
+
+void SummaryProfiler::reset() {
+	std::lock_guard<std::mutex> guard(_summaryMutex);
+
+	_summaries.clear();
+}
+
+SCP_vector<category_summary> SummaryProfiler::getSummaries() {
+	SCP_vector<category_summary> summaries;
+
+	{
+		std::lock_guard<std::mutex> guard(_summaryMutex);
+
+		summaries.reserve(_summaries.size());
+		for (const auto& entry : _summaries) {
+			summaries.push_back(entry.second);
+		}
+	}
+
+	std::sort(summaries.begin(), summaries.end(), [](const category_summary& left, const category_summary& right) {
+		return left.total_ns > right.total_ns;
+	});
+
+	return summaries;
+}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+#include "tracing/tracing.h"
+
+#include <mutex>
+
+/** @file
+ *  @ingroup tracing
+ */
+
+namespace tracing {
+
+/**
+ * @brief Accumulated timings of one category
+ */
+struct category_summary {
+	SCP_string name;
+
+	std::uint64_t count = 0;
+
+	std::uint64_t total_ns = 0;
+	std::uint64_t min_ns   = std::numeric_limits<std::uint64_t>::max();
+	std::uint64_t max_ns   = 0;
+};
+
+/**
+ * @brief Accumulates the time spent in each category over a longer run
+ *
+ * Unlike the FrameProfiler this does not keep the nesting of the events and it also counts events from other threads.
+ * Only CPU events are considered.
+ */
+class SummaryProfiler {
+	std::mutex _summaryMutex;
+	SCP_unordered_map<const Category*, category_summary> _summaries;
+
+ public:
+	void processEvent(const trace_event* event);
+
+	void reset();
+
+	/**
+	 * @brief Gets the accumulated timings
+	 * @return The timings of all categories which had at least one event, sorted by descending total time
+	 */
+	SCP_vector<category_summary> getSummaries();
+};
+
+/**
+ * @brief Gets the timings accumulated since the tracing system was initialized or the summary was last reset
+ *
+ * @note Only available if the summary profiler is enabled, i.e. in timedemo mode
+ */
+SCP_vector<category_summary> get_category_summaries();
+
+/**
+ * @brief Discards the accumulated timings
+ */
+void reset_category_summaries();
+
+}
@@ -3,8 +3,11 @@
 #include "globalincs/pstypes.h"
 #include "tracing/tracing.h"
 
-#include "utils/boost/syncboundedqueue.h"
-
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <mutex>
 #include <thread>
 
 
@@ -14,6 +17,14 @@
 
 namespace tracing {
 
+/**
+ * @brief Gets a new id which identifies an event processor instance
+ *
+ * The per-thread buffers of a processor are looked up by this id so a new instance never picks up the buffers of a
+ * destroyed one.
+ */
+std::uint64_t next_event_processor_id();
+
 /**
  * @brief A multi-threaded event processor
  *
@@ -26,51 +37,168 @@ namespace tracing {
  *
  * This function will be called in a background-thread whenever a new event arrives.
  *
+ * Every thread which submits events gets its own single producer, single consumer ring buffer so submitting an event
+ * never takes a lock or waits for another thread. The background thread polls all buffers. Events of one thread are
+ * processed in the order they were submitted but there is no ordering between threads. If a buffer is full the event
+ * is dropped instead of stalling the thread that is being measured. The number of dropped events is reported when the
+ * processor is destroyed.
+ *
+ * @note The buffer of a thread is only freed with the processor so this should not be used from short-lived threads.
+ *
  * @tparam Processor Your processor implementation
- * @tparam QUEUE_SIZE The maximum size of the internal event buffer
+ * @tparam BUFFER_SIZE The number of events each thread can buffer, must be a power of two
  */
-template<class Processor, size_t QUEUE_SIZE = 200>
+template<class Processor, size_t BUFFER_SIZE = 4096>
 class ThreadedEventProcessor {
-	sync_bounded_queue<trace_event> _event_queue;
+	static_assert((BUFFER_SIZE & (BUFFER_SIZE - 1)) == 0, "The buffer size must be a power of two!");
 
-	std::thread _worker_thread;
+	struct thread_buffer {
+		std::array<trace_event, BUFFER_SIZE> events;
+
+		// Written by the submitting thread, the index of the next slot to fill
+		alignas(64) std::atomic<size_t> head{0};
+		// Written by the worker thread, the index of the next slot to process
+		alignas(64) std::atomic<size_t> tail{0};
+
+		// Only accessed by the submitting thread until the worker has been stopped
+		std::uint64_t dropped = 0;
+	};
+
+	struct thread_slot {
+		std::uint64_t owner = 0;
+		thread_buffer* buffer = nullptr;
+	};
+
+	const std::uint64_t _id;
+
+	std::mutex _buffers_mutex;
+	SCP_vector<std::unique_ptr<thread_buffer>> _buffers;
+
+	std::atomic<bool> _stop{false};
 
 	Processor _processor;
 
+	std::thread _worker_thread;
+
+	static thread_slot& localSlot() {
+		static thread_local thread_slot slot;
+		return slot;
+	}
+
+	thread_buffer* getThreadBuffer() {
+		auto& slot = localSlot();
+
+		if (slot.owner != _id) {
+			// First event of this thread, this is the only time the submitting thread needs the lock
+			std::lock_guard<std::mutex> guard(_buffers_mutex);
+			_buffers.emplace_back(new thread_buffer());
+
+			slot.owner = _id;
+			slot.buffer = _buffers.back().get();
+		}
+
+		return slot.buffer;
+	}
+
+	size_t drainBuffer(thread_buffer* buffer) {
+		auto tail = buffer->tail.load(std::memory_order_relaxed);
+		auto head = buffer->head.load(std::memory_order_acquire);
+
+		for (auto i = tail; i != head; ++i) {
+			_processor.processEvent(&buffer->events[i & (BUFFER_SIZE - 1)]);
+		}
+
+		buffer->tail.store(head, std::memory_order_release);
+
+		return head - tail;
+	}
+
 	void workerThread() {
-		while (!_event_queue.closed()) {
-			try {
-				trace_event evt;
-				auto status = _event_queue.wait_pull_front(evt);
+		SCP_vector<thread_buffer*> buffers;
+
+		while (true) {
+			// Read this before draining so that everything submitted before the stop request is processed
+			auto stopping = _stop.load(std::memory_order_acquire);
 
-				if (status != success) {
-					break;
+			{
+				std::lock_guard<std::mutex> guard(_buffers_mutex);
+				for (auto i = buffers.size(); i < _buffers.size(); ++i) {
+					buffers.push_back(_buffers[i].get());
 				}
+			}
 
-				_processor.processEvent(&evt);
+			size_t processed = 0;
+			for (auto buffer : buffers) {
+				processed += drainBuffer(buffer);
 			}
-			catch (const sync_queue_is_closed&) {
-				// We are done here
+
+			if (stopping) {
 				break;
 			}
+
+			if (processed == 0) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
 		}
 	}
  public:
 	template<typename... Params>
 	explicit ThreadedEventProcessor(Params&& ... params)
-		: _event_queue(QUEUE_SIZE), _worker_thread(&ThreadedEventProcessor<Processor>::workerThread, this),
-		  _processor(std::forward<Params>(params)...) {}
+		: _id(next_event_processor_id()), _processor(std::forward<Params>(params)...),
+		  _worker_thread(&ThreadedEventProcessor::workerThread, this) {}
 	~ThreadedEventProcessor() {
-		_event_queue.close();
+		_stop.store(true, std::memory_order_release);
 		_worker_thread.join();
+
+		std::uint64_t dropped = 0;
+		for (auto& buffer : _buffers) {
+			dropped += buffer->dropped;
+		}
+
+		if (dropped > 0) {
+			mprintf(("Tracing: %" PRIu64 " events were dropped because the event buffers were full.\n", dropped));
+		}
+	}
+
+	/**
+	 * @brief Blocks until the worker thread has processed every event submitted before this call
+	 *
+	 * Needed before freeing anything the queued events still point to, e.g. a category.
+	 */
+	void waitForPendingEvents() {
+		while (true) {
+			bool pending = false;
+			{
+				std::lock_guard<std::mutex> guard(_buffers_mutex);
+				for (auto& buffer : _buffers) {
+					if (buffer->tail.load(std::memory_order_acquire) != buffer->head.load(std::memory_order_acquire)) {
+						pending = true;
+						break;
+					}
+				}
+			}
+
+			if (!pending) {
+				return;
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
 	}
 
 	void processEvent(const trace_event* event) {
-		try {
-			_event_queue.wait_push_back(*event);
-		} catch (const sync_queue_is_closed&) {
-			mprintf(("Stream queue was closed in processEvent! This should not be possible...\n"));
+		auto buffer = getThreadBuffer();
+
+		auto head = buffer->head.load(std::memory_order_relaxed);
+		auto tail = buffer->tail.load(std::memory_order_acquire);
+
+		if (head - tail >= BUFFER_SIZE) {
+			++buffer->dropped;
+			return;
 		}
+
+		buffer->events[head & (BUFFER_SIZE - 1)] = *event;
+		buffer->head.store(head + 1, std::memory_order_release);
 	}
 };
 
@@ -0,0 +1,169 @@
+#include "tracing/Timedemo.h"
+
+#include "cmdline/cmdline.h"
+#include "globalincs/systemvars.h"
+#include "io/timer.h"
+#include "libs/jansson.h"
+#include "tracing/SummaryProfiler.h"
+
+#include <algorithm>
+#include <memory>
+
+extern uint Cmdline_rng_seed;
+
+namespace {
+
+// The simulation runs at a fixed 60 frames per second
+const fix TIMEDEMO_FRAMETIME = F1_0 / 60;
+
+const char* const DEFAULT_OUTPUT_FILE = "timedemo.json";
+
+bool started = false;
+bool finished = false;
+
+int frames_done = 0;
+
+std::uint64_t start_time_ns = 0;
+std::uint64_t last_frame_ns = 0;
+fix start_mission_time = 0;
+
+SCP_vector<std::uint64_t> frame_times_ns;
+
+double to_milliseconds(std::uint64_t nanoseconds) {
+	return static_cast<double>(nanoseconds) / 1000000.0;
+}
+
+std::uint64_t percentile(const SCP_vector<std::uint64_t>& sorted_values, double fraction) {
+	if (sorted_values.empty()) {
+		return 0;
+	}
+
+	auto index = static_cast<size_t>(fraction * static_cast<double>(sorted_values.size() - 1) + 0.5);
+	return sorted_values[std::min(index, sorted_values.size() - 1)];
+}
+
+json_t* frame_times_to_json() {
+	auto sorted = frame_times_ns;
+	std::sort(sorted.begin(), sorted.end());
+
+	std::uint64_t total = 0;
+	for (auto time : sorted) {
+		total += time;
+	}
+
+	auto obj = json_object();
+	json_object_set_new(obj, "mean_ms", json_real(sorted.empty() ? 0.0 : to_milliseconds(total) / sorted.size()));
+	json_object_set_new(obj, "min_ms", json_real(to_milliseconds(sorted.empty() ? 0 : sorted.front())));
+	json_object_set_new(obj, "p50_ms", json_real(to_milliseconds(percentile(sorted, 0.5))));
+	json_object_set_new(obj, "p95_ms", json_real(to_milliseconds(percentile(sorted, 0.95))));
+	json_object_set_new(obj, "p99_ms", json_real(to_milliseconds(percentile(sorted, 0.99))));
+	json_object_set_new(obj, "max_ms", json_real(to_milliseconds(sorted.empty() ? 0 : sorted.back())));
+
+	return obj;
+}
+
+json_t* categories_to_json() {
+	auto array = json_array();
+
+	for (const auto& summary : tracing::get_category_summaries()) {
+		auto obj = json_object();
+
+		json_object_set_new(obj, "name", json_string(summary.name.c_str()));
+		json_object_set_new(obj, "count", json_integer(static_cast<json_int_t>(summary.count)));
+		json_object_set_new(obj, "total_ms", json_real(to_milliseconds(summary.total_ns)));
+		json_object_set_new(obj, "per_frame_ms", json_real(to_milliseconds(summary.total_ns) / frames_done));
+		json_object_set_new(obj, "mean_us", json_real(static_cast<double>(summary.total_ns) / summary.count / 1000.0));
+		json_object_set_new(obj, "min_us", json_real(static_cast<double>(summary.min_ns) / 1000.0));
+		json_object_set_new(obj, "max_us", json_real(static_cast<double>(summary.max_ns) / 1000.0));
+
+		json_array_append_new(array, obj);
+	}
+
+	return array;
+}
+
+void write_report(const char* mission_filename) {
+	auto wall_ns = last_frame_ns - start_time_ns;
+
+	std::unique_ptr<json_t> root(json_object());
+
+	json_object_set_new(root.get(), "mission", json_string(mission_filename));
+	json_object_set_new(root.get(), "frames", json_integer(frames_done));
+	json_object_set_new(root.get(), "frametime", json_real(f2fl(TIMEDEMO_FRAMETIME)));
+	json_object_set_new(root.get(), "seed", json_integer(Cmdline_rng_seed));
+	json_object_set_new(root.get(), "threads", json_integer(Cmdline_multithreading));
+	json_object_set_new(root.get(), "simulated_seconds", json_real(f2fl(Missiontime - start_mission_time)));
+	json_object_set_new(root.get(), "wall_seconds", json_real(to_milliseconds(wall_ns) / 1000.0));
+	json_object_set_new(root.get(), "frames_per_second",
+		json_real(wall_ns > 0 ? frames_done / (to_milliseconds(wall_ns) / 1000.0) : 0.0));
+	json_object_set_new(root.get(), "frame_times", frame_times_to_json());
+	json_object_set_new(root.get(), "categories", categories_to_json());
+
+	auto filename = Cmdline_timedemo_output != nullptr ? Cmdline_timedemo_output : DEFAULT_OUTPUT_FILE;
+	if (json_dump_file(root.get(), filename, JSON_INDENT(2)) != 0) {
+		mprintf(("TIMEDEMO: Failed to write the results to '%s'!\n", filename));
+		return;
+	}
+
+	mprintf(("TIMEDEMO: %d frames of '%s' took %.3f seconds, results written to '%s'\n", frames_done, mission_filename,
+		to_milliseconds(wall_ns) / 1000.0, filename));
+}
+
+}
+
+namespace tracing {
+namespace timedemo {
+
+bool active() {
+	return Cmdline_timedemo_frames > 0;
+}
+
+fix frametime() {
+	return TIMEDEMO_FRAMETIME;
+}
+
+void init() {
+	if (!active()) {
+		return;
+	}
+
+	timestamp_set_fixed_step(static_cast<std::uint64_t>(TIMEDEMO_FRAMETIME) * MICROSECONDS_PER_SECOND / F1_0);
+
+	frame_times_ns.reserve(Cmdline_timedemo_frames);
+}
+
+bool frame_finished(const char* mission_filename) {
+	Assertion(active(), "This function may only be called in timedemo mode!");
+
+	if (finished) {
+		return false;
+	}
+
+	auto now = timer_get_nanoseconds();
+
+	if (!started) {
+		// Everything up to the first frame in the mission is loading and not part of the measurement
+		started = true;
+		start_time_ns = now;
+		last_frame_ns = now;
+		start_mission_time = Missiontime;
+		reset_category_summaries();
+		return false;
+	}
+
+	frame_times_ns.push_back(now - last_frame_ns);
+	last_frame_ns = now;
+	++frames_done;
+
+	if (frames_done < Cmdline_timedemo_frames) {
+		return false;
+	}
+
+	write_report(mission_filename);
+	finished = true;
+
+	return true;
+}
+
+}
+}
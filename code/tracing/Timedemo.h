@@ -0,0 +1,44 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+/** @file
+ *  @ingroup tracing
+ *
+ *  The timedemo mode runs a mission without a display for a fixed number of frames. The simulation advances by a
+ *  fixed timestep per frame and the player ship is flown by the AI so that two runs of the same mission do the same
+ *  work. At the end the frame times and the time spent in each tracing category are written to a JSON file.
+ */
+
+namespace tracing {
+namespace timedemo {
+
+/**
+ * @brief Checks if the game was started in timedemo mode
+ */
+bool active();
+
+/**
+ * @brief The simulated time of one timedemo frame
+ */
+fix frametime();
+
+/**
+ * @brief Switches the timestamps to the fixed timestep
+ *
+ * Must be called after the timer and the tracing system are initialized.
+ */
+void init();
+
+/**
+ * @brief Records that a frame of the mission has been completed
+ *
+ * The first call starts the measurement so this should only be called once the player has entered the mission.
+ *
+ * @param mission_filename The file name of the running mission, used for the report
+ * @return @c true on the frame which completed the requested number of frames, the report has been written then
+ */
+bool frame_finished(const char* mission_filename);
+
+}
+}
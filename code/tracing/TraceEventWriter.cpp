@@ -1,116 +1,127 @@
 
 #include "tracing/TraceEventWriter.h"
-
-#include <iomanip>
+#include "tracing/BinaryTrace.h"
 
 namespace
 {
 using namespace tracing;
 
-const char* getTypeStr(tracing::EventType type) {
-	switch(type) {
-		case tracing::EventType::Complete:
-			return "X";
-		case tracing::EventType::Begin:
-			return "B";
-		case tracing::EventType::End:
-			return "E";
-		case EventType::AsyncBegin:
-			return "b";
-		case EventType::AsyncStep:
-			return "n";
-		case EventType::AsyncEnd:
-			return "e";
-		case EventType::Counter:
-			return "C";
-		default: 
-			UNREACHABLE("Invalid enum value!");
-			return "";
-	}
-}
-
-void writeTime(std::ofstream& out, std::uint64_t time) {
-	// Save stream state
-	auto flags = out.flags();
-	out << std::fixed << std::setprecision(3);
+// Write the data to the file in blocks of this size
+const size_t FLUSH_SIZE = 64 * 1024;
 
-	out << (time / 1000.);
+void write_name(SCP_vector<std::uint8_t>& out, std::uint8_t tag, std::uint32_t id, const char* name) {
+	auto length = strlen(name);
 
-	// and now restore it
-	out.flags(flags);
+	out.push_back(tag);
+	binary::write_varint(out, id);
+	binary::write_varint(out, length);
+	out.insert(out.end(), name, name + length);
 }
 
-void writeCompleteEvent(std::ofstream& out_str, const trace_event* evt) {
-	Assertion(evt->type == EventType::Complete, "Event must be a complete event!");
-
-	out_str << ",\"dur\":";
-	writeTime(out_str, evt->duration);
+void write_le(SCP_vector<std::uint8_t>& out, std::uint64_t value, size_t bytes) {
+	for (size_t i = 0; i < bytes; ++i) {
+		out.push_back(static_cast<std::uint8_t>(value >> (i * 8)));
+	}
 }
 }
 
 namespace tracing
 {
 
-TraceEventWriter::TraceEventWriter() : _out("tracing/trace.json") {
-	_out << "[";
+TraceEventWriter::TraceEventWriter(const char* path) : _out(path, std::ios::binary) {
+	_buffer.reserve(FLUSH_SIZE * 2);
+
+	_buffer.insert(_buffer.end(), std::begin(binary::MAGIC), std::end(binary::MAGIC));
+	write_le(_buffer, binary::VERSION, sizeof(binary::VERSION));
 }
 
 TraceEventWriter::~TraceEventWriter() {
-	_out << "]\n";
+	flush();
 	_out.close();
 }
 
+std::uint32_t TraceEventWriter::getCategoryId(const Category* category) {
+	auto iter = _category_ids.find(category);
+	if (iter != _category_ids.end()) {
+		return iter->second;
+	}
+
+	auto id = static_cast<std::uint32_t>(_category_ids.size());
+	_category_ids.emplace(category, id);
+	write_name(_buffer, binary::TAG_CATEGORY, id, category->getName());
+
+	return id;
+}
+
+std::uint32_t TraceEventWriter::getScopeId(const Scope* scope) {
+	auto iter = _scope_ids.find(scope);
+	if (iter != _scope_ids.end()) {
+		return iter->second;
+	}
+
+	auto id = static_cast<std::uint32_t>(_scope_ids.size());
+	_scope_ids.emplace(scope, id);
+	write_name(_buffer, binary::TAG_SCOPE, id, scope->getName());
+
+	return id;
+}
+
+void TraceEventWriter::flush() {
+	_out.write(reinterpret_cast<const char*>(_buffer.data()), _buffer.size());
+	_buffer.clear();
+}
+
 void TraceEventWriter::processEvent(const trace_event* event) {
 	if (event->type == EventType::Complete) {
 		if (event->duration < 1000) {
-			// Discard events that are less than a millisecond long
+			// Discard events that are less than a microsecond long
 			return;
 		}
 	}
 
-	if (!_first_line) {
-		_out << ",";
+	if (event->pid != GPU_PID && event->pid != _last_pid) {
+		_buffer.push_back(binary::TAG_PROCESS);
+		binary::write_varint(_buffer, binary::zigzag_encode(event->pid));
+		_last_pid = event->pid;
 	}
-	_out << "\n{\"tid\": " << event->tid << ",\"ts\":";
 
-	writeTime(_out, event->timestamp);
+	// The names need to be written before the event that uses them
+	auto category_id = getCategoryId(event->category);
+	auto scope_id = event->scope != nullptr ? getScopeId(event->scope) : 0;
 
-	_out << ",\"pid\":";
+	auto tag = static_cast<std::uint8_t>(event->type);
 	if (event->pid == GPU_PID) {
-		_out << "\"GPU\"";
+		tag |= binary::EVENT_FLAG_GPU;
 	}
-	else {
-		_out << event->pid;
+	if (event->scope != nullptr) {
+		tag |= binary::EVENT_FLAG_SCOPE;
 	}
 
+	_buffer.push_back(tag);
+	binary::write_varint(_buffer, category_id);
 	if (event->scope != nullptr) {
-		_out << ",\"cat\":\"" << event->scope->getName() << "\"";
-		_out << ",\"id\":\"" << reinterpret_cast<const void*>(event->scope) << "\"";
+		binary::write_varint(_buffer, scope_id);
 	}
+	binary::write_varint(_buffer, binary::zigzag_encode(event->tid));
+	binary::write_varint(_buffer, binary::zigzag_encode(static_cast<std::int64_t>(event->timestamp - _last_timestamp)));
 
-	_out << ",\"name\":\"" << event->category->getName() << "\",\"ph\":\"" << getTypeStr(event->type) << "\"";
+	_last_timestamp = event->timestamp;
 
 	switch (event->type) {
 		case EventType::Complete:
-			writeCompleteEvent(_out, event);
+			binary::write_varint(_buffer, event->duration);
 			break;
 		case EventType::Begin:
 		case EventType::End:
-			// Nothing to do here
-			break;
 		case EventType::AsyncBegin:
 		case EventType::AsyncStep:
 		case EventType::AsyncEnd:
 			// Nothing to do here...
 			break;
 		case EventType::Counter: {
-			auto flags = _out.flags();
-			_out << std::fixed;
-
-			_out << ",\"args\": {\"value\": " << event->value << "}";
-
-			// and now restore it
-			_out.flags(flags);
+			std::uint32_t bits;
+			memcpy(&bits, &event->value, sizeof(bits));
+			write_le(_buffer, bits, sizeof(bits));
 			break;
 		}
 		default:
@@ -118,8 +129,8 @@ void TraceEventWriter::processEvent(const trace_event* event) {
 			break;
 	}
 
-	_out << "}";
-
-	_first_line = false;
+	if (_buffer.size() >= FLUSH_SIZE) {
+		flush();
+	}
 }
 }
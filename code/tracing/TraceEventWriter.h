@@ -15,13 +15,31 @@
 
 namespace tracing
 {
+/**
+ * @brief Writes the events to a file in the binary trace format
+ *
+ * -binary_profiling keeps this file, -json_profiling converts it to tracing/trace.json on shutdown. Kept binary files
+ * can be converted later with the -convert_trace command line option, see tracing/BinaryTrace.h.
+ */
 class TraceEventWriter
 {
 	std::ofstream _out;
-	bool _first_line = true;
+
+	SCP_vector<std::uint8_t> _buffer;
+
+	SCP_unordered_map<const Category*, std::uint32_t> _category_ids;
+	SCP_unordered_map<const Scope*, std::uint32_t> _scope_ids;
+
+	std::uint64_t _last_timestamp = 0;
+	std::int64_t _last_pid = -1;
+
+	std::uint32_t getCategoryId(const Category* category);
+	std::uint32_t getScopeId(const Scope* scope);
+
+	void flush();
 
 public:
-	TraceEventWriter();
+	explicit TraceEventWriter(const char* path = "tracing/trace.bin");
 	~TraceEventWriter();
 
 	void processEvent(const trace_event* event);
@@ -48,6 +48,7 @@ Category ShipPostMove("Ship post move", false);
 Category FireballPostMove("Fireball post move", false);
 Category DebrisPostMove("Debris post move", false);
 Category AsteroidPostMove("Asteroid post move", false);
+Category AsteroidInstances("Asteroid instances", false);
 Category PreMove("Pre Move", false);
 Category Physics("Physics", false);
 Category PostMove("Post Move", false);
@@ -55,7 +56,13 @@ Category CollisionDetection("Collision Detection", false);
 
 Category RenderBuffer("Render Buffer", true);
 
+Category ObjectSnapshot("Object Snapshot", false);
+Category CullObjects("Cull Objects", false);
+Category RasterizeOccluders("Rasterize Occluders", false);
+Category BuildOcclusionPyramid("Build Occlusion Pyramid", false);
 Category QueueRender("Queue Render", false);
+Category SortModelDraws("Sort Model Draws", false);
+Category MergeModelInstances("Merge Model Instances", false);
 Category BuildModelUniforms("Build Model Uniforms", false);
 Category UploadModelUniforms("Upload Model Uniforms", true);
 Category SubmitDraws("Submit Draws", true);
@@ -127,6 +134,7 @@ Category LoadModelFile("Load model file", false);
 Category ReadModelFile("Read model file", false);
 Category ModelCreateVertexBuffers("Create model vertex buffers", false);
 Category ModelParseAllBSPTrees("Parse all BSP trees", false);
+Category ModelBuildOccluder("Build occluder", false);
 Category ModelParseBSPTree("Parse BSP tree", false);
 Category ModelConfigureVertexBuffers("Model configure vertex buffers", false);
 Category ModelCreateTransparencyIndexBuffer("Model create transparency buffer", false);
@@ -140,6 +148,7 @@ Category PageInStop("Finish page in", false);
 Category PageInSingleBitmap("Page in single bitmap", false);
 Category ShipPageIn("Ship page in", false);
 Category WeaponPageIn("Weapon page in", false);
+Category PreloadFiles("Preload files", false);
 
 Category RenderDecals("Render all decals", true);
 Category RenderSingleDecal("Render single decal", true);
@@ -61,6 +61,7 @@ extern Category ShipPostMove;
 extern Category FireballPostMove;
 extern Category DebrisPostMove;
 extern Category AsteroidPostMove;
+extern Category AsteroidInstances;
 extern Category PreMove;
 extern Category Physics;
 extern Category PostMove;
@@ -68,7 +69,13 @@ extern Category CollisionDetection;
 
 extern Category RenderBuffer;
 
+extern Category ObjectSnapshot;
+extern Category CullObjects;
+extern Category RasterizeOccluders;
+extern Category BuildOcclusionPyramid;
 extern Category QueueRender;
+extern Category SortModelDraws;
+extern Category MergeModelInstances;
 extern Category BuildModelUniforms;
 extern Category UploadModelUniforms;
 extern Category SubmitDraws;
@@ -141,6 +148,7 @@ extern Category LoadModelFile;
 extern Category ReadModelFile;
 extern Category ModelCreateVertexBuffers;
 extern Category ModelParseAllBSPTrees;
+extern Category ModelBuildOccluder;
 extern Category ModelParseBSPTree;
 extern Category ModelConfigureVertexBuffers;
 extern Category ModelCreateTransparencyIndexBuffer;
@@ -154,6 +162,7 @@ extern Category PageInStop;
 extern Category PageInSingleBitmap;
 extern Category ShipPageIn;
 extern Category WeaponPageIn;
+extern Category PreloadFiles;
 
 extern Category RenderDecals;
 extern Category RenderSingleDecal;
@@ -4,11 +4,15 @@
 #include "parse/parselo.h"
 #include "io/timer.h"
 
+#include "BinaryTrace.h"
 #include "TraceEventWriter.h"
 #include "MainFrameTimer.h"
 #include "FrameProfiler.h"
+#include "SummaryProfiler.h"
 
+#include <atomic>
 #include <cinttypes>
+#include <cstdio>
 #include <fstream>
 #include <future>
 #include <mutex>
@@ -52,9 +56,16 @@ namespace {
 
 using namespace tracing;
 
+// -json_profiling still records in the binary format and converts the file once the writer is done
+const char* const BINARY_TRACE_PATH = "tracing/trace.bin";
+const char* const JSON_TEMP_TRACE_PATH = "tracing/trace.json.bin";
+const char* const JSON_TRACE_PATH = "tracing/trace.json";
+
 std::unique_ptr<ThreadedTraceEventWriter> traceEventWriter;
+const char* traceEventPath = nullptr;
 std::unique_ptr<ThreadedMainFrameTimer> mainFrameTimer;
 std::unique_ptr<FrameProfiler> frameProfiler;
+std::unique_ptr<SummaryProfiler> summaryProfiler;
 
 SCP_vector<int> query_objects;
 // The GPU timestamp queries use an internal free list to reduce the number of graphics API calls
@@ -106,7 +117,14 @@ int gpu_start_query = -1;
 std::uint64_t gpu_start_time = 0;
 std::uint64_t cpu_start_time = 0;
 
-std::uint64_t current_id = 0;
+// Events are submitted from multiple threads
+std::atomic<std::uint64_t> current_id{0};
+
+std::atomic<std::uint64_t> processor_ids{0};
+
+std::uint64_t next_event_id() {
+	return current_id.fetch_add(1, std::memory_order_relaxed) + 1;
+}
 
 void submit_event(trace_event* evt) {
 	if (evt->pid == GPU_PID) {
@@ -127,6 +145,10 @@ void submit_event(trace_event* evt) {
 	if (frameProfiler) {
 		frameProfiler->processEvent(evt);
 	}
+
+	if (summaryProfiler) {
+		summaryProfiler->processEvent(evt);
+	}
 }
 
 void process_gpu_events() {
@@ -210,13 +232,18 @@ void init_event(const Category& category, trace_event* evt) {
 }
 
 namespace tracing {
+std::uint64_t next_event_processor_id() {
+	return processor_ids.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
 void init() {
 	do_trace_events = false;
 	do_async_events = false;
 	do_counter_events = false;
 
-	if (Cmdline_json_profiling) {
-		traceEventWriter.reset(new ThreadedTraceEventWriter());
+	if (Cmdline_json_profiling || Cmdline_binary_profiling) {
+		traceEventPath = Cmdline_binary_profiling ? BINARY_TRACE_PATH : JSON_TEMP_TRACE_PATH;
+		traceEventWriter.reset(new ThreadedTraceEventWriter(traceEventPath));
 		do_trace_events = true;
 		do_async_events = true;
 		do_counter_events = true;
@@ -229,6 +256,10 @@ void init() {
 		frameProfiler.reset(new FrameProfiler());
 		do_trace_events = true;
 	}
+	if (Cmdline_timedemo_frames > 0) {
+		summaryProfiler.reset(new SummaryProfiler());
+		do_trace_events = true;
+	}
 
 	do_gpu_queries = gr_is_capable(gr_capability::CAPABILITY_TIMESTAMP_QUERY);
 
@@ -260,6 +291,28 @@ SCP_string get_frame_profile_output() {
 	return frameProfiler->getContent();
 }
 
+SCP_vector<category_summary> get_category_summaries() {
+	Assertion(summaryProfiler, "The summary profiler must be enabled for this function!");
+
+	return summaryProfiler->getSummaries();
+}
+
+void reset_category_summaries() {
+	Assertion(summaryProfiler, "The summary profiler must be enabled for this function!");
+
+	summaryProfiler->reset();
+}
+
+void wait_for_pending_events() {
+	if (traceEventWriter) {
+		traceEventWriter->waitForPendingEvents();
+	}
+
+	if (mainFrameTimer) {
+		mainFrameTimer->waitForPendingEvents();
+	}
+}
+
 void shutdown() {
 	while (!gpu_events.empty()) {
 		process_events();
@@ -275,6 +328,18 @@ void shutdown() {
 
 	mainFrameTimer = nullptr;
 	traceEventWriter = nullptr;
+	summaryProfiler = nullptr;
+
+	if (traceEventPath != nullptr && Cmdline_json_profiling) {
+		SCP_string error;
+		if (!binary::convert_to_json(traceEventPath, JSON_TRACE_PATH, error)) {
+			mprintf(("TRACING: Failed to write '%s': %s\n", JSON_TRACE_PATH, error.c_str()));
+		}
+		if (traceEventPath == JSON_TEMP_TRACE_PATH) {
+			std::remove(JSON_TEMP_TRACE_PATH);
+		}
+	}
+	traceEventPath = nullptr;
 
 	initialized = false;
 }
@@ -295,7 +360,7 @@ void start(const Category& category, trace_event* evt) {
 
 	evt->duration = 0;
 	evt->type = EventType::Complete;
-	evt->event_id = ++current_id;
+	evt->event_id = next_event_id();
 
 	if (do_gpu_queries && category.usesGPUCounter()) {
 		Assertion(get_tid() == main_thread_id, "This function must be called from the main thread!");
@@ -327,7 +392,7 @@ void end(trace_event* evt) {
 	Assertion(evt->tid == get_tid(), "Complete events must be generated from the same thread!");
 
 	evt->duration = timer_get_nanoseconds() - evt->timestamp;
-	evt->end_event_id = ++current_id;
+	evt->end_event_id = next_event_id();
 
 	// Process CPU events
 	submit_event(evt);
@@ -363,7 +428,7 @@ void begin(const Category& category, const Scope& async_scope) {
 
 	evt.type = EventType::AsyncBegin;
 	evt.scope = &async_scope;
-	evt.event_id = ++current_id;
+	evt.event_id = next_event_id();
 
 	submit_event(&evt);
 }
@@ -378,7 +443,7 @@ void step(const Category& category, const Scope& async_scope) {
 
 	evt.type = EventType::AsyncStep;
 	evt.scope = &async_scope;
-	evt.event_id = ++current_id;
+	evt.event_id = next_event_id();
 
 	submit_event(&evt);
 }
@@ -393,7 +458,7 @@ void end(const Category& category, const Scope& async_scope) {
 
 	evt.type = EventType::AsyncEnd;
 	evt.scope = &async_scope;
-	evt.event_id = ++current_id;
+	evt.event_id = next_event_id();
 
 	submit_event(&evt);
 }
@@ -411,7 +476,7 @@ void value(const Category& category, float value) {
 	init_event(category, &evt);
 	evt.type = EventType::Counter;
 	evt.value = value;
-	evt.event_id = ++current_id;
+	evt.event_id = next_event_id();
 
 	submit_event(&evt);
 }
@@ -74,6 +74,13 @@ void frame_profile_process_frame();
  */
 SCP_string get_frame_profile_output();
 
+/**
+ * @brief Waits until the background processors have handled all events submitted so far
+ *
+ * Call this before freeing a category that may still be referenced by queued events.
+ */
+void wait_for_pending_events();
+
 /**
  * @brief Deinitializes the tracing subsystem
  */
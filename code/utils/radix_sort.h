@@ -0,0 +1,83 @@
+#pragma once
+
+#include "globalincs/vmallocator.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace util {
+
+/**
+ * @brief Stable LSD radix sort over a 64-bit key
+ *
+ * Sorts @c values in ascending order of @c key(value). Equal keys keep their relative order. Byte passes in which every
+ * key has the same digit are skipped so keys that only use a few bits only pay for the passes they need.
+ *
+ * @param values The values to sort
+ * @param scratch Storage used as the second buffer of the ping-pong passes. Pass the same vector every frame to avoid
+ * reallocating.
+ * @param key Function object returning the uint64_t sort key of a value
+ */
+template <typename T, typename KeyFunc>
+void radix_sort(SCP_vector<T>& values, SCP_vector<T>& scratch, KeyFunc&& key)
+{
+	constexpr size_t RADIX_BITS   = 8;
+	constexpr size_t RADIX_SIZE   = 1 << RADIX_BITS;
+	constexpr size_t NUM_PASSES   = sizeof(uint64_t) * 8 / RADIX_BITS;
+
+	const size_t count = values.size();
+	if (count < 2) {
+		return;
+	}
+
+	// Build the histograms of all passes with a single read of the input
+	std::array<std::array<size_t, RADIX_SIZE>, NUM_PASSES> histograms;
+	memset(histograms.data(), 0, sizeof(histograms));
+
+	for (const auto& value : values) {
+		uint64_t k = key(value);
+		for (size_t pass = 0; pass < NUM_PASSES; ++pass) {
+			++histograms[pass][(k >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)];
+		}
+	}
+
+	scratch.resize(count);
+
+	T* src = values.data();
+	T* dst = scratch.data();
+
+	for (size_t pass = 0; pass < NUM_PASSES; ++pass) {
+		auto& histogram = histograms[pass];
+
+		// All keys share this digit so this pass would not change the order
+		const uint64_t first_digit = (key(src[0]) >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1);
+		if (histogram[first_digit] == count) {
+			continue;
+		}
+
+		// Exclusive prefix sum turns the counts into output offsets
+		size_t offset = 0;
+		for (auto& bucket : histogram) {
+			auto bucket_count = bucket;
+			bucket = offset;
+			offset += bucket_count;
+		}
+
+		const auto shift = pass * RADIX_BITS;
+		for (size_t i = 0; i < count; ++i) {
+			const auto digit = (key(src[i]) >> shift) & (RADIX_SIZE - 1);
+			dst[histogram[digit]++] = std::move(src[i]);
+		}
+
+		std::swap(src, dst);
+	}
+
+	// An odd number of effective passes leaves the result in the scratch buffer
+	if (src != values.data()) {
+		values.swap(scratch);
+	}
+}
+
+} // namespace util
@@ -23,8 +23,44 @@ namespace threading {
 	static std::atomic<WorkerThreadTask> worker_task;
 
 	static SCP_vector<std::thread> worker_threads;
+	static std::thread::id main_thread_id;
+
+	struct parallel_for_job {
+		const std::function<void(size_t, size_t)>* func;
+		size_t count;
+		size_t chunk_size;
+		std::atomic_size_t next_chunk_start;
+		std::atomic_size_t elements_done;
+	};
+
+	static std::atomic<parallel_for_job*> current_parallel_job = nullptr;
+	static std::atomic_size_t parallel_job_participants = 0;
 
 	//Internal Functions
+	static void run_parallel_chunks(parallel_for_job& job) {
+		while (true) {
+			size_t begin = job.next_chunk_start.fetch_add(job.chunk_size);
+			if (begin >= job.count)
+				return;
+
+			size_t end = std::min(begin + job.chunk_size, job.count);
+			(*job.func)(begin, end);
+			job.elements_done.fetch_add(end - begin, std::memory_order_release);
+		}
+	}
+
+	static void parallel_for_worker_thread() {
+		//Register before looking at the job so that parallel_for can tell when no worker is touching it anymore
+		parallel_job_participants.fetch_add(1);
+
+		auto job = current_parallel_job.load();
+		if (job != nullptr) {
+			run_parallel_chunks(*job);
+		}
+
+		parallel_job_participants.fetch_sub(1);
+	}
+
 	static void mp_worker_thread_main(size_t threadIdx) {
 		while(true) {
 			{
@@ -38,6 +74,9 @@ namespace threading {
 				case WorkerThreadTask::COLLISION:
 					collide_mp_worker_thread(threadIdx);
 					break;
+				case WorkerThreadTask::PARALLEL_FOR:
+					parallel_for_worker_thread();
+					break;
 				default:
 					UNREACHABLE("Invalid threaded worker task!");
 			}
@@ -158,6 +197,8 @@ namespace threading {
 	}
 
 	void init_task_pool() {
+		main_thread_id = std::this_thread::get_id();
+
 		if (Cmdline_multithreading == 0) {
 			//At least given the current collision-detection threading, 8 cores (if available) seems like a sweetspot, with more cores adding too much overhead.
 			//This could be improved in the future.
@@ -184,6 +225,9 @@ namespace threading {
 		for(auto& thread : worker_threads) {
 			thread.join();
 		}
+		worker_threads.clear();
+
+		spin_down_threaded_task();
 	}
 
 	bool is_threading() {
@@ -193,4 +237,51 @@ namespace threading {
 	size_t get_num_workers() {
 		return worker_threads.size();
 	}
+
+	bool is_main_thread() {
+		return std::this_thread::get_id() == main_thread_id;
+	}
+
+	void parallel_for(size_t count, size_t min_chunk_size, const std::function<void(size_t begin, size_t end)>& func) {
+		if (count == 0)
+			return;
+
+		min_chunk_size = std::max(min_chunk_size, static_cast<size_t>(1));
+
+		if (!is_threading() || worker_threads.empty() || count <= min_chunk_size || !is_main_thread()) {
+			func(0, count);
+			return;
+		}
+
+		Assertion(current_parallel_job.load() == nullptr, "parallel_for must not be called recursively!");
+
+		//Aim for a few chunks per thread so that uneven chunks still balance out
+		size_t num_participants = worker_threads.size() + 1;
+		size_t chunk_size = std::max(min_chunk_size, (count + num_participants * 4 - 1) / (num_participants * 4));
+
+		parallel_for_job job;
+		job.func = &func;
+		job.count = count;
+		job.chunk_size = chunk_size;
+		job.next_chunk_start.store(0);
+		job.elements_done.store(0);
+
+		current_parallel_job.store(&job);
+		spin_up_threaded_task(WorkerThreadTask::PARALLEL_FOR);
+
+		run_parallel_chunks(job);
+
+		//All chunks have been handed out at this point, so the workers may go back to sleep once they are done
+		spin_down_threaded_task();
+
+		while (job.elements_done.load(std::memory_order_acquire) < count) {
+			std::this_thread::yield();
+		}
+
+		//The job lives on our stack, so wait until no worker can still be looking at it
+		current_parallel_job.store(nullptr);
+		while (parallel_job_participants.load() > 0) {
+			std::this_thread::yield();
+		}
+	}
 }
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
+#include <functional>
 
 namespace threading {
-	enum class WorkerThreadTask : uint8_t { EXIT, COLLISION };
+	enum class WorkerThreadTask : uint8_t { EXIT, COLLISION, PARALLEL_FOR };
 
 	//Call this to start a task on the task pool. Note that task-specific data must be set up before calling this.
 	void spin_up_threaded_task(WorkerThreadTask task);
@@ -16,4 +18,12 @@ namespace threading {
 
 	bool is_threading();
 	size_t get_num_workers();
+
+	//True on the thread which started the task pool
+	bool is_main_thread();
+
+	//Splits [0, count) into chunks of at least min_chunk_size elements and calls func(begin, end) for each of them on the task pool and the calling thread.
+	//Returns once all chunks have been processed. Must not be called on the main thread while another task is running.
+	//If threading is disabled, there is not enough work for more than one chunk or this is not called from the main thread, everything is run on the calling thread.
+	void parallel_for(size_t count, size_t min_chunk_size, const std::function<void(size_t begin, size_t end)>& func);
 }
\ No newline at end of file
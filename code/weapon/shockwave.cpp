@@ -273,7 +273,6 @@ int shockwave_get_framenum(const int sw_idx, const int ani_id)
 void shockwave_move(object *shockwave_objp, float frametime)
 {
 	shockwave	*sw;
-	object		*objp;
 	float			blast,damage;
 
 	Assertion(shockwave_objp->type == OBJ_SHOCKWAVE, "shockwave_move() called on an object of type %d instead of OBJ_SHOCKWAVE (%d); get a coder!\n", shockwave_objp->type, OBJ_SHOCKWAVE);
@@ -314,18 +313,16 @@ void shockwave_move(object *shockwave_objp, float frametime)
 
 	// blast ships and asteroids
 	// And (some) weapons
-	for ( objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) ) {
+	SCP_vector<object*> candidates;
+	weapon_area_find_candidates(&sw->pos, MIN(sw->outer_radius, sw->radius), candidates);
+
+	for (auto objp : candidates) {
 		if (objp->flags[Object::Object_Flags::Should_be_dead])
 			continue;
-		if ( (objp->type != OBJ_SHIP) && (objp->type != OBJ_ASTEROID) && (objp->type != OBJ_WEAPON)) {
-			continue;
-		}
 
 		if(objp->type == OBJ_WEAPON) {
 			// only apply to missiles with hitpoints
 			weapon_info* target_wip = &Weapon_info[Weapons[objp->instance].weapon_info_index];
-			if (target_wip->weapon_hitpoints <= 0)
-				continue;
 
 			if (!Shockwaves_always_damage_bombs && !(target_wip->wi_flags[Weapon::Info_Flags::Takes_shockwave_damage] || (sw->weapon_info_index >= 0 && Weapon_info[sw->weapon_info_index].wi_flags[Weapon::Info_Flags::Ciws])))
 				continue;
@@ -696,6 +693,9 @@ void shockwave_move_all(float frametime)
 {
 	shockwave	*sw, *next;
 	
+	// mission events and scripts may have moved objects since obj_move_all()
+	Obj_positions_version++;
+
 	sw = GET_FIRST(&Shockwave_list);
 	while ( sw != &Shockwave_list ) {
 		next = sw->next;
@@ -1034,6 +1034,8 @@ void spawn_child_weapons( object *objp, int spawn_index_override = -1);
 void weapon_detonate(object *objp);
 
 void	weapon_area_apply_blast(const vec3d *force_apply_pos, object *ship_objp, const vec3d *blast_pos, float blast, bool make_shockwave);
+void	weapon_area_find_candidates(const vec3d *pos, float radius, SCP_vector<object*> &candidates);
+void	weapon_area_object_moved(const object *objp);
 int	weapon_area_calc_damage(const object *objp, const vec3d *pos, float inner_rad, float outer_rad, float max_blast, float max_damage,
 										float *blast, float *damage, float limit);
 
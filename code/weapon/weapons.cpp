@@ -64,6 +64,7 @@
 #include "particle/volumes/PointVolume.h"
 #include "tracing/Monitor.h"
 #include "tracing/tracing.h"
+#include "utils/radix_sort.h"
 #include "weapon.h"
 #include "model/modelrender.h"
 
@@ -288,6 +289,33 @@ int Player_weapon_precedence_line;	// And this is the line the precedence list w
 constexpr int IMPACT_SOUND_DELTA = 50;	// in milliseconds
 static TIMESTAMP Weapon_impact_timer;	// timer, initialized at start of each mission
 
+// The objects which can be damaged by blasts and shockwaves, in obj_used_list order.  This only changes when objects are
+// added or removed, so it is usually built once per frame and shared by all the area effects of that frame.
+static SCP_vector<int> Area_effect_candidates;
+static int Area_effect_candidates_version = -1;
+static SCP_vector<int> Area_effect_candidate_index;			// per object, index into Area_effect_candidates or -1
+
+// Bucket grid over the bounding spheres of Area_effect_candidates so an area effect only has to look at the objects
+// near it.  It is rebuilt on the first area effect after a movement pass, which is about once per frame.  Objects which
+// move out of their cells before that are reported by weapon_area_object_moved() and tested by every area effect.
+struct area_effect_grid_entry
+{
+	uint64_t cell;
+	int candidate;		// index into Area_effect_candidates
+};
+static SCP_vector<area_effect_grid_entry> Area_effect_grid;	// sorted by cell
+static SCP_vector<area_effect_grid_entry> Area_effect_grid_scratch;
+static SCP_vector<int> Area_effect_grid_large;				// candidates which are not (or no longer) in the cells they touch
+static SCP_vector<vec3d> Area_effect_grid_positions;		// per candidate, where it was inserted into the grid
+static SCP_vector<bool> Area_effect_grid_in_large;			// per candidate, whether it is in Area_effect_grid_large
+static bool Area_effect_grid_outdated = false;				// too many objects moved, rebuild on the next area effect
+static SCP_vector<uint32_t> Area_effect_query_stamps;
+static uint32_t Area_effect_query_stamp = 0;
+static SCP_vector<int> Area_effect_query_results;
+static float Area_effect_grid_cell_size = 1.0f;
+static int Area_effect_grid_positions_version = -1;
+static int Area_effect_grid_candidates_version = -1;
+
 // energy suck defines
 #define ESUCK_DEFAULT_WEAPON_REDUCE				(10.0f)
 #define ESUCK_DEFAULT_AFTERBURNER_REDUCE		(10.0f)
@@ -7615,6 +7643,281 @@ int weapon_area_calc_damage(const object *objp, const vec3d *pos, float inner_ra
 	return 0;
 }
 
+// Radius of a sphere around the ship center which contains the bounding box used by weapon_area_calc_damage()
+static float weapon_area_ship_bound(const object *objp)
+{
+	auto pm = model_get(Ship_info[Ships[objp->instance].ship_info_index].model_num);
+
+	vec3d corner;
+	corner.xyz.x = MAX(fl_abs(pm->mins.xyz.x), fl_abs(pm->maxs.xyz.x));
+	corner.xyz.y = MAX(fl_abs(pm->mins.xyz.y), fl_abs(pm->maxs.xyz.y));
+	corner.xyz.z = MAX(fl_abs(pm->mins.xyz.z), fl_abs(pm->maxs.xyz.z));
+
+	return MAX(objp->radius, vm_vec_mag(&corner));
+}
+
+namespace {
+// Cells are addressed with 21 bits per axis, just like the light grid.  Coordinates outside of that range wrap around
+// which only adds a few false candidates that are removed by the exact test.
+const int AREA_EFFECT_GRID_CELL_BITS = 21;
+const int AREA_EFFECT_GRID_CELL_MASK = (1 << AREA_EFFECT_GRID_CELL_BITS) - 1;
+
+// An object touching more cells than this is tested by every area effect instead of being inserted into the grid
+const size_t AREA_EFFECT_GRID_MAX_CELLS_PER_OBJECT = 64;
+
+// Objects are inserted with this much extra room so moving a little doesn't take them out of their cells
+const float AREA_EFFECT_GRID_SLACK = 10.0f;
+
+// Once more than this fraction of the candidates left their cells the grid is rebuilt
+const size_t AREA_EFFECT_GRID_MOVED_FRACTION = 4;
+
+inline uint64_t area_effect_grid_cell_key(int x, int y, int z)
+{
+	return (static_cast<uint64_t>(x & AREA_EFFECT_GRID_CELL_MASK) << (AREA_EFFECT_GRID_CELL_BITS * 2))
+		| (static_cast<uint64_t>(y & AREA_EFFECT_GRID_CELL_MASK) << AREA_EFFECT_GRID_CELL_BITS)
+		| static_cast<uint64_t>(z & AREA_EFFECT_GRID_CELL_MASK);
+}
+
+inline int area_effect_grid_coord(float value, float cell_size)
+{
+	return static_cast<int>(floorf(value / cell_size));
+}
+
+// Radius of the sphere around an object's center which contains everything weapon_area_calc_damage() may hit
+float weapon_area_object_bound(const object *objp)
+{
+	return (objp->type == OBJ_SHIP) ? weapon_area_ship_bound(objp) : objp->radius;
+}
+
+void weapon_area_build_candidates()
+{
+	if (Area_effect_candidate_index.empty()) {
+		Area_effect_candidate_index.assign(MAX_OBJECTS, -1);
+	}
+	for (auto objnum : Area_effect_candidates) {
+		Area_effect_candidate_index[objnum] = -1;
+	}
+
+	Area_effect_candidates.clear();
+
+	for (auto objp : list_range(&obj_used_list)) {
+		if ( (objp->type != OBJ_SHIP) && (objp->type != OBJ_ASTEROID) && (objp->type != OBJ_WEAPON) ) {
+			continue;
+		}
+
+		// only missiles with hitpoints can be damaged
+		if ( (objp->type == OBJ_WEAPON) && (Weapon_info[Weapons[objp->instance].weapon_info_index].weapon_hitpoints <= 0) ) {
+			continue;
+		}
+
+		Area_effect_candidate_index[OBJ_INDEX(objp)] = static_cast<int>(Area_effect_candidates.size());
+		Area_effect_candidates.push_back(OBJ_INDEX(objp));
+	}
+
+	Area_effect_candidates_version = Obj_used_list_version;
+}
+
+void weapon_area_build_grid()
+{
+	Area_effect_grid.clear();
+	Area_effect_grid_large.clear();
+
+	Area_effect_query_stamps.assign(Area_effect_candidates.size(), 0);
+	Area_effect_query_stamp = 0;
+
+	Area_effect_grid_positions.clear();
+	Area_effect_grid_in_large.assign(Area_effect_candidates.size(), false);
+
+	Area_effect_grid_positions_version = Obj_positions_version;
+	Area_effect_grid_candidates_version = Area_effect_candidates_version;
+	Area_effect_grid_outdated = false;
+
+	if (Area_effect_candidates.empty()) {
+		return;
+	}
+
+	SCP_vector<float> bounds;
+	bounds.reserve(Area_effect_candidates.size());
+
+	float bound_sum = 0.0f;
+	for (auto objnum : Area_effect_candidates) {
+		float bound = weapon_area_object_bound(&Objects[objnum]) + AREA_EFFECT_GRID_SLACK;
+		bounds.push_back(bound);
+		bound_sum += bound;
+	}
+
+	// Size the cells so that an average object overlaps a handful of them
+	Area_effect_grid_cell_size = MAX(bound_sum / Area_effect_candidates.size(), 1.0f);
+
+	for (int i = 0; i < static_cast<int>(Area_effect_candidates.size()); ++i) {
+		const vec3d *pos = &Objects[Area_effect_candidates[i]].pos;
+		float bound = bounds[i];
+
+		Area_effect_grid_positions.push_back(*pos);
+
+		int min_x = area_effect_grid_coord(pos->xyz.x - bound, Area_effect_grid_cell_size), max_x = area_effect_grid_coord(pos->xyz.x + bound, Area_effect_grid_cell_size);
+		int min_y = area_effect_grid_coord(pos->xyz.y - bound, Area_effect_grid_cell_size), max_y = area_effect_grid_coord(pos->xyz.y + bound, Area_effect_grid_cell_size);
+		int min_z = area_effect_grid_coord(pos->xyz.z - bound, Area_effect_grid_cell_size), max_z = area_effect_grid_coord(pos->xyz.z + bound, Area_effect_grid_cell_size);
+
+		auto num_cells = static_cast<size_t>(max_x - min_x + 1) * (max_y - min_y + 1) * (max_z - min_z + 1);
+		if (num_cells > AREA_EFFECT_GRID_MAX_CELLS_PER_OBJECT) {
+			Area_effect_grid_large.push_back(i);
+			Area_effect_grid_in_large[i] = true;
+			continue;
+		}
+
+		for (int x = min_x; x <= max_x; ++x) {
+			for (int y = min_y; y <= max_y; ++y) {
+				for (int z = min_z; z <= max_z; ++z) {
+					Area_effect_grid.push_back({area_effect_grid_cell_key(x, y, z), i});
+				}
+			}
+		}
+	}
+
+	util::radix_sort(Area_effect_grid, Area_effect_grid_scratch, [](const area_effect_grid_entry& entry) { return entry.cell; });
+}
+
+void weapon_area_add_query_result(int candidate)
+{
+	// An object is listed in every cell it overlaps so make sure it is only returned once per query
+	if (Area_effect_query_stamps[candidate] == Area_effect_query_stamp) {
+		return;
+	}
+	Area_effect_query_stamps[candidate] = Area_effect_query_stamp;
+
+	Area_effect_query_results.push_back(candidate);
+}
+
+bool weapon_area_grid_current()
+{
+	return (Area_effect_candidates_version == Obj_used_list_version)
+		&& (Area_effect_grid_candidates_version == Area_effect_candidates_version)
+		&& (Area_effect_grid_positions_version == Obj_positions_version)
+		&& !Area_effect_grid_outdated;
+}
+}
+
+/**
+ * Tell the area effects that an object may have moved
+ *
+ * Has to be called for anything that moves objects while area effects can happen, i.e. between a bump of
+ * Obj_positions_version and the next one.  An object which left the room it was inserted into the grid with is tested by
+ * every following area effect, so they find it at its current position no matter how far it moved.
+ *
+ * @param objp	The object which was moved
+ */
+void weapon_area_object_moved(const object *objp)
+{
+	// the grid is rebuilt from the current positions anyway
+	if (!weapon_area_grid_current()) {
+		return;
+	}
+
+	int candidate = Area_effect_candidate_index[OBJ_INDEX(objp)];
+	if ( (candidate < 0) || Area_effect_grid_in_large[candidate] ) {
+		return;
+	}
+
+	if (vm_vec_dist_squared(&objp->pos, &Area_effect_grid_positions[candidate]) <= AREA_EFFECT_GRID_SLACK * AREA_EFFECT_GRID_SLACK) {
+		return;
+	}
+
+	Area_effect_grid_large.push_back(candidate);
+	Area_effect_grid_in_large[candidate] = true;
+
+	// at some point testing all the moved objects costs more than building the grid again
+	if (Area_effect_grid_large.size() > Area_effect_candidates.size() / AREA_EFFECT_GRID_MOVED_FRACTION) {
+		Area_effect_grid_outdated = true;
+	}
+}
+
+/**
+ * Find the objects an area effect might damage
+ *
+ * This is a conservative bounding sphere test so weapon_area_calc_damage() still has to be called for every candidate.
+ * Objects that can never take area damage (debris, fireballs, beams and weapons without hitpoints) are not returned,
+ * everything else, including the flags of the objects, still has to be checked by the caller.
+ *
+ * The objects are looked up in a bucket grid which is shared by all the area effects until objects are added or removed
+ * or the next movement pass, so every area effect only tests the objects in the cells it overlaps.  Objects moved in
+ * between have to be reported with weapon_area_object_moved().
+ *
+ * @param pos			World pos of blast center
+ * @param radius		Radius beyond which the area effect does no damage
+ * @param candidates	OUTPUT PARAMETER: receives the objects in obj_used_list order, so damage is applied in the same order
+ */
+void weapon_area_find_candidates(const vec3d *pos, float radius, SCP_vector<object*> &candidates)
+{
+	candidates.clear();
+
+	if (Area_effect_candidates_version != Obj_used_list_version) {
+		weapon_area_build_candidates();
+	}
+
+	if (!weapon_area_grid_current()) {
+		weapon_area_build_grid();
+	}
+
+	if (Area_effect_candidates.empty()) {
+		return;
+	}
+
+	if (++Area_effect_query_stamp == 0) {
+		// The stamp wrapped around so old stamps could be mistaken for the current query
+		std::fill(Area_effect_query_stamps.begin(), Area_effect_query_stamps.end(), 0);
+		Area_effect_query_stamp = 1;
+	}
+
+	Area_effect_query_results.clear();
+
+	int min_x = area_effect_grid_coord(pos->xyz.x - radius, Area_effect_grid_cell_size), max_x = area_effect_grid_coord(pos->xyz.x + radius, Area_effect_grid_cell_size);
+	int min_y = area_effect_grid_coord(pos->xyz.y - radius, Area_effect_grid_cell_size), max_y = area_effect_grid_coord(pos->xyz.y + radius, Area_effect_grid_cell_size);
+	int min_z = area_effect_grid_coord(pos->xyz.z - radius, Area_effect_grid_cell_size), max_z = area_effect_grid_coord(pos->xyz.z + radius, Area_effect_grid_cell_size);
+
+	auto num_cells = static_cast<size_t>(max_x - min_x + 1) * (max_y - min_y + 1) * (max_z - min_z + 1);
+
+	if (num_cells > Area_effect_candidates.size()) {
+		// Huge area effects touch more cells than there are objects so simply test all of them
+		for (int i = 0; i < static_cast<int>(Area_effect_candidates.size()); ++i) {
+			Area_effect_query_results.push_back(i);
+		}
+	} else {
+		for (auto candidate : Area_effect_grid_large) {
+			weapon_area_add_query_result(candidate);
+		}
+
+		for (int x = min_x; x <= max_x; ++x) {
+			for (int y = min_y; y <= max_y; ++y) {
+				for (int z = min_z; z <= max_z; ++z) {
+					auto key = area_effect_grid_cell_key(x, y, z);
+					auto cell = std::lower_bound(Area_effect_grid.begin(), Area_effect_grid.end(), key,
+						[](const area_effect_grid_entry& entry, uint64_t value) { return entry.cell < value; });
+
+					for ( ; cell != Area_effect_grid.end() && cell->cell == key; ++cell) {
+						weapon_area_add_query_result(cell->candidate);
+					}
+				}
+			}
+		}
+
+		// Keep the same order as a linear scan over obj_used_list would produce
+		std::sort(Area_effect_query_results.begin(), Area_effect_query_results.end());
+	}
+
+	for (auto candidate : Area_effect_query_results) {
+		auto objp = &Objects[Area_effect_candidates[candidate]];
+
+		// add a little to the range so rounding can never drop an object weapon_area_calc_damage() would have accepted
+		float range = radius + weapon_area_object_bound(objp) + 1.0f;
+		if (vm_vec_dist_squared(pos, &objp->pos) > range * range) {
+			continue;
+		}
+
+		candidates.push_back(objp);
+	}
+}
+
 /**
  * Apply the blast effects of an explosion to an object
  *
@@ -7674,25 +7977,22 @@ void weapon_area_apply_blast(const vec3d * /*force_apply_pos*/, object *objp, co
 void weapon_do_area_effect(object *wobjp, const shockwave_create_info *sci, const vec3d *pos, const object *impacted_obj)
 {
 	weapon_info	*wip;
-	object		*objp;
 	float			damage, blast;
 
 	wip = &Weapon_info[Weapons[wobjp->instance].weapon_info_index];	
 
 	// only blast ships and asteroids
 	// And (some) weapons
-	for ( objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) ) {
+	SCP_vector<object*> candidates;
+	weapon_area_find_candidates(pos, sci->outer_rad, candidates);
+
+	for (auto objp : candidates) {
 		if (objp->flags[Object::Object_Flags::Should_be_dead])
 			continue;
-		if ( (objp->type != OBJ_SHIP) && (objp->type != OBJ_ASTEROID) && (objp->type != OBJ_WEAPON) ) {
-			continue;
-		}
-	
+
 		if (objp->type == OBJ_WEAPON) {
 			// only apply to missiles with hitpoints
 			weapon_info* wip2 = &Weapon_info[Weapons[objp->instance].weapon_info_index];
-			if (wip2->weapon_hitpoints <= 0)
-				continue;
 			if (!((wip2->wi_flags[Weapon::Info_Flags::Takes_blast_damage]) || (wip->wi_flags[Weapon::Info_Flags::Ciws])))
 				continue;
 		}
@@ -107,6 +107,7 @@
 #include "mission/missionhotkey.h"
 #include "mission/missionload.h"
 #include "mission/missionlog.h"
+#include "mission/missionmanifest.h"
 #include "mission/missionmessage.h"
 #include "mission/missionparse.h"
 #include "mission/missiontraining.h"
@@ -144,6 +145,7 @@
 #include "network/multiutil.h"
 #include "network/stand_gui.h"
 #include "object/objcollide.h"
+#include "object/objectsnapshot.h"
 #include "object/objectsnd.h"
 #include "object/waypoint.h"
 #include "observer/observer.h"
@@ -191,7 +193,9 @@
 #include "starfield/supernova.h"
 #include "stats/medals.h"
 #include "stats/stats.h"
+#include "tracing/BinaryTrace.h"
 #include "tracing/Monitor.h"
+#include "tracing/Timedemo.h"
 #include "tracing/tracing.h"
 #include "utils/Random.h"
 #include "utils/threading.h"
@@ -1171,8 +1175,11 @@ void game_do_networking()
 // load a level.   You can find this value by looking at the return value
 // of game_busy_callback(nullptr), which I conveniently print out to the
 // debug output window with the '=== ENDING LOAD ==' stuff.   
+// If the mission was loaded before the count of that load is used instead.
 #define COUNT_ESTIMATE 719
 
+static int Game_loading_count_estimate = COUNT_ESTIMATE;
+
 int Game_loading_callback_inited = 0;
 int Game_loading_background = -1;
 generic_anim Game_loading_ani;
@@ -1206,7 +1213,7 @@ void game_loading_callback(int count)
 
 	int do_flip = 0;
 
-	int new_framenum = bm_get_anim_frame(Game_loading_ani.first_frame, static_cast<float>(count), static_cast<float>(COUNT_ESTIMATE));
+	int new_framenum = bm_get_anim_frame(Game_loading_ani.first_frame, static_cast<float>(count), static_cast<float>(Game_loading_count_estimate));
 	// retail incremented the frame number by one, essentially skipping the 1st frame except for single-frame anims
 	if (Game_loading_ani.num_frames > 1 && new_framenum < Game_loading_ani.num_frames-1) {
 		new_framenum++;
@@ -1251,7 +1258,7 @@ void game_loading_callback(int count)
 	}
 #endif
 
-	auto progress = static_cast<float>(count) / static_cast<float>(COUNT_ESTIMATE);
+	auto progress = static_cast<float>(count) / static_cast<float>(Game_loading_count_estimate);
 	CLAMP(progress, 0.0f, 1.0f);
 
 	if (scripting::hooks::OnLoadScreen->run(scripting::hook_param_list(scripting::hook_param("Progress", 'f', progress))) > 0) {
@@ -1278,10 +1285,13 @@ void game_loading_callback_init()
 	generic_anim_load(&Game_loading_ani);
 	Assertion( Game_loading_ani.num_frames > 0, "Load Screen animation %s not found, or corrupted. Needs to be an animation with at least 1 frame.", Game_loading_ani.filename );
 
+	auto recorded_count = mission_manifest_load_steps(Game_current_mission_filename);
+	Game_loading_count_estimate = (recorded_count > 0) ? recorded_count : COUNT_ESTIMATE;
+
 	Game_loading_callback_inited = 1;
 	io::mouse::CursorManager::get()->showCursor(false);
 	framenum = 0;
-	game_busy_callback( game_loading_callback, (COUNT_ESTIMATE/Game_loading_ani.num_frames)+1 );
+	game_busy_callback( game_loading_callback, (Game_loading_count_estimate/Game_loading_ani.num_frames)+1 );
 
 
 }
@@ -1291,20 +1301,18 @@ void game_loading_callback_close()
 	Assert( Game_loading_callback_inited==1 );
 
 	// Make sure bar shows all the way over.
-	game_loading_callback(COUNT_ESTIMATE);
+	game_loading_callback(Game_loading_count_estimate);
 	
-	int real_count __UNUSED = game_busy_callback( nullptr );
+	int real_count = game_busy_callback( nullptr );
+	mission_manifest_set_load_steps(real_count);
 	io::mouse::CursorManager::get()->showCursor(true);
 
 	Game_loading_callback_inited = 0;
 	
 #ifndef NDEBUG
 	mprintf(( "=================== ENDING LOAD ================\n" ));
-	mprintf(( "Real count = %d,  Estimated count = %d\n", real_count, COUNT_ESTIMATE ));
+	mprintf(( "Real count = %d,  Estimated count = %d\n", real_count, Game_loading_count_estimate ));
 	mprintf(( "================================================\n" ));
-#else
-	// to remove warnings in release build
-	real_count = 0;
 #endif
 
 	generic_anim_unload(&Game_loading_ani);
@@ -1451,6 +1459,11 @@ void game_post_level_init()
 
 	mission_process_alt_types();
 
+	// there is no recorded input so the AI flies the player ship to keep the timedemo repeatable
+	if (tracing::timedemo::active()) {
+		Player_use_ai = true;
+	}
+
 	if (scripting::hooks::OnMissionStart->isActive()) {
 		// HACK: That scripting hook should be in mission so GM_IN_MISSION has to be set
 		Game_mode |= GM_IN_MISSION;
@@ -1470,6 +1483,10 @@ bool game_start_mission()
 
 	int s1 __UNUSED = timer_get_milliseconds();
 
+	// read what the last load of this mission needed while everything is set up, and write down what this one needs
+	mission_manifest_prefetch(Game_current_mission_filename);
+	mission_manifest_record_start(Game_current_mission_filename);
+
 	// clear post processing settings
 	gr_post_process_set_defaults();
 
@@ -1512,6 +1529,9 @@ bool game_start_mission()
 			game_loading_callback_close();
 		}
 
+		mission_manifest_record_stop(false);
+		mission_manifest_prefetch_stop();
+
 		game_level_close();
 
 		return false;
@@ -1540,6 +1560,9 @@ bool game_start_mission()
 
 	bm_print_bitmaps();
 
+	mission_manifest_record_stop(true);
+	mission_manifest_prefetch_stop();
+
 	// init some common team select stuff now
 	if (Game_mode & GM_MULTIPLAYER) {
 		multi_ts_common_level_init();
@@ -1894,6 +1917,14 @@ void game_init()
 	// This needs to happen after graphics initialization
 	tracing::init();
 
+	if (tracing::timedemo::active()) {
+		if (Cmdline_start_mission == nullptr) {
+			Error(LOCATION, "The -timedemo command line option requires a mission set with -start_mission!");
+		}
+
+		tracing::timedemo::init();
+	}
+
 // Karajorma - Moved here from the sound init code cause otherwise windows complains
 #ifdef FS2_VOICER
 	if(Cmdline_voice_recognition)
@@ -3492,6 +3523,11 @@ void game_render_frame( camid cid, const vec3d* offset, const matrix* rot_offset
 
 	if (!(Game_mode & GM_LAB)) {
 		HUD_set_offsets();
+
+		// the objects are culled while the rest of the scene is set up, they are only needed once they get queued
+		if (Cmdline_pipeline_render) {
+			obj_render_cull_begin();
+		}
 	}
 
 	// for multiplayer clients, call code in Shield.cpp to set up the Shield_hit array.  Have to
@@ -3805,6 +3841,10 @@ void game_simulation_frame()
 	// Kick off externally injected operations after the simulation step has finished
 	executor::OnSimulationExecutor->process();
 	scripting::hooks::OnSimulation->run();
+
+	if (Cmdline_pipeline_render) {
+		obj_snapshot_take();
+	}
 }
 
 // Maybe render and process the dead-popup
@@ -4437,6 +4477,9 @@ void game_set_frametime(int state)
 	if ((Pre_player_entry) && (state == GS_STATE_GAME_PLAY)) {
 		Frametime = F1_0/4;
 		do_pre_player_skip = true;
+	} else if (tracing::timedemo::active()) {
+		// every timedemo frame simulates the same amount of time no matter how long it took
+		Frametime = tracing::timedemo::frametime();
 	}
 
 	Assertion( Framerate_cap > 0, "Framerate cap %d is too low. Needs to be a positive, non-zero number", Framerate_cap );
@@ -4565,6 +4608,12 @@ void game_do_frame(bool set_frametime)
 	last_single_step = game_single_step;
 
 	game_frame();
+
+	if (tracing::timedemo::active() && !Pre_player_entry) {
+		if (tracing::timedemo::frame_finished(Game_current_mission_filename)) {
+			gameseq_post_event(GS_EVENT_END_GAME);
+		}
+	}
 }
 
 void multi_maybe_do_frame()
@@ -6851,6 +6900,19 @@ int game_main(int argc, char *argv[])
 		return 1;
 	}
 
+	// converting a trace does not need any of the engine so do it before initializing anything
+	if (Cmdline_convert_trace != nullptr) {
+		SCP_string json_path = SCP_string(Cmdline_convert_trace) + ".json";
+		SCP_string error;
+
+		auto success = tracing::binary::convert_to_json(Cmdline_convert_trace, json_path.c_str(), error);
+		if (!error.empty()) {
+			fprintf(stderr, "%s\n", error.c_str());
+		}
+
+		return success ? 0 : 1;
+	}
+
 	game_init();
 
 	// if networking is unavailable then standalone is useless, so just fail
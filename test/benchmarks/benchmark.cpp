@@ -0,0 +1,336 @@
+#include "benchmark.h"
+
+#include <globalincs/version.h>
+#include <libs/jansson.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+namespace {
+
+struct registered_benchmark {
+	SCP_string name;
+	bench::BenchmarkFunc func;
+};
+
+SCP_vector<registered_benchmark>& get_registry()
+{
+	// Function local so that registrations from other translation units do not depend on the initialization order
+	static SCP_vector<registered_benchmark> registry;
+	return registry;
+}
+
+struct run_options {
+	SCP_string filter;
+	SCP_string json_path;
+	double min_time = 0.5;
+	int repetitions = 3;
+	bool list_only = false;
+};
+
+struct benchmark_result {
+	SCP_string name;
+	uint64_t iterations = 0;
+
+	// Per iteration times in nanoseconds of each repetition
+	SCP_vector<double> real_times;
+	SCP_vector<double> cpu_times;
+
+	double items_per_second = 0.0;
+
+	bool skipped = false;
+	SCP_string skip_reason;
+};
+
+const uint64_t MAX_ITERATIONS = 1000000000;
+
+bool starts_with(const char* arg, const char* prefix, const char** value_out)
+{
+	auto len = strlen(prefix);
+	if (strncmp(arg, prefix, len) != 0) {
+		return false;
+	}
+	*value_out = arg + len;
+	return true;
+}
+
+bool parse_options(int argc, char** argv, run_options& options)
+{
+	for (int i = 1; i < argc; ++i) {
+		const char* value;
+		if (starts_with(argv[i], "--filter=", &value)) {
+			options.filter = value;
+		} else if (starts_with(argv[i], "--json=", &value)) {
+			options.json_path = value;
+		} else if (starts_with(argv[i], "--min-time=", &value)) {
+			options.min_time = std::max(atof(value), 0.001);
+		} else if (starts_with(argv[i], "--repetitions=", &value)) {
+			options.repetitions = std::max(atoi(value), 1);
+		} else if (!strcmp(argv[i], "--list")) {
+			options.list_only = true;
+		} else {
+			printf("Usage: %s [--filter=<substring>] [--json=<file>] [--min-time=<seconds>] [--repetitions=<n>] [--list]\n",
+				argv[0]);
+			return false;
+		}
+	}
+	return true;
+}
+
+bool run_once(const registered_benchmark& benchmark, uint64_t iterations, bench::State& state_out)
+{
+	state_out = bench::State(iterations);
+	benchmark.func(state_out);
+	return !state_out.skipped();
+}
+
+benchmark_result run_benchmark(const registered_benchmark& benchmark, const run_options& options)
+{
+	benchmark_result result;
+	result.name = benchmark.name;
+
+	// Grow the iteration count until one run takes long enough to give a stable per iteration time
+	bench::State state(1);
+	uint64_t iterations = 1;
+	while (true) {
+		if (!run_once(benchmark, iterations, state)) {
+			result.skipped = true;
+			result.skip_reason = state.skip_reason();
+			return result;
+		}
+
+		const double elapsed = state.real_seconds();
+		if (elapsed >= options.min_time || iterations >= MAX_ITERATIONS) {
+			break;
+		}
+
+		// Aim a bit above the minimum time but never grow more than tenfold since the first runs are noisy
+		double multiplier = elapsed > 0.0 ? options.min_time * 1.4 / elapsed : 10.0;
+		multiplier = std::min(std::max(multiplier, 2.0), 10.0);
+		iterations = std::min(static_cast<uint64_t>(iterations * multiplier), MAX_ITERATIONS);
+	}
+
+	result.iterations = iterations;
+
+	// The calibration run counts as the first repetition
+	double items_per_second = 0.0;
+	for (int rep = 0; rep < options.repetitions; ++rep) {
+		if (rep > 0 && !run_once(benchmark, iterations, state)) {
+			result.skipped = true;
+			result.skip_reason = state.skip_reason();
+			return result;
+		}
+
+		result.real_times.push_back(state.real_seconds() * 1e9 / static_cast<double>(iterations));
+		result.cpu_times.push_back(state.cpu_seconds() * 1e9 / static_cast<double>(iterations));
+
+		if (state.items_processed() > 0 && state.real_seconds() > 0.0) {
+			items_per_second += static_cast<double>(state.items_processed()) / state.real_seconds();
+		}
+	}
+	result.items_per_second = items_per_second / options.repetitions;
+
+	return result;
+}
+
+double median(SCP_vector<double> values)
+{
+	std::sort(values.begin(), values.end());
+	const auto mid = values.size() / 2;
+	if (values.size() % 2 == 0) {
+		return (values[mid - 1] + values[mid]) / 2.0;
+	}
+	return values[mid];
+}
+
+double stddev(const SCP_vector<double>& values)
+{
+	if (values.size() < 2) {
+		return 0.0;
+	}
+
+	double mean = 0.0;
+	for (auto value : values) {
+		mean += value;
+	}
+	mean /= values.size();
+
+	double sum = 0.0;
+	for (auto value : values) {
+		sum += (value - mean) * (value - mean);
+	}
+	return std::sqrt(sum / (values.size() - 1));
+}
+
+void print_result(const benchmark_result& result)
+{
+	if (result.skipped) {
+		printf("%-48s %s\n", result.name.c_str(), ("SKIPPED: " + result.skip_reason).c_str());
+		return;
+	}
+
+	printf("%-48s %14.1f %14.1f %12llu", result.name.c_str(), median(result.real_times), median(result.cpu_times),
+		static_cast<unsigned long long>(result.iterations));
+	if (result.items_per_second > 0.0) {
+		printf(" %14.4g items/s", result.items_per_second);
+	}
+	printf("\n");
+	fflush(stdout);
+}
+
+json_t* result_to_json(const benchmark_result& result)
+{
+	auto obj = json_object();
+
+	json_object_set_new(obj, "name", json_string(result.name.c_str()));
+
+	if (result.skipped) {
+		json_object_set_new(obj, "skipped", json_true());
+		json_object_set_new(obj, "skip_reason", json_string(result.skip_reason.c_str()));
+		return obj;
+	}
+
+	json_object_set_new(obj, "iterations", json_integer(static_cast<json_int_t>(result.iterations)));
+	json_object_set_new(obj, "repetitions", json_integer(static_cast<json_int_t>(result.real_times.size())));
+	json_object_set_new(obj, "real_time", json_real(median(result.real_times)));
+	json_object_set_new(obj, "cpu_time", json_real(median(result.cpu_times)));
+	json_object_set_new(obj, "real_time_min", json_real(*std::min_element(result.real_times.begin(), result.real_times.end())));
+	json_object_set_new(obj, "real_time_max", json_real(*std::max_element(result.real_times.begin(), result.real_times.end())));
+	json_object_set_new(obj, "real_time_stddev", json_real(stddev(result.real_times)));
+	json_object_set_new(obj, "time_unit", json_string("ns"));
+
+	if (result.items_per_second > 0.0) {
+		json_object_set_new(obj, "items_per_second", json_real(result.items_per_second));
+	}
+
+	return obj;
+}
+
+bool write_json(const SCP_vector<benchmark_result>& results, const run_options& options, const char* executable)
+{
+	std::unique_ptr<json_t> root(json_object());
+
+	auto context = json_object();
+	json_object_set_new(context, "executable", json_string(executable));
+	json_object_set_new(context, "version", json_string(gameversion::get_version_string().c_str()));
+#ifdef NDEBUG
+	json_object_set_new(context, "build_type", json_string("release"));
+#else
+	json_object_set_new(context, "build_type", json_string("debug"));
+#endif
+	json_object_set_new(context, "num_cpus", json_integer(std::thread::hardware_concurrency()));
+	json_object_set_new(context, "min_time", json_real(options.min_time));
+	json_object_set_new(context, "repetitions", json_integer(options.repetitions));
+	json_object_set_new(root.get(), "context", context);
+
+	auto benchmarks = json_array();
+	for (const auto& result : results) {
+		json_array_append_new(benchmarks, result_to_json(result));
+	}
+	json_object_set_new(root.get(), "benchmarks", benchmarks);
+
+	return json_dump_file(root.get(), options.json_path.c_str(), JSON_INDENT(2)) == 0;
+}
+
+} // namespace
+
+namespace bench {
+
+State::State(uint64_t iterations) : _iterations(iterations), _remaining(iterations) {}
+
+void State::start()
+{
+	_started = true;
+	resume_timing();
+}
+
+void State::stop()
+{
+	if (_running) {
+		pause_timing();
+	}
+}
+
+void State::pause_timing()
+{
+	_real_time += std::chrono::steady_clock::now() - _real_start;
+	_cpu_time += static_cast<double>(std::clock() - _cpu_start) / CLOCKS_PER_SEC;
+	_running = false;
+}
+
+void State::resume_timing()
+{
+	_running = true;
+	_cpu_start = std::clock();
+	_real_start = std::chrono::steady_clock::now();
+}
+
+void State::skip(const char* reason)
+{
+	_skip_reason = reason;
+}
+
+Registration::Registration(const char* group, const char* name, BenchmarkFunc func)
+{
+	SCP_string full_name(group);
+	full_name += "/";
+	full_name += name;
+
+	get_registry().push_back({full_name, func});
+}
+
+int run_benchmarks(int argc, char** argv)
+{
+	run_options options;
+	if (!parse_options(argc, argv, options)) {
+		return 1;
+	}
+
+	auto benchmarks = get_registry();
+	std::sort(benchmarks.begin(), benchmarks.end(),
+		[](const registered_benchmark& lhs, const registered_benchmark& rhs) { return lhs.name < rhs.name; });
+
+	if (!options.filter.empty()) {
+		benchmarks.erase(std::remove_if(benchmarks.begin(), benchmarks.end(),
+							 [&options](const registered_benchmark& benchmark) {
+								 return benchmark.name.find(options.filter) == SCP_string::npos;
+							 }),
+			benchmarks.end());
+	}
+
+	if (options.list_only) {
+		for (const auto& benchmark : benchmarks) {
+			printf("%s\n", benchmark.name.c_str());
+		}
+		return 0;
+	}
+
+	printf("%-48s %14s %14s %12s\n", "Benchmark", "Time (ns)", "CPU (ns)", "Iterations");
+	printf("%s\n", SCP_string(92, '-').c_str());
+
+	SCP_vector<benchmark_result> results;
+	for (const auto& benchmark : benchmarks) {
+		results.push_back(run_benchmark(benchmark, options));
+		print_result(results.back());
+	}
+
+	if (!options.json_path.empty()) {
+		if (!write_json(results, options, argv[0])) {
+			fprintf(stderr, "Failed to write benchmark results to '%s'!\n", options.json_path.c_str());
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+namespace detail {
+void use_pointer(const volatile void*) {}
+} // namespace detail
+
+} // namespace bench
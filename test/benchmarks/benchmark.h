@@ -0,0 +1,135 @@
+#pragma once
+
+#include <globalincs/vmallocator.h>
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+
+/**
+ * @file
+ *
+ * A small microbenchmark harness for engine code paths.
+ *
+ * Benchmarks are plain functions registered with the BENCHMARK macro. The harness calls the function with a State
+ * object and the function runs the code to be measured inside a @c while(state.keep_running()) loop. Setup code before
+ * that loop is not timed. The harness calibrates the iteration count until a run takes at least the configured minimum
+ * time and then repeats the measurement a few times so the results include their spread.
+ *
+ * Benchmarks that use random input must use a fixed seed so that two runs of the suite measure the same work.
+ */
+
+namespace bench {
+
+class State {
+  public:
+	explicit State(uint64_t iterations);
+
+	/**
+	 * @brief Controls the timed loop of a benchmark
+	 *
+	 * The timer starts with the first call and stops when this returns false.
+	 *
+	 * @return @c true while there are iterations left to run
+	 */
+	bool keep_running()
+	{
+		if (_remaining > 0) {
+			if (!_started) {
+				start();
+			}
+			--_remaining;
+			return true;
+		}
+		stop();
+		return false;
+	}
+
+	/**
+	 * @brief Stops the timer until resume_timing() is called
+	 *
+	 * Used for per-iteration setup which should not be part of the measurement. Both calls have a cost of their own so
+	 * this should not be used in very short loops.
+	 */
+	void pause_timing();
+
+	void resume_timing();
+
+	/**
+	 * @brief Sets how many items the whole run processed
+	 *
+	 * When set the reports include an items per second rate.
+	 */
+	void set_items_processed(uint64_t items) { _items_processed = items; }
+
+	/**
+	 * @brief Marks this benchmark as skipped
+	 *
+	 * Used when the data a benchmark needs is not available. The benchmark must return without calling keep_running().
+	 */
+	void skip(const char* reason);
+
+	uint64_t iterations() const { return _iterations; }
+
+	bool skipped() const { return !_skip_reason.empty(); }
+	const SCP_string& skip_reason() const { return _skip_reason; }
+
+	double real_seconds() const { return _real_time.count(); }
+	double cpu_seconds() const { return _cpu_time; }
+	uint64_t items_processed() const { return _items_processed; }
+
+  private:
+	void start();
+	void stop();
+
+	uint64_t _iterations;
+	uint64_t _remaining;
+	uint64_t _items_processed = 0;
+
+	bool _started = false;
+	bool _running = false;
+
+	std::chrono::steady_clock::time_point _real_start;
+	std::clock_t _cpu_start = 0;
+
+	std::chrono::duration<double> _real_time{0.0};
+	double _cpu_time = 0.0;
+
+	SCP_string _skip_reason;
+};
+
+using BenchmarkFunc = void (*)(State&);
+
+struct Registration {
+	Registration(const char* group, const char* name, BenchmarkFunc func);
+};
+
+/**
+ * @brief Runs all registered benchmarks which match the command line filter
+ * @return The exit code of the benchmark executable
+ */
+int run_benchmarks(int argc, char** argv);
+
+namespace detail {
+void use_pointer(const volatile void* ptr);
+}
+
+/**
+ * @brief Keeps the compiler from optimizing away the computation of @c value
+ */
+template <typename T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	detail::use_pointer(&value);
+#endif
+}
+
+} // namespace bench
+
+#define BENCHMARK(group, name)                                                                                         \
+	static void bench_##group##_##name(bench::State& state);                                                           \
+	static const bench::Registration bench_##group##_##name##_registration(#group, #name, bench_##group##_##name);     \
+	static void bench_##group##_##name(bench::State& state)
@@ -0,0 +1,70 @@
+#include "benchmark.h"
+#include "environment.h"
+
+#include <cfile/cfile.h>
+
+namespace {
+
+// Loose files, files inside the VP, names with a different case and misses
+const char* const LOOKUP_NAMES[] = {
+	"dir.tbl",
+	"dir2.tbl",
+	"test.tbl",
+	"test2.tbl",
+	"DIR.TBL",
+	"Test2.tbl",
+	"missing.tbl",
+	"also_missing.tbm",
+};
+
+const size_t NUM_LOOKUP_NAMES = sizeof(LOOKUP_NAMES) / sizeof(LOOKUP_NAMES[0]);
+
+} // namespace
+
+BENCHMARK(cfile, find_file_location)
+{
+	bench::EngineEnvironment env(bench::INIT_CFILE, "cfile/list_files_in_vps_and_dirs");
+	if (!env.valid()) {
+		state.skip("CFile initialization failed");
+		return;
+	}
+
+	while (state.keep_running()) {
+		for (auto name : LOOKUP_NAMES) {
+			bench::do_not_optimize(cf_find_file_location(name, CF_TYPE_TABLES).found);
+		}
+	}
+	state.set_items_processed(state.iterations() * NUM_LOOKUP_NAMES);
+}
+
+BENCHMARK(cfile, exists_any_type)
+{
+	bench::EngineEnvironment env(bench::INIT_CFILE, "cfile/list_files_in_vps_and_dirs");
+	if (!env.valid()) {
+		state.skip("CFile initialization failed");
+		return;
+	}
+
+	while (state.keep_running()) {
+		for (auto name : LOOKUP_NAMES) {
+			bench::do_not_optimize(cf_exists_full(name, CF_TYPE_ANY));
+		}
+	}
+	state.set_items_processed(state.iterations() * NUM_LOOKUP_NAMES);
+}
+
+BENCHMARK(cfile, get_file_list)
+{
+	bench::EngineEnvironment env(bench::INIT_CFILE, "cfile/list_files_in_vps_and_dirs");
+	if (!env.valid()) {
+		state.skip("CFile initialization failed");
+		return;
+	}
+
+	SCP_vector<SCP_string> files;
+	while (state.keep_running()) {
+		files.clear();
+		bench::do_not_optimize(cf_get_file_list(files, CF_TYPE_TABLES, "*", CF_SORT_NAME));
+	}
+	state.set_items_processed(state.iterations());
+}
@@ -0,0 +1,144 @@
+#include "benchmark.h"
+
+#include <cmdline/cmdline.h>
+#include <ddsutils/ddsutils.h>
+#include <utils/threading.h>
+
+#include <random>
+
+namespace {
+
+struct synthetic_texture {
+	uint format;
+	uint size;
+	int faces;
+	SCP_vector<ubyte> data;
+	size_t decoded_size = 0;
+	uint64_t pixels = 0;
+};
+
+/**
+ * Random blocks for a square texture with a full mip chain. BC7 blocks use the modes typical encoders produce most.
+ */
+synthetic_texture build_texture(uint format, uint size, int faces, uint32_t seed)
+{
+	std::mt19937 rng(seed);
+
+	synthetic_texture tex;
+	tex.format = format;
+	tex.size   = size;
+	tex.faces  = faces;
+
+	const uint block_size = static_cast<uint>(dds_compressed_size(format, 4, 4, 1));
+
+	for (int f = 0; f < faces; ++f) {
+		for (uint s = size; s > 0; s >>= 1) {
+			auto begin = tex.data.size();
+			tex.data.resize(begin + dds_compressed_size(format, s, s, 1));
+			for (auto i = begin; i < tex.data.size(); ++i) {
+				tex.data[i] = static_cast<ubyte>(rng());
+			}
+
+			if (format == FOURCC_DX10) {
+				const int modes[] = {1, 5, 6, 6};
+				for (auto i = begin; i < tex.data.size(); i += block_size) {
+					auto mode = modes[rng() % 4];
+					tex.data[i] = static_cast<ubyte>((1 << mode) | (tex.data[i] & ~((2 << mode) - 1)));
+				}
+			}
+
+			tex.decoded_size += static_cast<size_t>(s) * s * 4;
+			tex.pixels += static_cast<uint64_t>(s) * s;
+		}
+	}
+
+	return tex;
+}
+
+void decode_texture(const synthetic_texture& tex, SCP_vector<ubyte>& out)
+{
+	const ubyte* src = tex.data.data();
+	ubyte* dst = out.data();
+
+	for (int f = 0; f < tex.faces; ++f) {
+		for (uint s = tex.size; s > 0; s >>= 1) {
+			dds_decompress(tex.format, src, s, s, 1, dst);
+			src += dds_compressed_size(tex.format, s, s, 1);
+			dst += static_cast<size_t>(s) * s * 4;
+		}
+	}
+}
+
+/**
+ * Starts the task pool with one thread per core for the lifetime of the object
+ */
+class task_pool_scope {
+  public:
+	task_pool_scope()
+	{
+		_old_threads = Cmdline_multithreading;
+		Cmdline_multithreading = 0;
+		threading::init_task_pool();
+	}
+	~task_pool_scope()
+	{
+		threading::shut_down_task_pool();
+		Cmdline_multithreading = _old_threads;
+	}
+
+  private:
+	int _old_threads;
+};
+
+void run_decode(bench::State& state, uint format, uint size, int faces)
+{
+	const auto tex = build_texture(format, size, faces, 1);
+	SCP_vector<ubyte> out(tex.decoded_size);
+
+	while (state.keep_running()) {
+		decode_texture(tex, out);
+		bench::do_not_optimize(out.front());
+	}
+	state.set_items_processed(state.iterations() * tex.pixels);
+}
+
+} // namespace
+
+BENCHMARK(ddsutils, decompress_bc7_4k)
+{
+	run_decode(state, FOURCC_DX10, 4096, 1);
+}
+
+BENCHMARK(ddsutils, decompress_bc7_4k_threaded)
+{
+	task_pool_scope pool;
+	run_decode(state, FOURCC_DX10, 4096, 1);
+}
+
+BENCHMARK(ddsutils, decompress_dxt5_4k)
+{
+	run_decode(state, FOURCC_DXT5, 4096, 1);
+}
+
+BENCHMARK(ddsutils, decompress_dxt5_4k_threaded)
+{
+	task_pool_scope pool;
+	run_decode(state, FOURCC_DXT5, 4096, 1);
+}
+
+BENCHMARK(ddsutils, decompress_dxt1_cubemap_1k)
+{
+	run_decode(state, FOURCC_DXT1, 1024, 6);
+}
+
+BENCHMARK(ddsutils, decompress_dxt1_cubemap_1k_threaded)
+{
+	task_pool_scope pool;
+	run_decode(state, FOURCC_DXT1, 1024, 6);
+}
+
+BENCHMARK(ddsutils, decompress_bc7_cubemap_1k_threaded)
+{
+	task_pool_scope pool;
+	run_decode(state, FOURCC_DX10, 1024, 6);
+}
@@ -0,0 +1,92 @@
+#include "environment.h"
+
+#include <bmpman/bmpman.h>
+#include <cfile/cfile.h>
+#include <cmdline/cmdline.h>
+#include <graphics/2d.h>
+#include <io/cursor.h>
+#include <io/timer.h>
+#include <localization/localize.h>
+#include <mod_table/mod_table.h>
+#include <osapi/osapi.h>
+
+#include <memory>
+
+namespace bench {
+
+EngineEnvironment::EngineEnvironment(uint64_t init_flags, const char* mod_dir) : _initFlags(init_flags)
+{
+	SCP_vector<SCP_string> args{"-parse_cmdline_only", "-standalone", "-portable_mode"};
+	if (mod_dir != nullptr) {
+		args.emplace_back("-mod");
+		args.emplace_back(mod_dir);
+	}
+
+	std::unique_ptr<char* []> parts(new char* [args.size()]);
+	for (size_t i = 0; i < args.size(); ++i) {
+		parts[i] = const_cast<char*>(args[i].c_str());
+	}
+	parse_cmdline((int) args.size(), parts.get());
+
+	timer_init();
+
+	os_init("Benchmark", "Benchmark");
+
+	if (_initFlags & INIT_CFILE) {
+		SCP_string cfile_dir(TEST_DATA_PATH);
+		cfile_dir += DIR_SEPARATOR_CHAR;
+		cfile_dir += "test"; // Cfile expects something after the path
+
+		if (cfile_init(cfile_dir.c_str())) {
+			_initFlags &= ~(INIT_CFILE | INIT_MOD_TABLE | INIT_GRAPHICS);
+			_valid = false;
+			return;
+		}
+
+		lcl_init(-1);
+		lcl_xstr_init();
+
+		if (_initFlags & INIT_MOD_TABLE) {
+			mod_table_init(); // load in all the mod dependent settings
+		}
+
+		if (_initFlags & INIT_GRAPHICS) {
+			if (!gr_init(nullptr, GR_STUB, 1024, 768)) {
+				_initFlags &= ~INIT_GRAPHICS;
+				_valid = false;
+			}
+		}
+	}
+}
+
+EngineEnvironment::~EngineEnvironment()
+{
+	if (_initFlags & INIT_CFILE) {
+		if (_initFlags & INIT_GRAPHICS) {
+			io::mouse::CursorManager::shutdown();
+
+			bm_unload_all();
+
+			gr_close();
+		}
+
+		if (_initFlags & INIT_MOD_TABLE) {
+			mod_table_reset();
+		}
+
+		cfile_close();
+	}
+
+	timer_close();
+
+	lcl_close();
+
+	os_cleanup();
+
+	if (Cmdline_mod != nullptr) {
+		delete[] Cmdline_mod;
+		Cmdline_mod = nullptr;
+	}
+}
+
+} // namespace bench
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <globalincs/vmallocator.h>
+
+#include <cstdint>
+
+namespace bench {
+
+enum InitFlags {
+	INIT_NONE = 0,
+	INIT_CFILE = 1 << 0,
+	INIT_MOD_TABLE = 1 << 1,
+	INIT_GRAPHICS = 1 << 2,
+};
+
+/**
+ * @brief Brings up the engine subsystems a benchmark depends on and shuts them down again when destroyed
+ *
+ * This mirrors the unit test fixture so that benchmarks run against the same data directory as the tests. Construct
+ * it before the timed loop of a benchmark.
+ */
+class EngineEnvironment {
+  public:
+	explicit EngineEnvironment(uint64_t init_flags = INIT_CFILE, const char* mod_dir = nullptr);
+	~EngineEnvironment();
+
+	EngineEnvironment(const EngineEnvironment&) = delete;
+	EngineEnvironment& operator=(const EngineEnvironment&) = delete;
+
+	/**
+	 * @return @c false if initializing one of the requested subsystems failed
+	 */
+	bool valid() const { return _valid; }
+
+  private:
+	uint64_t _initFlags;
+	bool _valid = true;
+};
+
+} // namespace bench
@@ -0,0 +1,82 @@
+#include "benchmark.h"
+
+#include <lighting/lighting.h>
+#include <math/vecmat.h>
+
+#include <random>
+
+namespace {
+
+const int NUM_LIGHTS  = 3000;
+const int NUM_QUERIES = 1024;
+
+vec3d random_vec(std::mt19937& rng, float range)
+{
+	std::uniform_real_distribution<float> dist(-range, range);
+
+	vec3d v;
+	v.xyz.x = dist(rng);
+	v.xyz.y = dist(rng);
+	v.xyz.z = dist(rng);
+	return v;
+}
+
+/**
+ * A scene like a large battle: mostly small weapon and explosion lights spread over a big volume plus a few large ones
+ */
+void build_scene(scene_lights& scene, std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> radius_dist(10.0f, 400.0f);
+	std::uniform_int_distribution<int> type_dist(1, 3);
+
+	for (int i = 0; i < NUM_LIGHTS; ++i) {
+		light l;
+		memset(&l, 0, sizeof(l));
+
+		l.type = static_cast<Light_Type>(type_dist(rng));
+		l.vec  = random_vec(rng, 10000.0f);
+		if (l.type == Light_Type::Tube) {
+			l.vec2 = l.vec + random_vec(rng, 500.0f);
+		} else {
+			l.vec2 = random_vec(rng, 1.0f);
+			vm_vec_normalize_safe(&l.vec2);
+		}
+
+		l.radb             = (i % 500 == 0) ? 20000.0f : radius_dist(rng);
+		l.radb_squared     = l.radb * l.radb;
+		l.rada             = l.radb * 0.5f;
+		l.rada_squared     = l.rada * l.rada;
+		l.cone_angle       = 0.7f;
+		l.cone_inner_angle = 0.8f;
+		l.intensity        = 1.0f;
+		l.flags            = LF_DEFAULT;
+		l.sun_index        = -1;
+
+		scene.addLight(&l);
+	}
+}
+
+} // namespace
+
+BENCHMARK(lighting, filter_lights)
+{
+	std::mt19937 rng(1);
+
+	scene_lights scene;
+	build_scene(scene, rng);
+
+	std::uniform_real_distribution<float> radius_dist(5.0f, 100.0f);
+	SCP_vector<std::pair<vec3d, float>> queries;
+	for (int i = 0; i < NUM_QUERIES; ++i) {
+		// Mostly fighter sized objects with the occasional capital ship
+		queries.emplace_back(random_vec(rng, 11000.0f), (i % 50 == 0) ? 5000.0f : radius_dist(rng));
+	}
+
+	size_t i = 0;
+	while (state.keep_running()) {
+		scene.setLightFilter(&queries[i].first, queries[i].second);
+		bench::do_not_optimize(scene.getNumFilteredLights());
+		i = (i + 1) % queries.size();
+	}
+	state.set_items_processed(state.iterations());
+}
@@ -0,0 +1,15 @@
+#include "benchmark.h"
+
+#include <windows_stub/config.h>
+
+#ifdef main
+#undef main
+#endif
+
+int main(int argc, char** argv)
+{
+	// Always change to the test data directory so mod directories resolve the same way as in the unit tests
+	_chdir(TEST_DATA_PATH);
+
+	return bench::run_benchmarks(argc, argv);
+}
@@ -0,0 +1,167 @@
+#include "benchmark.h"
+
+#include <math/fvi.h>
+#include <math/vecmat.h>
+
+#include <random>
+
+namespace {
+
+const size_t NUM_QUERIES = 1024;
+
+struct segment {
+	vec3d p0;
+	vec3d p1;
+};
+
+/**
+ * Random segments which start outside a sphere of radius 100 around the origin and point roughly at it, so a good
+ * part of the queries hit and the rest take the miss paths.
+ */
+SCP_vector<segment> random_segments(uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> dir_dist(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> offset_dist(-150.0f, 150.0f);
+
+	SCP_vector<segment> segments(NUM_QUERIES);
+	for (auto& seg : segments) {
+		vec3d dir;
+		dir.xyz.x = dir_dist(rng);
+		dir.xyz.y = dir_dist(rng);
+		dir.xyz.z = dir_dist(rng);
+		vm_vec_normalize_safe(&dir);
+
+		vec3d offset;
+		offset.xyz.x = offset_dist(rng);
+		offset.xyz.y = offset_dist(rng);
+		offset.xyz.z = offset_dist(rng);
+
+		vm_vec_scale_add(&seg.p0, &offset, &dir, -400.0f);
+		vm_vec_scale_add(&seg.p1, &offset, &dir, 400.0f);
+	}
+	return segments;
+}
+
+const vec3d sphere_pos = vmd_zero_vector;
+const float sphere_rad = 100.0f;
+
+} // namespace
+
+BENCHMARK(fvi, segment_sphere)
+{
+	const auto segments = random_segments(1);
+
+	size_t i = 0;
+	vec3d hit;
+	while (state.keep_running()) {
+		bench::do_not_optimize(fvi_segment_sphere(&hit, &segments[i].p0, &segments[i].p1, &sphere_pos, sphere_rad));
+		i = (i + 1) % NUM_QUERIES;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+BENCHMARK(fvi, ray_sphere)
+{
+	const auto segments = random_segments(2);
+
+	size_t i = 0;
+	vec3d hit;
+	while (state.keep_running()) {
+		bench::do_not_optimize(fvi_ray_sphere(&hit, &segments[i].p0, &segments[i].p1, &sphere_pos, sphere_rad));
+		i = (i + 1) % NUM_QUERIES;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+BENCHMARK(fvi, ray_boundingbox)
+{
+	const auto segments = random_segments(3);
+
+	SCP_vector<vec3d> directions(NUM_QUERIES);
+	for (size_t i = 0; i < NUM_QUERIES; ++i) {
+		vm_vec_sub(&directions[i], &segments[i].p1, &segments[i].p0);
+	}
+
+	const vec3d box_min{{{-80.0f, -40.0f, -120.0f}}};
+	const vec3d box_max{{{80.0f, 40.0f, 120.0f}}};
+
+	size_t i = 0;
+	vec3d hit;
+	while (state.keep_running()) {
+		bench::do_not_optimize(fvi_ray_boundingbox(&box_min, &box_max, &segments[i].p0, &directions[i], &hit));
+		i = (i + 1) % NUM_QUERIES;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+BENCHMARK(fvi, ray_plane)
+{
+	const auto segments = random_segments(4);
+
+	SCP_vector<vec3d> directions(NUM_QUERIES);
+	for (size_t i = 0; i < NUM_QUERIES; ++i) {
+		vm_vec_sub(&directions[i], &segments[i].p1, &segments[i].p0);
+	}
+
+	vec3d plane_norm{{{0.3f, 0.9f, -0.2f}}};
+	vm_vec_normalize(&plane_norm);
+
+	size_t i = 0;
+	vec3d hit;
+	while (state.keep_running()) {
+		bench::do_not_optimize(fvi_ray_plane(&hit, &sphere_pos, &plane_norm, &segments[i].p0, &directions[i], 0.0f));
+		i = (i + 1) % NUM_QUERIES;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+BENCHMARK(fvi, point_face)
+{
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> dist(-60.0f, 60.0f);
+
+	// A quad in the xy plane with points scattered around it
+	vec3d quad[4] = {{{{-50.0f, -50.0f, 0.0f}}}, {{{50.0f, -50.0f, 0.0f}}}, {{{50.0f, 50.0f, 0.0f}}}, {{{-50.0f, 50.0f, 0.0f}}}};
+	const vec3d* verts[4] = {&quad[0], &quad[1], &quad[2], &quad[3]};
+	const uv_pair uvs[4] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+	const vec3d norm = vmd_z_vector;
+
+	SCP_vector<vec3d> points(NUM_QUERIES);
+	for (auto& p : points) {
+		p.xyz.x = dist(rng);
+		p.xyz.y = dist(rng);
+		p.xyz.z = 0.0f;
+	}
+
+	size_t i = 0;
+	float u, v;
+	while (state.keep_running()) {
+		bench::do_not_optimize(fvi_point_face(&points[i], 4, verts, &norm, &u, &v, uvs));
+		i = (i + 1) % NUM_QUERIES;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+BENCHMARK(fvi, polyedge_sphereline)
+{
+	const auto segments = random_segments(6);
+
+	vec3d tri[3] = {{{{-100.0f, -80.0f, 0.0f}}}, {{{100.0f, -80.0f, 0.0f}}}, {{{0.0f, 100.0f, 0.0f}}}};
+	const vec3d* verts[3] = {&tri[0], &tri[1], &tri[2]};
+
+	SCP_vector<vec3d> velocities(NUM_QUERIES);
+	for (size_t i = 0; i < NUM_QUERIES; ++i) {
+		vm_vec_sub(&velocities[i], &segments[i].p1, &segments[i].p0);
+	}
+
+	size_t i = 0;
+	vec3d hit;
+	float hit_time;
+	while (state.keep_running()) {
+		bench::do_not_optimize(
+			fvi_polyedge_sphereline(&hit, &segments[i].p0, &velocities[i], 10.0f, 3, verts, &hit_time));
+		i = (i + 1) % NUM_QUERIES;
+	}
+	state.set_items_processed(state.iterations());
+}
@@ -0,0 +1,163 @@
+#include "benchmark.h"
+
+#include <math/vecmat.h>
+
+#include <random>
+
+namespace {
+
+const size_t NUM_VALUES = 1024;
+
+SCP_vector<vec3d> random_vectors(uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> dist(-1000.0f, 1000.0f);
+
+	SCP_vector<vec3d> vectors(NUM_VALUES);
+	for (auto& v : vectors) {
+		v.xyz.x = dist(rng);
+		v.xyz.y = dist(rng);
+		v.xyz.z = dist(rng);
+	}
+	return vectors;
+}
+
+SCP_vector<matrix> random_matrices(uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> dist(-PI, PI);
+
+	SCP_vector<matrix> matrices(NUM_VALUES);
+	for (auto& m : matrices) {
+		angles a;
+		a.p = dist(rng);
+		a.b = dist(rng);
+		a.h = dist(rng);
+		vm_angles_2_matrix(&m, &a);
+	}
+	return matrices;
+}
+
+} // namespace
+
+BENCHMARK(vecmat, vec_normalize)
+{
+	const auto source = random_vectors(1);
+	auto vectors = source;
+
+	size_t i = 0;
+	while (state.keep_running()) {
+		auto& v = vectors[i];
+		v = source[i];
+		bench::do_not_optimize(vm_vec_normalize(&v));
+		i = (i + 1) % NUM_VALUES;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+BENCHMARK(vecmat, vec_rotate)
+{
+	const auto vectors = random_vectors(2);
+	const auto matrices = random_matrices(3);
+
+	size_t i = 0;
+	vec3d out;
+	while (state.keep_running()) {
+		vm_vec_rotate(&out, &vectors[i], &matrices[i]);
+		bench::do_not_optimize(out);
+		i = (i + 1) % NUM_VALUES;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+BENCHMARK(vecmat, vec_unrotate)
+{
+	const auto vectors = random_vectors(4);
+	const auto matrices = random_matrices(5);
+
+	size_t i = 0;
+	vec3d out;
+	while (state.keep_running()) {
+		vm_vec_unrotate(&out, &vectors[i], &matrices[i]);
+		bench::do_not_optimize(out);
+		i = (i + 1) % NUM_VALUES;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+BENCHMARK(vecmat, matrix_x_matrix)
+{
+	const auto lhs = random_matrices(6);
+	const auto rhs = random_matrices(7);
+
+	size_t i = 0;
+	matrix out;
+	while (state.keep_running()) {
+		vm_matrix_x_matrix(&out, &lhs[i], &rhs[i]);
+		bench::do_not_optimize(out);
+		i = (i + 1) % NUM_VALUES;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+BENCHMARK(vecmat, vector_2_matrix)
+{
+	const auto vectors = random_vectors(8);
+
+	size_t i = 0;
+	matrix out;
+	while (state.keep_running()) {
+		vm_vector_2_matrix(&out, &vectors[i]);
+		bench::do_not_optimize(out);
+		i = (i + 1) % NUM_VALUES;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+BENCHMARK(vecmat, angles_2_matrix)
+{
+	std::mt19937 rng(9);
+	std::uniform_real_distribution<float> dist(-PI, PI);
+
+	SCP_vector<angles> input(NUM_VALUES);
+	for (auto& a : input) {
+		a.p = dist(rng);
+		a.b = dist(rng);
+		a.h = dist(rng);
+	}
+
+	size_t i = 0;
+	matrix out;
+	while (state.keep_running()) {
+		vm_angles_2_matrix(&out, &input[i]);
+		bench::do_not_optimize(out);
+		i = (i + 1) % NUM_VALUES;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+BENCHMARK(vecmat, orthogonalize_matrix)
+{
+	const auto source = random_matrices(10);
+
+	// Disturb the matrices a little so the orthogonalization has work to do
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float> dist(-0.05f, 0.05f);
+
+	auto disturbed = source;
+	for (auto& m : disturbed) {
+		for (auto& value : m.a1d) {
+			value += dist(rng);
+		}
+	}
+
+	size_t i = 0;
+	matrix m;
+	while (state.keep_running()) {
+		m = disturbed[i];
+		vm_orthogonalize_matrix(&m);
+		bench::do_not_optimize(m);
+		i = (i + 1) % NUM_VALUES;
+	}
+	state.set_items_processed(state.iterations());
+}
@@ -0,0 +1,106 @@
+#include "benchmark.h"
+#include "environment.h"
+
+#include <cfile/cfile.h>
+#include <model/model.h>
+
+#include <random>
+
+namespace {
+
+// The retail models can't be redistributed, so test_data/benchmarks/data/models contains a generated hull instead: an
+// ellipsoid of 960 triangles (80 x 50 x 240) with a median split BSP tree of four triangles per leaf. Its texture is
+// invisible and the submodel has $collide_invisible so the benchmark doesn't need any texture files. The file is written
+// by tools/make_benchmark_pof.py and the build checks that it still matches that script.
+const char* const BENCHMARK_MODEL = "benchmark.pof";
+
+const size_t NUM_QUERIES = 1024;
+
+struct model_query {
+	vec3d p0;
+	vec3d p1;
+};
+
+SCP_vector<model_query> random_queries(const polymodel* pm, uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> dir_dist(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> offset_dist(-0.5f, 0.5f);
+
+	SCP_vector<model_query> queries(NUM_QUERIES);
+	for (auto& query : queries) {
+		vec3d dir;
+		dir.xyz.x = dir_dist(rng);
+		dir.xyz.y = dir_dist(rng);
+		dir.xyz.z = dir_dist(rng);
+		vm_vec_normalize_safe(&dir);
+
+		// Aim at points inside the model bounding box so most segments pass through the hull
+		vec3d target;
+		for (int axis = 0; axis < 3; ++axis) {
+			auto center = (pm->mins.a1d[axis] + pm->maxs.a1d[axis]) * 0.5f;
+			auto extent = pm->maxs.a1d[axis] - pm->mins.a1d[axis];
+			target.a1d[axis] = center + extent * offset_dist(rng);
+		}
+
+		vm_vec_scale_add(&query.p0, &target, &dir, -2.0f * pm->rad);
+		vm_vec_scale_add(&query.p1, &target, &dir, 2.0f * pm->rad);
+	}
+	return queries;
+}
+
+void run_model_collide(bench::State& state, int flags, float radius)
+{
+	bench::EngineEnvironment env(bench::INIT_CFILE | bench::INIT_GRAPHICS, "benchmarks");
+	if (!env.valid()) {
+		state.skip("Engine initialization failed");
+		return;
+	}
+
+	if (!cf_exists_full(BENCHMARK_MODEL, CF_TYPE_MODELS)) {
+		state.skip("No benchmark.pof in test_data/benchmarks/data/models");
+		return;
+	}
+
+	model_init();
+
+	auto model_num = model_load(BENCHMARK_MODEL, nullptr, ErrorType::WARNING);
+	if (model_num < 0) {
+		state.skip("benchmark.pof could not be loaded");
+		model_free_all();
+		return;
+	}
+
+	const auto queries = random_queries(model_get(model_num), 1);
+	const vec3d pos = vmd_zero_vector;
+
+	size_t i = 0;
+	while (state.keep_running()) {
+		mc_info mc;
+		mc.model_num = model_num;
+		mc.orient = &vmd_identity_matrix;
+		mc.pos = &pos;
+		mc.p0 = &queries[i].p0;
+		mc.p1 = &queries[i].p1;
+		mc.flags = flags;
+		mc.radius = radius;
+
+		bench::do_not_optimize(model_collide(&mc));
+		i = (i + 1) % NUM_QUERIES;
+	}
+	state.set_items_processed(state.iterations());
+
+	model_free_all();
+}
+
+} // namespace
+
+BENCHMARK(model, collide_segment)
+{
+	run_model_collide(state, MC_CHECK_MODEL, 0.0f);
+}
+
+BENCHMARK(model, collide_sphereline)
+{
+	run_model_collide(state, MC_CHECK_MODEL | MC_CHECK_SPHERELINE, 5.0f);
+}
@@ -0,0 +1,81 @@
+#include "benchmark.h"
+
+#include <globalincs/systemvars.h>
+#include <object/objcollide.h>
+#include <object/object.h>
+
+#include <random>
+
+namespace {
+
+const int NUM_COLLIDERS = 1500;
+
+// Half the edge length of the cube the objects are scattered in
+const float FIELD_EXTENT = 3000.0f;
+
+} // namespace
+
+/**
+ * Runs the sort and sweep broadphase of the collision system over a field of debris.
+ *
+ * Debris never collides with other debris so this measures the axis sorts and the overlap sweeps plus the rejection
+ * checks of every candidate pair without any narrow phase work. Objects are moved a little between iterations like
+ * they would be between frames.
+ */
+BENCHMARK(object, sort_and_collide)
+{
+	auto old_detail_flags = Game_detail_flags;
+	Game_detail_flags |= DETAIL_FLAG_COLLISION;
+
+	obj_init();
+
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> pos_dist(-FIELD_EXTENT, FIELD_EXTENT);
+	std::uniform_real_distribution<float> radius_dist(5.0f, 60.0f);
+	std::uniform_real_distribution<float> vel_dist(-20.0f, 20.0f);
+
+	flagset<Object::Object_Flags> flags;
+	flags.set(Object::Object_Flags::Collides);
+
+	SCP_vector<int> objnums;
+	SCP_vector<vec3d> velocities;
+	for (int i = 0; i < NUM_COLLIDERS; ++i) {
+		vec3d pos;
+		pos.xyz.x = pos_dist(rng);
+		pos.xyz.y = pos_dist(rng);
+		pos.xyz.z = pos_dist(rng);
+
+		auto objnum = obj_create(OBJ_DEBRIS, -1, -1, &vmd_identity_matrix, &pos, radius_dist(rng), flags);
+		if (objnum < 0) {
+			break;
+		}
+		obj_add_collider(objnum);
+
+		objnums.push_back(objnum);
+
+		vec3d vel;
+		vel.xyz.x = vel_dist(rng);
+		vel.xyz.y = vel_dist(rng);
+		vel.xyz.z = vel_dist(rng);
+		velocities.push_back(vel);
+	}
+
+	while (state.keep_running()) {
+		obj_sort_and_collide();
+
+		state.pause_timing();
+		for (size_t i = 0; i < objnums.size(); ++i) {
+			auto objp = &Objects[objnums[i]];
+			objp->last_pos = objp->pos;
+			vm_vec_add2(&objp->pos, &velocities[i]);
+		}
+		state.resume_timing();
+	}
+	state.set_items_processed(state.iterations() * objnums.size());
+
+	// Reinitializing drops the objects without going through the type specific deletion code since there is no debris
+	// instance behind them
+	obj_init();
+
+	Game_detail_flags = old_detail_flags;
+}
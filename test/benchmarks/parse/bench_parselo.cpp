@@ -0,0 +1,122 @@
+#include "benchmark.h"
+#include "environment.h"
+
+#include <def_files/def_files.h>
+#include <parse/parselo.h>
+
+#include <random>
+
+namespace {
+
+const int NUM_ENTRIES = 500;
+
+/**
+ * Builds a table in the style of the weapon and ship tables with comments, optional fields and lists.
+ */
+SCP_string build_table(uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> float_dist(-1000.0f, 1000.0f);
+	std::uniform_int_distribution<int> int_dist(0, 100000);
+
+	SCP_string text = "; Synthetic table for the parser benchmarks\n#Entries\n\n";
+	for (int i = 0; i < NUM_ENTRIES; ++i) {
+		text += "$Name: Entry " + std::to_string(i) + "\n";
+		text += "$Mass: " + std::to_string(float_dist(rng)) + "\t; kilograms\n";
+		text += "$Count: " + std::to_string(int_dist(rng)) + "\n";
+		text += "$Offset: " + std::to_string(float_dist(rng)) + ", " + std::to_string(float_dist(rng)) + ", " +
+		        std::to_string(float_dist(rng)) + "\n";
+		if (i % 3 == 0) {
+			text += "/* An optional field\n   inside a block comment */\n";
+			text += "+Optional: " + std::to_string(float_dist(rng)) + "\n";
+		}
+		text += "$Flags: ( \"first flag\" \"second flag\" \"flag " + std::to_string(i) + "\" )\n";
+		text += "$Description:\nThe description of entry " + std::to_string(i) + "\nspans two lines.\n$end_multi_text\n\n";
+	}
+	text += "#End\n";
+
+	return text;
+}
+
+default_file make_default_file(const SCP_string& text)
+{
+	default_file file;
+	file.filename = "benchmark.tbl";
+	file.data = text.c_str();
+	file.size = text.size();
+	return file;
+}
+
+void parse_table()
+{
+	required_string("#Entries");
+
+	SCP_string name;
+	SCP_vector<SCP_string> flags;
+	SCP_string description;
+
+	while (optional_string("$Name:")) {
+		stuff_string(name, F_NAME);
+
+		float mass;
+		required_string("$Mass:");
+		stuff_float(&mass);
+
+		int count;
+		required_string("$Count:");
+		stuff_int(&count);
+
+		vec3d offset;
+		required_string("$Offset:");
+		stuff_vec3d(&offset);
+
+		float optional = 0.0f;
+		if (optional_string("+Optional:")) {
+			stuff_float(&optional);
+		}
+
+		flags.clear();
+		required_string("$Flags:");
+		stuff_string_list(flags);
+
+		required_string("$Description:");
+		stuff_string(description, F_MULTITEXT);
+
+		bench::do_not_optimize(mass + optional + offset.xyz.x + count);
+	}
+
+	required_string("#End");
+}
+
+} // namespace
+
+BENCHMARK(parselo, process_file_text)
+{
+	bench::EngineEnvironment env(bench::INIT_CFILE);
+
+	const auto text = build_table(1);
+	const auto file = make_default_file(text);
+
+	while (state.keep_running()) {
+		read_file_text_from_default(file);
+	}
+	state.set_items_processed(state.iterations() * NUM_ENTRIES);
+
+	stop_parse();
+}
+
+BENCHMARK(parselo, parse_table)
+{
+	bench::EngineEnvironment env(bench::INIT_CFILE);
+
+	const auto text = build_table(2);
+	read_file_text_from_default(make_default_file(text));
+
+	while (state.keep_running()) {
+		reset_parse();
+		parse_table();
+	}
+	state.set_items_processed(state.iterations() * NUM_ENTRIES);
+
+	stop_parse();
+}
@@ -0,0 +1,132 @@
+#include "benchmark.h"
+#include "environment.h"
+
+#include <parse/parselo.h>
+#include <parse/sexp.h>
+
+#include <random>
+
+namespace {
+
+const int NUM_EVENTS = 200;
+
+/**
+ * Builds the text of random arithmetic and boolean sexps like the conditions of mission events.
+ */
+class synthetic_event_builder {
+  public:
+	explicit synthetic_event_builder(uint32_t seed) : _rng(seed) {}
+
+	SCP_string boolean_expression(int depth)
+	{
+		static const char* const LOGIC_OPS[]      = {"and", "or", "xor"};
+		static const char* const COMPARISON_OPS[] = {"<", ">", "=", ">=", "<="};
+
+		auto choice = pick(4);
+		if (depth <= 0 || choice == 0) {
+			return "( " + SCP_string(COMPARISON_OPS[pick(5)]) + " " + number_expression(depth - 1) + " " +
+			       number_expression(depth - 1) + " )";
+		}
+		if (choice == 1) {
+			return "( not " + boolean_expression(depth - 1) + " )";
+		}
+
+		SCP_string text = "( " + SCP_string(LOGIC_OPS[pick(3)]);
+		auto num_args = 2 + pick(2);
+		for (int i = 0; i < num_args; ++i) {
+			text += " " + boolean_expression(depth - 1);
+		}
+		return text + " )";
+	}
+
+	SCP_string number_expression(int depth)
+	{
+		static const char* const ARITHMETIC_OPS[] = {"+", "-", "*", "min", "max"};
+
+		auto choice = pick(4);
+		if (depth <= 0 || choice == 0) {
+			return std::to_string(pick(100));
+		}
+		if (choice == 1) {
+			// The divisor is a literal so it can never be zero
+			return "( mod " + number_expression(depth - 1) + " " + std::to_string(1 + pick(50)) + " )";
+		}
+
+		return "( " + SCP_string(ARITHMETIC_OPS[pick(5)]) + " " + number_expression(depth - 1) + " " +
+		       number_expression(depth - 1) + " )";
+	}
+
+  private:
+	int pick(int count) { return std::uniform_int_distribution<int>(0, count - 1)(_rng); }
+
+	std::mt19937 _rng;
+};
+
+SCP_vector<SCP_string> build_events(uint32_t seed)
+{
+	synthetic_event_builder builder(seed);
+
+	SCP_vector<SCP_string> events;
+	for (int i = 0; i < NUM_EVENTS; ++i) {
+		events.push_back(builder.boolean_expression(4));
+	}
+	return events;
+}
+
+int parse_event(SCP_string& text)
+{
+	Mp = &text[0];
+	return get_sexp_main();
+}
+
+} // namespace
+
+BENCHMARK(sexp, parse_events)
+{
+	bench::EngineEnvironment env(bench::INIT_CFILE | bench::INIT_MOD_TABLE);
+	sexp_startup();
+
+	const auto events = build_events(1);
+	auto texts = events;
+
+	init_sexp();
+	while (state.keep_running()) {
+		for (auto& text : texts) {
+			bench::do_not_optimize(parse_event(text));
+		}
+
+		// Start every iteration with an empty node list
+		state.pause_timing();
+		init_sexp();
+		state.resume_timing();
+	}
+	state.set_items_processed(state.iterations() * events.size());
+
+	sexp_shutdown();
+}
+
+BENCHMARK(sexp, eval_events)
+{
+	bench::EngineEnvironment env(bench::INIT_CFILE | bench::INIT_MOD_TABLE);
+	sexp_startup();
+	init_sexp();
+
+	auto texts = build_events(2);
+
+	SCP_vector<int> nodes;
+	for (auto& text : texts) {
+		auto node = parse_event(text);
+		if (node >= 0) {
+			nodes.push_back(node);
+		}
+	}
+
+	while (state.keep_running()) {
+		for (auto node : nodes) {
+			bench::do_not_optimize(eval_sexp(node));
+		}
+	}
+	state.set_items_processed(state.iterations() * nodes.size());
+
+	sexp_shutdown();
+}
@@ -0,0 +1,45 @@
+
+set(source_files)
+
+add_file_folder(""
+    benchmark.cpp
+    benchmark.h
+    environment.cpp
+    environment.h
+    main.cpp
+    ../src/test_stubs.cpp
+)
+
+add_file_folder("CFile"
+    cfile/bench_cfile.cpp
+)
+
+add_file_folder("DDSUtils"
+    ddsutils/bench_dds_decompress.cpp
+)
+
+add_file_folder("Lighting"
+    lighting/bench_light_filter.cpp
+)
+
+add_file_folder("Math"
+    math/bench_fvi.cpp
+    math/bench_vecmat.cpp
+)
+
+add_file_folder("Model"
+    model/bench_modelcollide.cpp
+)
+
+add_file_folder("Object"
+    object/bench_objcollide.cpp
+)
+
+add_file_folder("Parse"
+    parse/bench_parselo.cpp
+    parse/bench_sexp.cpp
+)
+
+add_file_folder("Utils"
+    utils/bench_radix_sort.cpp
+)
@@ -0,0 +1,292 @@
+#!/usr/bin/env python3
+"""Generates test_data/benchmarks/data/models/benchmark.pof for the model_collide benchmarks.
+
+The retail models can't be redistributed, so the benchmarks use an ellipsoid hull instead. The model has a single
+submodel with a median split BSP tree (SORTNORM nodes down to BOUNDBOX leaves of at most LEAF_TRIANGLES TMAPPOLYs).
+Its only texture is "invisible" and the submodel is named $collide_invisible, so no texture files are needed.
+
+Usage:
+    make_benchmark_pof.py [output]      write the model, by default over the committed file
+    make_benchmark_pof.py --check       fail if the committed file differs from what this script generates
+"""
+
+import argparse
+import math
+import os
+import struct
+import sys
+
+DEFAULT_OUTPUT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "test_data", "benchmarks",
+                              "data", "models", "benchmark.pof")
+
+# Shape of the hull: SEGMENTS vertices around each of RINGS - 1 rings plus the two poles
+SEGMENTS = 32
+RINGS = 16
+RADIUS_X, RADIUS_Y, RADIUS_Z = 40.0, 25.0, 120.0
+
+LEAF_TRIANGLES = 4
+
+POF_VERSION = 2117
+
+# BSP chunk ids, see modelread.cpp
+OP_EOF = 0
+OP_DEFPOINTS = 1
+OP_TMAPPOLY = 3
+OP_SORTNORM = 4
+OP_BOUNDBOX = 5
+
+SORTNORM_SIZE = 80
+
+
+def pack_vec(v):
+    return struct.pack("<3f", *v)
+
+
+def sub(a, b):
+    return (a[0] - b[0], a[1] - b[1], a[2] - b[2])
+
+
+def cross(a, b):
+    return (a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0])
+
+
+def normalize(a):
+    length = math.sqrt(a[0] ** 2 + a[1] ** 2 + a[2] ** 2)
+    return (a[0] / length, a[1] / length, a[2] / length)
+
+
+def make_ellipsoid():
+    verts = [(0.0, 0.0, RADIUS_Z)]
+    normals = [(0.0, 0.0, 1.0)]
+    for r in range(1, RINGS):
+        theta = math.pi * r / RINGS
+        for s in range(SEGMENTS):
+            phi = 2 * math.pi * s / SEGMENTS
+            p = (RADIUS_X * math.sin(theta) * math.cos(phi), RADIUS_Y * math.sin(theta) * math.sin(phi),
+                 RADIUS_Z * math.cos(theta))
+            verts.append(p)
+            normals.append(normalize((p[0] / RADIUS_X ** 2, p[1] / RADIUS_Y ** 2, p[2] / RADIUS_Z ** 2)))
+    verts.append((0.0, 0.0, -RADIUS_Z))
+    normals.append((0.0, 0.0, -1.0))
+
+    north = 0
+    south = len(verts) - 1
+
+    def ring(r, s):
+        return 1 + (r - 1) * SEGMENTS + (s % SEGMENTS)
+
+    tris = []
+    for s in range(SEGMENTS):
+        tris.append((north, ring(1, s + 1), ring(1, s)))
+        tris.append((south, ring(RINGS - 1, s), ring(RINGS - 1, s + 1)))
+    for r in range(1, RINGS - 1):
+        for s in range(SEGMENTS):
+            a, b, c, d = ring(r, s), ring(r, s + 1), ring(r + 1, s + 1), ring(r + 1, s)
+            tris.append((a, b, c))
+            tris.append((a, c, d))
+
+    return verts, normals, tris
+
+
+class BspWriter:
+    def __init__(self, verts, normals):
+        self.verts = verts
+        self.normals = normals
+
+    def center(self, tri):
+        return tuple(sum(self.verts[i][k] for i in tri) / 3 for k in range(3))
+
+    def bbox(self, tris):
+        points = [self.verts[i] for tri in tris for i in tri]
+        return (tuple(min(p[k] for p in points) for k in range(3)),
+                tuple(max(p[k] for p in points) for k in range(3)))
+
+    def face_normal(self, tri):
+        p0, p1, p2 = (self.verts[i] for i in tri)
+        n = normalize(cross(sub(p1, p0), sub(p2, p1)))
+
+        # make it point away from the center of the ellipsoid
+        c = self.center(tri)
+        if n[0] * c[0] / RADIUS_X ** 2 + n[1] * c[1] / RADIUS_Y ** 2 + n[2] * c[2] / RADIUS_Z ** 2 < 0:
+            n = (-n[0], -n[1], -n[2])
+        return n
+
+    @staticmethod
+    def chunk(chunk_id, body):
+        return struct.pack("<ii", chunk_id, 8 + len(body)) + body
+
+    @staticmethod
+    def eof():
+        return struct.pack("<ii", OP_EOF, 0)
+
+    def defpoints(self):
+        num_verts = len(self.verts)
+
+        # one normal per vertex
+        counts = bytes([1] * num_verts)
+        header_size = 20 + num_verts
+        padding = (-header_size) % 4
+        data_offset = header_size + padding
+
+        data = b"".join(pack_vec(self.verts[i]) + pack_vec(self.normals[i]) for i in range(num_verts))
+        return struct.pack("<iiiii", OP_DEFPOINTS, data_offset + len(data), num_verts, num_verts, data_offset) \
+            + counts + b"\0" * padding + data
+
+    def tmappoly(self, tri):
+        c = self.center(tri)
+        radius = max(math.dist(c, self.verts[i]) for i in tri)
+
+        body = pack_vec(self.face_normal(tri)) + pack_vec(c) + struct.pack("<f", radius)
+        body += struct.pack("<ii", len(tri), 0)  # vertex count, texture 0
+        for k, i in enumerate(tri):
+            u = [0.0, 1.0, 1.0][k]
+            v = [0.0, 0.0, 1.0][k]
+            body += struct.pack("<HHff", i, i, u, v)
+        return self.chunk(OP_TMAPPOLY, body)
+
+    def tree(self, tris):
+        mins, maxs = self.bbox(tris)
+
+        if len(tris) <= LEAF_TRIANGLES:
+            out = self.chunk(OP_BOUNDBOX, pack_vec(mins) + pack_vec(maxs))
+            for tri in tris:
+                out += self.tmappoly(tri)
+            return out + self.eof()
+
+        # split along the longest axis at the median triangle
+        extent = [maxs[k] - mins[k] for k in range(3)]
+        axis = extent.index(max(extent))
+        tris = sorted(tris, key=lambda t: self.center(t)[axis])
+        half = len(tris) // 2
+        back, front = tris[:half], tris[half:]
+
+        split = (self.center(back[-1])[axis] + self.center(front[0])[axis]) / 2
+        plane_normal = [0.0, 0.0, 0.0]
+        plane_normal[axis] = 1.0
+        plane_point = [0.0, 0.0, 0.0]
+        plane_point[axis] = split
+
+        front_tree = self.tree(front)
+        back_tree = self.tree(back)
+
+        # the children follow the SORTNORM and the EOF terminating it
+        front_offset = SORTNORM_SIZE + 8
+        back_offset = front_offset + len(front_tree)
+
+        body = pack_vec(plane_normal) + pack_vec(plane_point)
+        body += struct.pack("<iiiiii", 0, front_offset, back_offset, 0, 0, 0)  # reserved, front, back, prelist, postlist, online
+        body += pack_vec(mins) + pack_vec(maxs)
+        node = self.chunk(OP_SORTNORM, body)
+        assert len(node) == SORTNORM_SIZE
+
+        return node + self.eof() + front_tree + back_tree
+
+
+def pof_string(s):
+    data = s.encode() + b"\0"
+    return struct.pack("<i", len(data)) + data
+
+
+def pof_chunk(tag, body):
+    return tag + struct.pack("<i", len(body)) + body
+
+
+def make_pof():
+    verts, normals, tris = make_ellipsoid()
+
+    writer = BspWriter(verts, normals)
+    bsp = writer.defpoints() + writer.tree(tris)
+    assert len(bsp) % 4 == 0
+
+    mins = (-RADIUS_X, -RADIUS_Y, -RADIUS_Z)
+    maxs = (RADIUS_X, RADIUS_Y, RADIUS_Z)
+    radius = max(math.sqrt(v[0] ** 2 + v[1] ** 2 + v[2] ** 2) for v in verts)
+    mass = 100.0
+
+    textures = pof_chunk(b"TXTR", struct.pack("<i", 1) + pof_string("invisible"))
+
+    header = struct.pack("<fii", radius, 0, 1)  # radius, obj flags, number of submodels
+    header += pack_vec(mins) + pack_vec(maxs)
+    header += struct.pack("<ii", 1, 0)  # one detail level, submodel 0
+    header += struct.pack("<i", 0)  # no debris pieces
+    header += struct.pack("<f", mass) + pack_vec((0.0, 0.0, 0.0))  # mass, center of mass
+    header += pack_vec((0.001, 0.0, 0.0)) + pack_vec((0.0, 0.001, 0.0)) + pack_vec((0.0, 0.0, 0.001))  # moment of inertia
+    header += struct.pack("<i", 0)  # no cross sections
+    header += struct.pack("<i", 0)  # no lights
+
+    submodel = struct.pack("<ifi", 0, radius, -1)  # submodel number, radius, no parent
+    submodel += pack_vec((0.0, 0.0, 0.0)) + pack_vec((0.0, 0.0, 0.0))  # offset, geometric center
+    submodel += pack_vec(mins) + pack_vec(maxs)
+    submodel += pof_string("detail0") + pof_string("$collide_invisible")
+    submodel += struct.pack("<ii", -1, -1)  # no rotation, no movement axis
+    submodel += struct.pack("<i", 0)  # no chunks
+    submodel += struct.pack("<i", len(bsp)) + bsp
+
+    pof = b"PSPO" + struct.pack("<i", POF_VERSION)
+    pof += textures + pof_chunk(b"HDR2", header) + pof_chunk(b"OBJ2", submodel)
+
+    verify_bsp(bsp, len(verts), len(tris))
+    return pof
+
+
+def verify_bsp(bsp, num_verts, num_tris):
+    """Walks the BSP data like the engine does so an inconsistent tree fails here instead of in model_load()"""
+
+    def read_int(offset):
+        return struct.unpack_from("<i", bsp, offset)[0]
+
+    assert read_int(0) == OP_DEFPOINTS
+    assert read_int(8) == num_verts
+
+    polys = 0
+    stack = [read_int(4)]
+    while stack:
+        offset = stack.pop()
+        chunk_id = read_int(offset)
+
+        if chunk_id == OP_SORTNORM:
+            assert read_int(offset + 4) == SORTNORM_SIZE
+            assert read_int(offset + SORTNORM_SIZE) == OP_EOF
+            for child in (read_int(offset + 36), read_int(offset + 40)):
+                if child != 0 and read_int(offset + child) != OP_EOF:
+                    stack.append(offset + child)
+        elif chunk_id == OP_BOUNDBOX:
+            offset += read_int(offset + 4)
+            while read_int(offset) != OP_EOF:
+                assert read_int(offset) == OP_TMAPPOLY
+                count = read_int(offset + 36)
+                assert read_int(offset + 4) == 44 + 12 * count
+                for k in range(count):
+                    assert struct.unpack_from("<H", bsp, offset + 44 + 12 * k)[0] < num_verts
+                polys += 1
+                offset += read_int(offset + 4)
+        else:
+            raise AssertionError("unexpected BSP chunk {} at {}".format(chunk_id, offset))
+
+    assert polys == num_tris
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the model used by the model_collide benchmarks")
+    parser.add_argument("output", nargs="?", default=DEFAULT_OUTPUT)
+    parser.add_argument("--check", action="store_true",
+                        help="compare the existing file with the generated one instead of writing it")
+    args = parser.parse_args()
+
+    pof = make_pof()
+
+    if args.check:
+        with open(args.output, "rb") as f:
+            existing = f.read()
+        if existing != pof:
+            print("{} is out of date, run {} to regenerate it".format(args.output, sys.argv[0]), file=sys.stderr)
+            return 1
+        return 0
+
+    with open(args.output, "wb") as f:
+        f.write(pof)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
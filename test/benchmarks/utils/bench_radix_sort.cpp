@@ -0,0 +1,69 @@
+#include "benchmark.h"
+
+#include <utils/radix_sort.h>
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+const size_t NUM_ELEMENTS = 10000;
+
+struct sort_entry {
+	uint64_t key;
+	int index;
+};
+
+/**
+ * Keys shaped like the model draw keys: a handful of shader and buffer combinations with many textures
+ */
+SCP_vector<sort_entry> build_entries(uint32_t seed)
+{
+	std::mt19937_64 rng(seed);
+	std::uniform_int_distribution<uint64_t> shader_dist(0, 15);
+	std::uniform_int_distribution<uint64_t> buffer_dist(0, 63);
+	std::uniform_int_distribution<uint64_t> texture_dist(0, 2047);
+
+	SCP_vector<sort_entry> entries(NUM_ELEMENTS);
+	for (size_t i = 0; i < NUM_ELEMENTS; ++i) {
+		entries[i].key   = (shader_dist(rng) << 47) | (buffer_dist(rng) << 37) | (texture_dist(rng) << 15);
+		entries[i].index = static_cast<int>(i);
+	}
+	return entries;
+}
+
+} // namespace
+
+BENCHMARK(utils, radix_sort)
+{
+	const auto source = build_entries(1);
+	SCP_vector<sort_entry> values;
+	SCP_vector<sort_entry> scratch;
+
+	while (state.keep_running()) {
+		state.pause_timing();
+		values = source;
+		state.resume_timing();
+
+		util::radix_sort(values, scratch, [](const sort_entry& entry) { return entry.key; });
+		bench::do_not_optimize(values.front());
+	}
+	state.set_items_processed(state.iterations() * NUM_ELEMENTS);
+}
+
+BENCHMARK(utils, stable_sort_reference)
+{
+	const auto source = build_entries(1);
+	SCP_vector<sort_entry> values;
+
+	while (state.keep_running()) {
+		state.pause_timing();
+		values = source;
+		state.resume_timing();
+
+		std::stable_sort(values.begin(), values.end(),
+			[](const sort_entry& lhs, const sort_entry& rhs) { return lhs.key < rhs.key; });
+		bench::do_not_optimize(values.front());
+	}
+	state.set_items_processed(state.iterations() * NUM_ELEMENTS);
+}
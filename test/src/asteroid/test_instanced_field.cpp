@@ -0,0 +1,351 @@
+#include <gtest/gtest.h>
+
+#include "asteroid/asteroid.h"
+#include "globalincs/systemvars.h"
+#include "missioneditor/missionsave.h"
+#include "model/model.h"
+#include "object/object.h"
+#include "render/3d.h"
+#include "ship/ship.h"
+
+#include "util/FSTestFixture.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <tuple>
+
+extern polymodel* Polygon_models[MAX_POLYGON_MODELS];
+
+// Only called by the mission parser itself so it is not in the headers
+extern void parse_asteroid_fields(mission* pm);
+
+namespace {
+
+const int NUM_ASTEROIDS = 2000;
+
+// Half the edge length of the cube the field fills
+const float FIELD_EXTENT = 3000.0f;
+
+const float ASTEROID_RADIUS = 20.0f;
+
+const float SHIP_RADIUS = 50.0f;
+
+// A field of motionless asteroids which all use the same stand-in model, with one ship to promote them
+class instanced_field_setup {
+  public:
+	instanced_field_setup()
+	{
+		saved_game_mode = Game_mode;
+		saved_eye_position = Eye_position;
+		saved_asteroid_info = std::move(Asteroid_info);
+
+		Game_mode = GM_NORMAL;
+		Asteroids_enabled = 1;
+
+		// keep the camera far away from the field so only the ship promotes asteroids
+		vm_vec_make(&Eye_position, 0.0f, 100000.0f, 0.0f);
+
+		model_num = 0;
+		while (Polygon_models[model_num] != nullptr) {
+			++model_num;
+		}
+
+		auto pm = new polymodel();
+		pm->id = model_num;
+		pm->rad = ASTEROID_RADIUS;
+		Polygon_models[model_num] = pm;
+
+		// small, medium and large all exist since asteroid_create_all() loads all of them
+		Asteroid_info.resize(NUM_ASTEROID_SIZES);
+		for (auto& asip : Asteroid_info) {
+			asip.initial_asteroid_strength = 100.0f;
+
+			asteroid_subtype_info subtype;
+			subtype.pof_filename[0] = '\0';
+			subtype.model_number = model_num;
+			subtype.type_name = "Brown";
+			asip.subtypes.push_back(subtype);
+		}
+
+		ship_info_index = static_cast<int>(Ship_info.size());
+		Ship_info.emplace_back();
+		Ship_info.back().model_num = model_num;
+
+		obj_init();
+		list_init(&Ship_obj_list);
+		asteroid_level_init();
+
+		Asteroid_field.num_initial_asteroids = NUM_ASTEROIDS;
+		Asteroid_field.field_type = FT_PASSIVE;
+		Asteroid_field.field_asteroid_type.push_back("Brown");
+		vm_vec_make(&Asteroid_field.min_bound, -FIELD_EXTENT, -FIELD_EXTENT, -FIELD_EXTENT);
+		vm_vec_make(&Asteroid_field.max_bound, FIELD_EXTENT, FIELD_EXTENT, FIELD_EXTENT);
+		Asteroid_field.bound_rad = FIELD_EXTENT * 2.0f;
+		Asteroid_field.instanced = true;
+	}
+
+	~instanced_field_setup()
+	{
+		asteroid_level_close();
+		obj_merge_created_list();
+		obj_delete_all_that_should_be_dead();
+		obj_init();
+		asteroid_level_init();
+
+		Ships[0].ship_info_index = -1;
+		Ship_info.pop_back();
+
+		Asteroid_info = std::move(saved_asteroid_info);
+
+		delete Polygon_models[model_num];
+		Polygon_models[model_num] = nullptr;
+
+		Eye_position = saved_eye_position;
+		Game_mode = saved_game_mode;
+	}
+
+	void create_ship(const vec3d* pos)
+	{
+		flagset<Object::Object_Flags> flags;
+		flags.set(Object::Object_Flags::Collides);
+
+		Ships[0].ship_info_index = ship_info_index;
+
+		ship_objnum = obj_create(OBJ_SHIP, -1, 0, &vmd_identity_matrix, pos, SHIP_RADIUS, flags);
+		ASSERT_GE(ship_objnum, 0);
+
+		obj_merge_created_list();
+	}
+
+	void move_ship(float x, float y, float z)
+	{
+		vm_vec_make(&Objects[ship_objnum].pos, x, y, z);
+	}
+
+	// One frame of the field, with the objects it created or let go of actually added and removed
+	static void frame()
+	{
+		asteroid_frame();
+
+		obj_merge_created_list();
+		obj_delete_all_that_should_be_dead();
+	}
+
+	int model_num = -1;
+	int ship_info_index = -1;
+	int ship_objnum = -1;
+
+  private:
+	int saved_game_mode;
+	vec3d saved_eye_position;
+	SCP_vector<asteroid_info> saved_asteroid_info;
+};
+
+struct asteroid_state {
+	int objnum;
+	vec3d pos;
+	float hull;
+};
+
+SCP_vector<asteroid_state> get_asteroid_objects()
+{
+	SCP_vector<asteroid_state> asteroids;
+	for (auto objp : list_range(&obj_used_list)) {
+		if (objp->type != OBJ_ASTEROID || objp->flags[Object::Object_Flags::Should_be_dead]) {
+			continue;
+		}
+
+		asteroids.push_back({OBJ_INDEX(objp), objp->pos, objp->hull_strength});
+	}
+
+	std::sort(asteroids.begin(), asteroids.end(), [](const asteroid_state& left, const asteroid_state& right) {
+		return std::tie(left.pos.xyz.x, left.pos.xyz.y, left.pos.xyz.z) < std::tie(right.pos.xyz.x, right.pos.xyz.y, right.pos.xyz.z);
+	});
+	return asteroids;
+}
+
+// Saves only the asteroid field section of a mission
+class asteroid_field_saver : public Fred_mission_save {
+  public:
+	explicit asteroid_field_saver(MissionFormat format)
+	{
+		set_save_format(format);
+	}
+
+	SCP_string save()
+	{
+		// there is no previous version of the mission to take comments from
+		char no_text[] = "";
+		reset_parse(no_text);
+
+		SCP_string path = SCP_string(".") + DIR_SEPARATOR_STR + "instanced_field_test.fs2";
+
+		fp = cfopen(path.c_str(), "wt", CF_TYPE_MISSIONS);
+		if (fp == nullptr) {
+			ADD_FAILURE() << "Could not open " << path << " for writing";
+			return "";
+		}
+
+		EXPECT_EQ(save_asteroid_fields(), 0);
+		cfclose(fp);
+		fp = nullptr;
+
+		std::ifstream in(path, std::ios::binary);
+		SCP_string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		in.close();
+
+		std::remove(path.c_str());
+
+		return text;
+	}
+};
+
+// Parses the section the way the mission parser does and leaves the result in Asteroid_field
+void parse_saved_field(const SCP_string& saved)
+{
+	SCP_string text = saved + "\n#End\n";
+	SCP_vector<char> buffer(text.begin(), text.end());
+	buffer.push_back('\0');
+
+	Asteroid_field = {};
+
+	reset_parse(buffer.data());
+	parse_asteroid_fields(&The_mission);
+}
+
+class AsteroidInstancedFieldParseTest : public test::FSTestFixture {
+  public:
+	AsteroidInstancedFieldParseTest() : test::FSTestFixture(INIT_CFILE)
+	{
+		pushModDir("asteroid");
+	}
+
+  protected:
+	void SetUp() override
+	{
+		test::FSTestFixture::SetUp();
+
+		Asteroid_field = {};
+		Asteroid_field.num_initial_asteroids = 250;
+		Asteroid_field.field_type = FT_PASSIVE;
+		vm_vec_make(&Asteroid_field.min_bound, -4000.0f, -3000.0f, -2000.0f);
+		vm_vec_make(&Asteroid_field.max_bound, 4000.0f, 3000.0f, 2000.0f);
+	}
+	void TearDown() override
+	{
+		Asteroid_field = {};
+
+		test::FSTestFixture::TearDown();
+	}
+};
+
+} // namespace
+
+TEST(AsteroidInstancedFieldTest, promote_demote_round_trip)
+{
+	instanced_field_setup field;
+
+	asteroid_create_all();
+	ASSERT_EQ(Num_asteroids, 0);
+
+	vec3d far_away;
+	vm_vec_make(&far_away, 0.0f, 0.0f, 100000.0f);
+	field.create_ship(&far_away);
+
+	// nothing is close to the field yet
+	field.frame();
+	ASSERT_EQ(Num_asteroids, 0);
+
+	// everything close to the ship becomes an object, with the hull it was created with
+	field.move_ship(0.0f, 0.0f, 0.0f);
+	field.frame();
+
+	auto promoted = get_asteroid_objects();
+	ASSERT_GT(promoted.size(), 0u);
+	ASSERT_EQ(Num_asteroids, static_cast<int>(promoted.size()));
+
+	for (const auto& asteroid : promoted) {
+		EXPECT_LT(vm_vec_mag(&asteroid.pos) - SHIP_RADIUS - ASTEROID_RADIUS, 1000.0f);
+		EXPECT_TRUE(Asteroids[Objects[asteroid.objnum].instance].flags & AF_INSTANCED);
+		EXPECT_GT(asteroid.hull, 0.0f);
+	}
+
+	// moving a bit away keeps them as objects, they are only demoted once they are 1500m away
+	field.move_ship(300.0f, 0.0f, 0.0f);
+	field.frame();
+
+	for (const auto& asteroid : promoted) {
+		EXPECT_EQ(Objects[asteroid.objnum].type, OBJ_ASTEROID);
+		EXPECT_FALSE(Objects[asteroid.objnum].flags[Object::Object_Flags::Should_be_dead]);
+	}
+	EXPECT_GE(Num_asteroids, static_cast<int>(promoted.size()));
+
+	// an asteroid thrown at a ship stays an object however far away everything else goes
+	int thrown = Objects[promoted.front().objnum].instance;
+	Asteroids[thrown].target_objnum = field.ship_objnum;
+
+	field.move_ship(0.0f, 0.0f, 100000.0f);
+	field.frame();
+
+	ASSERT_EQ(Num_asteroids, 1);
+	EXPECT_EQ(Asteroids[thrown].objnum, promoted.front().objnum);
+
+	Asteroids[thrown].target_objnum = -1;
+	field.frame();
+	ASSERT_EQ(Num_asteroids, 0);
+
+	// coming back promotes the same asteroids again, where they were left and as damaged as they were
+	field.move_ship(0.0f, 0.0f, 0.0f);
+	field.frame();
+
+	auto promoted_again = get_asteroid_objects();
+	ASSERT_EQ(promoted_again.size(), promoted.size());
+
+	for (size_t i = 0; i < promoted.size(); ++i) {
+		EXPECT_EQ(promoted_again[i].pos.xyz.x, promoted[i].pos.xyz.x);
+		EXPECT_EQ(promoted_again[i].pos.xyz.y, promoted[i].pos.xyz.y);
+		EXPECT_EQ(promoted_again[i].pos.xyz.z, promoted[i].pos.xyz.z);
+		EXPECT_EQ(promoted_again[i].hull, promoted[i].hull);
+	}
+}
+
+TEST_F(AsteroidInstancedFieldParseTest, instanced_field_survives_save_and_parse)
+{
+	Asteroid_field.instanced = true;
+
+	auto saved = asteroid_field_saver(MissionFormat::STANDARD).save();
+	EXPECT_NE(saved.find("+Instanced Field"), SCP_string::npos);
+
+	parse_saved_field(saved);
+
+	EXPECT_TRUE(Asteroid_field.instanced);
+	EXPECT_EQ(Asteroid_field.num_initial_asteroids, 250);
+	EXPECT_EQ(Asteroid_field.field_type, FT_PASSIVE);
+	EXPECT_FLOAT_EQ(Asteroid_field.min_bound.xyz.x, -4000.0f);
+	EXPECT_FLOAT_EQ(Asteroid_field.max_bound.xyz.z, 2000.0f);
+}
+
+TEST_F(AsteroidInstancedFieldParseTest, normal_field_stays_normal)
+{
+	auto saved = asteroid_field_saver(MissionFormat::STANDARD).save();
+	EXPECT_EQ(saved.find("+Instanced Field"), SCP_string::npos);
+
+	parse_saved_field(saved);
+
+	EXPECT_FALSE(Asteroid_field.instanced);
+	EXPECT_EQ(Asteroid_field.num_initial_asteroids, 250);
+}
+
+TEST_F(AsteroidInstancedFieldParseTest, retail_missions_leave_out_instancing)
+{
+	Asteroid_field.instanced = true;
+
+	auto saved = asteroid_field_saver(MissionFormat::RETAIL).save();
+	EXPECT_EQ(saved.find("+Instanced Field"), SCP_string::npos);
+
+	parse_saved_field(saved);
+
+	EXPECT_FALSE(Asteroid_field.instanced);
+}
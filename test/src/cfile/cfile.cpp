@@ -212,3 +212,40 @@ TEST_F(CFileTest, subfolder_list)
 	ASSERT_EQ(2, cf_get_file_list(table_files, CF_TYPE_TABLES, "*\\*.tbl", CF_SORT_NAME));
 	ASSERT_TRUE(table_files.back().substr(0, 6) == "folder");
 }
+
+TEST_F(CFileTest, preload_files)
+{
+	SCP_vector<CFileLocation> files;
+	files.push_back(cf_find_file_location("dir.tbl", CF_TYPE_TABLES));
+	files.push_back(cf_find_file_location("test.tbl", CF_TYPE_TABLES));
+
+	ASSERT_TRUE(files[0].found);
+	ASSERT_TRUE(files[1].found);
+	ASSERT_EQ((size_t)0, files[0].offset);
+	ASSERT_NE((size_t)0, files[1].offset); // this one is in the VP
+
+	cf_preload(files);
+
+	for (const auto& res : files) {
+		auto fp = cfopen(res.name_ext.c_str(), "rb", CF_TYPE_TABLES);
+		ASSERT_TRUE(fp != nullptr);
+
+		// read from memory with the same contents as on disk
+		ASSERT_TRUE(cf_returndata(fp) != nullptr);
+		ASSERT_EQ(5, cfilelength(fp));
+
+		char buffer[6] = {};
+		ASSERT_EQ(1, cfread(buffer, 5, 1, fp));
+		ASSERT_STREQ("asdf\n", buffer);
+
+		cfclose(fp);
+	}
+
+	cf_preload_release();
+
+	// opening the file again reads it from the disk
+	auto fp = cfopen("dir.tbl", "rb", CF_TYPE_TABLES);
+	ASSERT_TRUE(fp != nullptr);
+	ASSERT_EQ(5, cfilelength(fp));
+	cfclose(fp);
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include "ddsutils/ddsutils.h"
+#include "ddsutils/bcdec.h"
+
+#include <random>
+
+namespace {
+
+const ubyte CANARY = 0xCD;
+
+// What the old decoder produced: bcdec output per block, converted to BGRA
+SCP_vector<ubyte> reference_decode(uint format, const SCP_vector<ubyte>& src, uint width, uint height)
+{
+	void (*decode)(const void*, void*, int) = nullptr;
+	size_t block_size = 16;
+	switch (format) {
+	case FOURCC_DXT1:
+		decode = bcdec_bc1;
+		block_size = BCDEC_BC1_BLOCK_SIZE;
+		break;
+	case FOURCC_DXT3:
+		decode = bcdec_bc2;
+		break;
+	case FOURCC_DXT5:
+		decode = bcdec_bc3;
+		break;
+	default:
+		decode = bcdec_bc7;
+		break;
+	}
+
+	SCP_vector<ubyte> out(width * height * 4);
+	const ubyte* block = src.data();
+	for (uint y = 0; y < height; y += 4) {
+		for (uint x = 0; x < width; x += 4, block += block_size) {
+			ubyte pixels[4 * 4 * 4];
+			decode(block, pixels, 16);
+
+			for (uint i = 0; i < 4 && y + i < height; ++i) {
+				for (uint j = 0; j < 4 && x + j < width; ++j) {
+					const ubyte* px = pixels + i * 16 + j * 4;
+					ubyte* dst = &out[((y + i) * width + x + j) * 4];
+					dst[0] = px[2];
+					dst[1] = px[1];
+					dst[2] = px[0];
+					dst[3] = px[3];
+				}
+			}
+		}
+	}
+
+	return out;
+}
+
+void check_format(uint format, uint width, uint height, std::mt19937& rng)
+{
+	const auto size = dds_compressed_size(format, width, height, 1);
+	ASSERT_GT(size, (size_t)0);
+
+	SCP_vector<ubyte> src(size);
+	std::uniform_int_distribution<int> byte_dist(0, 255);
+	for (auto& b : src) {
+		b = static_cast<ubyte>(byte_dist(rng));
+	}
+
+	if (format == FOURCC_DXT1) {
+		// make sure both color modes show up
+		for (size_t i = 0; i < size; i += 16) {
+			std::swap(src[i], src[i + 2]);
+			std::swap(src[i + 1], src[i + 3]);
+		}
+	}
+
+	auto expected = reference_decode(format, src, width, height);
+
+	SCP_vector<ubyte> actual(width * height * 4 + 64, CANARY);
+	ASSERT_TRUE(dds_decompress(format, src.data(), width, height, 1, actual.data()));
+
+	for (size_t i = 0; i < expected.size(); ++i) {
+		ASSERT_EQ(expected[i], actual[i]) << "byte " << i << " of a " << width << "x" << height << " image";
+	}
+
+	// partial blocks at the edges must not write past the image
+	for (size_t i = expected.size(); i < actual.size(); ++i) {
+		ASSERT_EQ(CANARY, actual[i]);
+	}
+}
+
+} // namespace
+
+TEST(DDSDecompressTest, matches_bcdec)
+{
+	std::mt19937 rng(1);
+
+	const uint formats[] = {FOURCC_DXT1, FOURCC_DXT3, FOURCC_DXT5, FOURCC_DX10};
+	const uint sizes[][2] = {{256, 256}, {64, 16}, {13, 7}, {2, 2}, {1, 1}, {4, 1}, {130, 66}};
+
+	for (auto format : formats) {
+		for (const auto& size : sizes) {
+			check_format(format, size[0], size[1], rng);
+		}
+	}
+}
+
+TEST(DDSDecompressTest, volume_layers)
+{
+	std::mt19937 rng(2);
+
+	const uint width = 8, height = 6, depth = 3;
+	const auto layer_size = dds_compressed_size(FOURCC_DXT5, width, height, 1);
+	ASSERT_EQ(layer_size * depth, dds_compressed_size(FOURCC_DXT5, width, height, depth));
+
+	SCP_vector<ubyte> src(layer_size * depth);
+	for (auto& b : src) {
+		b = static_cast<ubyte>(rng());
+	}
+
+	SCP_vector<ubyte> actual(width * height * depth * 4);
+	ASSERT_TRUE(dds_decompress(FOURCC_DXT5, src.data(), width, height, depth, actual.data()));
+
+	for (uint d = 0; d < depth; ++d) {
+		SCP_vector<ubyte> layer(src.begin() + d * layer_size, src.begin() + (d + 1) * layer_size);
+		auto expected = reference_decode(FOURCC_DXT5, layer, width, height);
+		ASSERT_TRUE(std::equal(expected.begin(), expected.end(), actual.begin() + d * width * height * 4));
+	}
+}
+
+TEST(DDSDecompressTest, unknown_format)
+{
+	ubyte data[64] = {};
+	ASSERT_EQ((size_t)0, dds_compressed_size(FOURCC_DXT2, 4, 4, 1));
+	ASSERT_FALSE(dds_decompress(FOURCC_DXT2, data, 4, 4, 1, data));
+}
@@ -0,0 +1,114 @@
+
+#include <gtest/gtest.h>
+#include <random>
+
+#include "lighting/lighting.h"
+#include "math/vecmat.h"
+
+namespace {
+light make_light(Light_Type type, const vec3d& pos, const vec3d& vec2, float radius)
+{
+	light l;
+	memset(&l, 0, sizeof(l));
+
+	l.type = type;
+	l.vec = pos;
+	l.vec2 = vec2;
+	l.rada = radius * 0.5f;
+	l.rada_squared = l.rada * l.rada;
+	l.radb = radius;
+	l.radb_squared = l.radb * l.radb;
+	l.cone_angle = 0.7f;
+	l.cone_inner_angle = 0.8f;
+	l.intensity = 1.0f;
+	l.flags = LF_DEFAULT;
+	l.sun_index = -1;
+
+	return l;
+}
+
+vec3d random_vec(std::mt19937& gen, float range)
+{
+	std::uniform_real_distribution<float> dist(-range, range);
+
+	vec3d v;
+	v.xyz.x = dist(gen);
+	v.xyz.y = dist(gen);
+	v.xyz.z = dist(gen);
+	return v;
+}
+}
+
+TEST(LightFilterTests, gridMatchesLinearScan) {
+	std::mt19937 gen(4242);
+	std::uniform_real_distribution<float> radius_dist(10.0f, 400.0f);
+	std::uniform_int_distribution<int> type_dist(0, 3);
+
+	SCP_vector<light> lights;
+	scene_lights scene;
+
+	for (int i = 0; i < 3000; ++i) {
+		auto type = static_cast<Light_Type>(type_dist(gen));
+		auto pos = random_vec(gen, 10000.0f);
+
+		vec3d vec2;
+		if (type == Light_Type::Tube) {
+			vec2 = pos + random_vec(gen, 500.0f);
+		} else {
+			vec2 = random_vec(gen, 1.0f);
+			vm_vec_normalize_safe(&vec2);
+		}
+
+		// A few very large lights which do not fit into the grid cells
+		float radius = (i % 500 == 0) ? 20000.0f : radius_dist(gen);
+
+		lights.push_back(make_light(type, pos, vec2, radius));
+		if (i % 7 == 0) {
+			lights.back().flags |= LF_DUAL_CONE;
+		}
+
+		scene.addLight(&lights.back());
+	}
+
+	for (int i = 0; i < 500; ++i) {
+		auto pos = random_vec(gen, 11000.0f);
+		// Mostly fighter sized objects with the occasional capital ship
+		float rad = (i % 50 == 0) ? 5000.0f : radius_dist(gen) * 0.25f;
+
+		size_t expected = 0;
+		for (const auto& l : lights) {
+			if (l.type != Light_Type::Directional && light_affects_sphere(&l, &pos, rad)) {
+				++expected;
+			}
+		}
+
+		scene.setLightFilter(&pos, rad);
+
+		ASSERT_EQ(expected, scene.getNumFilteredLights()) << "Query " << i;
+	}
+}
+
+TEST(LightFilterTests, coneLightsAreFiltered) {
+	scene_lights scene;
+
+	vec3d origin = vmd_zero_vector;
+	vec3d forward = vmd_z_vector;
+
+	auto cone = make_light(Light_Type::Cone, origin, forward, 100.0f);
+	scene.addLight(&cone);
+
+	vec3d in_front;
+	vm_vec_make(&in_front, 0.0f, 0.0f, 50.0f);
+	scene.setLightFilter(&in_front, 1.0f);
+	ASSERT_EQ((size_t)1, scene.getNumFilteredLights());
+
+	vec3d behind;
+	vm_vec_make(&behind, 0.0f, 0.0f, -50.0f);
+	scene.setLightFilter(&behind, 1.0f);
+	ASSERT_EQ((size_t)0, scene.getNumFilteredLights());
+
+	vec3d out_of_range;
+	vm_vec_make(&out_of_range, 0.0f, 0.0f, 150.0f);
+	scene.setLightFilter(&out_of_range, 1.0f);
+	ASSERT_EQ((size_t)0, scene.getNumFilteredLights());
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include "model/modelrender.h"
+#include "render/3d.h"
+
+#include "util/FSTestFixture.h"
+
+class ModelDrawListInstancingTest : public test::FSTestFixture {
+  public:
+	ModelDrawListInstancingTest() : test::FSTestFixture(INIT_CFILE | INIT_GRAPHICS) {}
+
+  protected:
+	void SetUp() override
+	{
+		test::FSTestFixture::SetUp();
+
+		// a model with two submodels and two textures
+		buffer.flags = VB_FLAG_MODEL_ID;
+		buffer.tex_buf.resize(2);
+		for (auto& tex_buf : buffer.tex_buf) {
+			tex_buf.n_verts = 3;
+		}
+
+		g3_start_frame(1);
+		g3_set_view_matrix(&vmd_zero_vector, &vmd_identity_matrix, 0.75f);
+
+		scene.init();
+		scene.set_light_filter(&vmd_zero_vector, 1000.0f);
+	}
+
+	void TearDown() override
+	{
+		scene.reset();
+		g3_end_frame();
+
+		test::FSTestFixture::TearDown();
+	}
+
+	// Queues both textures of the model the way model_render_buffers() does for a batched model
+	void addShip(float x, const model_material& material)
+	{
+		vec3d pos = vmd_zero_vector;
+		pos.xyz.x = x;
+
+		scene.start_model_batch(2);
+		scene.push_transform(&pos, &vmd_identity_matrix);
+		scene.add_submodel_to_batch(0);
+		scene.add_submodel_to_batch(1);
+
+		for (size_t texi = 0; texi < buffer.tex_buf.size(); ++texi) {
+			scene.add_buffer_draw(&material, &vert_source, &buffer, texi, TMAP_FLAG_BATCH_TRANSFORMS);
+		}
+
+		scene.pop_transform();
+	}
+
+	model_draw_list scene;
+
+	indexed_vertex_source vert_source;
+	vertex_buffer buffer;
+};
+
+TEST_F(ModelDrawListInstancingTest, identical_ships_become_one_draw_per_texture)
+{
+	model_material material;
+
+	for (int i = 0; i < 3; ++i) {
+		addShip(i * 100.0f, material);
+	}
+	ASSERT_EQ(6u, scene.get_num_draws());
+
+	scene.init_render();
+
+	ASSERT_EQ(2u, scene.get_num_draws());
+}
+
+TEST_F(ModelDrawListInstancingTest, different_team_colors_are_not_merged)
+{
+	model_material material;
+	team_color color = {{0.5f, 0.5f, 0.5f}, {1.0f, 0.0f, 0.0f}};
+	material.set_team_color(color);
+
+	model_material other_material = material;
+	color.stripe.b = 1.0f;
+	other_material.set_team_color(color);
+
+	addShip(0.0f, material);
+	addShip(100.0f, other_material);
+	addShip(200.0f, material);
+
+	scene.init_render();
+
+	ASSERT_EQ(4u, scene.get_num_draws());
+}
+
+TEST_F(ModelDrawListInstancingTest, unsorted_draws_are_not_merged)
+{
+	model_material material;
+
+	addShip(0.0f, material);
+	addShip(100.0f, material);
+
+	scene.init_render(false);
+
+	ASSERT_EQ(4u, scene.get_num_draws());
+}
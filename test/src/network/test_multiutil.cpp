@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include "network/multiutil.h"
+
+#include <random>
+
+namespace {
+
+multi_quantized_transform random_transform(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> pos_dist(-100000.0f, 100000.0f);
+	std::uniform_real_distribution<float> y_dist(-60000.0f, 60000.0f);
+	std::uniform_real_distribution<float> angle_dist(-PI, PI);
+
+	vec3d pos;
+	pos.xyz.x = pos_dist(rng);
+	pos.xyz.y = y_dist(rng);
+	pos.xyz.z = pos_dist(rng);
+
+	angles angs;
+	angs.b = angle_dist(rng);
+	angs.h = angle_dist(rng);
+	angs.p = angle_dist(rng);
+
+	multi_quantized_transform transform;
+	multi_quantize_transform(&pos, &angs, &transform);
+	return transform;
+}
+
+void expect_transform_eq(const multi_quantized_transform& expected, const multi_quantized_transform& actual)
+{
+	for (int i = 0; i < 3; i++) {
+		EXPECT_EQ(expected.pos[i], actual.pos[i]);
+		EXPECT_EQ(expected.orient[i], actual.orient[i]);
+	}
+}
+
+} // namespace
+
+TEST(MultiUtilTest, transform_matches_position_and_orient_packers)
+{
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> pos_dist(-100000.0f, 100000.0f);
+	std::uniform_real_distribution<float> angle_dist(-PI, PI);
+
+	for (int i = 0; i < 100; i++) {
+		vec3d pos;
+		pos.xyz.x = pos_dist(rng);
+		pos.xyz.y = pos_dist(rng) * 0.5f;
+		pos.xyz.z = pos_dist(rng);
+
+		angles angs;
+		angs.b = angle_dist(rng);
+		angs.h = angle_dist(rng);
+		angs.p = angle_dist(rng);
+
+		ubyte expected[32] = {};
+		int expected_size = multi_pack_unpack_position(1, expected, &pos);
+		expected_size += multi_pack_unpack_orient(1, expected + expected_size, &angs);
+
+		multi_quantized_transform transform;
+		multi_quantize_transform(&pos, &angs, &transform);
+
+		ubyte actual[32] = {};
+		ASSERT_EQ(expected_size, multi_pack_unpack_transform(1, actual, &transform, true));
+		ASSERT_EQ(0, memcmp(expected, actual, expected_size));
+
+		// and reading it back gives the same values the old unpackers did
+		multi_quantized_transform read;
+		multi_pack_unpack_transform(0, actual, &read, true);
+		expect_transform_eq(transform, read);
+
+		vec3d expected_pos, actual_pos;
+		angles expected_angs, actual_angs;
+		int offset = multi_pack_unpack_position(0, expected, &expected_pos);
+		multi_pack_unpack_orient(0, expected + offset, &expected_angs);
+		multi_dequantize_transform(&read, &actual_pos, &actual_angs);
+
+		ASSERT_EQ(expected_pos.xyz.x, actual_pos.xyz.x);
+		ASSERT_EQ(expected_pos.xyz.y, actual_pos.xyz.y);
+		ASSERT_EQ(expected_pos.xyz.z, actual_pos.xyz.z);
+		ASSERT_EQ(expected_angs.b, actual_angs.b);
+		ASSERT_EQ(expected_angs.h, actual_angs.h);
+		ASSERT_EQ(expected_angs.p, actual_angs.p);
+	}
+}
+
+TEST(MultiUtilTest, transform_delta_round_trip)
+{
+	std::mt19937 rng(2);
+
+	// from tiny changes up to jumps across the whole range, to hit every size class
+	const int max_steps[] = {0, 100, 20000, 1 << 24};
+
+	for (auto max_step : max_steps) {
+		std::uniform_int_distribution<int> step_dist(-max_step, max_step);
+
+		for (int i = 0; i < 200; i++) {
+			auto baseline = random_transform(rng);
+
+			multi_quantized_transform transform = baseline;
+			for (int j = 0; j < 3; j++) {
+				transform.pos[j] = baseline.pos[j] + step_dist(rng);
+				CAP(transform.pos[j], j == 1 ? -33554432 : -67108864, j == 1 ? 33554431 : 67108863);
+
+				// the angles wrap around
+				transform.orient[j] = static_cast<std::int16_t>(baseline.orient[j] + step_dist(rng));
+			}
+
+			ubyte data[64];
+			int written = multi_pack_unpack_transform_delta(1, data, &baseline, &transform);
+
+			multi_quantized_transform read;
+			ASSERT_EQ(written, multi_pack_unpack_transform_delta(0, data, &baseline, &read));
+			expect_transform_eq(transform, read);
+
+			// never bigger than the full position and orientation plus the size classes
+			ASSERT_LE(written, 18);
+		}
+	}
+}
+
+TEST(MultiUtilTest, transform_delta_is_small_for_small_changes)
+{
+	std::mt19937 rng(3);
+	auto baseline = random_transform(rng);
+
+	ubyte data[64];
+
+	// nothing moved, only the size classes are sent
+	auto transform = baseline;
+	ASSERT_EQ(2, multi_pack_unpack_transform_delta(1, data, &baseline, &transform));
+
+	// an orientation going from just below PI to just above -PI is a small step
+	baseline.orient[1] = 32767;
+	transform.orient[1] = -32768;
+	ASSERT_EQ(3, multi_pack_unpack_transform_delta(1, data, &baseline, &transform));
+
+	multi_quantized_transform read;
+	multi_pack_unpack_transform_delta(0, data, &baseline, &read);
+	expect_transform_eq(transform, read);
+}
+
+TEST(MultiUtilTest, frame_is_acknowledged_once_all_packets_arrived)
+{
+	multi_frame_receipt receipts[MULTI_FRAME_RECEIPT_FRAMES];
+
+	int ack_frame;
+	uint ack_bits;
+
+	// the last packet of frame 10 is still missing
+	multi_frame_receipt_add(receipts, 10, 0, false, true);
+	multi_frame_receipt_get_ack(receipts, &ack_frame, &ack_bits);
+	ASSERT_EQ(-1, ack_frame);
+
+	multi_frame_receipt_add(receipts, 10, 1, true, true);
+	multi_frame_receipt_get_ack(receipts, &ack_frame, &ack_bits);
+	ASSERT_EQ(10, ack_frame);
+	ASSERT_EQ(0u, ack_bits);
+
+	// frame 11 lost its first packet, frame 12 arrived in one
+	multi_frame_receipt_add(receipts, 11, 1, true, true);
+	multi_frame_receipt_add(receipts, 12, 0, true, true);
+	multi_frame_receipt_get_ack(receipts, &ack_frame, &ack_bits);
+	ASSERT_EQ(12, ack_frame);
+	ASSERT_EQ(2u, ack_bits);
+}
+
+TEST(MultiUtilTest, frame_with_an_update_of_an_unknown_object_is_not_acknowledged)
+{
+	multi_frame_receipt receipts[MULTI_FRAME_RECEIPT_FRAMES];
+
+	int ack_frame;
+	uint ack_bits;
+
+	multi_frame_receipt_add(receipts, 20, 0, true, true);
+
+	// the position of a ship the client has not created yet arrived in frame 21, so the server must not send deltas
+	// against it
+	multi_frame_receipt_add(receipts, 21, 0, false, true);
+	multi_frame_receipt_add(receipts, 21, 1, true, false);
+	multi_frame_receipt_get_ack(receipts, &ack_frame, &ack_bits);
+	ASSERT_EQ(20, ack_frame);
+
+	// the frames after it are acknowledged again, without it
+	multi_frame_receipt_add(receipts, 22, 0, true, true);
+	multi_frame_receipt_get_ack(receipts, &ack_frame, &ack_bits);
+	ASSERT_EQ(22, ack_frame);
+	ASSERT_EQ(2u, ack_bits);
+
+	// a receipt slot reused by a later frame starts out clean
+	multi_frame_receipt_add(receipts, 21 + MULTI_FRAME_RECEIPT_FRAMES, 0, true, true);
+	multi_frame_receipt_get_ack(receipts, &ack_frame, &ack_bits);
+	ASSERT_EQ(21 + MULTI_FRAME_RECEIPT_FRAMES, ack_frame);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include "object/object.h"
+#include "object/objectsnapshot.h"
+#include "render/3d.h"
+#include "render/3dinternal.h"
+
+#include "util/FSTestFixture.h"
+
+#include <random>
+
+class ObjectRenderCullTest : public test::FSTestFixture {
+  public:
+	ObjectRenderCullTest() : test::FSTestFixture(INIT_CFILE | INIT_GRAPHICS) {}
+
+  protected:
+	void TearDown() override
+	{
+		G3_user_clip = 0;
+
+		test::FSTestFixture::TearDown();
+	}
+
+	// Spheres around the viewer, some of them far larger than others so they reach into the view from behind it
+	static obj_render_snapshot randomSnapshot(std::mt19937& rng, size_t count)
+	{
+		std::uniform_real_distribution<float> pos_dist(-2000.0f, 2000.0f);
+		std::uniform_real_distribution<float> rad_dist(1.0f, 50.0f);
+
+		obj_render_snapshot snapshot;
+		for (size_t i = 0; i < count; i++) {
+			vec3d pos;
+			pos.xyz.x = pos_dist(rng);
+			pos.xyz.y = pos_dist(rng);
+			pos.xyz.z = pos_dist(rng);
+
+			snapshot.objnum.push_back(static_cast<int>(i));
+			snapshot.signature.push_back(static_cast<int>(i) + 1);
+			snapshot.pos.push_back(pos);
+			snapshot.cull_radius.push_back(i % 10 == 0 ? rad_dist(rng) * 20.0f : rad_dist(rng));
+			snapshot.orient.push_back(vmd_identity_matrix);
+			snapshot.model_num.push_back(-1);
+		}
+
+		return snapshot;
+	}
+
+	// Culls the snapshot against the current view and compares the result to the objects which obj_in_view_cone() sees
+	static void expectSameAsViewCone(const obj_render_snapshot& snapshot)
+	{
+		obj_render_frustum frustum;
+		obj_render_frustum_init(&frustum);
+
+		obj_render_cull_result result;
+		obj_render_cull(snapshot, frustum, &result);
+
+		SCP_vector<int> expected;
+		for (size_t i = 0; i < snapshot.size(); i++) {
+			if (obj_in_view_cone(&snapshot.pos[i], snapshot.cull_radius[i])) {
+				expected.push_back(static_cast<int>(i));
+			}
+		}
+
+		ASSERT_FALSE(expected.empty());
+		ASSERT_LT(expected.size(), snapshot.size());
+		EXPECT_EQ(expected, result.visible);
+
+		// the model distances are only valid for the eye they were measured from
+		EXPECT_TRUE(result.eye_position == frustum.position);
+
+		ASSERT_EQ(snapshot.size(), result.in_view.size());
+		for (auto index : result.visible) {
+			EXPECT_EQ(1, result.in_view[index]);
+			EXPECT_EQ(-1.0f, result.model_distance[index]);
+		}
+	}
+};
+
+TEST_F(ObjectRenderCullTest, matches_view_cone)
+{
+	std::mt19937 rng(1);
+	auto snapshot = randomSnapshot(rng, 2000);
+
+	vec3d eye_pos = vmd_zero_vector;
+	eye_pos.xyz.x = 100.0f;
+	angles angs = {0.3f, 0.0f, 1.2f};
+	matrix eye_orient;
+	vm_angles_2_matrix(&eye_orient, &angs);
+
+	g3_start_frame(1);
+	g3_set_view_matrix(&eye_pos, &eye_orient, 0.75f);
+
+	expectSameAsViewCone(snapshot);
+
+	g3_end_frame();
+}
+
+TEST_F(ObjectRenderCullTest, matches_view_cone_with_asymmetric_fov)
+{
+	std::mt19937 rng(2);
+	auto snapshot = randomSnapshot(rng, 2000);
+
+	asymmetric_fov afov = {-0.5f, 0.3f, 0.4f, -0.35f};
+
+	g3_start_frame(1);
+	g3_set_view_matrix(&vmd_zero_vector, &vmd_identity_matrix, afov);
+
+	expectSameAsViewCone(snapshot);
+
+	g3_end_frame();
+}
+
+TEST_F(ObjectRenderCullTest, matches_view_cone_with_user_clip_plane)
+{
+	std::mt19937 rng(3);
+	auto snapshot = randomSnapshot(rng, 2000);
+
+	g3_start_frame(1);
+	g3_set_view_matrix(&vmd_zero_vector, &vmd_identity_matrix, 0.75f);
+
+	G3_user_clip = 1;
+	G3_user_clip_point = vmd_zero_vector;
+	G3_user_clip_point.xyz.z = 500.0f;
+	G3_user_clip_normal = vmd_zero_vector;
+	G3_user_clip_normal.xyz.x = 1.0f;
+
+	expectSameAsViewCone(snapshot);
+
+	g3_end_frame();
+}
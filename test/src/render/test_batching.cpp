@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+
+#include "render/batching.h"
+
+#include <random>
+
+namespace {
+
+// How the quads of camera facing bitmaps were built before they were expanded from batch_bitmap
+void reference_bitmap(const batch_view& view, const vec3d& pos, int orient, float rad, float depth, batch_vertex* out)
+{
+	rad *= 1.41421356f;
+
+	vec3d PNT = pos;
+	vec3d p[4];
+	vec3d fvec, rvec, uvec;
+
+	vm_vec_sub(&fvec, &view.position, &PNT);
+	vm_vec_normalize_safe(&fvec);
+
+	uvec = view.orient.vec.uvec;
+	vm_vec_cross(&rvec, &view.orient.vec.fvec, &uvec);
+	vm_vec_normalize_safe(&rvec);
+	vm_vec_cross(&uvec, &view.orient.vec.fvec, &rvec);
+
+	if (depth != 0.0f)
+		vm_vec_scale_add(&PNT, &PNT, &fvec, depth);
+
+	vm_vec_scale_add(&p[0], &PNT, &rvec, rad);
+	vm_vec_scale_add(&p[2], &PNT, &rvec, -rad);
+	vm_vec_scale_add(&p[1], &p[2], &uvec, rad);
+	vm_vec_scale_add(&p[3], &p[0], &uvec, -rad);
+	vm_vec_scale_add(&p[0], &p[0], &uvec, rad);
+	vm_vec_scale_add(&p[2], &p[2], &uvec, -rad);
+
+	batch_vertex verts[6];
+	verts[5].position = p[3];
+	verts[4].position = p[2];
+	verts[3].position = p[1];
+	verts[2].position = p[3];
+	verts[1].position = p[1];
+	verts[0].position = p[0];
+
+	const float u_flip[6] = {1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f};
+	const float v_flip[6] = {0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f};
+	for (int i = 0; i < 6; i++) {
+		verts[i].tex_coord.xyzw.x = (orient & 1) ? u_flip[i] : 1.0f - u_flip[i];
+		verts[i].tex_coord.xyzw.y = (orient & 2) ? v_flip[i] : 1.0f - v_flip[i];
+	}
+
+	// two triangles, 5-4-3 and 2-1-0
+	for (int i = 0; i < 6; i++) {
+		out[i] = verts[5 - i];
+	}
+}
+
+void expect_vec_near(const vec3d& expected, const vec3d& actual)
+{
+	EXPECT_NEAR(expected.xyz.x, actual.xyz.x, 1e-3f);
+	EXPECT_NEAR(expected.xyz.y, actual.xyz.y, 1e-3f);
+	EXPECT_NEAR(expected.xyz.z, actual.xyz.z, 1e-3f);
+}
+
+batch_view random_view(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> pos_dist(-1000.0f, 1000.0f);
+	std::uniform_real_distribution<float> angle_dist(-PI, PI);
+
+	vec3d pos;
+	pos.xyz.x = pos_dist(rng);
+	pos.xyz.y = pos_dist(rng);
+	pos.xyz.z = pos_dist(rng);
+
+	angles angs;
+	angs.p = angle_dist(rng);
+	angs.b = angle_dist(rng);
+	angs.h = angle_dist(rng);
+
+	matrix orient;
+	vm_angles_2_matrix(&orient, &angs);
+
+	batch_view view;
+	batching_init_view(&view, &pos, &orient);
+	return view;
+}
+
+} // namespace
+
+TEST(BatchingTest, bitmaps_match_the_old_quads)
+{
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> pos_dist(-1000.0f, 1000.0f);
+	std::uniform_real_distribution<float> rad_dist(0.1f, 50.0f);
+	std::uniform_int_distribution<int> orient_dist(0, 3);
+
+	SCP_vector<batch_view> views;
+	views.push_back(random_view(rng));
+	views.push_back(random_view(rng));
+
+	SCP_vector<batch_bitmap> bitmaps;
+	for (int i = 0; i < 64; i++) {
+		batch_bitmap bitmap;
+		bitmap.position.xyz.x = pos_dist(rng);
+		bitmap.position.xyz.y = pos_dist(rng);
+		bitmap.position.xyz.z = pos_dist(rng);
+		bitmap.radius = rad_dist(rng);
+		bitmap.depth = (i % 3 == 0) ? 0.0f : rad_dist(rng);
+		bitmap.angle = 0.0f;
+		bitmap.array_index = (float)(i % 5);
+		bitmap.r = (ubyte)i;
+		bitmap.g = 2;
+		bitmap.b = 3;
+		bitmap.a = 4;
+		bitmap.view = (uint)(i % 2);
+		bitmap.orient = (ubyte)orient_dist(rng);
+		bitmap.rotated = false;
+		bitmaps.push_back(bitmap);
+	}
+
+	SCP_vector<batch_vertex> verts(bitmaps.size() * 6);
+	batching_expand_bitmaps(bitmaps.data(), bitmaps.size(), views.data(), verts.data());
+
+	for (size_t i = 0; i < bitmaps.size(); i++) {
+		const auto& bitmap = bitmaps[i];
+
+		batch_vertex expected[6];
+		reference_bitmap(views[bitmap.view], bitmap.position, bitmap.orient, bitmap.radius, bitmap.depth, expected);
+
+		for (int j = 0; j < 6; j++) {
+			const auto& vert = verts[i * 6 + j];
+
+			expect_vec_near(expected[j].position, vert.position);
+			EXPECT_EQ(expected[j].tex_coord.xyzw.x, vert.tex_coord.xyzw.x);
+			EXPECT_EQ(expected[j].tex_coord.xyzw.y, vert.tex_coord.xyzw.y);
+			EXPECT_EQ(bitmap.array_index, vert.tex_coord.xyzw.z);
+			EXPECT_EQ(1.0f, vert.tex_coord.xyzw.w);
+			EXPECT_EQ(bitmap.radius, vert.radius);
+			EXPECT_EQ(bitmap.r, vert.r);
+			EXPECT_EQ(bitmap.a, vert.a);
+		}
+	}
+}
+
+TEST(BatchingTest, rotated_bitmaps_turn_around_the_view_direction)
+{
+	std::mt19937 rng(2);
+	SCP_vector<batch_view> views;
+	views.push_back(random_view(rng));
+
+	batch_bitmap bitmap;
+	vm_vec_scale_add(&bitmap.position, &views[0].position, &views[0].orient.vec.fvec, 100.0f);
+	bitmap.radius = 10.0f;
+	bitmap.depth = 0.0f;
+	bitmap.angle = 0.0f;
+	bitmap.array_index = 0.0f;
+	bitmap.r = bitmap.g = bitmap.b = bitmap.a = 255;
+	bitmap.view = 0;
+	bitmap.orient = 0;
+	bitmap.rotated = true;
+
+	batch_vertex unrotated[6];
+	batching_expand_bitmaps(&bitmap, 1, views.data(), unrotated);
+
+	// without an angle the same corners are used as by a bitmap which is not rotated
+	batch_bitmap flat = bitmap;
+	flat.rotated = false;
+	batch_vertex expected[6];
+	batching_expand_bitmaps(&flat, 1, views.data(), expected);
+
+	// rotated bitmaps emit the corners 0, 1, 3 and 1, 2, 3
+	const int expected_index[6] = {5, 4, 0, 4, 1, 0};
+	for (int j = 0; j < 6; j++) {
+		expect_vec_near(expected[expected_index[j]].position, unrotated[j].position);
+		EXPECT_EQ(expected[expected_index[j]].tex_coord.xyzw.x, unrotated[j].tex_coord.xyzw.x);
+		EXPECT_EQ(expected[expected_index[j]].tex_coord.xyzw.y, unrotated[j].tex_coord.xyzw.y);
+	}
+
+	// a quarter turn turns every corner by 90 degrees around the center
+	bitmap.angle = PI_2;
+	batch_vertex rotated[6];
+	batching_expand_bitmaps(&bitmap, 1, views.data(), rotated);
+
+	for (int j = 0; j < 6; j++) {
+		vec3d from_center, unrotated_from_center;
+		vm_vec_sub(&from_center, &rotated[j].position, &bitmap.position);
+		vm_vec_sub(&unrotated_from_center, &unrotated[j].position, &bitmap.position);
+
+		EXPECT_NEAR(vm_vec_mag(&unrotated_from_center), vm_vec_mag(&from_center), 1e-3f);
+		EXPECT_NEAR(0.0f, vm_vec_dot(&from_center, &unrotated_from_center), 1e-2f);
+		EXPECT_NEAR(0.0f, vm_vec_dot(&from_center, &views[0].orient.vec.fvec), 1e-3f);
+	}
+}
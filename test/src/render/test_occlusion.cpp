@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+
+#include "render/occlusion.h"
+
+#include <random>
+
+namespace {
+
+// The twelve triangles of a closed box, the way a hull is handed to occluder_build()
+SCP_vector<vec3d> box_triangles(const vec3d& min, const vec3d& max)
+{
+	auto corner = [&](int i) {
+		vec3d v;
+		v.xyz.x = (i & 1) ? max.xyz.x : min.xyz.x;
+		v.xyz.y = (i & 2) ? max.xyz.y : min.xyz.y;
+		v.xyz.z = (i & 4) ? max.xyz.z : min.xyz.z;
+		return v;
+	};
+
+	const int faces[6][4] = {
+		{0, 2, 6, 4}, {1, 5, 7, 3}, {0, 4, 5, 1}, {2, 3, 7, 6}, {0, 1, 3, 2}, {4, 6, 7, 5},
+	};
+
+	SCP_vector<vec3d> tris;
+	for (const auto& face : faces) {
+		for (int i : {0, 1, 2, 0, 2, 3}) {
+			tris.push_back(corner(face[i]));
+		}
+	}
+	return tris;
+}
+
+void mesh_bounds(const occluder_mesh& mesh, vec3d* min, vec3d* max)
+{
+	*min = *max = mesh.verts[0];
+	for (const auto& v : mesh.verts) {
+		for (int a = 0; a < 3; ++a) {
+			min->a1d[a] = std::min(min->a1d[a], v.a1d[a]);
+			max->a1d[a] = std::max(max->a1d[a], v.a1d[a]);
+		}
+	}
+}
+
+// Whether the segment from the origin to the point passes through the box
+bool segment_hits_box(const vec3d& point, const vec3d& min, const vec3d& max)
+{
+	float enter = 0.0f;
+	float leave = 1.0f;
+
+	for (int a = 0; a < 3; ++a) {
+		if (point.a1d[a] == 0.0f) {
+			if (min.a1d[a] > 0.0f || max.a1d[a] < 0.0f) {
+				return false;
+			}
+			continue;
+		}
+
+		float t0 = min.a1d[a] / point.a1d[a];
+		float t1 = max.a1d[a] / point.a1d[a];
+		enter = std::max(enter, std::min(t0, t1));
+		leave = std::min(leave, std::max(t0, t1));
+	}
+
+	return enter <= leave;
+}
+
+vec3d make_vec(float x, float y, float z)
+{
+	vec3d v;
+	v.xyz.x = x;
+	v.xyz.y = y;
+	v.xyz.z = z;
+	return v;
+}
+
+class OcclusionTest : public ::testing::Test {
+  protected:
+	void SetUp() override
+	{
+		hull_min = make_vec(-50.0f, -50.0f, 150.0f);
+		hull_max = make_vec(50.0f, 50.0f, 250.0f);
+
+		vec3d model_min = make_vec(-50.0f, -50.0f, -50.0f);
+		vec3d model_max = make_vec(50.0f, 50.0f, 50.0f);
+		occluder_build(&occluder, box_triangles(model_min, model_max), &model_min, &model_max, 10, 8);
+		ASSERT_FALSE(occluder.empty());
+
+		vec3d pos = make_vec(0.0f, 0.0f, 200.0f);
+		buffer.begin(&vmd_zero_vector, &vmd_identity_matrix);
+		buffer.add_occluder(occluder, &pos, &vmd_identity_matrix);
+		buffer.finish();
+
+		mesh_bounds(occluder, &occluder_min, &occluder_max);
+		vm_vec_add2(&occluder_min, &pos);
+		vm_vec_add2(&occluder_max, &pos);
+	}
+
+	vec3d hull_min, hull_max;
+	occluder_mesh occluder;
+	vec3d occluder_min, occluder_max;	// in world space
+	occlusion_buffer buffer;
+};
+
+} // namespace
+
+TEST_F(OcclusionTest, occluder_lies_inside_the_hull)
+{
+	// the inside of a box is one box
+	ASSERT_EQ(1, occluder.get_num_boxes());
+
+	for (int a = 0; a < 3; ++a) {
+		EXPECT_GE(occluder_min.a1d[a], hull_min.a1d[a]);
+		EXPECT_LE(occluder_max.a1d[a], hull_max.a1d[a]);
+
+		// most of the box is filled
+		EXPECT_GE(occluder_max.a1d[a] - occluder_min.a1d[a], 70.0f);
+	}
+
+	// the corners are numbered by their x, y and z bits
+	for (int i = 0; i < 8; ++i) {
+		for (int a = 0; a < 3; ++a) {
+			EXPECT_EQ(((i >> a) & 1) ? occluder.verts[7].a1d[a] : occluder.verts[0].a1d[a], occluder.verts[i].a1d[a]);
+		}
+	}
+}
+
+TEST_F(OcclusionTest, open_surface_builds_no_occluder)
+{
+	SCP_vector<vec3d> tris = {make_vec(-10.0f, -10.0f, 0.0f), make_vec(10.0f, -10.0f, 0.0f), make_vec(0.0f, 10.0f, 0.0f)};
+	vec3d min = make_vec(-10.0f, -10.0f, -1.0f);
+	vec3d max = make_vec(10.0f, 10.0f, 1.0f);
+
+	occluder_mesh mesh;
+	occluder_build(&mesh, tris, &min, &max, 8, 8);
+
+	EXPECT_TRUE(mesh.empty());
+}
+
+TEST_F(OcclusionTest, notch_narrower_than_a_cell_stays_open)
+{
+	// a U with a slot from x = 3 to 7 at the top, inside the cell from x = 0 to 10 of the grid
+	vec3d min = make_vec(-50.0f, -50.0f, -50.0f);
+	vec3d max = make_vec(50.0f, 50.0f, 50.0f);
+
+	SCP_vector<vec3d> tris;
+	auto add = [&tris](const vec3d& box_min, const vec3d& box_max) {
+		auto box = box_triangles(box_min, box_max);
+		tris.insert(tris.end(), box.begin(), box.end());
+	};
+	add(make_vec(-50.0f, -50.0f, -50.0f), make_vec(3.0f, 50.0f, 50.0f));
+	add(make_vec(3.0f, -50.0f, -50.0f), make_vec(7.0f, -20.0f, 50.0f));
+	add(make_vec(7.0f, -50.0f, -50.0f), make_vec(50.0f, 50.0f, 50.0f));
+
+	occluder_mesh mesh;
+	occluder_build(&mesh, tris, &min, &max, 10, 16);
+	ASSERT_FALSE(mesh.empty());
+
+	// no box reaches into the slot
+	for (size_t i = 0; i < mesh.verts.size(); i += 8) {
+		const auto& box_min = mesh.verts[i];
+		const auto& box_max = mesh.verts[i + 7];
+
+		bool in_slot = box_min.xyz.x < 7.0f && box_max.xyz.x > 3.0f && box_max.xyz.y > -20.0f;
+		EXPECT_FALSE(in_slot);
+	}
+
+	// what is behind the slot can be seen through it, what is behind the sides cannot
+	occlusion_buffer u_buffer;
+	vec3d pos = make_vec(0.0f, 0.0f, 200.0f);
+	u_buffer.begin(&vmd_zero_vector, &vmd_identity_matrix);
+	u_buffer.add_occluder(mesh, &pos, &vmd_identity_matrix);
+	u_buffer.finish();
+
+	vec3d behind_slot = make_vec(15.0f, 0.0f, 600.0f);
+	EXPECT_FALSE(u_buffer.sphere_occluded(&behind_slot, 0.5f));
+
+	vec3d behind_side = make_vec(-60.0f, 0.0f, 600.0f);
+	EXPECT_TRUE(u_buffer.sphere_occluded(&behind_side, 0.5f));
+}
+
+TEST_F(OcclusionTest, only_spheres_fully_behind_are_occluded)
+{
+	EXPECT_EQ(1, buffer.get_num_occluders());
+
+	vec3d behind = make_vec(0.0f, 0.0f, 600.0f);
+	EXPECT_TRUE(buffer.sphere_occluded(&behind, 10.0f));
+
+	vec3d in_front = make_vec(0.0f, 0.0f, 100.0f);
+	EXPECT_FALSE(buffer.sphere_occluded(&in_front, 10.0f));
+
+	vec3d beside = make_vec(400.0f, 0.0f, 600.0f);
+	EXPECT_FALSE(buffer.sphere_occluded(&beside, 10.0f));
+
+	// a sphere right on the silhouette of the occluder is partly visible
+	float silhouette = occluder_max.xyz.x / occluder_min.xyz.z;
+	vec3d on_edge = make_vec(silhouette * 600.0f, 0.0f, 600.0f);
+	EXPECT_FALSE(buffer.sphere_occluded(&on_edge, 20.0f));
+
+	// the sphere reaches around the occluder
+	EXPECT_FALSE(buffer.sphere_occluded(&behind, 400.0f));
+}
+
+TEST_F(OcclusionTest, occluded_spheres_are_hidden_everywhere)
+{
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> xy_dist(-300.0f, 300.0f);
+	std::uniform_real_distribution<float> z_dist(300.0f, 900.0f);
+	std::uniform_real_distribution<float> rad_dist(1.0f, 30.0f);
+	std::uniform_real_distribution<float> dir_dist(-1.0f, 1.0f);
+
+	int num_occluded = 0;
+	for (int i = 0; i < 2000; ++i) {
+		vec3d pos = make_vec(xy_dist(rng), xy_dist(rng), z_dist(rng));
+		float radius = rad_dist(rng);
+
+		if (!buffer.sphere_occluded(&pos, radius)) {
+			continue;
+		}
+		++num_occluded;
+
+		// every line of sight to the sphere has to pass the occluder
+		for (int j = 0; j < 100; ++j) {
+			vec3d dir = make_vec(dir_dist(rng), dir_dist(rng), dir_dist(rng));
+			if (vm_vec_normalize_safe(&dir) <= 0.0f) {
+				continue;
+			}
+
+			vec3d point;
+			vm_vec_scale_add(&point, &pos, &dir, radius);
+			ASSERT_TRUE(segment_hits_box(point, occluder_min, occluder_max));
+		}
+	}
+
+	EXPECT_GT(num_occluded, 0);
+}
+
+TEST_F(OcclusionTest, nothing_is_occluded_from_inside_the_occluder)
+{
+	vec3d center;
+	vm_vec_avg(&center, &occluder_min, &occluder_max);
+
+	occlusion_buffer inside;
+	inside.begin(&center, &vmd_identity_matrix);
+	vec3d pos = make_vec(0.0f, 0.0f, 200.0f);
+	inside.add_occluder(occluder, &pos, &vmd_identity_matrix);
+	inside.finish();
+
+	vec3d behind = make_vec(0.0f, 0.0f, 600.0f);
+	EXPECT_FALSE(inside.sphere_occluded(&behind, 10.0f));
+}
@@ -0,0 +1,88 @@
+#include "object/object.h"
+#include "scripting/global_hooks.h"
+#include "scripting/lua/LuaFunction.h"
+
+#include "scripting/ScriptingTestFixture.h"
+
+extern "C" {
+#include <lua.h>
+}
+
+namespace {
+
+class HookConditionsTest : public test::scripting::ScriptingTestFixture {
+  public:
+	HookConditionsTest() : test::scripting::ScriptingTestFixture(INIT_CFILE) {}
+
+  protected:
+	// Adds a collision hook which appends its name to the global "order" string when it runs
+	void addCollisionHook(const char* name, std::initializer_list<std::pair<const char*, const char*>> conditions)
+	{
+		const auto& hook = ::scripting::hooks::OnShipCollision;
+
+		script_action action;
+		action.hook.hook_function.language = SC_LUA;
+		action.hook.hook_function.function = luacpp::LuaFunction::createFromCode(_state->GetLuaSession(),
+			SCP_string("order = order .. '") + name + "'", name);
+		action.trace_category = _state->GetHookTraceCategory(name);
+
+		for (const auto& condition : conditions) {
+			action.local_conditions.emplace_back(hook->_conditions.at(condition.first)->parse(condition.second));
+		}
+
+		_state->AddConditionedHook(hook->getHookId(), std::move(action));
+	}
+
+	SCP_string runCollision(int type_a, int type_b)
+	{
+		object objp_a, objp_b;
+		objp_a.type = type_a;
+		objp_b.type = type_b;
+
+		EXPECT_TRUE(_state->EvalString("order = ''"));
+
+		::scripting::hooks::CollisionConditions conditions{{&objp_a, &objp_b}};
+		_state->RunCondition(::scripting::hooks::OnShipCollision->getHookId(), std::any(conditions));
+
+		auto L = _state->GetLuaSession();
+		lua_getglobal(L, "order");
+		SCP_string order = lua_tostring(L, -1);
+		lua_pop(L, 1);
+		return order;
+	}
+};
+
+} // namespace
+
+TEST_F(HookConditionsTest, indexedDispatchKeepsOrder)
+{
+	addCollisionHook("A", {{"Object type", "Ship"}});
+	addCollisionHook("B", {});
+	addCollisionHook("C", {{"Object type", "Weapon"}});
+	addCollisionHook("D", {{"Object type", "Asteroid"}});
+	addCollisionHook("E", {{"Object type", "Ship"}, {"Object type", "Weapon"}});
+	addCollisionHook("F", {{"Object type", "Invalid type"}});
+	_state->ProcessAddedHooks();
+
+	ASSERT_EQ("ABCE", runCollision(OBJ_SHIP, OBJ_WEAPON));
+	ASSERT_EQ("ABCE", runCollision(OBJ_WEAPON, OBJ_SHIP));
+	// Both objects are in the same bucket but the hook must still only run once
+	ASSERT_EQ("AB", runCollision(OBJ_SHIP, OBJ_SHIP));
+	ASSERT_EQ("BD", runCollision(OBJ_ASTEROID, OBJ_DEBRIS));
+	ASSERT_EQ("B", runCollision(OBJ_DEBRIS, OBJ_DEBRIS));
+}
+
+TEST_F(HookConditionsTest, hooksAddedLaterAreIndexed)
+{
+	addCollisionHook("A", {{"Object type", "Asteroid"}});
+	_state->ProcessAddedHooks();
+
+	ASSERT_EQ("A", runCollision(OBJ_ASTEROID, OBJ_SHIP));
+
+	addCollisionHook("B", {{"Object type", "Ship"}});
+	addCollisionHook("C", {});
+	_state->ProcessAddedHooks();
+
+	ASSERT_EQ("ABC", runCollision(OBJ_ASTEROID, OBJ_SHIP));
+	ASSERT_EQ("C", runCollision(OBJ_DEBRIS, OBJ_DEBRIS));
+}
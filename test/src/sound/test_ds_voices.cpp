@@ -0,0 +1,150 @@
+#include "sound/ds.h"
+#include "sound/ds3d.h"
+#include "sound/sound.h"
+
+#include "util/FSTestFixture.h"
+
+class DsVoicesTest : public test::FSTestFixture {
+  public:
+	DsVoicesTest() : test::FSTestFixture(INIT_NONE) {}
+
+  protected:
+	void SetUp() override
+	{
+		test::FSTestFixture::SetUp();
+
+		if (ds_init() != 0) {
+			GTEST_SKIP() << "No OpenAL playback device available.";
+		}
+		ds_initialized = TRUE;
+
+		vec3d listener = vmd_zero_vector;
+		ds3d_update_listener(&listener, nullptr, nullptr);
+	}
+
+	void TearDown() override
+	{
+		if (ds_initialized) {
+			ds_close();
+			ds_initialized = FALSE;
+		}
+
+		test::FSTestFixture::TearDown();
+	}
+
+	// One second of silence, long enough to still be playing when the test checks it
+	static int createBuffer()
+	{
+		const int frequency = 22050;
+
+		int sid = ds_create_buffer(frequency, 16, 1, 1);
+		EXPECT_GE(sid, 0);
+
+		SCP_vector<unsigned char> data(frequency * 2, 0);
+		EXPECT_EQ(0, ds_lock_data(sid, data.data(), static_cast<int>(data.size())));
+
+		return sid;
+	}
+
+	static ds_sound_handle play3d(int sid, int snd_id, float distance)
+	{
+		EnhancedSoundData data(SND_ENHANCED_PRIORITY_MEDIUM, 1000);
+
+		vec3d pos = vmd_zero_vector;
+		pos.xyz.z = distance;
+
+		return ds3d_play(sid, snd_id, &pos, nullptr, 10.0f, 2000.0f, true, 1.0f, 1.0f, &data);
+	}
+};
+
+TEST_F(DsVoicesTest, stale_handles_are_rejected)
+{
+	EnhancedSoundData data(SND_ENHANCED_PRIORITY_MEDIUM, 1000);
+
+	int sid = createBuffer();
+	auto first = ds_play(sid, 1, DS_MUST_PLAY, &data, 1.0f, 0.0f, TRUE);
+	ASSERT_TRUE(first.isValid());
+	ASSERT_GE(ds_get_channel(first), 0);
+
+	// unloading the buffer closes its channel, which frees the handle
+	ds_unload_buffer(sid);
+	ASSERT_EQ(-1, ds_get_channel_raw(first));
+
+	// the new sound gets the same voice but a different handle
+	sid = createBuffer();
+	auto second = ds_play(sid, 1, DS_MUST_PLAY, &data, 1.0f, 0.0f, TRUE);
+	ASSERT_TRUE(second.isValid());
+	ASSERT_NE(first, second);
+	ASSERT_GE(ds_get_channel_raw(second), 0);
+	ASSERT_EQ(-1, ds_get_channel_raw(first));
+	ASSERT_EQ(-1, ds_get_channel(first));
+}
+
+TEST_F(DsVoicesTest, audible_virtual_voice_takes_a_channel)
+{
+	int sid = createBuffer();
+
+	// looping sounds are never preempted, so once all channels play one the others have to go virtual
+	SCP_vector<ds_sound_handle> far_sounds;
+	for (int i = 0; i < 4096 && ds_get_number_virtual_voices() == 0; i++) {
+		auto handle = play3d(sid, i, 1000.0f);
+		ASSERT_TRUE(handle.isValid());
+		far_sounds.push_back(handle);
+	}
+	ASSERT_EQ(1, ds_get_number_virtual_voices());
+	ASSERT_TRUE(ds_is_virtual(far_sounds.back()));
+	ASSERT_EQ(-1, ds_get_channel(far_sounds.back()));
+
+	auto near_sound = play3d(sid, -1, 20.0f);
+	ASSERT_TRUE(near_sound.isValid());
+	ASSERT_TRUE(ds_is_virtual(near_sound));
+	ASSERT_EQ(2, ds_get_number_virtual_voices());
+
+	// the near sound is far more audible than any real voice, so it gets the channel of one of them
+	ds_do_frame();
+
+	ASSERT_FALSE(ds_is_virtual(near_sound));
+	ASSERT_GE(ds_get_channel(near_sound), 0);
+	ASSERT_EQ(2, ds_get_number_virtual_voices());
+
+	// the far sounds are all equally audible, so none of them is worth swapping
+	ds_do_frame();
+	ASSERT_FALSE(ds_is_virtual(near_sound));
+	ASSERT_EQ(2, ds_get_number_virtual_voices());
+
+	// virtual voices follow their source and can be stopped
+	vec3d pos = vmd_zero_vector;
+	ASSERT_TRUE(ds3d_update_voice(far_sounds.back(), 10.0f, 2000.0f, &pos, nullptr));
+
+	ds_stop_virtual(far_sounds.back());
+	ASSERT_FALSE(ds_is_virtual(far_sounds.back()));
+	ASSERT_FALSE(ds3d_update_voice(far_sounds.back(), 10.0f, 2000.0f, &pos, nullptr));
+	ASSERT_EQ(1, ds_get_number_virtual_voices());
+}
+
+TEST_F(DsVoicesTest, paused_virtual_voice_keeps_waiting)
+{
+	int sid = createBuffer();
+
+	SCP_vector<ds_sound_handle> far_sounds;
+	for (int i = 0; i < 4096 && ds_get_number_virtual_voices() == 0; i++) {
+		auto handle = play3d(sid, i, 1000.0f);
+		ASSERT_TRUE(handle.isValid());
+		far_sounds.push_back(handle);
+	}
+	ASSERT_EQ(1, ds_get_number_virtual_voices());
+
+	auto near_sound = play3d(sid, -1, 20.0f);
+	ASSERT_TRUE(ds_is_virtual(near_sound));
+
+	// a paused sound must not start playing on a channel, no matter how audible it is
+	snd_pause(near_sound);
+	ds_do_frame();
+	ASSERT_TRUE(ds_is_virtual(near_sound));
+	ASSERT_EQ(2, ds_get_number_virtual_voices());
+
+	snd_resume(near_sound);
+	ds_do_frame();
+	ASSERT_FALSE(ds_is_virtual(near_sound));
+	ASSERT_GE(ds_get_channel(near_sound), 0);
+}
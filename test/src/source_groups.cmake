@@ -13,10 +13,18 @@ add_file_folder("Actions\\\\Expression"
 	actions/expression/test_ExpressionParser.cpp
 )
 
+add_file_folder("Asteroid"
+    asteroid/test_instanced_field.cpp
+)
+
 add_file_folder("CFile"
     cfile/cfile.cpp
 )
 
+add_file_folder("DDSUtils"
+    ddsutils/test_dds_decompress.cpp
+)
+
 add_file_folder("Globalincs"
     globalincs/test_flagset.cpp
     globalincs/test_safe_strings.cpp
@@ -67,6 +75,10 @@ add_file_folder("Graphics"
 )
 endif()
 
+add_file_folder("Lighting"
+    lighting/test_light_filter.cpp
+)
+
 add_file_folder("Math"
     math/test_vecmat.cpp
 )
@@ -80,9 +92,18 @@ add_file_folder("mod"
 )
 
 add_file_folder("model"
+    model/test_model_draw_list_instancing.cpp
     model/test_modelread.cpp
 )
 
+add_file_folder("Network"
+    network/test_multiutil.cpp
+)
+
+add_file_folder("Object"
+    object/test_object_render_cull.cpp
+)
+
 add_file_folder("Parse"
     parse/test_parselo.cpp
     parse/test_replace.cpp
@@ -92,11 +113,17 @@ add_file_folder("Pilotfile"
     pilotfile/plr.cpp
 )
 
+add_file_folder("Render"
+    render/test_batching.cpp
+    render/test_occlusion.cpp
+)
+
 add_file_folder("Scripting"
     scripting/ade_args.cpp
     scripting/doc_parser.cpp
     scripting/require.cpp
     scripting/script_state.cpp
+    scripting/test_hook_conditions.cpp
     scripting/ScriptingTestFixture.h
     scripting/ScriptingTestFixture.cpp
 )
@@ -121,16 +148,26 @@ add_file_folder("Scripting\\\\Lua"
     scripting/lua/Value.cpp
 )
 
+add_file_folder("Sound"
+    sound/test_ds_voices.cpp
+)
+
 add_file_folder("Test Util"
     util/FSTestFixture.cpp
     util/FSTestFixture.h
     util/test_util.h
 )
 
+add_file_folder("Tracing"
+    tracing/test_binary_trace.cpp
+)
+
 add_file_folder("Utils"
     utils/HeapAllocatorTest.cpp
+    utils/test_radix_sort.cpp
 )
 
 add_file_folder("Weapon"
+    weapon/test_area_effect.cpp
     weapon/weapons.cpp
 )
@@ -0,0 +1,167 @@
+
+#include <gtest/gtest.h>
+
+#include "libs/jansson.h"
+#include "tracing/BinaryTrace.h"
+#include "tracing/ThreadedEventProcessor.h"
+#include "tracing/TraceEventWriter.h"
+
+#include <cstdio>
+#include <memory>
+
+using namespace tracing;
+
+namespace {
+Category TestCategory("Test category", false);
+Category OtherCategory("Other category", true);
+Scope TestScope("test_scope");
+
+trace_event make_event(const Category& category, EventType type, std::uint64_t timestamp, std::int64_t tid) {
+	trace_event evt;
+	evt.category = &category;
+	evt.type = type;
+	evt.timestamp = timestamp;
+	evt.tid = tid;
+	evt.pid = 1234;
+	return evt;
+}
+
+struct counting_processor {
+	SCP_vector<SCP_vector<std::uint64_t>>* ids_per_thread;
+
+	explicit counting_processor(SCP_vector<SCP_vector<std::uint64_t>>* ids) : ids_per_thread(ids) {}
+
+	void processEvent(const trace_event* event) {
+		(*ids_per_thread)[static_cast<size_t>(event->tid)].push_back(event->event_id);
+	}
+};
+}
+
+TEST(BinaryTraceTests, zigzag) {
+	const std::int64_t values[] = {0, 1, -1, 1000000, -1000000, std::numeric_limits<std::int64_t>::max(),
+		std::numeric_limits<std::int64_t>::min()};
+
+	for (auto value : values) {
+		ASSERT_EQ(value, binary::zigzag_decode(binary::zigzag_encode(value)));
+	}
+
+	// Small magnitudes must stay small so they fit in a single varint byte
+	ASSERT_EQ((std::uint64_t)1, binary::zigzag_encode(-1));
+	ASSERT_EQ((std::uint64_t)2, binary::zigzag_encode(1));
+}
+
+TEST(BinaryTraceTests, convertToJson) {
+	const char* binary_path = "test_trace.bin";
+	const char* json_path = "test_trace.json";
+
+	{
+		TraceEventWriter writer(binary_path);
+
+		auto complete = make_event(TestCategory, EventType::Complete, 5000000, 1);
+		complete.duration = 2500000;
+		writer.processEvent(&complete);
+
+		// Shorter than a microsecond so this is not written
+		auto tiny = make_event(TestCategory, EventType::Complete, 5100000, 1);
+		tiny.duration = 10;
+		writer.processEvent(&tiny);
+
+		// Timestamps of different threads are not ordered
+		auto async = make_event(OtherCategory, EventType::AsyncBegin, 4000000, 2);
+		async.scope = &TestScope;
+		writer.processEvent(&async);
+
+		auto counter = make_event(OtherCategory, EventType::Counter, 6000000, 1);
+		counter.value = 42.5f;
+		writer.processEvent(&counter);
+
+		auto gpu = make_event(TestCategory, EventType::Begin, 7000000, 1);
+		gpu.pid = GPU_PID;
+		writer.processEvent(&gpu);
+	}
+
+	SCP_string error;
+	ASSERT_TRUE(binary::convert_to_json(binary_path, json_path, error));
+	ASSERT_TRUE(error.empty());
+
+	json_error_t json_error;
+	std::unique_ptr<json_t> root(json_load_file(json_path, 0, &json_error));
+	ASSERT_TRUE(root != nullptr) << json_error.text;
+	ASSERT_TRUE(json_is_array(root.get()));
+	ASSERT_EQ((size_t)4, json_array_size(root.get()));
+
+	auto complete = json_array_get(root.get(), 0);
+	ASSERT_STREQ("Test category", json_string_value(json_object_get(complete, "name")));
+	ASSERT_STREQ("X", json_string_value(json_object_get(complete, "ph")));
+	ASSERT_DOUBLE_EQ(5000.0, json_number_value(json_object_get(complete, "ts")));
+	ASSERT_DOUBLE_EQ(2500.0, json_number_value(json_object_get(complete, "dur")));
+	ASSERT_EQ(1234, json_integer_value(json_object_get(complete, "pid")));
+	ASSERT_EQ(1, json_integer_value(json_object_get(complete, "tid")));
+
+	auto async = json_array_get(root.get(), 1);
+	ASSERT_STREQ("b", json_string_value(json_object_get(async, "ph")));
+	ASSERT_STREQ("test_scope", json_string_value(json_object_get(async, "cat")));
+	ASSERT_DOUBLE_EQ(4000.0, json_number_value(json_object_get(async, "ts")));
+	ASSERT_EQ(2, json_integer_value(json_object_get(async, "tid")));
+
+	auto counter = json_array_get(root.get(), 2);
+	ASSERT_STREQ("C", json_string_value(json_object_get(counter, "ph")));
+	ASSERT_DOUBLE_EQ(42.5, json_number_value(json_object_get(json_object_get(counter, "args"), "value")));
+
+	auto gpu = json_array_get(root.get(), 3);
+	ASSERT_STREQ("B", json_string_value(json_object_get(gpu, "ph")));
+	ASSERT_STREQ("GPU", json_string_value(json_object_get(gpu, "pid")));
+
+	std::remove(binary_path);
+	std::remove(json_path);
+}
+
+TEST(BinaryTraceTests, rejectsInvalidFile) {
+	const char* binary_path = "test_invalid_trace.bin";
+	const char* json_path = "test_invalid_trace.json";
+
+	auto fp = fopen(binary_path, "wb");
+	ASSERT_TRUE(fp != nullptr);
+	fputs("not a trace", fp);
+	fclose(fp);
+
+	SCP_string error;
+	ASSERT_FALSE(binary::convert_to_json(binary_path, json_path, error));
+	ASSERT_FALSE(error.empty());
+
+	std::remove(binary_path);
+}
+
+TEST(ThreadedEventProcessorTests, keepsPerThreadOrder) {
+	const int NUM_THREADS = 4;
+	// Fewer events than the buffer size so nothing can be dropped
+	const int EVENTS_PER_THREAD = 1000;
+
+	SCP_vector<SCP_vector<std::uint64_t>> ids(NUM_THREADS);
+
+	{
+		ThreadedEventProcessor<counting_processor, 1024> processor(&ids);
+
+		SCP_vector<std::thread> threads;
+		for (int t = 0; t < NUM_THREADS; ++t) {
+			threads.emplace_back([&processor, t]() {
+				for (int i = 0; i < EVENTS_PER_THREAD; ++i) {
+					auto evt = make_event(TestCategory, EventType::Complete, 0, t);
+					evt.event_id = static_cast<std::uint64_t>(i);
+					processor.processEvent(&evt);
+				}
+			});
+		}
+
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+
+	for (int t = 0; t < NUM_THREADS; ++t) {
+		ASSERT_EQ((size_t)EVENTS_PER_THREAD, ids[t].size());
+		for (int i = 0; i < EVENTS_PER_THREAD; ++i) {
+			ASSERT_EQ((std::uint64_t)i, ids[t][i]);
+		}
+	}
+}
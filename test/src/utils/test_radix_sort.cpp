@@ -0,0 +1,84 @@
+
+#include <gtest/gtest.h>
+#include <random>
+
+#include "utils/radix_sort.h"
+
+using namespace util;
+
+namespace {
+struct keyed_item {
+	uint64_t key;
+	int index;
+};
+
+uint64_t item_key(const keyed_item& item) { return item.key; }
+}
+
+TEST(RadixSortTests, emptyAndSingle) {
+	SCP_vector<keyed_item> values;
+	SCP_vector<keyed_item> scratch;
+
+	radix_sort(values, scratch, item_key);
+	ASSERT_TRUE(values.empty());
+
+	values.push_back({42, 0});
+	radix_sort(values, scratch, item_key);
+	ASSERT_EQ((size_t)1, values.size());
+	ASSERT_EQ((uint64_t)42, values[0].key);
+}
+
+TEST(RadixSortTests, matchesStableSort) {
+	std::mt19937_64 gen(1234);
+
+	SCP_vector<keyed_item> values;
+	for (int i = 0; i < 5000; ++i) {
+		// Only use a few distinct keys in the high bits so that stability is actually exercised
+		uint64_t key = (gen() % 16) << 58 | (gen() % 8);
+		values.push_back({key, i});
+	}
+
+	auto expected = values;
+	std::stable_sort(expected.begin(), expected.end(),
+		[](const keyed_item& a, const keyed_item& b) { return a.key < b.key; });
+
+	SCP_vector<keyed_item> scratch;
+	radix_sort(values, scratch, item_key);
+
+	ASSERT_EQ(expected.size(), values.size());
+	for (size_t i = 0; i < values.size(); ++i) {
+		ASSERT_EQ(expected[i].key, values[i].key);
+		ASSERT_EQ(expected[i].index, values[i].index);
+	}
+}
+
+TEST(RadixSortTests, fullWidthKeys) {
+	std::mt19937_64 gen(5678);
+
+	SCP_vector<uint64_t> values;
+	for (int i = 0; i < 10000; ++i) {
+		values.push_back(gen());
+	}
+
+	auto expected = values;
+	std::sort(expected.begin(), expected.end());
+
+	SCP_vector<uint64_t> scratch;
+	radix_sort(values, scratch, [](uint64_t v) { return v; });
+
+	ASSERT_EQ(expected, values);
+}
+
+TEST(RadixSortTests, identicalKeysKeepOrder) {
+	SCP_vector<keyed_item> values;
+	for (int i = 0; i < 300; ++i) {
+		values.push_back({0xDEADBEEFull, i});
+	}
+
+	SCP_vector<keyed_item> scratch;
+	radix_sort(values, scratch, item_key);
+
+	for (int i = 0; i < 300; ++i) {
+		ASSERT_EQ(i, values[i].index);
+	}
+}
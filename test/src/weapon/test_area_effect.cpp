@@ -0,0 +1,594 @@
+#include <gtest/gtest.h>
+
+#include "model/model.h"
+#include "object/object.h"
+#include "ship/ship.h"
+#include "weapon/shockwave.h"
+#include "weapon/weapon.h"
+
+#include <algorithm>
+#include <random>
+
+extern polymodel* Polygon_models[MAX_POLYGON_MODELS];
+extern shockwave Shockwaves[MAX_SHOCKWAVES];
+extern SCP_vector<shockwave_info> Shockwave_info;
+
+// Only called by the weapon code itself so they are not in the headers
+extern void weapon_do_area_effect(object* wobjp, const shockwave_create_info* sci, const vec3d* pos, const object* impacted_obj);
+extern void shockwave_move(object* shockwave_objp, float frametime);
+
+namespace {
+
+const int NUM_TARGETS = 500;
+
+const int NUM_SHIPS = 40;
+
+// Half the edge length of the cube the objects are scattered in
+const float FIELD_EXTENT = 2000.0f;
+
+struct area_damage_total {
+	int hits = 0;
+	float damage = 0.0f;
+	float blast = 0.0f;
+};
+
+bool can_take_area_damage(const object* objp)
+{
+	return objp->type == OBJ_ASTEROID || objp->type == OBJ_SHIP;
+}
+
+void add_damage(area_damage_total& total, const object* objp, const vec3d* pos, float inner_rad, float outer_rad,
+	float limit)
+{
+	float damage, blast;
+	if (weapon_area_calc_damage(objp, pos, inner_rad, outer_rad, 100.0f, 250.0f, &blast, &damage, limit) == -1) {
+		return;
+	}
+
+	++total.hits;
+	total.damage += damage;
+	total.blast += blast;
+}
+
+void create_targets(std::mt19937& rng, int count)
+{
+	std::uniform_real_distribution<float> pos_dist(-FIELD_EXTENT, FIELD_EXTENT);
+	std::uniform_real_distribution<float> radius_dist(2.0f, 80.0f);
+
+	flagset<Object::Object_Flags> flags;
+	flags.set(Object::Object_Flags::Collides);
+
+	for (int i = 0; i < count; ++i) {
+		vec3d pos;
+		pos.xyz.x = pos_dist(rng);
+		pos.xyz.y = pos_dist(rng);
+		pos.xyz.z = pos_dist(rng);
+
+		// Points can never be damaged so they must never show up as candidates
+		auto type = (i % 10 == 0) ? OBJ_POINT : OBJ_ASTEROID;
+
+		ASSERT_GE(obj_create(type, -1, -1, &vmd_identity_matrix, &pos, radius_dist(rng), flags), 0);
+	}
+
+	obj_merge_created_list();
+}
+
+// Ships use their bounding box instead of their radius, so give them a long and thin model which is rotated
+// differently for every ship
+class area_effect_ship_setup {
+  public:
+	area_effect_ship_setup()
+	{
+		model_num = 0;
+		while (Polygon_models[model_num] != nullptr) {
+			++model_num;
+		}
+
+		auto pm = new polymodel();
+		pm->id = model_num;
+		pm->mins.xyz.x = -20.0f;
+		pm->mins.xyz.y = -10.0f;
+		pm->mins.xyz.z = -150.0f;
+		pm->maxs.xyz.x = 20.0f;
+		pm->maxs.xyz.y = 10.0f;
+		pm->maxs.xyz.z = 250.0f;
+		pm->rad = 260.0f;
+		Polygon_models[model_num] = pm;
+
+		ship_info_index = static_cast<int>(Ship_info.size());
+		Ship_info.emplace_back();
+		Ship_info.back().model_num = model_num;
+	}
+
+	~area_effect_ship_setup()
+	{
+		for (int i = 0; i < NUM_SHIPS; ++i) {
+			Ships[i].ship_info_index = -1;
+		}
+
+		Ship_info.pop_back();
+
+		delete Polygon_models[model_num];
+		Polygon_models[model_num] = nullptr;
+	}
+
+	void create_ships(std::mt19937& rng)
+	{
+		std::uniform_real_distribution<float> pos_dist(-FIELD_EXTENT, FIELD_EXTENT);
+		std::uniform_real_distribution<float> angle_dist(0.0f, PI2);
+
+		flagset<Object::Object_Flags> flags;
+		flags.set(Object::Object_Flags::Collides);
+
+		for (int i = 0; i < NUM_SHIPS; ++i) {
+			vec3d pos;
+			pos.xyz.x = pos_dist(rng);
+			pos.xyz.y = pos_dist(rng);
+			pos.xyz.z = pos_dist(rng);
+
+			angles angs;
+			angs.p = angle_dist(rng);
+			angs.b = angle_dist(rng);
+			angs.h = angle_dist(rng);
+
+			matrix orient;
+			vm_angles_2_matrix(&orient, &angs);
+
+			Ships[i].ship_info_index = ship_info_index;
+
+			// The radius is deliberately smaller than the bounding box so only the box can make them candidates
+			ASSERT_GE(obj_create(OBJ_SHIP, -1, i, &orient, &pos, 60.0f, flags), 0);
+		}
+
+		obj_merge_created_list();
+	}
+
+  private:
+	int model_num = -1;
+	int ship_info_index = -1;
+};
+
+void check_area_effect(const vec3d* pos, float inner_rad, float outer_rad, float limit)
+{
+	area_damage_total expected;
+	for (auto objp : list_range(&obj_used_list)) {
+		if (can_take_area_damage(objp)) {
+			add_damage(expected, objp, pos, inner_rad, outer_rad, limit);
+		}
+	}
+
+	// Shockwaves look up the objects within their current radius, blasts within their outer radius
+	SCP_vector<object*> candidates;
+	weapon_area_find_candidates(pos, MIN(outer_rad, limit), candidates);
+
+	area_damage_total actual;
+	const object* last = nullptr;
+	for (auto objp : candidates) {
+		ASSERT_TRUE(can_take_area_damage(objp));
+
+		// The candidates have to be in list order so the damage is applied in the same order as before
+		if (last != nullptr) {
+			bool in_order = false;
+			for (auto next = GET_NEXT(last); next != END_OF_LIST(&obj_used_list); next = GET_NEXT(next)) {
+				if (next == objp) {
+					in_order = true;
+					break;
+				}
+			}
+			ASSERT_TRUE(in_order);
+		}
+		last = objp;
+
+		add_damage(actual, objp, pos, inner_rad, outer_rad, limit);
+	}
+
+	// Same objects in the same order, so even the float sums have to be bit identical
+	ASSERT_EQ(expected.hits, actual.hits);
+	ASSERT_EQ(expected.damage, actual.damage);
+	ASSERT_EQ(expected.blast, actual.blast);
+}
+
+vec3d random_position(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> pos_dist(-FIELD_EXTENT, FIELD_EXTENT);
+
+	vec3d pos;
+	pos.xyz.x = pos_dist(rng);
+	pos.xyz.y = pos_dist(rng);
+	pos.xyz.z = pos_dist(rng);
+	return pos;
+}
+
+void check_random_blasts(std::mt19937& rng, int count)
+{
+	std::uniform_real_distribution<float> radius_dist(10.0f, 600.0f);
+
+	for (int i = 0; i < count; ++i) {
+		auto pos = random_position(rng);
+
+		auto outer_rad = radius_dist(rng);
+		auto inner_rad = outer_rad * 0.25f;
+
+		check_area_effect(&pos, inner_rad, outer_rad, outer_rad);
+		if (::testing::Test::HasFatalFailure()) {
+			return;
+		}
+	}
+}
+
+void check_random_shockwaves(std::mt19937& rng, int count)
+{
+	std::uniform_real_distribution<float> radius_dist(10.0f, 600.0f);
+	std::uniform_real_distribution<float> progress_dist(0.0f, 1.0f);
+
+	for (int i = 0; i < count; ++i) {
+		auto pos = random_position(rng);
+
+		auto outer_rad = radius_dist(rng);
+		auto inner_rad = outer_rad * 0.25f;
+
+		// A shockwave only damages what its expanding front has reached so far
+		auto current_rad = outer_rad * progress_dist(rng);
+
+		check_area_effect(&pos, inner_rad, outer_rad, current_rad);
+		if (::testing::Test::HasFatalFailure()) {
+			return;
+		}
+	}
+}
+
+// Moves some objects without a new movement pass, like physics and collision responses do while area effects can happen
+void move_objects_in_pass(std::mt19937& rng, int every_nth)
+{
+	std::uniform_real_distribution<float> nudge_dist(-5.0f, 5.0f);
+
+	int count = 0;
+	for (auto objp : list_range(&obj_used_list)) {
+		if (count % every_nth == 0) {
+			// far enough to leave the cells it was in
+			objp->pos = random_position(rng);
+		} else {
+			// or just a little within its slack
+			objp->pos.xyz.x += nudge_dist(rng);
+			objp->pos.xyz.y += nudge_dist(rng);
+		}
+		weapon_area_object_moved(objp);
+		++count;
+	}
+}
+
+// Missiles with hitpoints take the damage of area effects directly from their hull strength, so they make it easy to
+// check the damage weapon_do_area_effect() and shockwave_move() actually applied
+class area_effect_missile_setup {
+  public:
+	area_effect_missile_setup()
+	{
+		weapon_info_index = static_cast<int>(Weapon_info.size());
+		Weapon_info.emplace_back();
+
+		auto& wi = Weapon_info.back();
+		wi.weapon_hitpoints = 10;
+		wi.armor_type_idx = -1;
+		wi.wi_flags.set(Weapon::Info_Flags::Takes_blast_damage);
+		wi.wi_flags.set(Weapon::Info_Flags::Takes_shockwave_damage);
+
+		if (Shockwave_info.empty()) {
+			Shockwave_info.emplace_back();
+			added_shockwave_info = true;
+		}
+	}
+
+	~area_effect_missile_setup()
+	{
+		for (int i = 0; i < MAX_WEAPONS; ++i) {
+			Weapons[i].weapon_info_index = -1;
+		}
+		Shockwaves[0].flags = 0;
+
+		Weapon_info.pop_back();
+		if (added_shockwave_info) {
+			Shockwave_info.pop_back();
+		}
+	}
+
+	// Weapon 0 is the one exploding, the others are its targets
+	void create_missiles(std::mt19937& rng, int count)
+	{
+		flagset<Object::Object_Flags> flags;
+		flags.set(Object::Object_Flags::Collides);
+
+		for (int i = 0; i <= count; ++i) {
+			Weapons[i].weapon_info_index = weapon_info_index;
+			Weapons[i].team = (i == 0) ? 1 : 0;
+
+			auto pos = random_position(rng);
+			int objnum = obj_create(OBJ_WEAPON, -1, i, &vmd_identity_matrix, &pos, 5.0f, flags);
+			ASSERT_GE(objnum, 0);
+			Objects[objnum].hull_strength = 1.0e6f;
+
+			if (i == 0) {
+				blast_objnum = objnum;
+			}
+		}
+
+		obj_merge_created_list();
+	}
+
+	// What applying the area effect to every object in the list, like before the grid, would leave of their hulls
+	SCP_vector<float> expected_hulls(const vec3d* pos, float inner_rad, float outer_rad, float limit) const
+	{
+		SCP_vector<float> hulls;
+		for (auto objp : list_range(&obj_used_list)) {
+			float hull = objp->hull_strength;
+
+			float damage, blast;
+			if (objp->type == OBJ_WEAPON && OBJ_INDEX(objp) != blast_objnum
+				&& weapon_area_calc_damage(objp, pos, inner_rad, outer_rad, 100.0f, 250.0f, &blast, &damage, limit) != -1) {
+				hull -= damage;
+			}
+			hulls.push_back(hull);
+		}
+		return hulls;
+	}
+
+	void check_hulls(const SCP_vector<float>& expected) const
+	{
+		size_t i = 0;
+		for (auto objp : list_range(&obj_used_list)) {
+			ASSERT_LT(i, expected.size());
+			ASSERT_EQ(expected[i], objp->hull_strength);
+			++i;
+		}
+	}
+
+	void check_blast(const vec3d* pos, float inner_rad, float outer_rad)
+	{
+		auto expected = expected_hulls(pos, inner_rad, outer_rad, outer_rad);
+
+		shockwave_create_info sci;
+		shockwave_create_info_init(&sci);
+		sci.inner_rad = inner_rad;
+		sci.outer_rad = outer_rad;
+		sci.damage = 250.0f;
+		sci.blast = 100.0f;
+
+		// the exploding missile itself would be hit as well, keep it out of range of the check
+		Objects[blast_objnum].flags.remove(Object::Object_Flags::Collides);
+		weapon_do_area_effect(&Objects[blast_objnum], &sci, pos, nullptr);
+
+		check_hulls(expected);
+	}
+
+	void check_shockwave(std::mt19937& rng, const vec3d* pos, float inner_rad, float outer_rad)
+	{
+		Objects[blast_objnum].flags.remove(Object::Object_Flags::Collides);
+
+		auto sw = &Shockwaves[0];
+		sw->flags = SW_USED;
+		sw->speed = outer_rad / 4.0f;
+		sw->inner_radius = inner_rad;
+		sw->outer_radius = outer_rad;
+		sw->damage = 250.0f;
+		sw->blast = 100.0f;
+		sw->radius = 1.0f;
+		sw->pos = *pos;
+		sw->obj_sig_hitlist.clear();
+		sw->shockwave_info_index = 0;
+		sw->weapon_info_index = -1;
+		sw->time_elapsed = 0.0f;
+		sw->total_time = outer_rad / sw->speed;
+		sw->delay_stamp = -1;
+		sw->blast_sound_id = gamesnd_id();
+
+		flagset<Object::Object_Flags> flags;
+		int objnum = obj_create(OBJ_SHOCKWAVE, -1, 0, &vmd_identity_matrix, pos, outer_rad, flags);
+		ASSERT_GE(objnum, 0);
+		obj_merge_created_list();
+
+		// the expanding front hits more objects every frame, while some objects move around in between
+		for (int frame = 0; frame < 3; ++frame) {
+			float radius = MIN(sw->radius + sw->speed, outer_rad);
+			auto expected = expected_hulls(pos, inner_rad, outer_rad, radius);
+
+			shockwave_move(&Objects[objnum], 1.0f);
+			ASSERT_EQ(radius, sw->radius);
+			check_hulls(expected);
+			if (::testing::Test::HasFatalFailure()) {
+				return;
+			}
+
+			move_objects_in_pass(rng, 7);
+		}
+
+		// the shockwave was never added to the shockwave list, so don't let obj_delete() remove it from there
+		Objects[objnum].type = OBJ_POINT;
+		Objects[objnum].flags.set(Object::Object_Flags::Should_be_dead);
+		obj_delete_all_that_should_be_dead();
+		sw->flags = 0;
+	}
+
+  private:
+	int weapon_info_index = -1;
+	int blast_objnum = -1;
+	bool added_shockwave_info = false;
+};
+
+} // namespace
+
+TEST(WeaponAreaEffectTest, candidates_match_full_scan)
+{
+	obj_init();
+
+	std::mt19937 rng(1);
+	create_targets(rng, NUM_TARGETS);
+
+	check_random_blasts(rng, 200);
+
+	obj_init();
+}
+
+TEST(WeaponAreaEffectTest, candidates_follow_object_list_changes)
+{
+	obj_init();
+
+	std::mt19937 rng(2);
+	create_targets(rng, NUM_TARGETS);
+	check_random_blasts(rng, 50);
+
+	// New objects have to show up after they were merged into the used list
+	create_targets(rng, NUM_TARGETS / 2);
+	check_random_blasts(rng, 50);
+
+	// and deleted objects have to disappear, these are turned into points first since the test asteroids have no
+	// asteroid instance which could be deleted
+	int count = 0;
+	for (auto objp : list_range(&obj_used_list)) {
+		if (count % 3 == 0) {
+			objp->type = OBJ_POINT;
+			objp->flags.set(Object::Object_Flags::Should_be_dead);
+		}
+		++count;
+	}
+	obj_delete_all_that_should_be_dead();
+	check_random_blasts(rng, 50);
+
+	obj_init();
+}
+
+TEST(WeaponAreaEffectTest, ship_candidates_use_bounding_box)
+{
+	obj_init();
+
+	area_effect_ship_setup ships;
+
+	std::mt19937 rng(3);
+	create_targets(rng, NUM_TARGETS);
+	ships.create_ships(rng);
+
+	check_random_blasts(rng, 200);
+
+	// A blast right next to the far end of a ship is only in range of its bounding box, not of its radius
+	for (auto objp : list_range(&obj_used_list)) {
+		if (objp->type != OBJ_SHIP) {
+			continue;
+		}
+
+		vec3d pos;
+		vm_vec_scale_add(&pos, &objp->pos, &objp->orient.vec.fvec, 260.0f);
+
+		SCP_vector<object*> candidates;
+		weapon_area_find_candidates(&pos, 20.0f, candidates);
+		ASSERT_NE(candidates.end(), std::find(candidates.begin(), candidates.end(), objp));
+	}
+
+	obj_init();
+}
+
+TEST(WeaponAreaEffectTest, shockwave_candidates_match_full_scan)
+{
+	obj_init();
+
+	area_effect_ship_setup ships;
+
+	std::mt19937 rng(4);
+	create_targets(rng, NUM_TARGETS);
+	ships.create_ships(rng);
+
+	check_random_shockwaves(rng, 200);
+
+	obj_init();
+}
+
+TEST(WeaponAreaEffectTest, candidates_follow_moved_objects)
+{
+	obj_init();
+
+	area_effect_ship_setup ships;
+
+	std::mt19937 rng(5);
+	create_targets(rng, NUM_TARGETS);
+	ships.create_ships(rng);
+	check_random_shockwaves(rng, 50);
+
+	// Move everything far enough to leave the cells it was in, just like a frame of obj_move_all() would
+	for (auto objp : list_range(&obj_used_list)) {
+		objp->pos = random_position(rng);
+	}
+	Obj_positions_version++;
+
+	check_random_blasts(rng, 50);
+	check_random_shockwaves(rng, 50);
+
+	obj_init();
+}
+
+TEST(WeaponAreaEffectTest, candidates_follow_objects_moved_during_pass)
+{
+	obj_init();
+
+	area_effect_ship_setup ships;
+
+	std::mt19937 rng(6);
+	create_targets(rng, NUM_TARGETS);
+	ships.create_ships(rng);
+	check_random_blasts(rng, 20);
+
+	// A few objects leave their cells, these are found without building the grid again
+	move_objects_in_pass(rng, 20);
+	check_random_blasts(rng, 50);
+	check_random_shockwaves(rng, 50);
+
+	// So many objects moved that the grid is built again
+	move_objects_in_pass(rng, 2);
+	check_random_blasts(rng, 50);
+	check_random_shockwaves(rng, 50);
+
+	obj_init();
+}
+
+TEST(WeaponAreaEffectTest, blast_damage_matches_full_scan)
+{
+	obj_init();
+
+	area_effect_missile_setup missiles;
+
+	std::mt19937 rng(7);
+	missiles.create_missiles(rng, NUM_TARGETS);
+
+	std::uniform_real_distribution<float> radius_dist(10.0f, 600.0f);
+	for (int i = 0; i < 100; ++i) {
+		auto pos = random_position(rng);
+		auto outer_rad = radius_dist(rng);
+
+		missiles.check_blast(&pos, outer_rad * 0.25f, outer_rad);
+		ASSERT_FALSE(::testing::Test::HasFatalFailure());
+
+		// missiles keep flying between the explosions of the same frame
+		if (i % 10 == 0) {
+			move_objects_in_pass(rng, 5);
+		}
+	}
+
+	obj_init();
+}
+
+TEST(WeaponAreaEffectTest, shockwave_damage_matches_full_scan)
+{
+	obj_init();
+
+	area_effect_missile_setup missiles;
+
+	std::mt19937 rng(8);
+	missiles.create_missiles(rng, NUM_TARGETS);
+
+	std::uniform_real_distribution<float> radius_dist(100.0f, 800.0f);
+	for (int i = 0; i < 20; ++i) {
+		auto pos = random_position(rng);
+		auto outer_rad = radius_dist(rng);
+
+		missiles.check_shockwave(rng, &pos, outer_rad * 0.25f, outer_rad);
+		ASSERT_FALSE(::testing::Test::HasFatalFailure());
+	}
+
+	obj_init();
+}